@@ -0,0 +1,124 @@
+# Copyright (c) 2021 The Regents of The University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script measures the host time the memory controller spends per
+# served request. A traffic generator issues back-to-back random
+# requests so that the controller queues stay full, which stresses the
+# scheduler rather than the rest of the simulator. Compare the reported
+# host time per request across controller changes, queue depths and
+# channel counts.
+
+import argparse
+import time
+
+import m5
+from m5.objects import *
+from m5.util import addToPath
+
+addToPath('../')
+
+from common import ObjectList
+from common import MemConfig
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("--mem-type", default="DDR4_2400_16x4",
+                    choices=ObjectList.mem_list.get_names(),
+                    help="type of memory to use")
+parser.add_argument("--mem-channels", type=int, default=1,
+                    help="number of memory channels")
+parser.add_argument("--mem-ranks", type=int, default=None,
+                    help="number of ranks per channel")
+parser.add_argument("--buffer-size", type=int, default=128,
+                    help="read and write queue entries per channel")
+parser.add_argument("--sched", default="frfcfs", choices=["fcfs", "frfcfs"],
+                    help="memory scheduling policy")
+parser.add_argument("--rd-perc", type=int, default=70,
+                    help="percentage of read requests")
+parser.add_argument("--duration", default="1ms",
+                    help="simulated time to run the traffic for")
+
+args = parser.parse_args()
+
+system = System(membus=SystemXBar(width=64))
+system.clk_domain = SrcClockDomain(clock='2.0GHz',
+                                   voltage_domain=VoltageDomain(voltage='1V'))
+
+mem_range = AddrRange('1GB')
+system.mem_ranges = [mem_range]
+system.mmap_using_noreserve = True
+
+args.external_memory_system = 0
+args.tlm_memory = 0
+args.elastic_trace_en = 0
+MemConfig.config_mem(args, system)
+
+for ctrl in system.mem_ctrls:
+    if not isinstance(ctrl, m5.objects.MemCtrl):
+        fatal("This script assumes the controller is a MemCtrl subclass")
+    ctrl.mem_sched_policy = args.sched
+    # no point slowing things down by storing any data
+    ctrl.dram.null = True
+    ctrl.dram.read_buffer_size = args.buffer_size
+    ctrl.dram.write_buffer_size = args.buffer_size
+
+system.tgen = PyTrafficGen()
+system.tgen.port = system.membus.cpu_side_ports
+system.system_port = system.membus.cpu_side_ports
+
+root = Root(full_system=False, system=system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+
+duration = m5.ticks.fromSeconds(m5.util.convert.anyToLatency(args.duration))
+
+def traffic():
+    # issue requests as fast as possible to keep the queues full
+    yield system.tgen.createRandom(duration, 0, mem_range.end, 64, 1000, 1000,
+                                   args.rd_perc, 0)
+    yield system.tgen.createExit(0)
+
+system.tgen.start(traffic())
+
+start = time.time()
+exit_event = m5.simulate()
+host_seconds = time.time() - start
+
+def stat_value(group, name):
+    for stat in group.getStats():
+        if stat.name == name:
+            return stat.value
+    fatal("Stat %s not found" % name)
+
+requests = sum(stat_value(ctrl, "readReqs") + stat_value(ctrl, "writeReqs")
+               for ctrl in system.mem_ctrls)
+
+print("Exiting @ tick %i because %s" % (m5.curTick(), exit_event.getCause()))
+print("Requests served: %d" % requests)
+print("Host seconds: %.3f" % host_seconds)
+if requests:
+    print("Host time per request: %.3f us" % (host_seconds * 1e6 / requests))
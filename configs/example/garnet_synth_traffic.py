@@ -35,6 +35,7 @@ import os, optparse, sys
 addToPath('../')
 
 from common import Options
+from network import Network
 from ruby import Ruby
 
 # Get paths we might need.  It's expected this file is in m5/configs/example.
@@ -134,6 +135,14 @@ for ruby_port in system.ruby._cpu_ports:
      cpus[i].test = ruby_port.slave
      i += 1
 
+# Spread the network over several event queues if requested. The
+# testers talk to their sequencer directly, so they have to share the
+# event queue of the sequencer's controller.
+lookahead = Network.partition_network(options, system.ruby.network)
+if lookahead is not None:
+    for (cpu, ruby_port) in zip(cpus, system.ruby._cpu_ports):
+        cpu.eventq_index = ruby_port.get_parent().eventq_index
+
 # -----------------------
 # run simulation
 # -----------------------
@@ -144,6 +153,16 @@ root.system.mem_mode = 'timing'
 # Not much point in this being higher than the L1 latency
 m5.ticks.setGlobalFrequency('1ps')
 
+if lookahead is not None:
+    # Partitions only interact through links between routers, so the
+    # quantum can be as large as the shortest of those links.
+    m5.ticks.fixGlobalFrequency()
+    ruby_period = m5.ticks.fromSeconds(
+        1.0 / m5.util.convert.anyToFrequency(options.ruby_clock))
+    root.sim_quantum = lookahead * ruby_period
+    print("Running garnet on %d event queues with a %d tick quantum" %
+          (options.network_partitions, root.sim_quantum))
+
 # instantiate configuration
 m5.instantiate()
 
@@ -0,0 +1,108 @@
+# Copyright (c) 2021 The Regents of The University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script measures the host time Ruby spends per memory check of the
+# random tester. The tester keeps every sequencer busy with racing loads
+# and stores, so most of the host time goes to the protocol controllers
+# and their cache lookups. The protocol is picked when building gem5, so
+# run this script on builds such as MESI_Two_Level and CHI, and compare
+# the reported host time per check across changes.
+
+import optparse
+import os
+import sys
+import time
+
+import m5
+from m5.objects import *
+from m5.defines import buildEnv
+from m5.util import addToPath
+
+addToPath('../')
+
+from common import Options
+from ruby import Ruby
+
+parser = optparse.OptionParser()
+Options.addNoISAOptions(parser)
+
+parser.add_option("--checks", type="int", default=100000,
+                  help="number of tester checks to complete")
+parser.add_option("-f", "--wakeup_freq", type="int", default=10,
+                  help="wakeup every N cycles")
+
+Ruby.define_options(parser)
+
+(options, args) = parser.parse_args()
+
+if args:
+    print("Error: script doesn't take any positional arguments")
+    sys.exit(1)
+
+tester = RubyTester(check_flush=False,
+                    checks_to_complete=options.checks,
+                    wakeup_frequency=options.wakeup_freq)
+
+system = System(cpu=tester, mem_ranges=[AddrRange(options.mem_size)])
+system.voltage_domain = VoltageDomain(voltage=options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock=options.sys_clock,
+                                   voltage_domain=system.voltage_domain)
+
+Ruby.create_system(options, False, system)
+
+system.ruby.clk_domain = SrcClockDomain(clock=options.ruby_clock,
+                                        voltage_domain=system.voltage_domain)
+
+tester.num_cpus = len(system.ruby._cpu_ports)
+
+for ruby_port in system.ruby._cpu_ports:
+    if ruby_port.support_data_reqs and ruby_port.support_inst_reqs:
+        tester.cpuInstDataPort = ruby_port.slave
+    elif ruby_port.support_data_reqs:
+        tester.cpuDataPort = ruby_port.slave
+    elif ruby_port.support_inst_reqs:
+        tester.cpuInstPort = ruby_port.slave
+
+    ruby_port.no_retry_on_stall = True
+    ruby_port.using_ruby_tester = True
+
+root = Root(full_system=False, system=system)
+root.system.mem_mode = 'timing'
+
+m5.ticks.setGlobalFrequency('1ns')
+
+m5.instantiate()
+
+start = time.time()
+exit_event = m5.simulate(options.abs_max_tick)
+host_seconds = time.time() - start
+
+print("Exiting @ tick %i because %s" % (m5.curTick(), exit_event.getCause()))
+print("Protocol: %s" % buildEnv['PROTOCOL'])
+print("Checks completed: %d" % options.checks)
+print("Host seconds: %.3f" % host_seconds)
+print("Host time per check: %.3f us" %
+      (host_seconds * 1e6 / options.checks))
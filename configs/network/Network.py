@@ -72,6 +72,20 @@ def define_options(parser):
     parser.add_option("--garnet-deadlock-threshold", action="store",
                       type="int", default=50000,
                       help="network-level deadlock threshold.")
+    parser.add_option("--garnet-model", type="choice",
+                      default="cycle_accurate",
+                      choices=['cycle_accurate', 'analytical'],
+                      help="""'cycle_accurate' simulates every flit,
+                            'analytical' routes whole messages and models
+                            contention with per-link occupancy. Much
+                            faster, meant for design-space sweeps.""")
+    parser.add_option("--network-partitions", action="store", type="int",
+                      default=1,
+                      help="""number of event queues (host threads) the
+                            garnet routers, and the controllers attached
+                            to them, are spread over. Routers are split
+                            in contiguous blocks of router ids (groups
+                            of rows in a mesh).""")
 
 def create_network(options, ruby):
 
@@ -113,6 +127,7 @@ def init_network(options, network, InterfaceClass):
         network.ni_flit_size = options.link_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
+        network.network_model = options.garnet_model
 
         # Create Bridges and connect them to the corresponding links
         for intLink in network.int_links:
@@ -190,3 +205,66 @@ def init_network(options, network, InterfaceClass):
         assert(options.network == "garnet")
         network.enable_fault_model = True
         network.fault_model = FaultModel()
+
+def partition_network(options, network):
+    """Spread a garnet network over options.network_partitions event
+    queues. Each router is assigned to a partition together with the
+    controllers, network interfaces and links attached to it, so that
+    partitions only interact through the internal links between
+    routers. Children of the controllers (sequencers, message buffers,
+    memory controllers) inherit their event queue. Returns the
+    smallest latency in cycles of a link crossing partitions, which is
+    the lookahead bounding the simulation quantum, or None if nothing
+    was partitioned."""
+
+    num_partitions = options.network_partitions
+    if num_partitions <= 1:
+        return None
+
+    if options.network != "garnet":
+        fatal("--network-partitions requires the garnet network")
+
+    routers = sorted(network.routers, key=lambda r: r.router_id)
+    if num_partitions > len(routers):
+        fatal("Cannot spread %d routers over %d partitions" %
+              (len(routers), num_partitions))
+
+    partition = {}
+    for (i, router) in enumerate(routers):
+        partition[router.router_id] = i * num_partitions // len(routers)
+        router.eventq_index = partition[router.router_id]
+
+    for (i, ext_link) in enumerate(network.ext_links):
+        if ext_link.ext_cdc or ext_link.ext_serdes or \
+           ext_link.int_cdc or ext_link.int_serdes:
+            fatal("Network bridges are not supported on %s with "
+                  "--network-partitions" % ext_link)
+
+        eq = partition[ext_link.int_node.router_id]
+        ext_link.ext_node.eventq_index = eq
+        for obj in ext_link.descendants():
+            obj.eventq_index = eq
+        if network.netifs:
+            network.netifs[i].eventq_index = eq
+
+    lookahead = None
+    for int_link in network.int_links:
+        if int_link.src_cdc or int_link.src_serdes or \
+           int_link.dst_cdc or int_link.dst_serdes:
+            fatal("Network bridges are not supported on %s with "
+                  "--network-partitions" % int_link)
+
+        # Links are serviced by the object feeding them: the source
+        # router for flits and the destination router for credits.
+        src_eq = partition[int_link.src_node.router_id]
+        dst_eq = partition[int_link.dst_node.router_id]
+        int_link.eventq_index = src_eq
+        int_link.network_link.eventq_index = src_eq
+        int_link.credit_link.eventq_index = dst_eq
+
+        if src_eq != dst_eq:
+            latency = int(int_link.latency)
+            if lookahead is None or latency < lookahead:
+                lookahead = latency
+
+    return lookahead
@@ -2384,7 +2384,7 @@ ISA::addressTranslation64(TLB::ArmTranslationType tran_type,
     // with unexpected atomic snoop requests.
     warn_once("Doing AT (address translation) in functional mode! Fix Me!\n");
 
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         val, 0, flags,  Request::funcRequestorId,
         tc->pcState().pc(), tc->contextId());
 
@@ -2435,7 +2435,7 @@ ISA::addressTranslation(TLB::ArmTranslationType tran_type,
     // with unexpected atomic snoop requests.
     warn_once("Doing AT (address translation) in functional mode! Fix Me!\n");
 
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         val, 0, flags,  Request::funcRequestorId,
         tc->pcState().pc(), tc->contextId());
 
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARCH_GENERIC_MICRO_TLB_HH__
+#define __ARCH_GENERIC_MICRO_TLB_HH__
+
+#include <array>
+#include <cstddef>
+
+#include "base/types.hh"
+
+/**
+ * A small direct mapped cache of recent translations which sits in front
+ * of the lookup of a TLB. Entries are tagged with a page number (with any
+ * address space identifier folded into it) and point to the entry of the
+ * TLB which translates that page.
+ *
+ * The cache doesn't track the entries of the TLB, so it has to be flushed
+ * whenever an entry of the TLB is removed or replaced.
+ */
+template <class Entry, size_t NumEntries = 16>
+class MicroTLB
+{
+  private:
+    struct Slot
+    {
+        Addr tag = MaxAddr;
+        Entry *entry = nullptr;
+    };
+    std::array<Slot, NumEntries> slots;
+
+  public:
+    /** Find the entry for a page, or nullptr if it isn't cached. */
+    Entry *
+    lookup(Addr tag) const
+    {
+        const Slot &slot = slots[tag % NumEntries];
+        return slot.tag == tag ? slot.entry : nullptr;
+    }
+
+    /** Remember the entry for a page. */
+    void
+    insert(Addr tag, Entry *entry)
+    {
+        Slot &slot = slots[tag % NumEntries];
+        slot.tag = tag;
+        slot.entry = entry;
+    }
+
+    /** Forget about all pages. */
+    void
+    flush()
+    {
+        slots.fill(Slot());
+    }
+};
+
+#endif // __ARCH_GENERIC_MICRO_TLB_HH__
@@ -92,11 +92,8 @@ struct TlbEntry : public Serializable
 
     TlbEntryTrie::Handle trieHandle;
 
-    // A sequence number to keep track of LRU.
-    uint64_t lruSeq;
-
     TlbEntry()
-        : paddr(0), vaddr(0), logBytes(0), pte(), lruSeq(0)
+        : paddr(0), vaddr(0), logBytes(0), pte()
     {}
 
     // Return the page size in bytes
@@ -31,6 +31,7 @@
 
 #include "arch/riscv/tlb.hh"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -68,9 +69,14 @@ buildKey(Addr vpn, uint16_t asid)
 
 TLB::TLB(const Params &p) :
     BaseTLB(p), size(p.size), tlb(size),
-    lruSeq(0), stats(this), pma(p.pma_checker)
+    plru(std::max<size_t>(size, 1)), stats(this), pma(p.pma_checker)
 {
-    for (size_t x = 0; x < size; x++) {
+    fatal_if(!size, "TLBs must have a non-zero size.\n");
+
+    // The free list is a stack, so fill it backwards to hand out the
+    // entries in order.
+    freeList.reserve(size);
+    for (size_t x = size; x-- > 0; ) {
         tlb[x].trieHandle = NULL;
         freeList.push_back(&tlb[x]);
     }
@@ -88,49 +94,51 @@ TLB::getWalker()
 void
 TLB::evictLRU()
 {
-    // Find the entry with the lowest (and hence least recently updated)
-    // sequence number.
-
-    size_t lru = 0;
-    for (size_t i = 1; i < size; i++) {
-        if (tlb[i].lruSeq < tlb[lru].lruSeq)
-            lru = i;
-    }
-
-    remove(lru);
+    remove(plru.victim());
 }
 
 TlbEntry *
 TLB::lookup(Addr vpn, uint16_t asid, Mode mode, bool hidden)
 {
-    TlbEntry *entry = trie.lookup(buildKey(vpn, asid));
+    const Addr key = buildKey(vpn, asid);
+
+    if (hidden)
+        return trie.lookup(key);
 
-    if (!hidden) {
+    // Try the last translations first, which spares the walk of the trie.
+    MicroTLB<TlbEntry> &micro_tlb = microTLBs[mode == Execute];
+    const Addr tag = key >> PageShift;
+    TlbEntry *entry = micro_tlb.lookup(tag);
+    if (!entry) {
+        entry = trie.lookup(key);
         if (entry)
-            entry->lruSeq = nextSeq();
+            micro_tlb.insert(tag, entry);
+    }
 
-        if (mode == Write)
-            stats.writeAccesses++;
-        else
-            stats.readAccesses++;
+    if (entry)
+        plru.touch(entry - tlb.data());
 
-        if (!entry) {
-            if (mode == Write)
-                stats.writeMisses++;
-            else
-                stats.readMisses++;
-        }
-        else {
-            if (mode == Write)
-                stats.writeHits++;
-            else
-                stats.readHits++;
-        }
+    if (mode == Write)
+        stats.writeAccesses++;
+    else
+        stats.readAccesses++;
 
-        DPRINTF(TLBVerbose, "lookup(vpn=%#x, asid=%#x): %s ppn %#x\n",
-                vpn, asid, entry ? "hit" : "miss", entry ? entry->paddr : 0);
+    if (!entry) {
+        if (mode == Write)
+            stats.writeMisses++;
+        else
+            stats.readMisses++;
+    }
+    else {
+        if (mode == Write)
+            stats.writeHits++;
+        else
+            stats.readHits++;
     }
 
+    DPRINTF(TLBVerbose, "lookup(vpn=%#x, asid=%#x): %s ppn %#x\n",
+            vpn, asid, entry ? "hit" : "miss", entry ? entry->paddr : 0);
+
     return entry;
 }
 
@@ -152,12 +160,12 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
     if (freeList.empty())
         evictLRU();
 
-    newEntry = freeList.front();
-    freeList.pop_front();
+    newEntry = freeList.back();
+    freeList.pop_back();
 
     Addr key = buildKey(vpn, entry.asid);
     *newEntry = entry;
-    newEntry->lruSeq = nextSeq();
+    plru.touch(newEntry - tlb.data());
     newEntry->vaddr = vpn;
     newEntry->trieHandle =
     trie.insert(key, TlbEntryTrie::MaxBits - entry.logBytes, newEntry);
@@ -212,6 +220,9 @@ TLB::remove(size_t idx)
     trie.remove(tlb[idx].trieHandle);
     tlb[idx].trieHandle = NULL;
     freeList.push_back(&tlb[idx]);
+
+    for (auto &micro_tlb: microTLBs)
+        micro_tlb.flush();
 }
 
 Fault
@@ -470,7 +481,6 @@ TLB::serialize(CheckpointOut &cp) const
     // Only store the entries in use.
     uint32_t _size = size - freeList.size();
     SERIALIZE_SCALAR(_size);
-    SERIALIZE_SCALAR(lruSeq);
 
     uint32_t _count = 0;
     for (uint32_t x = 0; x < size; x++) {
@@ -489,11 +499,13 @@ TLB::unserialize(CheckpointIn &cp)
         fatal("TLB size less than the one in checkpoint!");
     }
 
-    UNSERIALIZE_SCALAR(lruSeq);
+    for (auto &micro_tlb: microTLBs)
+        micro_tlb.flush();
 
     for (uint32_t x = 0; x < _size; x++) {
-        TlbEntry *newEntry = freeList.front();
-        freeList.pop_front();
+        TlbEntry *newEntry = freeList.back();
+        freeList.pop_back();
+        plru.touch(newEntry - tlb.data());
 
         newEntry->unserializeSection(cp, csprintf("Entry%d", x));
         Addr key = buildKey(newEntry->vaddr, newEntry->asid);
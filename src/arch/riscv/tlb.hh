@@ -32,14 +32,16 @@
 #ifndef __ARCH_RISCV_TLB_HH__
 #define __ARCH_RISCV_TLB_HH__
 
-#include <list>
+#include <vector>
 
+#include "arch/generic/micro_tlb.hh"
 #include "arch/generic/tlb.hh"
 #include "arch/riscv/isa.hh"
 #include "arch/riscv/isa_traits.hh"
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/pma_checker.hh"
 #include "arch/riscv/utility.hh"
+#include "base/tree_plru.hh"
 #include "base/statistics.hh"
 #include "mem/request.hh"
 #include "params/RiscvTLB.hh"
@@ -55,14 +57,16 @@ class Walker;
 
 class TLB : public BaseTLB
   {
-    typedef std::list<TlbEntry *> EntryList;
-
   protected:
     size_t size;
     std::vector<TlbEntry> tlb;  // our TLB
     TlbEntryTrie trie;          // for quick access
-    EntryList freeList;         // free entries
-    uint64_t lruSeq;
+    std::vector<TlbEntry *> freeList; // free entries
+    TreePLRU plru;              // replacement state
+
+    // Last translations of instruction fetches and data accesses, tagged
+    // by ASID and page. Flushed whenever an entry is removed.
+    MicroTLB<TlbEntry> microTLBs[2];
 
     Walker *walker;
 
@@ -132,8 +136,6 @@ class TLB : public BaseTLB
                            ThreadContext *tc, Mode mode) const override;
 
   private:
-    uint64_t nextSeq() { return ++lruSeq; }
-
     TlbEntry *lookup(Addr vpn, uint16_t asid, Mode mode, bool hidden);
 
     void evictLRU();
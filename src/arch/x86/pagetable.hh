@@ -85,8 +85,6 @@ namespace X86ISA
         bool patBit;
         // Whether or not memory on this page can be executed.
         bool noExec;
-        // A sequence number to keep track of LRU.
-        uint64_t lruSeq;
 
         TlbEntryTrie::Handle trieHandle;
 
@@ -37,6 +37,7 @@
 
 #include "arch/x86/tlb.hh"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -61,12 +62,16 @@ namespace X86ISA {
 
 TLB::TLB(const Params &p)
     : BaseTLB(p), configAddress(0), size(p.size),
-      tlb(size), lruSeq(0), m5opRange(p.system->m5opRange()), stats(this)
+      tlb(size), plru(std::max<uint32_t>(size, 1)),
+      m5opRange(p.system->m5opRange()), stats(this)
 {
     if (!size)
         fatal("TLBs must have a non-zero size.\n");
 
-    for (int x = 0; x < size; x++) {
+    // The free list is a stack, so fill it backwards to hand out the
+    // entries in order.
+    freeList.reserve(size);
+    for (int x = size - 1; x >= 0; x--) {
         tlb[x].trieHandle = NULL;
         freeList.push_back(&tlb[x]);
     }
@@ -78,19 +83,17 @@ TLB::TLB(const Params &p)
 void
 TLB::evictLRU()
 {
-    // Find the entry with the lowest (and hence least recently updated)
-    // sequence number.
-
-    unsigned lru = 0;
-    for (unsigned i = 1; i < size; i++) {
-        if (tlb[i].lruSeq < tlb[lru].lruSeq)
-            lru = i;
-    }
+    freeEntry(&tlb[plru.victim()]);
+}
 
-    assert(tlb[lru].trieHandle);
-    trie.remove(tlb[lru].trieHandle);
-    tlb[lru].trieHandle = NULL;
-    freeList.push_back(&tlb[lru]);
+void
+TLB::freeEntry(TlbEntry *entry)
+{
+    assert(entry->trieHandle);
+    trie.remove(entry->trieHandle);
+    entry->trieHandle = NULL;
+    freeList.push_back(entry);
+    flushMicroTLBs();
 }
 
 TlbEntry *
@@ -106,11 +109,11 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
     if (freeList.empty())
         evictLRU();
 
-    newEntry = freeList.front();
-    freeList.pop_front();
+    newEntry = freeList.back();
+    freeList.pop_back();
 
     *newEntry = entry;
-    newEntry->lruSeq = nextSeq();
+    plru.touch(newEntry - tlb.data());
     newEntry->vaddr = vpn;
     newEntry->trieHandle =
     trie.insert(vpn, TlbEntryTrie::MaxBits - entry.logBytes, newEntry);
@@ -122,7 +125,25 @@ TLB::lookup(Addr va, bool update_lru)
 {
     TlbEntry *entry = trie.lookup(va);
     if (entry && update_lru)
-        entry->lruSeq = nextSeq();
+        plru.touch(entry - tlb.data());
+    return entry;
+}
+
+TlbEntry *
+TLB::cachedLookup(Addr va, Mode mode)
+{
+    MicroTLB<TlbEntry> &micro_tlb = microTLB(mode);
+    const Addr tag = va >> PageShift;
+
+    TlbEntry *entry = micro_tlb.lookup(tag);
+    if (entry) {
+        plru.touch(entry - tlb.data());
+        return entry;
+    }
+
+    entry = lookup(va);
+    if (entry)
+        micro_tlb.insert(tag, entry);
     return entry;
 }
 
@@ -131,11 +152,8 @@ TLB::flushAll()
 {
     DPRINTF(TLB, "Invalidating all entries.\n");
     for (unsigned i = 0; i < size; i++) {
-        if (tlb[i].trieHandle) {
-            trie.remove(tlb[i].trieHandle);
-            tlb[i].trieHandle = NULL;
-            freeList.push_back(&tlb[i]);
-        }
+        if (tlb[i].trieHandle)
+            freeEntry(&tlb[i]);
     }
 }
 
@@ -150,11 +168,8 @@ TLB::flushNonGlobal()
 {
     DPRINTF(TLB, "Invalidating all non global entries.\n");
     for (unsigned i = 0; i < size; i++) {
-        if (tlb[i].trieHandle && !tlb[i].global) {
-            trie.remove(tlb[i].trieHandle);
-            tlb[i].trieHandle = NULL;
-            freeList.push_back(&tlb[i]);
-        }
+        if (tlb[i].trieHandle && !tlb[i].global)
+            freeEntry(&tlb[i]);
     }
 }
 
@@ -162,11 +177,8 @@ void
 TLB::demapPage(Addr va, uint64_t asn)
 {
     TlbEntry *entry = trie.lookup(va);
-    if (entry) {
-        trie.remove(entry->trieHandle);
-        entry->trieHandle = NULL;
-        freeList.push_back(entry);
-    }
+    if (entry)
+        freeEntry(entry);
 }
 
 namespace
@@ -371,7 +383,7 @@ TLB::translate(const RequestPtr &req,
         if (m5Reg.paging) {
             DPRINTF(TLB, "Paging enabled.\n");
             // The vaddr already has the segment base applied.
-            TlbEntry *entry = lookup(vaddr);
+            TlbEntry *entry = cachedLookup(vaddr, mode);
             if (mode == Read) {
                 stats.rdAccesses++;
             } else {
@@ -533,7 +545,6 @@ TLB::serialize(CheckpointOut &cp) const
     // Only store the entries in use.
     uint32_t _size = size - freeList.size();
     SERIALIZE_SCALAR(_size);
-    SERIALIZE_SCALAR(lruSeq);
 
     uint32_t _count = 0;
     for (uint32_t x = 0; x < size; x++) {
@@ -552,11 +563,11 @@ TLB::unserialize(CheckpointIn &cp)
         fatal("TLB size less than the one in checkpoint!");
     }
 
-    UNSERIALIZE_SCALAR(lruSeq);
-
+    flushMicroTLBs();
     for (uint32_t x = 0; x < _size; x++) {
-        TlbEntry *newEntry = freeList.front();
-        freeList.pop_front();
+        TlbEntry *newEntry = freeList.back();
+        freeList.pop_back();
+        plru.touch(newEntry - tlb.data());
 
         newEntry->unserializeSection(cp, csprintf("Entry%d", x));
         newEntry->trieHandle = trie.insert(newEntry->vaddr,
@@ -38,11 +38,12 @@
 #ifndef __ARCH_X86_TLB_HH__
 #define __ARCH_X86_TLB_HH__
 
-#include <list>
 #include <vector>
 
+#include "arch/generic/micro_tlb.hh"
 #include "arch/generic/tlb.hh"
 #include "arch/x86/pagetable.hh"
+#include "base/tree_plru.hh"
 #include "base/trie.hh"
 #include "mem/request.hh"
 #include "params/X86TLB.hh"
@@ -59,8 +60,6 @@ namespace X86ISA
       protected:
         friend class Walker;
 
-        typedef std::list<TlbEntry *> EntryList;
-
         uint32_t configAddress;
 
       public:
@@ -76,7 +75,14 @@ namespace X86ISA
 
       protected:
 
-        EntryList::iterator lookupIt(Addr va, bool update_lru = true);
+        /**
+         * Look up the entry for an address through the micro TLB of the
+         * kind of access, falling back to the full lookup on a miss.
+         */
+        TlbEntry *cachedLookup(Addr va, Mode mode);
+
+        /** Make an entry available again and forget about it. */
+        void freeEntry(TlbEntry *entry);
 
         Walker * walker;
 
@@ -94,10 +100,30 @@ namespace X86ISA
 
         std::vector<TlbEntry> tlb;
 
-        EntryList freeList;
+        std::vector<TlbEntry *> freeList;
 
         TlbEntryTrie trie;
-        uint64_t lruSeq;
+        TreePLRU plru;
+
+        /**
+         * Direct mapped caches of the last translations, one for
+         * instruction fetches and one for data accesses. They are flushed
+         * whenever an entry is freed.
+         */
+        MicroTLB<TlbEntry> microTLBs[2];
+
+        MicroTLB<TlbEntry> &
+        microTLB(Mode mode)
+        {
+            return microTLBs[mode == Execute];
+        }
+
+        void
+        flushMicroTLBs()
+        {
+            for (auto &micro_tlb: microTLBs)
+                micro_tlb.flush();
+        }
 
         AddrRange m5opRange;
 
@@ -120,12 +146,6 @@ namespace X86ISA
 
         void evictLRU();
 
-        uint64_t
-        nextSeq()
-        {
-            return ++lruSeq;
-        }
-
         Fault translateAtomic(
             const RequestPtr &req, ThreadContext *tc, Mode mode) override;
         Fault translateFunctional(
@@ -94,6 +94,10 @@
 // Prevent a function from being inlined.
 #  define M5_NO_INLINE [[gnu::noinline]]
 
+// Inline a function into all its callers, whatever the optimization level.
+// The function has to be defined in every translation unit calling it.
+#  define M5_FORCE_INLINE [[gnu::always_inline]] inline
+
 // Set the visibility of a symbol.
 #  define M5_PUBLIC [[gnu:visibility("default")]]
 #  define M5_LOCAL [[gnu::visibility("hidden")]]
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/free_list_pool.hh"
+
+#include <algorithm>
+#include <mutex>
+
+#include "base/logging.hh"
+
+/**
+ * The free lists and counters of every pool for one thread. Live thread
+ * states are tracked so that statistics can be collected from all of
+ * them.
+ */
+struct FreeListPool::ThreadState
+{
+    ThreadCache caches[maxPools];
+
+    ThreadState();
+    ~ThreadState();
+};
+
+namespace
+{
+
+std::mutex &
+registryMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<FreeListPool *> &
+poolRegistry()
+{
+    static std::vector<FreeListPool *> pools;
+    return pools;
+}
+
+/** Add a pool to the registry and return its index there. */
+int
+registerPool(FreeListPool *pool)
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto &pools = poolRegistry();
+    fatal_if(pools.size() >= FreeListPool::maxPools,
+             "Too many memory pools, can't create %s.", pool->name());
+    pools.push_back(pool);
+    return pools.size() - 1;
+}
+
+} // anonymous namespace
+
+std::vector<FreeListPool::ThreadState *> &
+FreeListPool::threadStates()
+{
+    static std::vector<ThreadState *> threads;
+    return threads;
+}
+
+FreeListPool::ThreadState::ThreadState()
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+    threadStates().push_back(this);
+}
+
+FreeListPool::ThreadState::~ThreadState()
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+
+    auto &threads = threadStates();
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        if (*it == this) {
+            threads.erase(it);
+            break;
+        }
+    }
+
+    const auto &pools = poolRegistry();
+    for (int i = 0; i < pools.size(); i++) {
+        ThreadCache &cache = caches[i];
+        pools[i]->retiredHits += cache.hits;
+        pools[i]->retiredMisses += cache.misses;
+        while (cache.head) {
+            FreeChunk *chunk = cache.head;
+            cache.head = chunk->next;
+            ::operator delete(chunk);
+        }
+    }
+}
+
+FreeListPool::FreeListPool(const std::string &name, size_t chunk_size)
+    : _name(name), _chunkSize(std::max(chunk_size, sizeof(FreeChunk))),
+      index(registerPool(this)), reserved(0), retiredHits(0),
+      retiredMisses(0)
+{
+}
+
+FreeListPool::ThreadCache &
+FreeListPool::threadCache()
+{
+    static thread_local ThreadState state;
+    return state.caches[index];
+}
+
+void
+FreeListPool::reserve(size_t num)
+{
+#ifndef NO_MEM_POOLS
+    size_t prev = reserved.load(std::memory_order_relaxed);
+    while (prev < num &&
+           !reserved.compare_exchange_weak(prev, num,
+                                           std::memory_order_relaxed)) {
+    }
+    warmUp(threadCache());
+#endif
+}
+
+void
+FreeListPool::warmUp(ThreadCache &cache)
+{
+    cache.warm = true;
+
+    const size_t num = reserved.load(std::memory_order_relaxed);
+    cache.limit = std::max(cache.limit, num);
+    for (; cache.free < num; cache.free++) {
+        FreeChunk *chunk = static_cast<FreeChunk *>(::operator new(_chunkSize));
+        chunk->next = cache.head;
+        cache.head = chunk;
+    }
+}
+
+Counter
+FreeListPool::hits() const
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+    Counter total = retiredHits;
+    for (auto *thread: threadStates())
+        total += thread->caches[index].hits;
+    return total;
+}
+
+Counter
+FreeListPool::misses() const
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+    Counter total = retiredMisses;
+    for (auto *thread: threadStates())
+        total += thread->caches[index].misses;
+    return total;
+}
+
+const std::vector<FreeListPool *> &
+FreeListPool::pools()
+{
+    return poolRegistry();
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_FREE_LIST_POOL_HH__
+#define __BASE_FREE_LIST_POOL_HH__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * A pool of fixed size chunks of memory for objects which are allocated
+ * and freed at a very high rate, e.g. packets and requests.
+ *
+ * Freed chunks are pushed onto a free list which is private to the
+ * calling thread, so neither allocation nor release needs any locking,
+ * even when the simulator runs several event queues in parallel. A chunk
+ * may be released by a different thread than the one which allocated it,
+ * in which case it simply joins the releasing thread's free list. Free
+ * lists are capped, so a thread which only releases chunks that other
+ * threads allocated hands the excess back to the heap rather than
+ * hoarding it. The rest of the memory is handed back when a thread exits.
+ *
+ * When gem5 is built with NO_MEM_POOLS defined (see --without-mem-pools,
+ * which is implied by --with-asan) every allocation goes straight to the
+ * heap so that memory checkers see each object individually.
+ */
+class FreeListPool
+{
+  public:
+    /** Maximum number of pools which can exist in the simulator. */
+    static const int maxPools = 16;
+
+    /**
+     * Maximum number of chunks on the free list of a thread, unless more
+     * were reserved with reserve().
+     */
+    static const size_t maxFree = 4096;
+
+    /**
+     * @param name Name of the pool, used when reporting statistics.
+     * @param chunk_size Size of every chunk handed out by this pool.
+     */
+    FreeListPool(const std::string &name, size_t chunk_size);
+
+    /** Pools are global, and are never destroyed while in use. */
+    FreeListPool(const FreeListPool &) = delete;
+    FreeListPool &operator=(const FreeListPool &) = delete;
+
+    const std::string &name() const { return _name; }
+    size_t chunkSize() const { return _chunkSize; }
+
+    /** Get a chunk of chunkSize() bytes. */
+    void *
+    allocate()
+    {
+#ifndef NO_MEM_POOLS
+        ThreadCache &cache = threadCache();
+        if (!cache.head && !cache.warm)
+            warmUp(cache);
+        if (cache.head) {
+            FreeChunk *chunk = cache.head;
+            cache.head = chunk->next;
+            cache.free--;
+            bump(cache.hits);
+            return chunk;
+        }
+        bump(cache.misses);
+#else
+        bump(threadCache().misses);
+#endif
+        return ::operator new(_chunkSize);
+    }
+
+    /** Return a chunk previously obtained from allocate(). */
+    void
+    release(void *p)
+    {
+        if (!p)
+            return;
+#ifndef NO_MEM_POOLS
+        ThreadCache &cache = threadCache();
+        if (cache.free >= cache.limit) {
+            ::operator delete(p);
+            return;
+        }
+        FreeChunk *chunk = static_cast<FreeChunk *>(p);
+        chunk->next = cache.head;
+        cache.head = chunk;
+        cache.free++;
+#else
+        ::operator delete(p);
+#endif
+    }
+
+    /**
+     * Get size bytes, from a chunk if they fit in one and from the heap
+     * otherwise, e.g. for classes of different sizes sharing a pool.
+     */
+    void *
+    allocate(size_t size)
+    {
+        return size <= _chunkSize ? allocate() : ::operator new(size);
+    }
+
+    /** Return size bytes previously obtained from allocate(size). */
+    void
+    release(void *p, size_t size)
+    {
+        if (size <= _chunkSize)
+            release(p);
+        else
+            ::operator delete(p);
+    }
+
+    /**
+     * Make sure that every thread can allocate num chunks without going
+     * to the heap, e.g. to warm up the pool for a structure of known
+     * capacity. The calling thread's free list is filled up right away,
+     * and the one of any other thread when it first runs out of chunks.
+     */
+    void reserve(size_t num);
+
+    /**
+     * Count an allocation which the caller avoided by other means, e.g.
+     * by reusing an object it kept instead of releasing it, so that it
+     * shows up in the hits of the pool.
+     */
+    void noteReuse() { bump(threadCache().hits); }
+
+    /** Number of allocations served from a free list, over all threads. */
+    Counter hits() const;
+    /** Number of allocations which had to go to the heap. */
+    Counter misses() const;
+
+    /** All the pools which have been created. */
+    static const std::vector<FreeListPool *> &pools();
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    /**
+     * Per thread state of a pool. The counters are only ever written by
+     * the owning thread, but are atomic so that statistics can be
+     * gathered from another one.
+     */
+    struct ThreadCache
+    {
+        FreeChunk *head = nullptr;
+        /** Number of chunks on the free list. */
+        size_t free = 0;
+        /** Number of chunks the free list may hold. */
+        size_t limit = maxFree;
+        /** The free list has been filled up to the reserved size. */
+        bool warm = false;
+        std::atomic<Counter> hits{0};
+        std::atomic<Counter> misses{0};
+    };
+
+    struct ThreadState;
+
+    /** The state of every live thread which has used a pool. */
+    static std::vector<ThreadState *> &threadStates();
+
+    static void
+    bump(std::atomic<Counter> &c)
+    {
+        // Only the owning thread writes, so there is no need for a
+        // (much more expensive) atomic read-modify-write.
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    }
+
+    ThreadCache &threadCache();
+
+    /** Fill a free list up to the reserved number of chunks. */
+    void warmUp(ThreadCache &cache);
+
+    const std::string _name;
+    const size_t _chunkSize;
+    const int index;
+
+    /** Number of chunks every thread should have, see reserve(). */
+    std::atomic<size_t> reserved;
+
+    /** Counts from threads which have exited. */
+    std::atomic<Counter> retiredHits;
+    std::atomic<Counter> retiredMisses;
+};
+
+/**
+ * A standard library compatible allocator which takes single objects
+ * from a FreeListPool, e.g. for use with std::allocate_shared. Requests
+ * for more than one object are passed on to the heap. Single objects must
+ * fit in a chunk, which is asserted. Builds without assertions pass the
+ * ones which don't on to the heap as well.
+ */
+template <typename T>
+class PoolAllocator
+{
+  public:
+    typedef T value_type;
+
+    explicit PoolAllocator(FreeListPool &_pool) : pool(&_pool) {}
+
+    /**
+     * Chunk size of a pool for objects created with std::allocate_shared.
+     * Their chunks also hold the reference counts, a vtable pointer and a
+     * copy of the allocator, with padding to align the object.
+     */
+    static constexpr size_t
+    sharedChunkSize()
+    {
+        return sizeof(T) + alignof(T) + 4 * sizeof(void *);
+    }
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &other) : pool(other.pool)
+    {}
+
+    /**
+     * Arrays which fit in a chunk, such as the buffer of a small vector,
+     * are taken from the pool too.
+     */
+    T *
+    allocate(size_t n)
+    {
+        assert(n != 1 || sizeof(T) <= pool->chunkSize());
+        if (n > std::allocator<T>().max_size())
+            throw std::bad_alloc();
+        return static_cast<T *>(pool->allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *p, size_t n)
+    {
+        pool->release(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool
+    operator==(const PoolAllocator<U> &other) const
+    {
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool
+    operator!=(const PoolAllocator<U> &other) const
+    {
+        return pool != other.pool;
+    }
+
+    FreeListPool *pool;
+};
+
+#endif // __BASE_FREE_LIST_POOL_HH__
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "base/free_list_pool.hh"
+
+namespace
+{
+
+FreeListPool testPool("test", 48);
+FreeListPool sharedPool("test_shared", 128);
+FreeListPool tinyPool("test_tiny", 1);
+FreeListPool reservedPool("test_reserved", 64);
+FreeListPool cappedPool("test_capped", 64);
+
+struct Payload
+{
+    int a;
+    double b;
+    Payload(int _a, double _b) : a(_a), b(_b) {}
+};
+
+FreeListPool sizedPool("test_sized",
+                       PoolAllocator<Payload>::sharedChunkSize());
+
+} // anonymous namespace
+
+TEST(FreeListPoolTest, ChunkSize)
+{
+    EXPECT_EQ(48, testPool.chunkSize());
+    EXPECT_EQ("test", testPool.name());
+
+    // Chunks must at least be able to hold the free list link.
+    EXPECT_EQ(sizeof(void *), tinyPool.chunkSize());
+}
+
+TEST(FreeListPoolTest, Registered)
+{
+    const auto &pools = FreeListPool::pools();
+    std::set<const FreeListPool *> found(pools.begin(), pools.end());
+    EXPECT_EQ(1, found.count(&testPool));
+    EXPECT_EQ(1, found.count(&sharedPool));
+}
+
+TEST(FreeListPoolTest, Reuse)
+{
+    Counter hits = testPool.hits();
+    Counter misses = testPool.misses();
+
+    void *first = testPool.allocate();
+    void *second = testPool.allocate();
+    EXPECT_NE(first, second);
+
+    testPool.release(first);
+    testPool.release(second);
+
+#ifndef NO_MEM_POOLS
+    // The free list is LIFO.
+    EXPECT_EQ(second, testPool.allocate());
+    EXPECT_EQ(first, testPool.allocate());
+#else
+    first = testPool.allocate();
+    second = testPool.allocate();
+#endif
+
+    testPool.release(first);
+    testPool.release(second);
+    testPool.release(nullptr);
+
+    EXPECT_EQ(hits + misses + 4, testPool.hits() + testPool.misses());
+#ifndef NO_MEM_POOLS
+    EXPECT_LE(hits + 2, testPool.hits());
+#endif
+}
+
+TEST(FreeListPoolTest, Threads)
+{
+#ifndef NO_MEM_POOLS
+    Counter hits = testPool.hits();
+#endif
+    Counter misses = testPool.misses();
+
+    // Each thread gets its own free list, and gives its memory back when
+    // it finishes, but the counts it gathered are kept.
+    std::thread worker([] {
+        for (int i = 0; i < 10; i++)
+            testPool.release(testPool.allocate());
+    });
+    worker.join();
+
+#ifndef NO_MEM_POOLS
+    EXPECT_EQ(hits + 9, testPool.hits());
+    EXPECT_EQ(misses + 1, testPool.misses());
+#else
+    EXPECT_EQ(misses + 10, testPool.misses());
+#endif
+}
+
+TEST(FreeListPoolTest, Reserve)
+{
+    Counter hits = reservedPool.hits();
+    Counter misses = reservedPool.misses();
+
+    reservedPool.reserve(4);
+    // Reserving again doesn't add chunks which are already there.
+    reservedPool.reserve(2);
+
+    void *chunks[4];
+    for (auto &chunk: chunks)
+        chunk = reservedPool.allocate();
+    for (auto &chunk: chunks)
+        reservedPool.release(chunk);
+
+#ifndef NO_MEM_POOLS
+    EXPECT_EQ(hits + 4, reservedPool.hits());
+    EXPECT_EQ(misses, reservedPool.misses());
+#else
+    EXPECT_EQ(misses + 4, reservedPool.misses());
+#endif
+
+    // Other threads get the reserved chunks as well, e.g. the threads
+    // of the event queues a simulated object is run by.
+    std::thread worker([] {
+        void *chunks[4];
+        for (auto &chunk: chunks)
+            chunk = reservedPool.allocate();
+        for (auto &chunk: chunks)
+            reservedPool.release(chunk);
+    });
+    worker.join();
+
+#ifndef NO_MEM_POOLS
+    EXPECT_EQ(hits + 8, reservedPool.hits());
+    EXPECT_EQ(misses, reservedPool.misses());
+#else
+    EXPECT_EQ(misses + 8, reservedPool.misses());
+#endif
+}
+
+TEST(FreeListPoolTest, NoteReuse)
+{
+    Counter hits = testPool.hits();
+    Counter misses = testPool.misses();
+    testPool.noteReuse();
+    EXPECT_EQ(hits + 1, testPool.hits());
+    EXPECT_EQ(misses, testPool.misses());
+}
+
+TEST(FreeListPoolTest, CrossThreadRelease)
+{
+    void *chunk = testPool.allocate();
+    std::thread worker([chunk] { testPool.release(chunk); });
+    worker.join();
+    SUCCEED();
+}
+
+TEST(FreeListPoolTest, CrossThreadReleaseIsCapped)
+{
+    // A thread which releases the chunks of another one keeps no more
+    // than maxFree of them.
+    const size_t num = FreeListPool::maxFree + 10;
+    std::vector<void *> chunks(num);
+    for (auto &chunk: chunks)
+        chunk = cappedPool.allocate();
+
+    std::thread worker([&chunks] {
+        for (auto *chunk: chunks)
+            cappedPool.release(chunk);
+
+        Counter hits = cappedPool.hits();
+        Counter misses = cappedPool.misses();
+        for (auto &chunk: chunks)
+            chunk = cappedPool.allocate();
+#ifndef NO_MEM_POOLS
+        EXPECT_EQ(hits + FreeListPool::maxFree, cappedPool.hits());
+        EXPECT_EQ(misses + 10, cappedPool.misses());
+#else
+        EXPECT_EQ(misses + chunks.size(), cappedPool.misses());
+#endif
+        for (auto *chunk: chunks)
+            cappedPool.release(chunk);
+    });
+    worker.join();
+}
+
+TEST(PoolAllocatorTest, SharedChunkSize)
+{
+    // Objects created with std::allocate_shared fit in a chunk of a pool
+    // sized for them, along with their reference counts.
+    Counter hits = sizedPool.hits();
+    Counter misses = sizedPool.misses();
+
+    PoolAllocator<Payload> alloc(sizedPool);
+    std::allocate_shared<Payload>(alloc, 1, 2.0).reset();
+    auto second = std::allocate_shared<Payload>(alloc, 3, 4.0);
+    EXPECT_EQ(3, second->a);
+
+#ifndef NO_MEM_POOLS
+    EXPECT_EQ(hits + 1, sizedPool.hits());
+    EXPECT_EQ(misses + 1, sizedPool.misses());
+#else
+    EXPECT_EQ(misses + 2, sizedPool.misses());
+#endif
+}
+
+TEST(PoolAllocatorTest, SharedPtr)
+{
+    Counter misses = sharedPool.misses();
+    Counter hits = sharedPool.hits();
+
+    PoolAllocator<Payload> alloc(sharedPool);
+    auto first = std::allocate_shared<Payload>(alloc, 1, 2.0);
+    EXPECT_EQ(1, first->a);
+    EXPECT_EQ(2.0, first->b);
+    first.reset();
+
+    auto second = std::allocate_shared<Payload>(alloc, 3, 4.0);
+    EXPECT_EQ(3, second->a);
+    EXPECT_EQ(4.0, second->b);
+
+    EXPECT_EQ(misses + hits + 2, sharedPool.misses() + sharedPool.hits());
+#ifndef NO_MEM_POOLS
+    EXPECT_EQ(hits + 1, sharedPool.hits());
+#endif
+}
+
+TEST(PoolAllocatorTest, Arrays)
+{
+    // Arrays larger than a chunk go to the heap.
+    Counter misses = sharedPool.misses();
+    PoolAllocator<Payload> alloc(sharedPool);
+    Payload *array = alloc.allocate(100);
+    alloc.deallocate(array, 100);
+    EXPECT_EQ(misses, sharedPool.misses());
+}
+
+TEST(PoolAllocatorTest, SmallArrays)
+{
+    // Arrays which fit in a chunk are taken from the pool.
+    Counter misses = sharedPool.misses();
+    Counter hits = sharedPool.hits();
+    PoolAllocator<char> alloc(sharedPool);
+    const size_t n = sharedPool.chunkSize();
+    alloc.deallocate(alloc.allocate(n), n);
+    char *array = alloc.allocate(n);
+    alloc.deallocate(array, n);
+    EXPECT_EQ(misses + hits + 2, sharedPool.misses() + sharedPool.hits());
+#ifndef NO_MEM_POOLS
+    EXPECT_LE(hits + 1, sharedPool.hits());
+#endif
+}
+
+TEST(PoolAllocatorTest, Equality)
+{
+    PoolAllocator<Payload> a(testPool);
+    PoolAllocator<int> b(testPool);
+    PoolAllocator<Payload> c(sharedPool);
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a != b);
+    EXPECT_TRUE(a != c);
+}
@@ -138,6 +138,15 @@ class RefCountingPtr
             RefCountingPtr<T>>::type;
     friend NonConstT;
     /** @} */
+    /// Pointers to derived classes are converted to this one.
+    template <class U> friend class RefCountingPtr;
+
+    /// Whether a pointer to a U can become a pointer to a T, other than by
+    /// adding const to the same type.
+    template <class U>
+    using IfDerived = std::enable_if_t<std::is_convertible<U *, T *>::value &&
+        !std::is_same<std::remove_const_t<U>,
+                      std::remove_const_t<T>>::value>;
     /// The stored pointer.
     /// Arguably this should be private.
     T *data;
@@ -207,6 +216,20 @@ class RefCountingPtr
     template <bool B = TisConst>
     RefCountingPtr(const NonConstT &r) { copy(r.data); }
 
+    /// Create a pointer to the object of a pointer to a derived class.
+    /// Adds a reference.
+    template <class U, class = IfDerived<U>>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.data); }
+
+    /// Move a pointer to a derived class into this one.
+    /// Does not add a reference.
+    template <class U, class = IfDerived<U>>
+    RefCountingPtr(RefCountingPtr<U> &&r)
+    {
+        data = r.data;
+        r.data = nullptr;
+    }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -68,6 +68,11 @@ class TestRC : public RefCounted
 };
 typedef RefCountingPtr<TestRC> Ptr;
 
+class DerivedRC : public TestRC
+{
+};
+typedef RefCountingPtr<DerivedRC> DerivedPtr;
+
 } // anonymous namespace
 
 TEST(RefcntTest, NullPointerCheck)
@@ -170,3 +175,28 @@ TEST(RefcntTest, EqualityOperators)
     EXPECT_TRUE(equalTestAPtr != equalTestB);
     EXPECT_TRUE(equalTestAPtr != equalTestBPtr);
 }
+
+TEST(RefcntTest, DerivedToBaseConversion)
+{
+    // Copying a pointer to a derived class adds a reference.
+    DerivedPtr derived = new DerivedRC();
+    Ptr copied = derived;
+    EXPECT_EQ(copied.get(), derived.get());
+    derived = NULL;
+    EXPECT_EQ(1, liveListSize());
+
+    // Moving one transfers the reference.
+    DerivedPtr source = new DerivedRC();
+    Ptr moved = std::move(source);
+    EXPECT_EQ(NULL, source.get());
+    EXPECT_EQ(2, liveListSize());
+    copied = NULL;
+    moved = NULL;
+    EXPECT_EQ(0, liveListSize());
+
+    // Constness can be added along the way.
+    RefCountingPtr<const TestRC> const_ptr = DerivedPtr(new DerivedRC());
+    EXPECT_EQ(1, liveListSize());
+    const_ptr = NULL;
+    EXPECT_EQ(0, liveListSize());
+}
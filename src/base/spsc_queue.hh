@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_SPSC_QUEUE_HH__
+#define __BASE_SPSC_QUEUE_HH__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * A bounded, lock-free queue connecting exactly one producer thread to
+ * exactly one consumer thread. Each side owns one of the two indices
+ * and only reads the other one, so neither push() nor pop() ever
+ * blocks; they fail instead when the queue is full or empty, and it is
+ * up to the caller to decide how to wait.
+ *
+ * The indices increase monotonically and are reduced modulo the
+ * capacity, which is rounded up to a power of two, when used.
+ */
+template <typename T>
+class SpscQueue
+{
+  private:
+    /** Keep the indices on separate cache lines to avoid false sharing */
+    static constexpr size_t cacheLineSize = 64;
+
+    std::vector<T> slots;
+    const size_t mask;
+
+    /** Next slot to pop, only written by the consumer */
+    alignas(cacheLineSize) std::atomic<size_t> head;
+    /** Next slot to push, only written by the producer */
+    alignas(cacheLineSize) std::atomic<size_t> tail;
+
+    static size_t
+    roundCapacity(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+  public:
+    /**
+     * @param capacity Minimum number of elements the queue can hold
+     */
+    explicit SpscQueue(size_t capacity)
+        : slots(roundCapacity(capacity)), mask(slots.size() - 1),
+          head(0), tail(0)
+    {
+        assert(capacity > 0);
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /** Number of elements the queue can hold */
+    size_t capacity() const { return slots.size(); }
+
+    /**
+     * Append an element. Only to be called by the producer.
+     *
+     * @return False if the queue is full, the element is not consumed
+     */
+    bool
+    push(T &&val)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size())
+            return false;
+        slots[t & mask] = std::move(val);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool
+    push(const T &val)
+    {
+        T copy(val);
+        return push(std::move(copy));
+    }
+
+    /**
+     * Remove the oldest element. Only to be called by the consumer.
+     *
+     * @return False if the queue is empty
+     */
+    bool
+    pop(T &val)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h)
+            return false;
+        val = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Number of elements in the queue. A hint unless the other side is
+     * known not to be pushing or popping at the same time.
+     */
+    size_t
+    size() const
+    {
+        // Load the head first, it can't pass the tail loaded after it
+        const size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    /**
+     * Check for elements. Exact when called by the consumer, a hint
+     * otherwise.
+     */
+    bool
+    empty() const
+    {
+        return head.load(std::memory_order_acquire) ==
+            tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif // __BASE_SPSC_QUEUE_HH__
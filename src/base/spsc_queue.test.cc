@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "base/spsc_queue.hh"
+
+TEST(SpscQueue, Capacity)
+{
+    SpscQueue<int> q(5);
+    EXPECT_EQ(q.capacity(), 8u);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(SpscQueue, FullAndEmpty)
+{
+    SpscQueue<int> q(4);
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(q.push(i));
+    EXPECT_FALSE(q.push(4));
+    EXPECT_FALSE(q.empty());
+
+    int val;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(q.pop(val));
+        EXPECT_EQ(val, i);
+    }
+    EXPECT_FALSE(q.pop(val));
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(SpscQueue, Size)
+{
+    SpscQueue<int> q(4);
+    EXPECT_EQ(q.size(), 0u);
+    int val;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(q.push(i));
+        ASSERT_TRUE(q.push(i));
+        EXPECT_EQ(q.size(), 2u);
+        ASSERT_TRUE(q.pop(val));
+        EXPECT_EQ(q.size(), 1u);
+        ASSERT_TRUE(q.pop(val));
+        EXPECT_EQ(q.size(), 0u);
+    }
+}
+
+/** The indices keep growing past the capacity and wrap around */
+TEST(SpscQueue, WrapAround)
+{
+    SpscQueue<int> q(2);
+    int val;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(q.push(i));
+        ASSERT_TRUE(q.push(i + 1000));
+        ASSERT_TRUE(q.pop(val));
+        EXPECT_EQ(val, i);
+        ASSERT_TRUE(q.pop(val));
+        EXPECT_EQ(val, i + 1000);
+    }
+}
+
+TEST(SpscQueue, MoveOnly)
+{
+    SpscQueue<std::unique_ptr<int>> q(2);
+    EXPECT_TRUE(q.push(std::unique_ptr<int>(new int(42))));
+
+    std::unique_ptr<int> val;
+    ASSERT_TRUE(q.pop(val));
+    ASSERT_NE(val, nullptr);
+    EXPECT_EQ(*val, 42);
+}
+
+/** Elements cross threads in order, without loss or duplication */
+TEST(SpscQueue, TwoThreads)
+{
+    const uint64_t count = 1000000;
+    SpscQueue<uint64_t> q(64);
+
+    std::thread producer([&] () {
+        for (uint64_t i = 0; i < count; i++) {
+            while (!q.push(i))
+                std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    while (expected < count) {
+        uint64_t val;
+        if (!q.pop(val)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(val, expected);
+        expected++;
+    }
+    producer.join();
+    EXPECT_TRUE(q.empty());
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/columnar.hh"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstring>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "base/stats/info.hh"
+#include "sim/cur_tick.hh"
+
+namespace Stats {
+
+constexpr char Columnar::Magic[8];
+constexpr uint32_t Columnar::Version;
+
+namespace
+{
+
+void
+putString(std::vector<uint8_t> &buf, const std::string &s)
+{
+    const uint32_t len = s.size();
+    const auto *p = reinterpret_cast<const uint8_t *>(&len);
+    buf.insert(buf.end(), p, p + sizeof(len));
+    buf.insert(buf.end(), s.begin(), s.end());
+}
+
+template <class T>
+void
+putValue(std::vector<uint8_t> &buf, T value)
+{
+    const auto *p = reinterpret_cast<const uint8_t *>(&value);
+    buf.insert(buf.end(), p, p + sizeof(value));
+}
+
+/** Subname of element i, falling back to its index. */
+std::string
+indexName(const std::vector<std::string> &names, size_t i)
+{
+    return i < names.size() && !names[i].empty() ?
+        names[i] : std::to_string(i);
+}
+
+/** Number of columns a distribution is flattened to. */
+size_t
+distColumns(const DistData &data)
+{
+    return 7 + data.cvec.size();
+}
+
+} // anonymous namespace
+
+Columnar::Columnar(const std::string &file, bool _compress, bool desc,
+                   bool formulas)
+    : compress(_compress), enableDescriptions(desc),
+      enableFormula(formulas), os(simout.create(file, true, true)),
+      position(0), schemaChanged(false), dumpCount(0)
+{
+    FileHeader header;
+    std::memcpy(header.magic, Magic, sizeof(header.magic));
+    header.version = Version;
+    header.flags = compress ? uint32_t(Compressed) : 0;
+    os->stream()->write(reinterpret_cast<const char *>(&header),
+                        sizeof(header));
+}
+
+Columnar::~Columnar()
+{
+    simout.close(os);
+}
+
+void
+Columnar::begin()
+{
+    path.clear();
+    position = 0;
+    schemaChanged = false;
+
+    const uint64_t tick = curTick();
+    row.resize(1);
+    std::memcpy(&row[0], &tick, sizeof(tick));
+}
+
+void
+Columnar::end()
+{
+    assert(valid());
+
+    // Stats that disappeared at the end of the list change the layout
+    // as much as new ones do.
+    if (schemaChanged || position != schema.size() || dumpCount == 0) {
+        schema.resize(position);
+        writeSchema();
+        lastRow.assign(row.size(), 0);
+    }
+    writeRow();
+
+    os->stream()->flush();
+    dumpCount++;
+}
+
+bool
+Columnar::valid() const
+{
+    return os->stream()->good();
+}
+
+void
+Columnar::beginGroup(const char *name)
+{
+    path.push_back(name);
+}
+
+void
+Columnar::endGroup()
+{
+    assert(!path.empty());
+    path.pop_back();
+}
+
+std::string
+Columnar::statName(const std::string &name) const
+{
+    std::string full;
+    for (const char *group : path) {
+        full += group;
+        full += '.';
+    }
+    return full + name;
+}
+
+Columnar::SchemaEntry *
+Columnar::nextEntry(const Info &info, StatKind kind, size_t columns,
+                    const std::vector<double> &buckets)
+{
+    if (!schemaChanged && position < schema.size()) {
+        const SchemaEntry &entry = schema[position];
+        if (entry.id == info.id && entry.kind == kind &&
+            entry.columns == columns && entry.buckets == buckets) {
+            position++;
+            return nullptr;
+        }
+    }
+
+    schemaChanged = true;
+    schema.resize(position++);
+    schema.emplace_back();
+
+    SchemaEntry &entry = schema.back();
+    entry.id = info.id;
+    entry.kind = kind;
+    entry.columns = columns;
+    entry.buckets = buckets;
+    entry.name = statName(info.name);
+    if (enableDescriptions)
+        entry.desc = info.desc;
+    entry.subnames.reserve(columns);
+    return &entry;
+}
+
+void
+Columnar::visit(const ScalarInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    if (SchemaEntry *entry = nextEntry(info, ScalarKind, 1))
+        entry->subnames.emplace_back();
+
+    row.push_back(info.result());
+}
+
+void
+Columnar::visit(const VectorInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    const VResult &vr = info.result();
+    if (SchemaEntry *entry = nextEntry(info, VectorKind, vr.size())) {
+        for (size_t i = 0; i < vr.size(); ++i) {
+            entry->subnames.push_back("::" + indexName(info.subnames, i));
+        }
+    }
+
+    row.insert(row.end(), vr.begin(), vr.end());
+}
+
+void
+Columnar::distSubnames(std::vector<std::string> &names,
+                       const std::string &prefix, const DistData &data) const
+{
+    static const char *fields[] = {
+        "samples", "sum", "squares", "min_value", "max_value",
+        "underflows", "overflows",
+    };
+    for (const char *field : fields)
+        names.push_back(prefix + "::" + field);
+
+    for (size_t i = 0; i < data.cvec.size(); ++i)
+        names.push_back(csprintf("%s::%g", prefix,
+                                 data.min + i * data.bucket_size));
+}
+
+void
+Columnar::distBuckets(std::vector<double> &buckets,
+                      const DistData &data) const
+{
+    // histograms move and widen their buckets as samples come in
+    buckets.push_back(data.min);
+    buckets.push_back(data.bucket_size);
+}
+
+void
+Columnar::appendDist(const DistData &data)
+{
+    row.push_back(data.samples);
+    row.push_back(data.sum);
+    row.push_back(data.squares);
+    row.push_back(data.min_val);
+    row.push_back(data.max_val);
+    row.push_back(data.underflow);
+    row.push_back(data.overflow);
+    row.insert(row.end(), data.cvec.begin(), data.cvec.end());
+}
+
+void
+Columnar::visit(const DistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    std::vector<double> buckets;
+    distBuckets(buckets, info.data);
+    if (SchemaEntry *entry = nextEntry(info, DistKind,
+                                       distColumns(info.data), buckets)) {
+        distSubnames(entry->subnames, "", info.data);
+    }
+
+    appendDist(info.data);
+}
+
+void
+Columnar::visit(const VectorDistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    size_t columns = 0;
+    std::vector<double> buckets;
+    for (const auto &data : info.data) {
+        columns += distColumns(data);
+        distBuckets(buckets, data);
+    }
+
+    if (SchemaEntry *entry = nextEntry(info, VectorDistKind, columns,
+                                       buckets)) {
+        for (size_t i = 0; i < info.data.size(); ++i) {
+            distSubnames(entry->subnames,
+                         "_" + indexName(info.subnames, i), info.data[i]);
+        }
+    }
+
+    for (const auto &data : info.data)
+        appendDist(data);
+}
+
+void
+Columnar::visit(const Vector2dInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    const size_t columns = info.x * info.y;
+    if (SchemaEntry *entry = nextEntry(info, Vector2dKind, columns)) {
+        for (size_t x = 0; x < info.x; ++x) {
+            const std::string xname = "_" + indexName(info.subnames, x);
+            for (size_t y = 0; y < info.y; ++y) {
+                entry->subnames.push_back(
+                    xname + "::" + indexName(info.y_subnames, y));
+            }
+        }
+    }
+
+    row.insert(row.end(), info.cvec.begin(), info.cvec.begin() + columns);
+}
+
+void
+Columnar::visit(const FormulaInfo &info)
+{
+    if (!enableFormula || !info.flags.isSet(display))
+        return;
+
+    const VResult &vr = info.result();
+    if (SchemaEntry *entry = nextEntry(info, FormulaKind, vr.size())) {
+        for (size_t i = 0; i < vr.size(); ++i) {
+            entry->subnames.push_back("::" + indexName(info.subnames, i));
+        }
+    }
+
+    row.insert(row.end(), vr.begin(), vr.end());
+}
+
+void
+Columnar::visit(const SparseHistInfo &info)
+{
+    warn_once("Columnar stat files don't support sparse histograms.\n");
+}
+
+void
+Columnar::writeSchema()
+{
+    uint64_t columns = 0;
+    for (const auto &entry : schema)
+        columns += entry.columns;
+    assert(columns + 1 == row.size());
+
+    std::vector<uint8_t> buf;
+    putValue<uint32_t>(buf, schema.size());
+    putValue<uint64_t>(buf, columns);
+    for (const auto &entry : schema) {
+        putValue<uint8_t>(buf, entry.kind);
+        putValue<uint32_t>(buf, entry.columns);
+        putString(buf, entry.name);
+        putString(buf, entry.desc);
+        for (const auto &subname : entry.subnames)
+            putString(buf, subname);
+    }
+
+    writeRecord(SchemaRecord, buf.data(), buf.size());
+}
+
+void
+Columnar::writeRow()
+{
+    if (!compress) {
+        writeRecord(RowRecord, row.data(), row.size() * sizeof(double));
+        return;
+    }
+
+    // Unchanged values XOR to zero, which deflate squeezes well.
+    assert(lastRow.size() == row.size());
+    std::vector<uint64_t> delta(row.size());
+    for (size_t i = 0; i < row.size(); ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &row[i], sizeof(bits));
+        delta[i] = bits ^ lastRow[i];
+        lastRow[i] = bits;
+    }
+    writeRecord(RowRecord, delta.data(), delta.size() * sizeof(uint64_t));
+}
+
+void
+Columnar::writeRecord(RecordType type, const void *data, size_t size)
+{
+    RecordHeader header;
+    header.type = type;
+    header.flags = 0;
+    header.rawSize = size;
+
+    const void *payload = data;
+    if (compress) {
+        uLongf dest_size = compressBound(size);
+        scratch.resize(dest_size);
+        const int ret = compress2(scratch.data(), &dest_size,
+                                  static_cast<const Bytef *>(data), size,
+                                  Z_BEST_SPEED);
+        fatal_if(ret != Z_OK, "Failed to compress stat record (%d).\n", ret);
+        header.flags = Compressed;
+        payload = scratch.data();
+        size = dest_size;
+    }
+    header.size = size;
+
+    std::ostream &stream = *os->stream();
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(static_cast<const char *>(payload), size);
+}
+
+std::unique_ptr<Output>
+initColumnar(const std::string &filename, bool compress, bool desc,
+             bool formulas)
+{
+    return std::unique_ptr<Output>(
+        new Columnar(filename, compress, desc, formulas));
+}
+
+} // namespace Stats
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_COLUMNAR_HH__
+#define __BASE_STATS_COLUMNAR_HH__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+class OutputStream;
+
+namespace Stats {
+
+struct DistData;
+
+/**
+ * Binary columnar stat output.
+ *
+ * The schema (stat names, descriptions and the column layout) is
+ * written once and every dump appends a single row of packed doubles
+ * to the file. Column names are only generated when the layout of a
+ * dump differs from the previous one, so a periodic dump costs little
+ * more than copying the stat values.
+ *
+ * File layout (native byte order):
+ *   FileHeader
+ *   { RecordHeader, payload }*
+ *
+ * A Schema record lists the stats that make up the following rows:
+ *   uint32_t numStats, uint64_t numColumns,
+ *   numStats x { uint8_t kind, uint32_t columns, str name, str desc,
+ *                columns x str subname }
+ * where str is a uint32_t length followed by the characters. A Row
+ * record holds the tick of the dump followed by numColumns doubles.
+ * When compression is enabled, each row is XORed with the previous
+ * row of the same schema and deflated, so counters that did not
+ * change between dumps cost almost nothing. Uncompressed rows have a
+ * constant stride and can be memory-mapped directly.
+ */
+class Columnar : public Output
+{
+  public:
+    static constexpr char Magic[8] = { 'g', 'e', 'm', '5',
+                                       's', 'c', 'o', 'l' };
+    static constexpr uint32_t Version = 1;
+
+    enum FileFlags : uint32_t
+    {
+        Compressed = 0x1,
+    };
+
+    enum RecordType : uint32_t
+    {
+        SchemaRecord = 1,
+        RowRecord = 2,
+    };
+
+    /** Kind of stat a schema entry was generated from. */
+    enum StatKind : uint8_t
+    {
+        ScalarKind,
+        VectorKind,
+        DistKind,
+        VectorDistKind,
+        Vector2dKind,
+        FormulaKind,
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t type;
+        uint32_t flags;
+        /** Size of the payload in the file. */
+        uint64_t size;
+        /** Size of the payload once decompressed. */
+        uint64_t rawSize;
+    };
+
+    Columnar(const std::string &file, bool compress, bool desc,
+             bool formulas);
+    ~Columnar();
+
+    Columnar() = delete;
+    Columnar(const Columnar &other) = delete;
+
+  public: // Output interface
+    void begin() override;
+    void end() override;
+    bool valid() const override;
+
+    void beginGroup(const char *name) override;
+    void endGroup() override;
+
+    void visit(const ScalarInfo &info) override;
+    void visit(const VectorInfo &info) override;
+    void visit(const DistInfo &info) override;
+    void visit(const VectorDistInfo &info) override;
+    void visit(const Vector2dInfo &info) override;
+    void visit(const FormulaInfo &info) override;
+    void visit(const SparseHistInfo &info) override;
+
+  protected:
+    struct SchemaEntry
+    {
+        int id;
+        StatKind kind;
+        size_t columns;
+        /** Bucket min and size of every distribution of the stat. */
+        std::vector<double> buckets;
+        std::string name;
+        std::string desc;
+        std::vector<std::string> subnames;
+    };
+
+    /**
+     * Check the next stat against the schema of the previous dump.
+     *
+     * @param buckets Bucket layout of the distributions of the stat,
+     *        whose changes alter the names of the columns.
+     * @return A schema entry to fill in if the layout changed at this
+     * point, nullptr if the previous entry still describes the stat.
+     */
+    SchemaEntry *nextEntry(const Info &info, StatKind kind, size_t columns,
+                           const std::vector<double> &buckets = {});
+
+    /** Full name of a stat in the current group. */
+    std::string statName(const std::string &name) const;
+
+    void appendDist(const DistData &data);
+    void distBuckets(std::vector<double> &buckets,
+                     const DistData &data) const;
+    void distSubnames(std::vector<std::string> &names,
+                      const std::string &prefix, const DistData &data) const;
+
+    void writeSchema();
+    void writeRow();
+    void writeRecord(RecordType type, const void *data, size_t size);
+
+  protected:
+    const bool compress;
+    const bool enableDescriptions;
+    const bool enableFormula;
+
+    OutputStream *os;
+
+    /** Names of the groups currently being visited. */
+    std::vector<const char *> path;
+
+    std::vector<SchemaEntry> schema;
+    /** Index of the next schema entry to check against. */
+    size_t position;
+    /** Set if this dump's layout differs from the previous one. */
+    bool schemaChanged;
+
+    /** Tick followed by the values of the current dump. */
+    std::vector<double> row;
+    /** Previous row of the same schema, used for XOR compression. */
+    std::vector<uint64_t> lastRow;
+    std::vector<uint8_t> scratch;
+
+    unsigned dumpCount;
+};
+
+std::unique_ptr<Output> initColumnar(const std::string &filename,
+                                     bool compress = true, bool desc = true,
+                                     bool formulas = true);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_COLUMNAR_HH__
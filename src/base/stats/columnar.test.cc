@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "base/stats/columnar.hh"
+#include "base/stats/info.hh"
+
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+class MockScalar : public Stats::ScalarInfo
+{
+  public:
+    Stats::Counter val = 0;
+
+    MockScalar(const char *_name)
+    {
+        name = _name;
+        desc = "scalar";
+        flags.set(Stats::display);
+    }
+
+    bool check() const override { return true; }
+    void prepare() override {}
+    void reset() override {}
+    bool zero() const override { return val == 0; }
+    void visit(Stats::Output &visitor) override { visitor.visit(*this); }
+
+    Stats::Counter value() const override { return val; }
+    Stats::Result result() const override { return val; }
+    Stats::Result total() const override { return val; }
+};
+
+class MockVector : public Stats::VectorInfo
+{
+  public:
+    Stats::VCounter vals;
+    mutable Stats::VResult res;
+
+    MockVector(const char *_name, size_t size)
+        : vals(size, 0), res(size, 0)
+    {
+        name = _name;
+        flags.set(Stats::display);
+        subnames = { "first" };
+    }
+
+    bool check() const override { return true; }
+    void prepare() override {}
+    void reset() override {}
+    bool zero() const override { return false; }
+    void visit(Stats::Output &visitor) override { visitor.visit(*this); }
+
+    Stats::size_type size() const override { return vals.size(); }
+    const Stats::VCounter &value() const override { return vals; }
+    const Stats::VResult &
+    result() const override
+    {
+        res.assign(vals.begin(), vals.end());
+        return res;
+    }
+    Stats::Result total() const override { return 0; }
+};
+
+class MockDist : public Stats::DistInfo
+{
+  public:
+    MockDist(const char *_name, size_t buckets)
+    {
+        name = _name;
+        flags.set(Stats::display);
+        data = Stats::DistData();
+        data.type = Stats::Hist;
+        data.bucket_size = 1;
+        data.cvec.assign(buckets, 0);
+    }
+
+    bool check() const override { return true; }
+    void prepare() override {}
+    void reset() override {}
+    bool zero() const override { return false; }
+    void visit(Stats::Output &visitor) override { visitor.visit(*this); }
+};
+
+struct Record
+{
+    Stats::Columnar::RecordHeader header;
+    std::vector<uint8_t> payload;
+};
+
+/** Parse a columnar stat file, inflating compressed payloads. */
+std::vector<Record>
+readRecords(const std::string &file, Stats::Columnar::FileHeader &header)
+{
+    std::ifstream is(file, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(is)),
+                              std::istreambuf_iterator<char>());
+
+    std::vector<Record> records;
+    std::memcpy(&header, data.data(), sizeof(header));
+    size_t pos = sizeof(header);
+    while (pos < data.size()) {
+        Record rec;
+        std::memcpy(&rec.header, &data[pos], sizeof(rec.header));
+        pos += sizeof(rec.header);
+        rec.payload.resize(rec.header.rawSize);
+        if (rec.header.flags & Stats::Columnar::Compressed) {
+            uLongf size = rec.payload.size();
+            EXPECT_EQ(Z_OK, uncompress(rec.payload.data(), &size,
+                                       &data[pos], rec.header.size));
+            EXPECT_EQ(rec.header.rawSize, size);
+        } else {
+            std::memcpy(rec.payload.data(), &data[pos], rec.header.size);
+        }
+        pos += rec.header.size;
+        records.push_back(std::move(rec));
+    }
+    return records;
+}
+
+std::vector<double>
+rowValues(const Record &rec)
+{
+    std::vector<double> values(rec.payload.size() / sizeof(double));
+    std::memcpy(values.data(), rec.payload.data(), rec.payload.size());
+    return values;
+}
+
+void
+dump(Stats::Output &out, std::vector<Stats::Info *> stats)
+{
+    out.begin();
+    out.beginGroup("system");
+    for (auto *info : stats)
+        info->visit(out);
+    out.endGroup();
+    out.end();
+}
+
+} // anonymous namespace
+
+/** Uncompressed rows are stored verbatim after a single schema. */
+TEST(ColumnarTest, RawRows)
+{
+    const std::string file = testing::TempDir() + "columnar_raw.gcol";
+    MockScalar scalar("cycles");
+    MockVector vector("hits", 2);
+    {
+        auto out = Stats::initColumnar(file, false);
+        scalar.val = 3;
+        vector.vals = { 1, 2 };
+        dump(*out, { &scalar, &vector });
+        tickHandler.setCurTick(100);
+        scalar.val = 5;
+        dump(*out, { &scalar, &vector });
+    }
+
+    Stats::Columnar::FileHeader header;
+    auto records = readRecords(file, header);
+    ASSERT_EQ(0, std::memcmp(header.magic, Stats::Columnar::Magic, 8));
+    EXPECT_EQ(0, header.flags);
+    ASSERT_EQ(3, records.size());
+    EXPECT_EQ(Stats::Columnar::SchemaRecord, records[0].header.type);
+    EXPECT_EQ(Stats::Columnar::RowRecord, records[1].header.type);
+    EXPECT_EQ(Stats::Columnar::RowRecord, records[2].header.type);
+
+    // Rows have a constant stride: tick + 3 columns.
+    EXPECT_EQ(4 * sizeof(double), records[1].header.size);
+    auto row = rowValues(records[2]);
+    uint64_t tick;
+    std::memcpy(&tick, &row[0], sizeof(tick));
+    EXPECT_EQ(100, tick);
+    EXPECT_EQ(5, row[1]);
+    EXPECT_EQ(1, row[2]);
+    EXPECT_EQ(2, row[3]);
+
+    // The schema holds the full name and the column subnames.
+    const auto &schema = records[0].payload;
+    uint32_t num_stats;
+    uint64_t num_columns;
+    std::memcpy(&num_stats, &schema[0], sizeof(num_stats));
+    std::memcpy(&num_columns, &schema[4], sizeof(num_columns));
+    EXPECT_EQ(2, num_stats);
+    EXPECT_EQ(3, num_columns);
+    const std::string text(schema.begin(), schema.end());
+    EXPECT_NE(std::string::npos, text.find("system.cycles"));
+    EXPECT_NE(std::string::npos, text.find("::first"));
+    EXPECT_NE(std::string::npos, text.find("::1"));
+}
+
+/** A change in the stat layout emits a new schema before the row. */
+TEST(ColumnarTest, SchemaChange)
+{
+    const std::string file = testing::TempDir() + "columnar_schema.gcol";
+    MockScalar scalar("cycles");
+    MockVector vector("hits", 2);
+    {
+        auto out = Stats::initColumnar(file, false);
+        dump(*out, { &scalar });
+        dump(*out, { &scalar, &vector });
+        dump(*out, { &scalar, &vector });
+        dump(*out, { &scalar });
+    }
+
+    Stats::Columnar::FileHeader header;
+    auto records = readRecords(file, header);
+    std::vector<uint32_t> types;
+    for (const auto &rec : records)
+        types.push_back(rec.header.type);
+    const std::vector<uint32_t> expected = {
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+        Stats::Columnar::RowRecord,
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+    };
+    EXPECT_EQ(expected, types);
+}
+
+/**
+ * Moving or widening the buckets of a distribution renames its
+ * columns, so it emits a new schema even if the layout is the same.
+ */
+TEST(ColumnarTest, DistBucketChange)
+{
+    const std::string file = testing::TempDir() + "columnar_dist.gcol";
+    MockDist dist("latency", 2);
+    {
+        auto out = Stats::initColumnar(file, false);
+        dump(*out, { &dist });
+        dist.data.samples = 3;
+        dump(*out, { &dist });
+        dist.data.bucket_size = 4;
+        dump(*out, { &dist });
+        dist.data.min = 8;
+        dump(*out, { &dist });
+    }
+
+    Stats::Columnar::FileHeader header;
+    auto records = readRecords(file, header);
+    std::vector<uint32_t> types;
+    for (const auto &rec : records)
+        types.push_back(rec.header.type);
+    const std::vector<uint32_t> expected = {
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+        Stats::Columnar::RowRecord,
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+        Stats::Columnar::SchemaRecord, Stats::Columnar::RowRecord,
+    };
+    ASSERT_EQ(expected, types);
+
+    const std::string last(records[5].payload.begin(),
+                           records[5].payload.end());
+    EXPECT_NE(std::string::npos, last.find("::8"));
+    EXPECT_NE(std::string::npos, last.find("::12"));
+    EXPECT_EQ(std::string::npos, last.find("::4"));
+}
+
+/** Compressed rows are XORed with the previous row of the schema. */
+TEST(ColumnarTest, CompressedRows)
+{
+    const std::string file = testing::TempDir() + "columnar_zip.gcol";
+    MockScalar scalar("cycles");
+    MockVector vector("hits", 64);
+    {
+        auto out = Stats::initColumnar(file, true);
+        tickHandler.setCurTick(0);
+        scalar.val = 7;
+        dump(*out, { &scalar, &vector });
+        scalar.val = 9;
+        dump(*out, { &scalar, &vector });
+    }
+
+    Stats::Columnar::FileHeader header;
+    auto records = readRecords(file, header);
+    EXPECT_EQ(Stats::Columnar::Compressed, header.flags);
+    ASSERT_EQ(3, records.size());
+    EXPECT_LT(records[2].header.size, records[2].header.rawSize);
+
+    std::vector<uint64_t> first(records[1].payload.size() / 8);
+    std::vector<uint64_t> second(first.size());
+    std::memcpy(first.data(), records[1].payload.data(),
+                records[1].payload.size());
+    std::memcpy(second.data(), records[2].payload.data(),
+                records[2].payload.size());
+    for (size_t i = 0; i < first.size(); ++i)
+        second[i] ^= first[i];
+
+    double value;
+    std::memcpy(&value, &first[1], sizeof(value));
+    EXPECT_EQ(7, value);
+    std::memcpy(&value, &second[1], sizeof(value));
+    EXPECT_EQ(9, value);
+}
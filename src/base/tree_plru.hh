@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_TREE_PLRU_HH__
+#define __BASE_TREE_PLRU_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "base/intmath.hh"
+
+/**
+ * Tree based pseudo least recently used replacement over a fixed number of
+ * ways, e.g. the entries of a fully associative TLB.
+ *
+ * The ways are the leaves of a binary tree with one bit per inner node,
+ * which points to the half of the subtree that was used least recently.
+ * Touching a way flips the bits on its path away from it and finding the
+ * victim follows the bits from the root, so both take log2(ways) steps
+ * instead of a scan of every way. The number of ways doesn't need to be a
+ * power of two; subtrees without any ways are never chosen.
+ */
+class TreePLRU
+{
+  private:
+    size_t numWays;
+    size_t numLeaves;
+    std::vector<bool> bits;
+
+  public:
+    explicit TreePLRU(size_t num_ways) :
+        numWays(num_ways),
+        numLeaves(size_t(1) << ceilLog2(num_ways)),
+        bits(numLeaves - 1, false)
+    {
+        assert(num_ways > 0);
+    }
+
+    size_t ways() const { return numWays; }
+
+    /** Mark a way as the most recently used one. */
+    void
+    touch(size_t way)
+    {
+        assert(way < numWays);
+        size_t node = 0, lo = 0, hi = numLeaves;
+        while (hi - lo > 1) {
+            const size_t mid = (lo + hi) / 2;
+            const bool right = way >= mid;
+            bits[node] = !right;
+            node = 2 * node + 1 + right;
+            if (right)
+                lo = mid;
+            else
+                hi = mid;
+        }
+    }
+
+    /** Find the way to replace. */
+    size_t
+    victim() const
+    {
+        size_t node = 0, lo = 0, hi = numLeaves;
+        while (hi - lo > 1) {
+            const size_t mid = (lo + hi) / 2;
+            const bool right = bits[node] && mid < numWays;
+            node = 2 * node + 1 + right;
+            if (right)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /** Forget about all uses. */
+    void
+    reset()
+    {
+        bits.assign(bits.size(), false);
+    }
+};
+
+#endif // __BASE_TREE_PLRU_HH__
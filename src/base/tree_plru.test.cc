@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "base/tree_plru.hh"
+
+/** A single way is always the victim. */
+TEST(TreePLRUTest, SingleWay)
+{
+    TreePLRU plru(1);
+    EXPECT_EQ(plru.victim(), 0);
+    plru.touch(0);
+    EXPECT_EQ(plru.victim(), 0);
+}
+
+/** The victim is never the most recently touched way. */
+TEST(TreePLRUTest, VictimIsNotMRU)
+{
+    for (size_t ways: { 2, 3, 5, 8, 12, 64 }) {
+        TreePLRU plru(ways);
+        for (size_t i = 0; i < 4 * ways; i++) {
+            const size_t way = (i * 7) % ways;
+            plru.touch(way);
+            EXPECT_NE(plru.victim(), way);
+            EXPECT_LT(plru.victim(), ways);
+        }
+    }
+}
+
+/** Replacing the victim and touching it again cycles through every way. */
+TEST(TreePLRUTest, VictimsCoverAllWays)
+{
+    for (size_t ways: { 2, 4, 16, 64 }) {
+        TreePLRU plru(ways);
+        std::set<size_t> victims;
+        for (size_t i = 0; i < ways; i++) {
+            const size_t victim = plru.victim();
+            victims.insert(victim);
+            plru.touch(victim);
+        }
+        EXPECT_EQ(victims.size(), ways);
+    }
+}
+
+/** With a power of two number of ways, filling in order is exact LRU. */
+TEST(TreePLRUTest, InOrderIsLRU)
+{
+    TreePLRU plru(8);
+    for (size_t i = 0; i < 8; i++)
+        plru.touch(i);
+    EXPECT_EQ(plru.victim(), 0);
+    plru.touch(0);
+    EXPECT_EQ(plru.victim(), 4);
+}
+
+/** Resetting forgets about all uses. */
+TEST(TreePLRUTest, Reset)
+{
+    TreePLRU plru(4);
+    plru.touch(0);
+    EXPECT_NE(plru.victim(), 0);
+    plru.reset();
+    EXPECT_EQ(plru.victim(), 0);
+}
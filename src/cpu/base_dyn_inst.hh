@@ -52,6 +52,7 @@
 
 #include "arch/generic/tlb.hh"
 #include "arch/utility.hh"
+#include "base/free_list_pool.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
 #include "cpu/checker/cpu.hh"
@@ -145,7 +146,7 @@ class BaseDynInst : public ExecContext, public RefCounted
     InstSeqNum seqNum;
 
     /** The StaticInst used by this BaseDynInst. */
-    const StaticInstPtr staticInst;
+    StaticInstPtr staticInst;
 
     /** Pointer to the Impl's CPU object. */
     ImplCPU *cpu;
@@ -193,11 +194,43 @@ class BaseDynInst : public ExecContext, public RefCounted
 
         size_t srcsReady = 0;
 
-        using BackingStorePtr = std::unique_ptr<uint8_t[]>;
-        using BufCursor = BackingStorePtr::pointer;
-
+        /**
+         * The backing store is taken from a pool when it is small enough,
+         * which it is for almost all instructions.
+         */
+        struct BufDeleter
+        {
+            bool pooled;
+
+            void
+            operator()(uint8_t *p) const
+            {
+                if (pooled)
+                    regsPool.release(p);
+                else
+                    delete [] p;
+            }
+        };
+
+        using BackingStorePtr = std::unique_ptr<uint8_t[], BufDeleter>;
+        using BufCursor = uint8_t *;
+
+        /** Usable size of the backing store. */
+        size_t bufSize;
         BackingStorePtr buf;
 
+        static BackingStorePtr
+        allocateBuf(size_t &size)
+        {
+            if (size <= regsPool.chunkSize()) {
+                size = regsPool.chunkSize();
+                return BackingStorePtr(
+                        static_cast<uint8_t *>(regsPool.allocate()),
+                        BufDeleter{true});
+            }
+            return BackingStorePtr(new uint8_t[size], BufDeleter{false});
+        }
+
         // Members should be ordered based on required alignment so that they
         // can be allocated contiguously.
 
@@ -250,19 +283,45 @@ class BaseDynInst : public ExecContext, public RefCounted
             std::fill(_readySrcIdx, _readySrcIdx + (numSrcs() + 7) / 8, 0);
         }
 
-        Regs(size_t srcs, size_t dests) : _numSrcs(srcs), _numDests(dests),
-            buf(new uint8_t[bytesForSources(srcs) + bytesForDests(dests)])
+        /** Divide the backing store up into the per-register arrays. */
+        void
+        layOut()
         {
             BufCursor cur = buf.get();
-            allocate(_flatDestIdx, cur, dests);
-            allocate(_destIdx, cur, dests);
-            allocate(_prevDestIdx, cur, dests);
-            allocate(_srcIdx, cur, srcs);
-            allocate(_readySrcIdx, cur, (srcs + 7) / 8);
+            allocate(_flatDestIdx, cur, _numDests);
+            allocate(_destIdx, cur, _numDests);
+            allocate(_prevDestIdx, cur, _numDests);
+            allocate(_srcIdx, cur, _numSrcs);
+            allocate(_readySrcIdx, cur, (_numSrcs + 7) / 8);
 
             init();
         }
 
+        Regs(size_t srcs, size_t dests) : _numSrcs(srcs), _numDests(dests),
+            bufSize(bytesForSources(srcs) + bytesForDests(dests)),
+            buf(allocateBuf(bufSize))
+        {
+            layOut();
+        }
+
+        /**
+         * Set the registers up for another instruction, keeping the
+         * backing store if it is big enough.
+         */
+        void
+        reset(size_t srcs, size_t dests)
+        {
+            size_t size = bytesForSources(srcs) + bytesForDests(dests);
+            if (size > bufSize) {
+                buf = allocateBuf(size);
+                bufSize = size;
+            }
+            _numSrcs = srcs;
+            _numDests = dests;
+            srcsReady = 0;
+            layOut();
+        }
+
         // Returns the flattened register index of the idx'th destination
         // register.
         const RegId &
@@ -337,6 +396,9 @@ class BaseDynInst : public ExecContext, public RefCounted
         }
     };
 
+    /** Pool for the register information of the instructions. */
+    static FreeListPool regsPool;
+
   public:
     Regs regs;
 
@@ -351,7 +413,7 @@ class BaseDynInst : public ExecContext, public RefCounted
     TheISA::PCState predPC;
 
     /** The Macroop if one exists */
-    const StaticInstPtr macroop;
+    StaticInstPtr macroop;
 
     /** How many source registers are ready. */
     uint8_t readyRegs;
@@ -526,10 +588,47 @@ class BaseDynInst : public ExecContext, public RefCounted
     /** BaseDynInst destructor. */
     ~BaseDynInst();
 
+    /**
+     * Reference counting, which hides the one of RefCounted so that an
+     * instruction which is no longer referenced can be recycled instead
+     * of destroyed.
+     */
+    void incref() const { ++refCount; }
+
+    void
+    decref() const
+    {
+        if (--refCount <= 0)
+            const_cast<BaseDynInst *>(this)->recycle();
+    }
+
+  protected:
+    /**
+     * Called when the last reference to the instruction is dropped. A
+     * derived class can keep the instruction, cleared but constructed,
+     * to reset it for a later instruction, which saves constructing
+     * and destroying its members every time.
+     */
+    virtual void recycle() { delete this; }
+
+    /**
+     * End the life of the instruction without destroying it: release
+     * everything it references, but keep the storage of its members.
+     */
+    void clear();
+
+    /** Start the life of a cleared instruction, as the constructor does. */
+    void reset(const StaticInstPtr &_staticInst,
+               const StaticInstPtr &_macroop, TheISA::PCState _pc,
+               TheISA::PCState _predPC, InstSeqNum seq_num, ImplCPU *_cpu);
+
   private:
     /** Function to initialize variables in the constructors. */
     void initVars();
 
+    /** Number of references to the instruction, see decref(). */
+    mutable int refCount = 0;
+
   public:
     /** Dumps out contents of this BaseDynInst. */
     void dump();
@@ -56,6 +56,10 @@
 #include "mem/request.hh"
 #include "sim/faults.hh"
 
+// Big enough for the registers of all but the most unusual instructions.
+template <class Impl>
+FreeListPool BaseDynInst<Impl>::regsPool("dyn_inst_regs", 256);
+
 template <class Impl>
 BaseDynInst<Impl>::BaseDynInst(const StaticInstPtr &_staticInst,
                                const StaticInstPtr &_macroop,
@@ -142,17 +146,32 @@ BaseDynInst<Impl>::initVars()
 
 template <class Impl>
 BaseDynInst<Impl>::~BaseDynInst()
+{
+    // recycled instructions have been cleared already
+    if (staticInst)
+        clear();
+}
+
+template <class Impl>
+void
+BaseDynInst<Impl>::clear()
 {
     if (memData) {
         delete [] memData;
+        memData = nullptr;
     }
 
     if (traceData) {
         delete traceData;
+        traceData = nullptr;
     }
 
     fault = NoFault;
 
+    while (!instResult.empty())
+        instResult.pop();
+    reqToVerify = nullptr;
+
 #ifndef NDEBUG
     --cpu->instcount;
 
@@ -164,6 +183,34 @@ BaseDynInst<Impl>::~BaseDynInst()
     cpu->snList.erase(seqNum);
 #endif
 
+    staticInst = nullptr;
+    macroop = nullptr;
+}
+
+template <class Impl>
+void
+BaseDynInst<Impl>::reset(const StaticInstPtr &_staticInst,
+                         const StaticInstPtr &_macroop, TheISA::PCState _pc,
+                         TheISA::PCState _predPC, InstSeqNum seq_num,
+                         ImplCPU *_cpu)
+{
+    assert(!staticInst);
+
+    staticInst = _staticInst;
+    cpu = _cpu;
+    thread = nullptr;
+    regs.reset(staticInst->numSrcRegs(), staticInst->numDestRegs());
+    macroop = _macroop;
+    savedReq = nullptr;
+    lqIt = LQIterator();
+    sqIt = SQIterator();
+
+    seqNum = seq_num;
+
+    pc = _pc;
+    predPC = _predPC;
+
+    initVars();
 }
 
 #ifdef DEBUG
@@ -29,9 +29,11 @@
 #ifndef __CPU_DECODE_CACHE_HH__
 #define __CPU_DECODE_CACHE_HH__
 
+#include <memory>
 #include <unordered_map>
 
 #include "base/bitfield.hh"
+#include "base/types.hh"
 #include "cpu/static_inst_fwd.hh"
 
 namespace DecodeCache
@@ -41,12 +43,25 @@ namespace DecodeCache
 template <typename EMI>
 using InstMap = std::unordered_map<EMI, StaticInstPtr>;
 
-/// A sparse map from an Addr to a Value, stored in page chunks.
+/**
+ * A sparse map from an Addr to a Value, stored in page chunks.
+ *
+ * Chunks are found through a two level table. The upper bits of the
+ * address select a directory in a hash map and the next bits select the
+ * chunk in the directory. A small direct mapped cache of the most recently
+ * used chunks sits in front of the table, so the hot path of a lookup is a
+ * single tag compare.
+ */
 template<class Value, Addr CacheChunkShift = 12>
 class AddrMap
 {
   protected:
     static constexpr Addr CacheChunkBytes = 1ULL << CacheChunkShift;
+    /// Number of bits of the address which select a chunk in a directory.
+    static constexpr unsigned DirShift = 9;
+    static constexpr Addr DirChunks = 1ULL << DirShift;
+    /// Number of entries of the front cache.
+    static constexpr Addr FrontEntries = 16;
 
     static constexpr Addr
     chunkOffset(Addr addr)
@@ -60,68 +75,85 @@ class AddrMap
         return addr & ~(CacheChunkBytes - 1);
     }
 
+    static constexpr Addr
+    chunkNum(Addr addr)
+    {
+        return addr >> CacheChunkShift;
+    }
+
+    static constexpr Addr
+    dirNum(Addr addr)
+    {
+        return addr >> (CacheChunkShift + DirShift);
+    }
+
     // A chunk of cache entries.
     struct CacheChunk
     {
         Value items[CacheChunkBytes];
     };
-    // A map of cache chunks which allows a sparse mapping.
-    typedef typename std::unordered_map<Addr, CacheChunk *> ChunkMap;
-    typedef typename ChunkMap::iterator ChunkIt;
-    // Mini cache of recent lookups.
-    ChunkIt recent[2];
-    ChunkMap chunkMap;
-
-    /// Update the mini cache of recent lookups.
-    /// @param recentest The most recent result;
-    void
-    update(ChunkIt recentest)
+    // The chunks of a contiguous region of DirChunks chunks.
+    struct Directory
+    {
+        std::unique_ptr<CacheChunk> chunks[DirChunks];
+    };
+    // A map of directories which allows a sparse mapping.
+    typedef typename std::unordered_map<Addr, std::unique_ptr<Directory>>
+        DirMap;
+    DirMap dirMap;
+    // The most recently used directory.
+    Addr recentDirNum = 0;
+    Directory *recentDir = nullptr;
+
+    // Direct mapped cache of recently used chunks, tagged by chunk number.
+    struct FrontEntry
     {
-        recent[1] = recent[0];
-        recent[0] = recentest;
+        Addr tag = MaxAddr;
+        CacheChunk *chunk = nullptr;
+    };
+    FrontEntry front[FrontEntries];
+
+    /// Find the CacheChunk which goes with a particular address in the
+    /// table, creating it if it doesn't exist yet.
+    /// @param addr The address to look up.
+    CacheChunk *
+    walk(Addr addr)
+    {
+        const Addr dir_num = dirNum(addr);
+        if (!recentDir || recentDirNum != dir_num) {
+            auto &dir = dirMap[dir_num];
+            if (!dir)
+                dir.reset(new Directory);
+            recentDir = dir.get();
+            recentDirNum = dir_num;
+        }
+
+        auto &chunk = recentDir->chunks[chunkNum(addr) & (DirChunks - 1)];
+        if (!chunk)
+            chunk.reset(new CacheChunk);
+        return chunk.get();
     }
 
     /// Attempt to find the CacheChunk which goes with a particular
-    /// address. First check the small cache of recent results, then
-    /// actually look in the hash map.
+    /// address. First check the front cache, then walk the table.
     /// @param addr The address to look up.
     CacheChunk *
     getChunk(Addr addr)
     {
-        Addr chunk_addr = chunkStart(addr);
-
-        // Check against recent lookups.
-        if (recent[0] != chunkMap.end()) {
-            if (recent[0]->first == chunk_addr)
-                return recent[0]->second;
-            if (recent[1] != chunkMap.end() &&
-                    recent[1]->first == chunk_addr) {
-                update(recent[1]);
-                // recent[1] has just become recent[0].
-                return recent[0]->second;
-            }
-        }
-
-        // Actually look in the hash_map.
-        ChunkIt it = chunkMap.find(chunk_addr);
-        if (it != chunkMap.end()) {
-            update(it);
-            return it->second;
+        const Addr chunk_num = chunkNum(addr);
+        FrontEntry &entry = front[chunk_num % FrontEntries];
+        if (entry.tag != chunk_num) {
+            entry.chunk = walk(addr);
+            entry.tag = chunk_num;
         }
-
-        // Didn't find an existing chunk, so add a new one.
-        CacheChunk *newChunk = new CacheChunk;
-        typename ChunkMap::value_type to_insert(chunk_addr, newChunk);
-        update(chunkMap.insert(to_insert).first);
-        return newChunk;
+        return entry.chunk;
     }
 
   public:
     /// Constructor
-    AddrMap()
-    {
-        recent[0] = recent[1] = chunkMap.end();
-    }
+    AddrMap() = default;
+    AddrMap(const AddrMap &) = delete;
+    AddrMap &operator=(const AddrMap &) = delete;
 
     Value &
     lookup(Addr addr)
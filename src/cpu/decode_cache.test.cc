@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "cpu/decode_cache.hh"
+
+/** Entries are default constructed and keep their values. */
+TEST(DecodeCacheAddrMapTest, LookupKeepsValues)
+{
+    DecodeCache::AddrMap<int> map;
+
+    EXPECT_EQ(map.lookup(0x1000), 0);
+    map.lookup(0x1000) = 1;
+    map.lookup(0x1001) = 2;
+    EXPECT_EQ(map.lookup(0x1000), 1);
+    EXPECT_EQ(map.lookup(0x1001), 2);
+    EXPECT_EQ(map.lookup(0x1002), 0);
+}
+
+/**
+ * Addresses which share an entry of the front cache, a directory or
+ * nothing at all map to distinct entries.
+ */
+TEST(DecodeCacheAddrMapTest, DistinctAddresses)
+{
+    DecodeCache::AddrMap<Addr> map;
+    const Addr addrs[] = {
+        0x0, 0x10, 0x1000, 0x11000, 0x21000, 0x200000, 0x201000,
+        0x7fffffffe000, 0xffffffff80001000ULL, MaxAddr,
+    };
+
+    for (Addr addr: addrs)
+        map.lookup(addr) = addr + 1;
+    for (int i = 0; i < 3; i++) {
+        for (Addr addr: addrs)
+            EXPECT_EQ(map.lookup(addr), addr + 1);
+    }
+}
+
+/** References to entries remain valid when other chunks are created. */
+TEST(DecodeCacheAddrMapTest, StableReferences)
+{
+    DecodeCache::AddrMap<Addr> map;
+    Addr &first = map.lookup(0x400000);
+    first = 42;
+
+    for (Addr addr = 0; addr < (Addr)1 << 28; addr += 0x100000)
+        map.lookup(addr + 0x10) = addr;
+
+    EXPECT_EQ(&map.lookup(0x400000), &first);
+    EXPECT_EQ(first, 42);
+}
@@ -76,6 +76,14 @@ MinorCPU::MinorCPU(const MinorCPUParams &params) :
 
     Minor::MinorDynInst::init();
 
+    /* Make room for enough instructions to fill the pipeline's buffers */
+    Minor::MinorDynInst::reservePool(
+        params.decodeInputBufferSize * params.decodeInputWidth +
+        params.executeInputBufferSize * params.executeInputWidth +
+        params.executeLSQRequestsQueueSize +
+        params.executeLSQTransfersQueueSize +
+        params.executeLSQStoreBufferSize);
+
     pipeline = new Minor::Pipeline(*this, params);
     activityRecorder = pipeline->getActivityRecorder();
 
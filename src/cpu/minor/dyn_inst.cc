@@ -75,6 +75,8 @@ operator <<(std::ostream &os, const InstId &id)
 
 MinorDynInstPtr MinorDynInst::bubbleInst = NULL;
 
+FreeListPool MinorDynInst::pool("minor_dyn_insts", sizeof(MinorDynInst));
+
 void
 MinorDynInst::init()
 {
@@ -48,6 +48,7 @@
 
 #include <iostream>
 
+#include "base/free_list_pool.hh"
 #include "base/refcnt.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
@@ -231,6 +232,10 @@ class MinorDynInst : public RefCounted
      *  up */
     std::vector<RegId> flatDestRegIdx;
 
+  private:
+    /** Pool the instructions are allocated from */
+    static FreeListPool pool;
+
   public:
     MinorDynInst(StaticInstPtr si, InstId id_=InstId(), Fault fault_=NoFault) :
         staticInst(si), id(id_), traceData(NULL),
@@ -270,6 +275,23 @@ class MinorDynInst : public RefCounted
     /** Initialise the class */
     static void init();
 
+    /** Instructions, including squashed wrong path ones, are created and
+     *  destroyed at a high rate so their memory is recycled through a
+     *  pool.  Unlike O3's, the instructions themselves aren't kept for
+     *  reuse: constructing one only fills in a few fields, and they are
+     *  plain RefCounted objects which are deleted when dropped */
+    static void *
+    operator new(size_t size)
+    {
+        assert(size == sizeof(MinorDynInst));
+        return pool.allocate();
+    }
+
+    static void operator delete(void *p) { pool.release(p); }
+
+    /** Prepare the pool for num instructions to be in flight at once */
+    static void reservePool(size_t num) { pool.reserve(num); }
+
     /** Print (possibly verbose) instruction information for
      *  MinorTrace using the given Named object's name */
     void minorTraceInst(const Named &named_object) const;
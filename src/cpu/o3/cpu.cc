@@ -285,6 +285,11 @@ FullO3CPU<Impl>::FullO3CPU(const DerivO3CPUParams &params)
     // Setup the ROB for whichever stages need it.
     commit.setROB(&rob);
 
+    // Make sure a full pipeline's worth of instructions can be created
+    // without going to the heap.
+    Impl::DynInst::reservePool(params.numROBEntries + params.numIQEntries +
+                               params.LQEntries + params.SQEntries);
+
     lastActivatedCycle = 0;
 
     DPRINTF(O3CPU, "Creating O3CPU object.\n");
@@ -1820,7 +1825,7 @@ FullO3CPU<Impl>::htmSendAbortSignal(ThreadID tid, uint64_t htm_uid,
 
     // notify l1 d-cache (ruby) that core has aborted transaction
     RequestPtr req =
-        std::make_shared<Request>(addr, size, flags, _dataRequestorId);
+        Request::create(addr, size, flags, _dataRequestorId);
 
     req->taskId(taskId());
     req->setContext(this->thread[tid]->contextId());
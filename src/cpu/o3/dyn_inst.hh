@@ -43,7 +43,9 @@
 #define __CPU_O3_DYN_INST_HH__
 
 #include <array>
+#include <vector>
 
+#include "base/free_list_pool.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/isa_specific.hh"
@@ -75,6 +77,23 @@ class BaseO3DynInst : public BaseDynInst<Impl>
 
     ~BaseO3DynInst();
 
+    /**
+     * A dynamic instruction is created for every instruction fetched,
+     * including the wrong path instructions which are squashed soon
+     * after. Instructions which are no longer referenced are therefore
+     * kept, and reset for a later instruction rather than constructed
+     * again, see recycle(). Their memory comes from a pool.
+     */
+    static BaseO3DynInst *create(const StaticInstPtr &staticInst,
+            const StaticInstPtr &macroop, TheISA::PCState pc,
+            TheISA::PCState predPC, InstSeqNum seq_num, O3CPU *cpu);
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p);
+
+    /** Prepare the pool for num instructions to be in flight at once. */
+    static void reservePool(size_t num);
+
     /** Executes the instruction.*/
     Fault execute();
 
@@ -88,6 +107,29 @@ class BaseO3DynInst : public BaseDynInst<Impl>
     /** Initializes variables. */
     void initVars();
 
+    /** Clear the instruction, and keep it for create() to reuse. */
+    void recycle() override;
+
+    /** Print the pipeline activity viewer record of the instruction. */
+    void dumpPipeView();
+
+    /**
+     * The instructions kept for reuse. As each CPU runs from a single
+     * thread, and its instructions are created and dropped there, every
+     * thread has its own list. The list only grows up to the largest
+     * number of instructions in flight on the thread. Whatever is left
+     * on it when the thread exits goes back to the heap, not the pool.
+     */
+    struct RecycledInsts : public std::vector<BaseO3DynInst *>
+    {
+        ~RecycledInsts();
+    };
+
+    static RecycledInsts &recycledInsts();
+
+    /** Pool the instructions are allocated from. */
+    static FreeListPool pool;
+
   protected:
     /** Explicitation of dependent names. */
     using BaseDynInst<Impl>::cpu;
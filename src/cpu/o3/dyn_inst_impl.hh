@@ -46,6 +46,89 @@
 #include "cpu/o3/dyn_inst.hh"
 #include "debug/O3PipeView.hh"
 
+template <class Impl>
+FreeListPool BaseO3DynInst<Impl>::pool("o3_dyn_insts",
+                                       sizeof(BaseO3DynInst<Impl>));
+
+template <class Impl>
+void *
+BaseO3DynInst<Impl>::operator new(size_t size)
+{
+    assert(size == sizeof(BaseO3DynInst<Impl>));
+    return pool.allocate();
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::operator delete(void *p)
+{
+    pool.release(p);
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::reservePool(size_t num)
+{
+    pool.reserve(num);
+}
+
+template <class Impl>
+BaseO3DynInst<Impl>::RecycledInsts::~RecycledInsts()
+{
+    // The per thread state of the pool may be destroyed before this
+    // list, as thread_local objects go in the reverse order of their
+    // construction, so hand the memory straight back to the heap. The
+    // pool takes all of its chunks from there.
+    for (auto *inst : *this) {
+        inst->~BaseO3DynInst();
+        ::operator delete(inst);
+    }
+}
+
+template <class Impl>
+typename BaseO3DynInst<Impl>::RecycledInsts &
+BaseO3DynInst<Impl>::recycledInsts()
+{
+    static thread_local RecycledInsts insts;
+    return insts;
+}
+
+template <class Impl>
+BaseO3DynInst<Impl> *
+BaseO3DynInst<Impl>::create(const StaticInstPtr &staticInst,
+                            const StaticInstPtr &macroop,
+                            TheISA::PCState pc, TheISA::PCState predPC,
+                            InstSeqNum seq_num, O3CPU *cpu)
+{
+    RecycledInsts &recycled = recycledInsts();
+    if (recycled.empty())
+        return new BaseO3DynInst(staticInst, macroop, pc, predPC, seq_num,
+                                 cpu);
+
+    BaseO3DynInst *inst = recycled.back();
+    recycled.pop_back();
+    inst->reset(staticInst, macroop, pc, predPC, seq_num, cpu);
+    inst->initVars();
+    pool.noteReuse();
+    return inst;
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::recycle()
+{
+#ifndef NO_MEM_POOLS
+    dumpPipeView();
+    this->clear();
+    _destMiscRegVal.clear();
+    _destMiscRegIdx.clear();
+    recycledInsts().push_back(this);
+#else
+    // let memory checkers see every instruction
+    delete this;
+#endif
+}
+
 template <class Impl>
 BaseO3DynInst<Impl>::BaseO3DynInst(const StaticInstPtr &staticInst,
                                    const StaticInstPtr &macroop,
@@ -65,6 +148,15 @@ BaseO3DynInst<Impl>::BaseO3DynInst(const StaticInstPtr &_staticInst,
 }
 
 template <class Impl>BaseO3DynInst<Impl>::~BaseO3DynInst()
+{
+    // recycled instructions have been cleared already
+    if (this->staticInst)
+        dumpPipeView();
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::dumpPipeView()
 {
 #if TRACING_ON
     if (DTRACE(O3PipeView)) {
@@ -43,10 +43,10 @@
 #define __CPU_O3_INST_QUEUE_HH__
 
 #include <list>
-#include <map>
 #include <queue>
 #include <vector>
 
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "cpu/o3/dep_graph.hh"
@@ -90,8 +90,8 @@ class InstructionQueue
     typedef typename Impl::CPUPol::IssueStruct IssueStruct;
     typedef typename Impl::CPUPol::TimeStruct TimeStruct;
 
-    // Typedef of iterator through the list of instructions.
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    /** Ring buffer of instructions in the order they were added. */
+    typedef CircularQueue<DynInstPtr> InstQueue;
 
     /** FU completion event class. */
     class FUCompletion : public Event {
@@ -305,24 +305,37 @@ class InstructionQueue
     // Instruction lists, ready queues, and ordering
     //////////////////////////////////////
 
-    /** List of all the instructions in the IQ (some of which may be issued). */
-    std::list<DynInstPtr> instList[Impl::MaxThreads];
+    /** All the instructions in the IQ (some of which may be issued), in
+     *  program order. Issued instructions are only removed when they
+     *  commit, so this is sized by the ROB rather than by the IQ.
+     */
+    InstQueue instList[Impl::MaxThreads];
 
-    /** List of instructions that are ready to be executed. */
-    std::list<DynInstPtr> instsToExecute;
+    /** Instructions that are ready to be executed. */
+    InstQueue instsToExecute;
 
     /** List of instructions waiting for their DTB translation to
      *  complete (hw page table walk in progress).
      */
-    std::list<DynInstPtr> deferredMemInsts;
+    std::vector<DynInstPtr> deferredMemInsts;
 
-    /** List of instructions that have been cache blocked. */
-    std::list<DynInstPtr> blockedMemInsts;
+    /** Instructions that have been cache blocked. */
+    InstQueue blockedMemInsts;
 
-    /** List of instructions that were cache blocked, but a retry has been seen
+    /** Instructions that were cache blocked, but a retry has been seen
      * since, so they can now be retried. May fail again go on the blocked list.
      */
-    std::list<DynInstPtr> retryMemInsts;
+    InstQueue retryMemInsts;
+
+    /**
+     * Append an instruction to one of the instruction queues. The queues
+     * are sized for the worst case up front, but grow rather than drop
+     * the oldest entry should that turn out to be too small.
+     */
+    static void pushInst(InstQueue &queue, const DynInstPtr &inst);
+
+    /** Empty an instruction queue, dropping its references. */
+    static void clearInsts(InstQueue &queue);
 
     /**
      * Struct for comparing entries to be added to the priority queue.
@@ -346,50 +359,35 @@ class InstructionQueue
      */
     ReadyInstQueue readyInsts[Num_OpClasses];
 
-    /** List of non-speculative instructions that will be scheduled
-     *  once the IQ gets a signal from commit.  While it's redundant to
-     *  have the key be a part of the value (the sequence number is stored
-     *  inside of DynInst), when these instructions are woken up only
-     *  the sequence number will be available.  Thus it is most efficient to be
-     *  able to search by the sequence number alone.
-     */
-    std::map<InstSeqNum, DynInstPtr> nonSpecInsts;
+    static_assert(Num_OpClasses <= 64,
+                  "The ready op classes must fit in a 64 bit mask");
 
-    typedef typename std::map<InstSeqNum, DynInstPtr>::iterator NonSpecMapIt;
+    /** Bit mask of the op classes which have ready instructions. */
+    uint64_t readyClasses;
 
-    /** Entry for the list age ordering by op class. */
-    struct ListOrderEntry {
-        OpClass queueType;
-        InstSeqNum oldestInst;
-    };
+    /** Add an instruction to the ready queue of its op class. */
+    void pushReadyInst(const DynInstPtr &inst);
 
-    /** List that contains the age order of the oldest instruction of each
-     *  ready queue.  Used to select the oldest instruction available
-     *  among op classes.
-     *  @todo: Might be better to just move these entries around instead
-     *  of creating new ones every time the position changes due to an
-     *  instruction issuing.  Not sure std::list supports this.
-     */
-    std::list<ListOrderEntry> listOrder;
-
-    typedef typename std::list<ListOrderEntry>::iterator ListOrderIt;
+    /** Remove the oldest instruction from the ready queue of an op class. */
+    void popReadyInst(OpClass op_class);
 
-    /** Tracks if each ready queue is on the age order list. */
-    bool queueOnList[Num_OpClasses];
+    /**
+     * Find the op class holding the oldest ready instruction, out of a
+     * non-empty mask of op classes which all have ready instructions.
+     * Used to select the oldest instruction available among op classes.
+     */
+    OpClass oldestReadyClass(uint64_t op_classes) const;
 
-    /** Iterators of each ready queue.  Points to their spot in the age order
-     *  list.
+    /** List of non-speculative instructions that will be scheduled
+     *  once the IQ gets a signal from commit. There are only ever a
+     *  handful of these, so they are simply searched by sequence number.
      */
-    ListOrderIt readyIt[Num_OpClasses];
+    std::vector<DynInstPtr> nonSpecInsts;
 
-    /** Add an op class to the age order list. */
-    void addToOrderList(OpClass op_class);
+    typedef typename std::vector<DynInstPtr>::iterator NonSpecIt;
 
-    /**
-     * Called when the oldest instruction has been removed from a ready queue;
-     * this places that ready queue into the proper spot in the age order list.
-     */
-    void moveToYoungerInst(ListOrderIt age_order_it);
+    /** Find a non-speculative instruction by its sequence number. */
+    NonSpecIt findNonSpec(InstSeqNum seq_num);
 
     DependencyGraph<DynInstPtr> dependGraph;
 
@@ -42,9 +42,11 @@
 #ifndef __CPU_O3_INST_QUEUE_IMPL_HH__
 #define __CPU_O3_INST_QUEUE_IMPL_HH__
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
+#include "base/bitfield.hh"
 #include "base/logging.hh"
 #include "cpu/o3/fu_pool.hh"
 #include "cpu/o3/inst_queue.hh"
@@ -118,6 +120,17 @@ InstructionQueue<Impl>::InstructionQueue(O3CPU *cpu_ptr, IEW *iew_ptr,
         memDepUnit[tid].setIQ(this);
     }
 
+    // Instructions stay on the instruction list until they commit, so it
+    // is bounded by the ROB rather than the IQ, as is the queue of issued
+    // instructions. Blocked memory instructions are bounded by the LSQ.
+    for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++)
+        instList[tid] = InstQueue(params.numROBEntries);
+    instsToExecute = InstQueue(params.numROBEntries);
+    blockedMemInsts = InstQueue(params.LQEntries + params.SQEntries);
+    retryMemInsts = InstQueue(params.LQEntries + params.SQEntries);
+    deferredMemInsts.reserve(params.LQEntries + params.SQEntries);
+    nonSpecInsts.reserve(numEntries);
+
     resetState();
 
     //Figure out resource sharing policy
@@ -391,7 +404,7 @@ InstructionQueue<Impl>::resetState()
     //Initialize thread IQ counts
     for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++) {
         count[tid] = 0;
-        instList[tid].clear();
+        clearInsts(instList[tid]);
     }
 
     // Initialize the number of free IQ entries.
@@ -413,14 +426,12 @@ InstructionQueue<Impl>::resetState()
     for (int i = 0; i < Num_OpClasses; ++i) {
         while (!readyInsts[i].empty())
             readyInsts[i].pop();
-        queueOnList[i] = false;
-        readyIt[i] = listOrder.end();
     }
+    readyClasses = 0;
     nonSpecInsts.clear();
-    listOrder.clear();
     deferredMemInsts.clear();
-    blockedMemInsts.clear();
-    retryMemInsts.clear();
+    clearInsts(blockedMemInsts);
+    clearInsts(retryMemInsts);
     wbOutstanding = 0;
 }
 
@@ -554,17 +565,7 @@ template <class Impl>
 bool
 InstructionQueue<Impl>::hasReadyInsts()
 {
-    if (!listOrder.empty()) {
-        return true;
-    }
-
-    for (int i = 0; i < Num_OpClasses; ++i) {
-        if (!readyInsts[i].empty()) {
-            return true;
-        }
-    }
-
-    return false;
+    return readyClasses != 0;
 }
 
 template <class Impl>
@@ -586,7 +587,7 @@ InstructionQueue<Impl>::insert(const DynInstPtr &new_inst)
 
     assert(freeEntries != 0);
 
-    instList[new_inst->threadNumber].push_back(new_inst);
+    pushInst(instList[new_inst->threadNumber], new_inst);
 
     --freeEntries;
 
@@ -629,7 +630,8 @@ InstructionQueue<Impl>::insertNonSpec(const DynInstPtr &new_inst)
 
     assert(new_inst);
 
-    nonSpecInsts[new_inst->seqNum] = new_inst;
+    assert(findNonSpec(new_inst->seqNum) == nonSpecInsts.end());
+    nonSpecInsts.push_back(new_inst);
 
     DPRINTF(IQ, "Adding non-speculative instruction [sn:%llu] PC %s "
             "to the IQ.\n",
@@ -637,7 +639,7 @@ InstructionQueue<Impl>::insertNonSpec(const DynInstPtr &new_inst)
 
     assert(freeEntries != 0);
 
-    instList[new_inst->threadNumber].push_back(new_inst);
+    pushInst(instList[new_inst->threadNumber], new_inst);
 
     --freeEntries;
 
@@ -688,55 +690,66 @@ InstructionQueue<Impl>::getInstToExecute()
 
 template <class Impl>
 void
-InstructionQueue<Impl>::addToOrderList(OpClass op_class)
+InstructionQueue<Impl>::pushInst(InstQueue &queue, const DynInstPtr &inst)
 {
-    assert(!readyInsts[op_class].empty());
-
-    ListOrderEntry queue_entry;
-
-    queue_entry.queueType = op_class;
-
-    queue_entry.oldestInst = readyInsts[op_class].top()->seqNum;
-
-    ListOrderIt list_it = listOrder.begin();
-    ListOrderIt list_end_it = listOrder.end();
-
-    while (list_it != list_end_it) {
-        if ((*list_it).oldestInst > queue_entry.oldestInst) {
-            break;
-        }
-
-        list_it++;
+    if (queue.full()) {
+        InstQueue bigger(std::max<size_t>(queue.capacity() * 2, 1));
+        for (auto &entry: queue)
+            bigger.push_back(std::move(entry));
+        queue = std::move(bigger);
     }
+    queue.push_back(inst);
+}
 
-    readyIt[op_class] = listOrder.insert(list_it, queue_entry);
-    queueOnList[op_class] = true;
+template <class Impl>
+void
+InstructionQueue<Impl>::clearInsts(InstQueue &queue)
+{
+    // Popping doesn't destroy the entries, so drop the references to
+    // the instructions explicitly to let them be freed.
+    for (auto &entry: queue)
+        entry = nullptr;
+    queue.flush();
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::pushReadyInst(const DynInstPtr &inst)
+{
+    OpClass op_class = inst->opClass();
+    readyInsts[op_class].push(inst);
+    readyClasses |= ULL(1) << op_class;
 }
 
 template <class Impl>
 void
-InstructionQueue<Impl>::moveToYoungerInst(ListOrderIt list_order_it)
+InstructionQueue<Impl>::popReadyInst(OpClass op_class)
 {
-    // Get iterator of next item on the list
-    // Delete the original iterator
-    // Determine if the next item is either the end of the list or younger
-    // than the new instruction.  If so, then add in a new iterator right here.
-    // If not, then move along.
-    ListOrderEntry queue_entry;
-    OpClass op_class = (*list_order_it).queueType;
-    ListOrderIt next_it = list_order_it;
-
-    ++next_it;
-
-    queue_entry.queueType = op_class;
-    queue_entry.oldestInst = readyInsts[op_class].top()->seqNum;
-
-    while (next_it != listOrder.end() &&
-           (*next_it).oldestInst < queue_entry.oldestInst) {
-        ++next_it;
+    readyInsts[op_class].pop();
+    if (readyInsts[op_class].empty())
+        readyClasses &= ~(ULL(1) << op_class);
+}
+
+template <class Impl>
+OpClass
+InstructionQueue<Impl>::oldestReadyClass(uint64_t op_classes) const
+{
+    assert(op_classes);
+
+    OpClass oldest = static_cast<OpClass>(ctz64(op_classes));
+    InstSeqNum oldest_inst = readyInsts[oldest].top()->seqNum;
+
+    for (op_classes &= op_classes - 1; op_classes;
+         op_classes &= op_classes - 1) {
+        OpClass op_class = static_cast<OpClass>(ctz64(op_classes));
+        assert(!readyInsts[op_class].empty());
+        if (readyInsts[op_class].top()->seqNum < oldest_inst) {
+            oldest = op_class;
+            oldest_inst = readyInsts[op_class].top()->seqNum;
+        }
     }
 
-    readyIt[op_class] = listOrder.insert(next_it, queue_entry);
+    return oldest;
 }
 
 template <class Impl>
@@ -757,7 +770,7 @@ InstructionQueue<Impl>::processFUCompletion(const DynInstPtr &inst, int fu_idx)
     // of a cycle, otherwise they could add too many instructions to
     // the queue.
     issueToExecuteQueue->access(-1)->size++;
-    instsToExecute.push_back(inst);
+    pushInst(instsToExecute, inst);
 }
 
 // @todo: Figure out a better way to remove the squashed items from the
@@ -782,22 +795,17 @@ InstructionQueue<Impl>::scheduleReadyInsts()
         addReadyMemInst(mem_inst);
     }
 
-    // Have iterator to head of the list
-    // While I haven't exceeded bandwidth or reached the end of the list,
-    // Try to get a FU that can do what this op needs.
-    // If successful, change the oldestInst to the new top of the list, put
-    // the queue in the proper place in the list.
-    // Increment the iterator.
+    // While I haven't exceeded bandwidth or run out of op classes to try,
+    // pick the op class with the oldest ready instruction and try to get
+    // a FU that can do what this op needs.
+    // If there is no free FU, drop the op class for the rest of the cycle.
     // This will avoid trying to schedule a certain op class if there are no
     // FUs that handle it.
     int total_issued = 0;
-    ListOrderIt order_it = listOrder.begin();
-    ListOrderIt order_end_it = listOrder.end();
+    uint64_t op_classes = readyClasses;
 
-    while (total_issued < totalWidth && order_it != order_end_it) {
-        OpClass op_class = (*order_it).queueType;
-
-        assert(!readyInsts[op_class].empty());
+    while (total_issued < totalWidth && op_classes) {
+        OpClass op_class = oldestReadyClass(op_classes);
 
         DynInstPtr issuing_inst = readyInsts[op_class].top();
 
@@ -809,19 +817,9 @@ InstructionQueue<Impl>::scheduleReadyInsts()
             iqIOStats.intInstQueueReads++;
         }
 
-        assert(issuing_inst->seqNum == (*order_it).oldestInst);
-
         if (issuing_inst->isSquashed()) {
-            readyInsts[op_class].pop();
-
-            if (!readyInsts[op_class].empty()) {
-                moveToYoungerInst(order_it);
-            } else {
-                readyIt[op_class] = listOrder.end();
-                queueOnList[op_class] = false;
-            }
-
-            listOrder.erase(order_it++);
+            popReadyInst(op_class);
+            op_classes &= readyClasses;
 
             ++iqStats.squashedInstsIssued;
 
@@ -851,7 +849,7 @@ InstructionQueue<Impl>::scheduleReadyInsts()
         if (idx != FUPool::NoFreeFU) {
             if (op_latency == Cycles(1)) {
                 i2e_info->size++;
-                instsToExecute.push_back(issuing_inst);
+                pushInst(instsToExecute, issuing_inst);
 
                 // Add the FU onto the list of FU's to be freed next
                 // cycle if we used one.
@@ -882,14 +880,8 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                     tid, issuing_inst->pcState(),
                     issuing_inst->seqNum);
 
-            readyInsts[op_class].pop();
-
-            if (!readyInsts[op_class].empty()) {
-                moveToYoungerInst(order_it);
-            } else {
-                readyIt[op_class] = listOrder.end();
-                queueOnList[op_class] = false;
-            }
+            popReadyInst(op_class);
+            op_classes &= readyClasses;
 
             issuing_inst->setIssued();
             ++total_issued;
@@ -908,12 +900,11 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                 memDepUnit[tid].issue(issuing_inst);
             }
 
-            listOrder.erase(order_it++);
             iqStats.statIssuedInstType[tid][op_class]++;
         } else {
             iqStats.statFuBusy[op_class]++;
             iqStats.fuBusy[tid]++;
-            ++order_it;
+            op_classes &= ~(ULL(1) << op_class);
         }
     }
 
@@ -938,25 +929,33 @@ InstructionQueue<Impl>::scheduleNonSpec(const InstSeqNum &inst)
     DPRINTF(IQ, "Marking nonspeculative instruction [sn:%llu] as ready "
             "to execute.\n", inst);
 
-    NonSpecMapIt inst_it = nonSpecInsts.find(inst);
+    NonSpecIt inst_it = findNonSpec(inst);
 
     assert(inst_it != nonSpecInsts.end());
 
-    ThreadID tid = (*inst_it).second->threadNumber;
+    DynInstPtr ns_inst = std::move(*inst_it);
+    nonSpecInsts.erase(inst_it);
+
+    ThreadID tid = ns_inst->threadNumber;
 
-    (*inst_it).second->setAtCommit();
+    ns_inst->setAtCommit();
 
-    (*inst_it).second->setCanIssue();
+    ns_inst->setCanIssue();
 
-    if (!(*inst_it).second->isMemRef()) {
-        addIfReady((*inst_it).second);
+    if (!ns_inst->isMemRef()) {
+        addIfReady(ns_inst);
     } else {
-        memDepUnit[tid].nonSpecInstReady((*inst_it).second);
+        memDepUnit[tid].nonSpecInstReady(ns_inst);
     }
+}
 
-    (*inst_it).second = NULL;
-
-    nonSpecInsts.erase(inst_it);
+template <class Impl>
+typename InstructionQueue<Impl>::NonSpecIt
+InstructionQueue<Impl>::findNonSpec(InstSeqNum seq_num)
+{
+    return std::find_if(nonSpecInsts.begin(), nonSpecInsts.end(),
+                        [seq_num](const DynInstPtr &inst)
+                        { return inst->seqNum == seq_num; });
 }
 
 template <class Impl>
@@ -966,11 +965,9 @@ InstructionQueue<Impl>::commit(const InstSeqNum &inst, ThreadID tid)
     DPRINTF(IQ, "[tid:%i] Committing instructions older than [sn:%llu]\n",
             tid,inst);
 
-    ListIt iq_it = instList[tid].begin();
-
-    while (iq_it != instList[tid].end() &&
-           (*iq_it)->seqNum <= inst) {
-        ++iq_it;
+    while (!instList[tid].empty() &&
+           instList[tid].front()->seqNum <= inst) {
+        instList[tid].front() = nullptr;
         instList[tid].pop_front();
     }
 
@@ -1081,23 +1078,12 @@ template <class Impl>
 void
 InstructionQueue<Impl>::addReadyMemInst(const DynInstPtr &ready_inst)
 {
-    OpClass op_class = ready_inst->opClass();
-
-    readyInsts[op_class].push(ready_inst);
-
-    // Will need to reorder the list if either a queue is not on the list,
-    // or it has an older instruction than last time.
-    if (!queueOnList[op_class]) {
-        addToOrderList(op_class);
-    } else if (readyInsts[op_class].top()->seqNum  <
-               (*readyIt[op_class]).oldestInst) {
-        listOrder.erase(readyIt[op_class]);
-        addToOrderList(op_class);
-    }
+    pushReadyInst(ready_inst);
 
     DPRINTF(IQ, "Instruction is ready to issue, putting it onto "
             "the ready list, PC %s opclass:%i [sn:%llu].\n",
-            ready_inst->pcState(), op_class, ready_inst->seqNum);
+            ready_inst->pcState(), ready_inst->opClass(),
+            ready_inst->seqNum);
 }
 
 template <class Impl>
@@ -1134,14 +1120,16 @@ InstructionQueue<Impl>::blockMemInst(const DynInstPtr &blocked_inst)
 {
     blocked_inst->clearIssued();
     blocked_inst->clearCanIssue();
-    blockedMemInsts.push_back(blocked_inst);
+    pushInst(blockedMemInsts, blocked_inst);
 }
 
 template <class Impl>
 void
 InstructionQueue<Impl>::cacheUnblocked()
 {
-    retryMemInsts.splice(retryMemInsts.end(), blockedMemInsts);
+    for (auto &blocked_inst: blockedMemInsts)
+        pushInst(retryMemInsts, blocked_inst);
+    clearInsts(blockedMemInsts);
     // Get the CPU ticking again
     cpu->wakeCPU();
 }
@@ -1150,7 +1138,7 @@ template <class Impl>
 typename Impl::DynInstPtr
 InstructionQueue<Impl>::getDeferredMemInstToExecute()
 {
-    for (ListIt it = deferredMemInsts.begin(); it != deferredMemInsts.end();
+    for (auto it = deferredMemInsts.begin(); it != deferredMemInsts.end();
          ++it) {
         if ((*it)->translationCompleted() || (*it)->isSquashed()) {
             DynInstPtr mem_inst = std::move(*it);
@@ -1204,19 +1192,16 @@ template <class Impl>
 void
 InstructionQueue<Impl>::doSquash(ThreadID tid)
 {
-    // Start at the tail.
-    ListIt squash_it = instList[tid].end();
-    --squash_it;
-
     DPRINTF(IQ, "[tid:%i] Squashing until sequence number %i!\n",
             tid, squashedSeqNum[tid]);
 
     // Squash any instructions younger than the squashed sequence number
-    // given.
-    while (squash_it != instList[tid].end() &&
-           (*squash_it)->seqNum > squashedSeqNum[tid]) {
+    // given, starting at the tail.
+    while (!instList[tid].empty() &&
+           instList[tid].back()->seqNum > squashedSeqNum[tid]) {
 
-        DynInstPtr squashed_inst = (*squash_it);
+        DynInstPtr squashed_inst = std::move(instList[tid].back());
+        instList[tid].pop_back();
         if (squashed_inst->isFloating()) {
             iqIOStats.fpInstQueueWrites++;
         } else if (squashed_inst->isVector()) {
@@ -1229,7 +1214,6 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
         // hasn't already been squashed in the IQ.
         if (squashed_inst->threadNumber != tid ||
             squashed_inst->isSquashedInIQ()) {
-            --squash_it;
             continue;
         }
 
@@ -1280,8 +1264,8 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
 
             } else if (!squashed_inst->isStoreConditional() ||
                        !squashed_inst->isCompleted()) {
-                NonSpecMapIt ns_inst_it =
-                    nonSpecInsts.find(squashed_inst->seqNum);
+                NonSpecIt ns_inst_it =
+                    findNonSpec(squashed_inst->seqNum);
 
                 // we remove non-speculative instructions from
                 // nonSpecInsts already when they are ready, and so we
@@ -1294,8 +1278,6 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
                            squashed_inst->isMemRef());
                 } else {
 
-                    (*ns_inst_it).second = NULL;
-
                     nonSpecInsts.erase(ns_inst_it);
 
                     ++iqStats.squashedNonSpecRemoved;
@@ -1338,7 +1320,6 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
             assert(dependGraph.empty(dest_reg->flatIndex()));
             dependGraph.clearInst(dest_reg->flatIndex());
         }
-        instList[tid].erase(squash_it--);
         ++iqStats.squashedInstsExamined;
     }
 }
@@ -1447,23 +1428,11 @@ InstructionQueue<Impl>::addIfReady(const DynInstPtr &inst)
             return;
         }
 
-        OpClass op_class = inst->opClass();
-
         DPRINTF(IQ, "Instruction is ready to issue, putting it onto "
                 "the ready list, PC %s opclass:%i [sn:%llu].\n",
-                inst->pcState(), op_class, inst->seqNum);
-
-        readyInsts[op_class].push(inst);
-
-        // Will need to reorder the list if either a queue is not on the list,
-        // or it has an older instruction than last time.
-        if (!queueOnList[op_class]) {
-            addToOrderList(op_class);
-        } else if (readyInsts[op_class].top()->seqNum  <
-                   (*readyIt[op_class]).oldestInst) {
-            listOrder.erase(readyIt[op_class]);
-            addToOrderList(op_class);
-        }
+                inst->pcState(), inst->opClass(), inst->seqNum);
+
+        pushReadyInst(inst);
     }
 }
 
@@ -1486,30 +1455,26 @@ InstructionQueue<Impl>::dumpLists()
 
     cprintf("Non speculative list size: %i\n", nonSpecInsts.size());
 
-    NonSpecMapIt non_spec_it = nonSpecInsts.begin();
-    NonSpecMapIt non_spec_end_it = nonSpecInsts.end();
-
     cprintf("Non speculative list: ");
 
-    while (non_spec_it != non_spec_end_it) {
-        cprintf("%s [sn:%llu]", (*non_spec_it).second->pcState(),
-                (*non_spec_it).second->seqNum);
-        ++non_spec_it;
+    for (const auto &non_spec_inst: nonSpecInsts) {
+        cprintf("%s [sn:%llu]", non_spec_inst->pcState(),
+                non_spec_inst->seqNum);
     }
 
     cprintf("\n");
 
-    ListOrderIt list_order_it = listOrder.begin();
-    ListOrderIt list_order_end_it = listOrder.end();
+    uint64_t op_classes = readyClasses;
     int i = 1;
 
     cprintf("List order: ");
 
-    while (list_order_it != list_order_end_it) {
-        cprintf("%i OpClass:%i [sn:%llu] ", i, (*list_order_it).queueType,
-                (*list_order_it).oldestInst);
+    while (op_classes) {
+        OpClass op_class = oldestReadyClass(op_classes);
+        cprintf("%i OpClass:%i [sn:%llu] ", i, op_class,
+                readyInsts[op_class].top()->seqNum);
 
-        ++list_order_it;
+        op_classes &= ~(ULL(1) << op_class);
         ++i;
     }
 
@@ -1524,7 +1489,7 @@ InstructionQueue<Impl>::dumpInsts()
     for (ThreadID tid = 0; tid < numThreads; ++tid) {
         int num = 0;
         int valid_num = 0;
-        ListIt inst_list_it = instList[tid].begin();
+        auto inst_list_it = instList[tid].begin();
 
         while (inst_list_it != instList[tid].end()) {
             cprintf("Instruction:%i\n", num);
@@ -1564,7 +1529,7 @@ InstructionQueue<Impl>::dumpInsts()
 
     int num = 0;
     int valid_num = 0;
-    ListIt inst_list_it = instsToExecute.begin();
+    auto inst_list_it = instsToExecute.begin();
 
     while (inst_list_it != instsToExecute.end())
     {
@@ -37,6 +37,8 @@
 
 #include "cpu/o3/probe/elastic_trace.hh"
 
+#include <algorithm>
+
 #include "base/callback.hh"
 #include "base/output.hh"
 #include "base/trace.hh"
@@ -51,6 +53,7 @@ ElasticTrace::ElasticTrace(const ElasticTraceParams &params)
        lastClearedSeqNum(0),
        depWindowSize(params.depWindowSize),
        dataTraceStream(nullptr),
+       maxExecTick(0),
        instTraceStream(nullptr),
        startTraceInst(params.startTraceInst),
        allProbesReg(false),
@@ -158,6 +161,7 @@ ElasticTrace::fetchReqTrace(const RequestPtr &req)
     inst_fetch_pkt.set_addr(req->getPaddr());
     inst_fetch_pkt.set_size(req->getSize());
     // Write the message to the stream.
+    instTraceStream->seekPoint(curTick());
     instTraceStream->write(inst_fetch_pkt);
 }
 
@@ -860,7 +864,15 @@ ElasticTrace::writeDepTrace(uint32_t num_to_write)
                 dep_pkt.set_weight(num_filtered_nodes);
                 num_filtered_nodes = 0;
             }
-            // Write the message to the protobuf output stream
+            // Write the message to the protobuf output stream. Records
+            // are written in commit order, so the seek points are keyed
+            // by the latest execute tick so far, which never decreases.
+            // Every record before a seek point then executed no later
+            // than its key.
+            const Tick exec_tick = temp_ptr->getExecuteTick();
+            dep_pkt.set_exec_tick(exec_tick);
+            maxExecTick = std::max(maxExecTick, exec_tick);
+            dataTraceStream->seekPoint(maxExecTick);
             dataTraceStream->write(dep_pkt);
         } else {
             // Don't write the node to the trace but note that we have filtered
@@ -347,6 +347,12 @@ class ElasticTrace : public ProbeListenerObject
     /** Protobuf output stream for data dependency trace */
     ProtoOutputStream* dataTraceStream;
 
+    /**
+     * Latest execute tick of the records written to the data dependency
+     * trace, which keys its seek points
+     */
+    Tick maxExecTick;
+
     /** Protobuf output stream for instruction fetch trace. */
     ProtoOutputStream* instTraceStream;
 
@@ -83,10 +83,10 @@ AtomicSimpleCPU::AtomicSimpleCPU(const AtomicSimpleCPUParams &p)
       ppCommit(nullptr)
 {
     _status = Idle;
-    ifetch_req = std::make_shared<Request>();
-    data_read_req = std::make_shared<Request>();
-    data_write_req = std::make_shared<Request>();
-    data_amo_req = std::make_shared<Request>();
+    ifetch_req = Request::create();
+    data_read_req = Request::create();
+    data_write_req = Request::create();
+    data_amo_req = Request::create();
 }
 
 
@@ -392,18 +392,22 @@ AtomicSimpleCPU::readMem(Addr addr, uint8_t *data, unsigned size,
         // Now do the access.
         if (predicate && fault == NoFault &&
             !req->getFlags().isSet(Request::NO_ACCESS)) {
-            Packet pkt(req, Packet::makeReadCmd(req));
-            pkt.dataStatic(data);
+            if (req->isLocalAccess() ||
+                    !accessDataBackdoor(req, data, false)) {
+                Packet pkt(req, Packet::makeReadCmd(req));
+                pkt.dataStatic(data);
 
-            if (req->isLocalAccess()) {
-                dcache_latency += req->localAccessor(thread->getTC(), &pkt);
-            } else {
-                dcache_latency += sendPacket(dcachePort, &pkt);
+                if (req->isLocalAccess()) {
+                    dcache_latency +=
+                        req->localAccessor(thread->getTC(), &pkt);
+                } else {
+                    dcache_latency += sendPacket(dcachePort, &pkt);
+                }
+
+                assert(!pkt.isError());
             }
             dcache_access = true;
 
-            assert(!pkt.isError());
-
             if (req->isLLSC()) {
                 TheISA::handleLockedRead(thread, req);
             }
@@ -491,7 +495,12 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
                 }
             }
 
-            if (do_access && !req->getFlags().isSet(Request::NO_ACCESS)) {
+            if (do_access && !req->getFlags().isSet(Request::NO_ACCESS) &&
+                    !req->isLocalAccess() &&
+                    accessDataBackdoor(req, data, true)) {
+                dcache_access = true;
+            } else if (do_access &&
+                    !req->getFlags().isSet(Request::NO_ACCESS)) {
                 Packet pkt(req, Packet::makeWriteCmd(req));
                 pkt.dataStatic(data);
 
@@ -581,20 +590,23 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
 
     // Now do the access.
     if (fault == NoFault && !req->getFlags().isSet(Request::NO_ACCESS)) {
-        // We treat AMO accesses as Write accesses with SwapReq command
-        // data will hold the return data of the AMO access
-        Packet pkt(req, Packet::makeWriteCmd(req));
-        pkt.dataStatic(data);
+        if (req->isLocalAccess() || !accessDataBackdoor(req, data, true)) {
+            // We treat AMO accesses as Write accesses with SwapReq command
+            // data will hold the return data of the AMO access
+            Packet pkt(req, Packet::makeWriteCmd(req));
+            pkt.dataStatic(data);
 
-        if (req->isLocalAccess()) {
-            dcache_latency += req->localAccessor(thread->getTC(), &pkt);
-        } else {
-            dcache_latency += sendPacket(dcachePort, &pkt);
+            if (req->isLocalAccess()) {
+                dcache_latency += req->localAccessor(thread->getTC(), &pkt);
+            } else {
+                dcache_latency += sendPacket(dcachePort, &pkt);
+            }
+
+            assert(!pkt.isError());
         }
 
         dcache_access = true;
 
-        assert(!pkt.isError());
         assert(!req->isLLSC());
     }
 
@@ -103,6 +103,22 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     virtual Tick sendPacket(RequestPort &port, const PacketPtr &pkt);
     virtual Tick fetchInstMem();
 
+    /**
+     * Try to do a data access directly in host memory instead of sending
+     * a packet through the data port.
+     *
+     * @param req The translated request.
+     * @param data The data to read into, to write, or the old data of an
+     *             atomic operation.
+     * @param write True for writes and atomic operations.
+     * @return True if the access was done.
+     */
+    virtual bool
+    accessDataBackdoor(const RequestPtr &req, uint8_t *data, bool write)
+    {
+        return false;
+    }
+
     /**
      * An AtomicCPUPort overrides the default behaviour of the
      * recvAtomicSnoop and ignores the packet instead of panicking. It
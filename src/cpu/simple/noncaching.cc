@@ -62,6 +62,10 @@ NonCachingSimpleCPU::sendPacket(RequestPort &port, const PacketPtr &pkt)
     MemBackdoorPtr bd = nullptr;
     Tick latency = port.sendAtomicBackdoor(pkt, bd);
 
+    // Memories only hand out backdoors while they hold no reservations.
+    if (bd && bd->range().contains(lockedAddr))
+        lockedAddr = MaxAddr;
+
     // If the target gave us a backdoor for next time and we didn't
     // already have it, record it.
     if (bd && memBackdoors.insert(bd->range(), bd) != memBackdoors.end()) {
@@ -93,3 +97,52 @@ NonCachingSimpleCPU::fetchInstMem()
     memcpy(&inst, bd->ptr() + offset, ifetch_req->getSize());
     return 0;
 }
+
+bool
+NonCachingSimpleCPU::accessDataBackdoor(const RequestPtr &req, uint8_t *data,
+                                        bool write)
+{
+    // Requests with side effects beyond reading or writing the data, e.g.
+    // on the LL/SC reservations kept by the memory, are sent as packets.
+    // Backdoors are only handed out by memories, so accesses to devices
+    // always take the slow path.
+    const Request::FlagsType slow_path =
+        Request::UNCACHEABLE | Request::STRICT_ORDER | Request::LLSC |
+        Request::LOCKED_RMW | Request::MEM_SWAP | Request::MEM_SWAP_COND |
+        Request::CLEAN | Request::INVALIDATE | Request::HTM_CMD;
+    const Addr paddr = req->getPaddr();
+    if (req->getFlags().isSet(slow_path) || req->isMasked()) {
+        if (req->isLLSC() && !write)
+            lockedAddr = paddr;
+        return false;
+    }
+
+    // Plain stores have to clear the LL/SC reservations held in the
+    // memory, which stores through a backdoor wouldn't do. Taking a
+    // reservation invalidates the backdoor, and the memory hands out no
+    // new one while any are left. Don't count on the invalidation for
+    // our own load locked: keep stores on the port until the memory
+    // hands a backdoor out again.
+    if (write && lockedAddr != MaxAddr)
+        return false;
+
+    const unsigned size = req->getSize();
+    auto bd_it = memBackdoors.contains(RangeSize(paddr, size));
+    if (bd_it == memBackdoors.end())
+        return false;
+
+    auto *bd = bd_it->second;
+    if (write ? !bd->writeable() : !bd->readable())
+        return false;
+
+    uint8_t *host_addr = bd->ptr() + (paddr - bd->range().start());
+    if (req->isAtomic()) {
+        memcpy(data, host_addr, size);
+        (*req->getAtomicOpFunctor())(host_addr);
+    } else if (write) {
+        memcpy(host_addr, data, size);
+    } else {
+        memcpy(data, host_addr, size);
+    }
+    return true;
+}
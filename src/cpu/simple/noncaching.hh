@@ -57,8 +57,14 @@ class NonCachingSimpleCPU : public AtomicSimpleCPU
   protected:
     AddrRangeMap<MemBackdoorPtr, 1> memBackdoors;
 
+    // Address of our last load locked while the memory may still hold a
+    // reservation for it, MaxAddr otherwise.
+    Addr lockedAddr = MaxAddr;
+
     Tick sendPacket(RequestPort &port, const PacketPtr &pkt) override;
     Tick fetchInstMem() override;
+    bool accessDataBackdoor(const RequestPtr &req, uint8_t *data,
+                            bool write) override;
 };
 
 #endif // __CPU_SIMPLE_NONCACHING_HH__
@@ -87,6 +87,12 @@ TraceGen::InputStream::read(TraceElement& element)
     return false;
 }
 
+bool
+TraceGen::InputStream::seek(Tick tick)
+{
+    return trace.seek(tick);
+}
+
 Tick
 TraceGen::nextPacketTick(bool elastic, Tick delay) const
 {
@@ -113,14 +119,25 @@ TraceGen::nextPacketTick(bool elastic, Tick delay) const
 void
 TraceGen::enter()
 {
-    // update the trace offset to the time where the state was entered.
-    tickOffset = curTick();
+    // update the trace offset to the time where the state was
+    // entered, such that the start tick is replayed right away. The
+    // arithmetic is modular, and the sum with a trace tick that is
+    // not before the start tick never wraps.
+    tickOffset = curTick() - startTick;
 
     // clear everything
     currElement.clear();
 
-    // read the first element in the file and set the complete flag
-    traceComplete = !trace.read(nextElement);
+    // jump close to the start tick if the trace allows it, and skip
+    // the elements that were recorded before it
+    if (startTick != 0 && !trace.seek(startTick)) {
+        DPRINTF(TrafficGen, "Trace is not seekable, reading up to "
+                "tick %d\n", startTick);
+    }
+    do {
+        // read the next element in the file and set the complete flag
+        traceComplete = !trace.read(nextElement);
+    } while (!traceComplete && nextElement.tick < startTick);
 }
 
 PacketPtr
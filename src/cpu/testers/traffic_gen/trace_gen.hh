@@ -53,7 +53,9 @@
 /**
  * The trace replay generator reads a trace file and plays
  * back the transactions. The trace is offset with respect to
- * the time when the state was entered.
+ * the time when the state was entered. Replay can start part way
+ * into the trace, in which case a seekable (zstd) trace is entered
+ * close to the start tick rather than read from the beginning.
  */
 class TraceGen : public BaseGen
 {
@@ -140,6 +142,16 @@ class TraceGen : public BaseGen
          * @return True if an element could be read successfully
          */
         bool read(TraceElement& element);
+
+        /**
+         * Move the stream close to the first element recorded at or
+         * after the given tick, if the trace is seekable. Elements
+         * before the tick may still follow.
+         *
+         * @param tick Tick to move to
+         * @return True if the stream supports seeking
+         */
+        bool seek(Tick tick);
     };
 
   public:
@@ -152,13 +164,16 @@ class TraceGen : public BaseGen
      * @param _duration duration of this state before transitioning
      * @param trace_file File to read the transactions from
      * @param addr_offset Positive offset to add to trace address
+     * @param start_tick Trace tick to start the replay from
      */
     TraceGen(SimObject &obj, RequestorID requestor_id, Tick _duration,
-             const std::string& trace_file, Addr addr_offset)
+             const std::string& trace_file, Addr addr_offset,
+             Tick start_tick = 0)
         : BaseGen(obj, requestor_id, _duration),
           trace(trace_file),
           tickOffset(0),
           addrOffset(addr_offset),
+          startTick(start_tick),
           traceComplete(false)
     {
     }
@@ -198,6 +213,12 @@ class TraceGen : public BaseGen
      */
     Addr addrOffset;
 
+    /**
+     * Tick in the trace to start the replay from. Elements recorded
+     * before it are skipped.
+     */
+    const Tick startTick;
+
     /**
      * Set to true when the trace replay for one instance of
      * state is complete.
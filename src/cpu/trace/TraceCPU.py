@@ -83,3 +83,9 @@ class TraceCPU(BaseCPU):
     progressMsgInterval = Param.Unsigned(0, "Interval of committed "\
                                          "instructions at which to print a"\
                                          " progress msg")
+
+    # Replay the traces starting from the records written at or after this
+    # tick of the recording. Seekable (zstd) traces are entered close to
+    # the start tick, and the data dependency trace must be seekable.
+    traceStartTick = Param.Tick(0, "Tick of the recorded traces to start "\
+                                "the replay from")
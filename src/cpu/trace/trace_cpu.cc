@@ -60,7 +60,8 @@ TraceCPU::TraceCPU(const TraceCPUParams &params)
         execCompleteEvent(nullptr),
         enableEarlyExit(params.enableEarlyExit),
         progressMsgInterval(params.progressMsgInterval),
-        progressMsgThreshold(params.progressMsgInterval), traceStats(this)
+        progressMsgThreshold(params.progressMsgInterval),
+        traceStartTick(params.traceStartTick), traceStats(this)
 {
     // Increment static counter for number of Trace CPUs.
     ++TraceCPU::numTraceCPUs;
@@ -108,10 +109,10 @@ TraceCPU::init()
     BaseCPU::init();
 
     // Get the send tick of the first instruction read request
-    Tick first_icache_tick = icacheGen.init();
+    Tick first_icache_tick = icacheGen.init(traceStartTick);
 
     // Get the send tick of the first data read/write request
-    Tick first_dcache_tick = dcacheGen.init();
+    Tick first_dcache_tick = dcacheGen.init(traceStartTick);
 
     // Set the trace offset as the minimum of that in both traces
     traceOffset = std::min(first_icache_tick, first_dcache_tick);
@@ -239,11 +240,17 @@ ElasticDataGenStatGroup::ElasticDataGenStatGroup(Stats::Group *parent,
 }
 
 Tick
-TraceCPU::ElasticDataGen::init()
+TraceCPU::ElasticDataGen::init(Tick start_tick)
 {
     DPRINTF(TraceCPUData, "Initializing data memory request generator "
             "DcacheGen: elastic issue with retry.\n");
 
+    // Starting part way into the trace relies on the execute ticks the
+    // trace was keyed with when written
+    fatal_if(start_tick != 0 && !trace.seek(start_tick),
+             "%s: Starting the replay at tick %d requires a seekable "
+             "(zstd) data dependency trace.\n", name(), start_tick);
+
     panic_if(!readNextWindow(),
             "Trace has %d elements. It must have at least %d elements.",
             depGraph.size(), 2 * windowSize);
@@ -301,13 +308,11 @@ TraceCPU::ElasticDataGen::readNextWindow()
     uint32_t num_read = 0;
     while (num_read != windowSize) {
 
-        // Create a new graph node
-        GraphNode* new_node = new GraphNode;
-
-        // Read the next line to get the next record. If that fails then end of
-        // trace has been reached and traceComplete needs to be set in addition
-        // to returning false.
-        if (!trace.read(new_node)) {
+        // Read the next line to get the next record as a new graph node.
+        // If that fails then end of trace has been reached and
+        // traceComplete needs to be set in addition to returning false.
+        GraphNode* new_node = trace.read();
+        if (!new_node) {
             DPRINTF(TraceCPUData, "\tTrace complete!\n");
             traceComplete = true;
             return false;
@@ -589,7 +594,7 @@ TraceCPU::ElasticDataGen::executeMemReq(GraphNode* node_ptr)
     }
 
     // Create a request and the packet containing request
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         node_ptr->physAddr, node_ptr->size, node_ptr->flags, requestorId);
     req->setReqInstSeqNum(node_ptr->seqNum);
 
@@ -974,14 +979,26 @@ TraceCPU::FixedRetryGen::FixedRetryGenStatGroup::FixedRetryGenStatGroup(
 }
 
 Tick
-TraceCPU::FixedRetryGen::init()
+TraceCPU::FixedRetryGen::init(Tick start_tick)
 {
     DPRINTF(TraceCPUInst, "Initializing instruction fetch request generator"
             " IcacheGen: fixed issue with retry.\n");
 
-    if (nextExecute()) {
+    // Jump close to the start tick if the trace allows it, the messages
+    // sent before it are skipped either way
+    if (start_tick != 0 && !trace.seek(start_tick)) {
+        DPRINTF(TraceCPUInst, "\tTrace is not seekable, reading up to "
+                "tick %d.\n", start_tick);
+    }
+
+    bool found;
+    do {
+        found = nextExecute();
+    } while (found && currElement.tick < start_tick);
+
+    if (found) {
         DPRINTF(TraceCPUInst, "\tFirst tick = %d.\n", currElement.tick);
-        return currElement.tick;
+        return currElement.tick - start_tick;
     } else {
         panic("Read of first message in the trace failed.\n");
         return MaxTick;
@@ -1078,7 +1095,7 @@ TraceCPU::FixedRetryGen::send(Addr addr, unsigned size, const MemCmd& cmd,
 {
 
     // Create new request
-    auto req = std::make_shared<Request>(addr, size, flags, requestorId);
+    auto req = Request::create(addr, size, flags, requestorId);
     req->setPC(pc);
 
     // If this is not done it triggers assert in L1 cache for invalid contextId
@@ -1186,7 +1203,14 @@ TraceCPU::ElasticDataGen::InputStream::InputStream(
         const std::string& filename, const double time_multiplier) :
     trace(filename),
     timeMultiplier(time_multiplier),
-    microOpCount(0)
+    microOpCount(0),
+    readMicroOpCount(0),
+    skipBefore(0),
+    nodes(readAheadSize),
+    readerStop(false),
+    readerDone(false),
+    readerWaiting(false),
+    simWaiting(false)
 {
     // Create a protobuf message for the header and read it from the stream
     ProtoMessage::InstDepRecordHeader header_msg;
@@ -1204,17 +1228,153 @@ TraceCPU::ElasticDataGen::InputStream::InputStream(
     }
 }
 
+TraceCPU::ElasticDataGen::InputStream::~InputStream()
+{
+    stopReader();
+}
+
 void
 TraceCPU::ElasticDataGen::InputStream::reset()
 {
+    stopReader();
     trace.reset();
+    microOpCount = 0;
+    readMicroOpCount = 0;
+    skipBefore = 0;
 }
 
 bool
-TraceCPU::ElasticDataGen::InputStream::read(GraphNode* element)
+TraceCPU::ElasticDataGen::InputStream::seek(Tick tick)
+{
+    stopReader();
+    readMicroOpCount = microOpCount;
+    if (!trace.seek(tick))
+        return false;
+    // The seek lands on a frame which may start with records executed
+    // before the tick
+    skipBefore = tick;
+    return true;
+}
+
+void
+TraceCPU::ElasticDataGen::InputStream::stopReader()
+{
+    if (!reader.joinable())
+        return;
+
+    readerStop.store(true, std::memory_order_relaxed);
+    {
+        // The reader checks for the stop under the lock before sleeping
+        std::lock_guard<std::mutex> lock(waitLock);
+        spaceFreed.notify_one();
+    }
+    reader.join();
+
+    GraphNode* node;
+    while (nodes.pop(node))
+        delete node;
+
+    readerStop.store(false, std::memory_order_relaxed);
+    readerDone.store(false, std::memory_order_relaxed);
+}
+
+void
+TraceCPU::ElasticDataGen::InputStream::notifyWaiting(
+        const std::atomic<bool> &waiting, std::condition_variable &cond)
+{
+    // Order the preceding update of the queue or the flags against
+    // reading the waiting flag. The sleeping side orders setting it
+    // against checking the queue the same way, so at least one of the
+    // two sides sees the other.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(waitLock);
+        cond.notify_one();
+    }
+}
+
+void
+TraceCPU::ElasticDataGen::InputStream::readAhead()
+{
+    while (!readerStop.load(std::memory_order_relaxed)) {
+        GraphNode* node = new GraphNode;
+        if (!decode(node)) {
+            delete node;
+            break;
+        }
+
+        if (!nodes.push(node)) {
+            // Sleep until the simulation catches up when far enough
+            // ahead
+            std::unique_lock<std::mutex> lock(waitLock);
+            readerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool pushed = false;
+            spaceFreed.wait(lock, [this, node, &pushed]() {
+                pushed = nodes.push(node);
+                return pushed ||
+                    readerStop.load(std::memory_order_relaxed);
+            });
+            readerWaiting.store(false, std::memory_order_relaxed);
+            if (!pushed) {
+                delete node;
+                return;
+            }
+        }
+        // Let a waiting simulation run once there is a batch of nodes
+        // for it, rather than waking it up for every single node
+        if (nodes.size() >= nodes.capacity() / 2)
+            notifyWaiting(simWaiting, nodeAdded);
+    }
+    readerDone.store(true, std::memory_order_release);
+    notifyWaiting(simWaiting, nodeAdded);
+}
+
+TraceCPU::ElasticDataGen::GraphNode*
+TraceCPU::ElasticDataGen::InputStream::read()
+{
+    if (!reader.joinable())
+        reader = std::thread([this]() { readAhead(); });
+
+    GraphNode* node;
+    if (!nodes.pop(node)) {
+        std::unique_lock<std::mutex> lock(waitLock);
+        simWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped = false;
+        nodeAdded.wait(lock, [this, &node, &popped]() {
+            popped = nodes.pop(node);
+            return popped || readerDone.load(std::memory_order_acquire);
+        });
+        simWaiting.store(false, std::memory_order_relaxed);
+        // The reader finishes after pushing its last node, so check the
+        // queue once more before concluding that the trace is done
+        if (!popped && !nodes.pop(node))
+            return nullptr;
+    }
+    // Likewise wake up a waiting reader once it can decode a batch
+    if (nodes.size() <= nodes.capacity() / 2)
+        notifyWaiting(readerWaiting, spaceFreed);
+
+    // Account for the ops up to this node only, however far the reader
+    // thread got
+    microOpCount = node->robNum;
+    return node;
+}
+
+bool
+TraceCPU::ElasticDataGen::InputStream::decode(GraphNode* element)
 {
     ProtoMessage::InstDepRecord pkt_msg;
-    if (trace.read(pkt_msg)) {
+    bool found = trace.read(pkt_msg);
+    while (found && skipBefore != 0) {
+        if (!pkt_msg.has_exec_tick() || pkt_msg.exec_tick() >= skipBefore)
+            skipBefore = 0;
+        else
+            found = trace.read(pkt_msg);
+    }
+
+    if (found) {
         // Required fields
         element->seqNum = pkt_msg.seq_num();
         element->type = pkt_msg.type();
@@ -1268,11 +1428,11 @@ TraceCPU::ElasticDataGen::InputStream::read(GraphNode* element)
             element->pc = 0;
 
         // ROB occupancy number
-        ++microOpCount;
+        ++readMicroOpCount;
         if (pkt_msg.has_weight()) {
-            microOpCount += pkt_msg.weight();
+            readMicroOpCount += pkt_msg.weight();
         }
-        element->robNum = microOpCount;
+        element->robNum = readMicroOpCount;
         return true;
     }
 
@@ -1387,6 +1547,12 @@ TraceCPU::FixedRetryGen::InputStream::reset()
     trace.reset();
 }
 
+bool
+TraceCPU::FixedRetryGen::InputStream::seek(Tick tick)
+{
+    return trace.seek(tick);
+}
+
 bool
 TraceCPU::FixedRetryGen::InputStream::read(TraceElement* element)
 {
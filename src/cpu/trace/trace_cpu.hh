@@ -38,13 +38,18 @@
 #ifndef __CPU_TRACE_TRACE_CPU_HH__
 #define __CPU_TRACE_TRACE_CPU_HH__
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <mutex>
 #include <queue>
 #include <set>
+#include <thread>
 #include <unordered_map>
 
 #include "arch/registers.hh"
+#include "base/spsc_queue.hh"
 #include "base/statistics.hh"
 #include "cpu/base.hh"
 #include "debug/TraceCPUData.hh"
@@ -398,6 +403,17 @@ class TraceCPU : public BaseCPU
              * @return True if an element could be read successfully
              */
             bool read(TraceElement* element);
+
+            /**
+             * Move the stream to the first record executed at or after
+             * the given tick of the recording, if the trace is seekable.
+             * Records from traces without execute ticks are not skipped
+             * beyond the seek point.
+             *
+             * @param tick Recording tick to move to
+             * @return True if the stream supports seeking
+             */
+            bool seek(Tick tick);
         };
 
       public:
@@ -417,12 +433,14 @@ class TraceCPU : public BaseCPU
         }
 
         /**
-         * Called from TraceCPU init(). Reads the first message from the
-         * input trace file and returns the send tick.
+         * Called from TraceCPU init(). Reads the first message sent at or
+         * after the start tick from the input trace file and returns its
+         * send tick relative to the start tick.
          *
+         * @param start_tick Tick in the trace to start the replay from
          * @return Tick when first packet must be sent
          */
-        Tick init();
+        Tick init(Tick start_tick);
 
         /**
          * This tries to send current or retry packet and returns true if
@@ -754,11 +772,21 @@ class TraceCPU : public BaseCPU
         /**
          * The InputStream encapsulates a trace file and the
          * internal buffers and populates GraphNodes based on
-         * the input.
+         * the input. Decoding the records is done ahead of the
+         * simulation by a reader thread, which hands the nodes over
+         * through a lock-free queue. The thread is only running while
+         * the stream is being read, and the file is only accessed by
+         * the thread while it is. A side which finds the queue full or
+         * empty sleeps until the other side has made it half empty or
+         * half full again, so that the threads don't wake each other up
+         * for every node.
          */
         class InputStream
         {
           private:
+            /** Number of nodes the reader thread decodes ahead */
+            static const size_t readAheadSize = 1024;
+
             /** Input file stream for the protobuf trace */
             ProtoInputStream trace;
 
@@ -773,12 +801,73 @@ class TraceCPU : public BaseCPU
             /** Count of committed ops read from trace plus the filtered ops */
             uint64_t microOpCount;
 
+            /** The same count for the nodes decoded by the reader thread */
+            uint64_t readMicroOpCount;
+
+            /**
+             * After a seek, the records which executed before this tick
+             * are skipped, up to the first one which didn't
+             */
+            Tick skipBefore;
+
             /**
              * The window size that is read from the header of the protobuf
              * trace and used to process the dependency trace
              */
             uint32_t windowSize;
 
+            /** Decoded nodes on their way to the simulation thread */
+            SpscQueue<GraphNode*> nodes;
+
+            /** Thread decoding the trace ahead of the simulation */
+            std::thread reader;
+
+            /** Set to ask the reader thread to stop */
+            std::atomic<bool> readerStop;
+
+            /** Set by the reader thread when the trace is exhausted */
+            std::atomic<bool> readerDone;
+
+            /** Lock for sleeping on a full or empty queue */
+            std::mutex waitLock;
+
+            /** Signalled when the queue drained or the reader stops */
+            std::condition_variable spaceFreed;
+
+            /** Signalled when the queue filled up or the trace ends */
+            std::condition_variable nodeAdded;
+
+            /** Set while the reader thread sleeps on a full queue */
+            std::atomic<bool> readerWaiting;
+
+            /** Set while the simulation sleeps on an empty queue */
+            std::atomic<bool> simWaiting;
+
+            /**
+             * Wake up the other side if it is sleeping on the given
+             * condition. Must follow the change it has to see.
+             */
+            void notifyWaiting(const std::atomic<bool> &waiting,
+                               std::condition_variable &cond);
+
+            /** Main loop of the reader thread */
+            void readAhead();
+
+            /**
+             * Stop the reader thread, if any, and drop the nodes it
+             * decoded but were not read, such that the file can be
+             * accessed again.
+             */
+            void stopReader();
+
+            /**
+             * Decode the next record of the trace.
+             *
+             * @param element Trace element to populate
+             * @return True if an element could be read successfully
+             */
+            bool decode(GraphNode* element);
+
           public:
             /**
              * Create a trace input stream for a given file name.
@@ -789,6 +878,8 @@ class TraceCPU : public BaseCPU
             InputStream(const std::string& filename,
                         const double time_multiplier);
 
+            ~InputStream();
+
             /**
              * Reset the stream such that it can be played once
              * again.
@@ -798,19 +889,27 @@ class TraceCPU : public BaseCPU
             /**
              * Attempt to read a trace element from the stream,
              * and also notify the caller if the end of the file
-             * was reached.
+             * was reached. The first read starts the reader thread.
              *
-             * @param element Trace element to populate
-             * @param size of register dependency array stored in the element
-             * @return True if an element could be read successfully
+             * @return The next node, owned by the caller, or nullptr if
+             * the end of the trace was reached
              */
-            bool read(GraphNode* element);
+            GraphNode* read();
 
             /** Get window size from trace */
             uint32_t getWindowSize() const { return windowSize; }
 
             /** Get number of micro-ops modelled in the TraceCPU replay */
             uint64_t getMicroOpCount() const { return microOpCount; }
+
+            /**
+             * Move the stream close to the records written at the
+             * given tick of the recording, if the trace is seekable.
+             *
+             * @param tick Recording tick to move to
+             * @return True if the stream supports seeking
+             */
+            bool seek(Tick tick);
         };
 
         public:
@@ -838,11 +937,15 @@ class TraceCPU : public BaseCPU
 
         /**
          * Called from TraceCPU init(). Reads the first message from the
-         * input trace file and returns the send tick.
+         * input trace file and returns the send tick. A non-zero start
+         * tick enters the trace at the first record executed at that
+         * tick, which requires a seekable trace. Dependencies on the
+         * records skipped this way are considered complete.
          *
+         * @param start_tick Tick in the trace to start the replay from
          * @return Tick when first packet must be sent
          */
-        Tick init();
+        Tick init(Tick start_tick);
 
         /**
          * Adjust traceOffset based on what TraceCPU init() determines on
@@ -1102,6 +1205,9 @@ class TraceCPU : public BaseCPU
      * message is printed.
      */
     uint64_t progressMsgThreshold;
+
+    /** Tick of the recorded traces to start the replay from. */
+    const Tick traceStartTick;
     struct TraceStats : public Stats::Group
     {
         TraceStats(TraceCPU *trace);
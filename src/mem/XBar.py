@@ -82,6 +82,15 @@ class BaseXBar(ClockedObject):
     # Width governing the throughput of the crossbar
     width = Param.Unsigned("Datapath width per port (bytes)")
 
+    # Optionally let a layer forward every packet arriving in the tick
+    # it became busy, rather than retrying all but the first. The layer
+    # is then occupied for the combined time of the batch, and released
+    # by a single event, which keeps the throughput while reducing the
+    # number of events and retries in large systems. Packets in a batch
+    # see the crossbar latency from the start of the batch.
+    batch_layers = Param.Bool(False, "Forward packets arriving at a " \
+                              "layer in the same tick as one batch")
+
     # The default port can be left unconnected, or be used to connect
     # a default response port
     default = RequestPort("Port for connecting an optional default responder")
@@ -140,6 +149,12 @@ class SnoopFilter(SimObject):
     # Sanity check on max capacity to track, adjust if needed.
     max_capacity = Param.MemorySize('8MiB', "Maximum capacity of snoop filter")
 
+    # With a non-zero associativity the snoop filter holds at most
+    # max_capacity worth of lines, in a set-associative table, and
+    # back-invalidates the lines it evicts in the caches above.
+    assoc = Param.Unsigned(0, "Associativity of the snoop filter, " \
+                           "0 to track any number of lines")
+
 # We use a coherent crossbar to connect multiple requestors to the L2
 # caches. Normally this crossbar would be part of the cache itself.
 class L2XBar(CoherentXBar):
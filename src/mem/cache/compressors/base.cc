@@ -107,21 +107,27 @@ Base::setCache(BaseCache *_cache)
 
 std::vector<Base::Chunk>
 Base::toChunks(const uint64_t* data) const
+{
+    std::vector<Chunk> chunks;
+    toChunks(data, chunks);
+    return chunks;
+}
+
+void
+Base::toChunks(const uint64_t* data, std::vector<Chunk>& chunks) const
 {
     // Number of chunks in a 64-bit value
     const unsigned num_chunks_per_64 =
         (sizeof(uint64_t) * CHAR_BIT) / chunkSizeBits;
 
     // Turn a 64-bit array into a chunkSizeBits-array
-    std::vector<Chunk> chunks((blkSize * CHAR_BIT) / chunkSizeBits, 0);
+    chunks.resize((blkSize * CHAR_BIT) / chunkSizeBits);
     for (int i = 0; i < chunks.size(); i++) {
-        const int index_64 = std::floor(i / (double)num_chunks_per_64);
+        const int index_64 = i / num_chunks_per_64;
         const unsigned start = i % num_chunks_per_64;
         chunks[i] = bits(data[index_64],
             (start + 1) * chunkSizeBits - 1, start * chunkSizeBits);
     }
-
-    return chunks;
 }
 
 void
@@ -145,8 +151,9 @@ std::unique_ptr<Base::CompressionData>
 Base::compress(const uint64_t* data, Cycles& comp_lat, Cycles& decomp_lat)
 {
     // Apply compression
+    toChunks(data, chunkBuffer);
     std::unique_ptr<CompressionData> comp_data =
-        compress(toChunks(data), comp_lat, decomp_lat);
+        compress(chunkBuffer, comp_lat, decomp_lat);
 
     // If we are in debug mode apply decompression just after the compression.
     // If the results do not match, we've got an error
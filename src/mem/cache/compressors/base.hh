@@ -150,6 +150,12 @@ class Base : public SimObject
         Stats::Scalar decompressions;
     } stats;
 
+    /**
+     * Scratch buffer holding the chunks of the line being compressed. It
+     * is reused by every compression to avoid allocating it per line.
+     */
+    std::vector<Chunk> chunkBuffer;
+
     /**
      * This function splits the raw data into chunks, so that it can be
      * parsed by the compressor.
@@ -159,6 +165,15 @@ class Base : public SimObject
      */
     std::vector<Chunk> toChunks(const uint64_t* data) const;
 
+    /**
+     * Split the raw data into chunks, filling a caller provided buffer
+     * instead of allocating a new one.
+     *
+     * @param data The raw pointer to the data being compressed.
+     * @param chunks The buffer to fill, which is resized as needed.
+     */
+    void toChunks(const uint64_t* data, std::vector<Chunk>& chunks) const;
+
     /**
      * This function re-joins the chunks to recreate the original data.
      *
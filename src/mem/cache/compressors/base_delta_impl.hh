@@ -36,6 +36,7 @@
 #include "debug/CacheComp.hh"
 #include "mem/cache/compressors/base_delta.hh"
 #include "mem/cache/compressors/dictionary_compressor_impl.hh"
+#include "mem/cache/compressors/pattern_kernels.hh"
 
 namespace Compressor {
 
@@ -65,6 +66,25 @@ BaseDelta<BaseType, DeltaSizeBits>::addToDictionary(DictionaryEntry data)
         DictionaryCompressor<BaseType>::numEntries++] = data;
 }
 
+template <class BaseType, std::size_t DeltaSizeBits>
+std::unique_ptr<typename DictionaryCompressor<BaseType>::Pattern>
+BaseDelta<BaseType, DeltaSizeBits>::findPattern(const DictionaryEntry& bytes)
+{
+    // A value is encoded as a delta from the first base that is close
+    // enough to it, or becomes a new base otherwise
+    const typename std::make_signed<BaseType>::type limit =
+        DeltaSizeBits ? mask(DeltaSizeBits - 1) : 0;
+    const int match_location = Kernel::findDelta<BaseType>(
+        DictionaryCompressor<BaseType>::getDictionaryBytes(),
+        DictionaryCompressor<BaseType>::numEntries,
+        DictionaryCompressor<BaseType>::fromDictionaryEntry(bytes), limit);
+
+    return getPattern(bytes, (match_location < 0) ?
+        DictionaryCompressor<BaseType>::toDictionaryEntry(0) :
+        DictionaryCompressor<BaseType>::dictionary[match_location],
+        match_location);
+}
+
 template <class BaseType, std::size_t DeltaSizeBits>
 std::unique_ptr<Base::CompressionData>
 BaseDelta<BaseType, DeltaSizeBits>::compress(
@@ -36,6 +36,13 @@
 
 namespace Compressor {
 
+FreeListPool BaseDictionaryCompressor::objectPool(
+    "dictionary_compressor_objects", 64);
+
+// Enough for the patterns of a 128 byte line of 16 bit values
+FreeListPool BaseDictionaryCompressor::entriesPool(
+    "dictionary_compressor_entries", 64 * sizeof(void *));
+
 BaseDictionaryCompressor::BaseDictionaryCompressor(const Params &p)
   : Base(p), dictionarySize(p.dictionary_size),
     numEntries(0), dictionaryStats(stats, *this)
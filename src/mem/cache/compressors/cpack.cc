@@ -33,6 +33,7 @@
 #include "mem/cache/compressors/cpack.hh"
 
 #include "mem/cache/compressors/dictionary_compressor_impl.hh"
+#include "mem/cache/compressors/pattern_kernels.hh"
 #include "params/CPack.hh"
 
 namespace Compressor {
@@ -49,4 +50,35 @@ CPack::addToDictionary(DictionaryEntry data)
     dictionary[numEntries++] = data;
 }
 
+std::unique_ptr<DictionaryCompressor<uint32_t>::Pattern>
+CPack::findPattern(const DictionaryEntry& bytes)
+{
+    // Go through the patterns in the order of the factory, i.e., from the
+    // smallest to the largest, so that the first match is the best one.
+    // The dictionary based ones search for the earliest matching entry
+    const DictionaryEntry zero = toDictionaryEntry(0);
+    if (PatternZZZZ::isPattern(bytes, zero, -1)) {
+        return getPattern(bytes, zero, -1);
+    }
+
+    const uint32_t value = fromDictionaryEntry(bytes);
+    int match_location = Kernel::findMasked<uint32_t>(getDictionaryBytes(),
+        numEntries, value, 0xFFFFFFFF);
+    if (match_location < 0) {
+        if (PatternZZZX::isPattern(bytes, zero, -1)) {
+            return getPattern(bytes, zero, -1);
+        }
+        match_location = Kernel::findMasked<uint32_t>(getDictionaryBytes(),
+            numEntries, value, 0xFFFFFF00);
+    }
+    if (match_location < 0) {
+        match_location = Kernel::findMasked<uint32_t>(getDictionaryBytes(),
+            numEntries, value, 0xFFFF0000);
+    }
+
+    return getPattern(bytes,
+        (match_location < 0) ? zero : dictionary[match_location],
+        match_location);
+}
+
 } // namespace Compressor
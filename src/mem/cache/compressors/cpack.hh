@@ -96,6 +96,9 @@ class CPack : public DictionaryCompressor<uint32_t>
         return PatternFactory::getPattern(bytes, dict_bytes, match_location);
     }
 
+    std::unique_ptr<Pattern> findPattern(
+        const DictionaryEntry& bytes) override;
+
     void addToDictionary(DictionaryEntry data) override;
 
   public:
@@ -52,6 +52,7 @@
 #include <vector>
 
 #include "base/bitfield.hh"
+#include "base/free_list_pool.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/compressors/base.hh"
@@ -101,6 +102,16 @@ class BaseDictionaryCompressor : public Base
     typedef BaseDictionaryCompressorParams Params;
     BaseDictionaryCompressor(const Params &p);
     ~BaseDictionaryCompressor() = default;
+
+    /**
+     * A pattern is created for every value compressed, and a compression
+     * data for every line, so their memory is recycled through a pool
+     * rather than going to the heap every time.
+     */
+    static FreeListPool objectPool;
+
+    /** Pool for the pattern lists of the compression data. */
+    static FreeListPool entriesPool;
 };
 
 /**
@@ -198,6 +209,32 @@ class DictionaryCompressor : public BaseDictionaryCompressor
     getPattern(const DictionaryEntry& bytes, const DictionaryEntry& dict_bytes,
         const int match_location) const = 0;
 
+    /**
+     * Find the smallest pattern that matches the value, trying every
+     * dictionary entry in order. Ties are resolved in favor of not using
+     * the dictionary, and then of the earliest entry.
+     *
+     * Every candidate pattern is instantiated, so compressors that know
+     * which entry their patterns can match should override this with a
+     * direct search of the dictionary (@sa Kernel).
+     *
+     * @param bytes The value to be compressed.
+     * @return The best pattern.
+     */
+    virtual std::unique_ptr<Pattern> findPattern(const DictionaryEntry& bytes);
+
+    /**
+     * Get the dictionary as an array of consecutive entries, in the layout
+     * expected by the pattern matching kernels.
+     */
+    const uint8_t*
+    getDictionaryBytes() const
+    {
+        static_assert(sizeof(DictionaryEntry) == sizeof(T),
+            "Dictionary entries must be packed");
+        return reinterpret_cast<const uint8_t*>(dictionary.data());
+    }
+
     /**
      * Compress data.
      *
@@ -321,6 +358,18 @@ class DictionaryCompressor<T>::Pattern
     /** Default destructor. */
     virtual ~Pattern() = default;
 
+    static void *
+    operator new(size_t size)
+    {
+        return BaseDictionaryCompressor::objectPool.allocate(size);
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        BaseDictionaryCompressor::objectPool.release(p, size);
+    }
+
     /**
      * Get enum number associated to this pattern.
      *
@@ -388,12 +437,26 @@ template <class T>
 class DictionaryCompressor<T>::CompData : public CompressionData
 {
   public:
+    typedef PoolAllocator<std::unique_ptr<Pattern>> EntryAllocator;
+
     /** The patterns matched in the original line. */
-    std::vector<std::unique_ptr<Pattern>> entries;
+    std::vector<std::unique_ptr<Pattern>, EntryAllocator> entries;
 
     CompData();
     ~CompData() = default;
 
+    static void *
+    operator new(size_t size)
+    {
+        return BaseDictionaryCompressor::objectPool.allocate(size);
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        BaseDictionaryCompressor::objectPool.release(p, size);
+    }
+
     /**
      * Add a pattern entry to the list of patterns.
      *
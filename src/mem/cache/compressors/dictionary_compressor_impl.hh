@@ -44,7 +44,8 @@ namespace Compressor {
 
 template <class T>
 DictionaryCompressor<T>::CompData::CompData()
-    : CompressionData()
+    : CompressionData(),
+      entries(EntryAllocator(BaseDictionaryCompressor::entriesPool))
 {
 }
 
@@ -72,11 +73,13 @@ template <class T>
 void
 DictionaryCompressor<T>::resetDictionary()
 {
+    // Set all entries as 0. Entries are only ever added at the end of
+    // the valid ones, so the others are still clear
+    std::fill(dictionary.begin(), dictionary.begin() + numEntries,
+        toDictionaryEntry(0));
+
     // Reset number of valid entries
     numEntries = 0;
-
-    // Set all entries as 0
-    std::fill(dictionary.begin(), dictionary.end(), toDictionaryEntry(0));
 }
 
 template <typename T>
@@ -88,11 +91,8 @@ DictionaryCompressor<T>::instantiateDictionaryCompData() const
 
 template <typename T>
 std::unique_ptr<typename DictionaryCompressor<T>::Pattern>
-DictionaryCompressor<T>::compressValue(const T data)
+DictionaryCompressor<T>::findPattern(const DictionaryEntry& bytes)
 {
-    // Split data in bytes
-    const DictionaryEntry bytes = toDictionaryEntry(data);
-
     // Start as a no-match pattern. A negative match location is used so that
     // patterns that depend on the dictionary entry don't match
     std::unique_ptr<Pattern> pattern =
@@ -110,6 +110,18 @@ DictionaryCompressor<T>::compressValue(const T data)
         }
     }
 
+    return pattern;
+}
+
+template <typename T>
+std::unique_ptr<typename DictionaryCompressor<T>::Pattern>
+DictionaryCompressor<T>::compressValue(const T data)
+{
+    // Split data in bytes
+    const DictionaryEntry bytes = toDictionaryEntry(data);
+
+    std::unique_ptr<Pattern> pattern = findPattern(bytes);
+
     // Update stats
     dictionaryStats.patterns[pattern->getPatternNumber()]++;
 
@@ -133,6 +145,7 @@ DictionaryCompressor<T>::compress(const std::vector<Chunk>& chunks)
 
     // Compress every value sequentially
     CompData* const comp_data_ptr = static_cast<CompData*>(comp_data.get());
+    comp_data_ptr->entries.reserve(chunks.size());
     for (const auto& value : chunks) {
         std::unique_ptr<Pattern> pattern = compressValue(value);
         DPRINTF(CacheComp, "Compressed %016x to %s\n", value,
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * Vectorized kernels shared by the dictionary based compressors. They
+ * search a dictionary for the first entry a value can be matched
+ * against, which is the bulk of the work of compressing a line.
+ */
+
+#ifndef __MEM_CACHE_COMPRESSORS_PATTERN_KERNELS_HH__
+#define __MEM_CACHE_COMPRESSORS_PATTERN_KERNELS_HH__
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "base/bitfield.hh"
+
+namespace Compressor {
+
+/**
+ * The dictionaries hold their entries as consecutive arrays of bytes,
+ * least significant byte first (@sa DictionaryCompressor::DictionaryEntry).
+ * The kernels work on that layout directly, so that the dictionaries need
+ * not keep a second copy of their values. Each kernel has a scalar
+ * version, which is used for the entries that do not fill a whole vector
+ * and on hosts without a vectorized version.
+ */
+namespace Kernel {
+
+/** Get an entry of a dictionary as a value. */
+template <class T>
+inline T
+loadEntry(const uint8_t *entries, std::size_t index)
+{
+    const uint8_t *entry = entries + index * sizeof(T);
+    T value = 0;
+    for (int i = sizeof(T) - 1; i >= 0; i--) {
+        value <<= 8;
+        value |= entry[i];
+    }
+    return value;
+}
+
+/**
+ * Find the first entry whose masked bits equal the masked value, starting
+ * at a given entry.
+ *
+ * @param entries The dictionary entries.
+ * @param num_entries Number of valid entries.
+ * @param value The value to match.
+ * @param mask The bits that must match.
+ * @param first The first entry to consider.
+ * @return The index of the entry, or -1 if no entry matches.
+ */
+template <class T>
+inline int
+findMaskedScalar(const uint8_t *entries, std::size_t num_entries, T value,
+                 T mask, std::size_t first = 0)
+{
+    for (std::size_t i = first; i < num_entries; i++) {
+        if (((loadEntry<T>(entries, i) ^ value) & mask) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Find the first entry such that the value is within the given signed
+ * distance of it, i.e., the value can be encoded as a delta from that
+ * entry. The difference wraps around at the size of the type.
+ *
+ * @param entries The dictionary entries (the bases).
+ * @param num_entries Number of valid entries.
+ * @param value The value to encode.
+ * @param limit The largest magnitude of a delta.
+ * @param first The first entry to consider.
+ * @return The index of the entry, or -1 if no entry is close enough.
+ */
+template <class T>
+inline int
+findDeltaScalar(const uint8_t *entries, std::size_t num_entries, T value,
+                typename std::make_signed<T>::type limit,
+                std::size_t first = 0)
+{
+    using SignedT = typename std::make_signed<T>::type;
+    for (std::size_t i = first; i < num_entries; i++) {
+        const SignedT delta = value - loadEntry<T>(entries, i);
+        if ((delta >= -limit) && (delta <= limit)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#if defined(__SSE2__)
+/**
+ * The lane operations of a 128-bit vector holding values of a given size.
+ * Only the sizes with a signed comparison in the available instruction
+ * set can be used to search for deltas.
+ */
+template <std::size_t Size>
+struct Lanes;
+
+template <>
+struct Lanes<2>
+{
+    static constexpr bool hasCompare = true;
+    static __m128i set1(uint64_t v) { return _mm_set1_epi16(int16_t(v)); }
+    static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi16(a, b); }
+    static __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi16(a, b); }
+};
+
+template <>
+struct Lanes<4>
+{
+    static constexpr bool hasCompare = true;
+    static __m128i set1(uint64_t v) { return _mm_set1_epi32(int32_t(v)); }
+    static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+    static __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi32(a, b); }
+};
+
+template <>
+struct Lanes<8>
+{
+    static __m128i set1(uint64_t v) { return _mm_set1_epi64x(int64_t(v)); }
+    static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi64(a, b); }
+#if defined(__SSE4_2__)
+    static constexpr bool hasCompare = true;
+    static __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi64(a, b); }
+#else
+    static constexpr bool hasCompare = false;
+    static __m128i gt(__m128i a, __m128i b) { return _mm_setzero_si128(); }
+#endif
+};
+
+/**
+ * Turn a byte mask, as produced by _mm_movemask_epi8, into a mask with
+ * the lowest bit of each lane set if all the bytes of the lane are set.
+ */
+template <std::size_t Size>
+inline unsigned
+laneMask(unsigned byte_mask)
+{
+    unsigned lane_starts = 0;
+    for (unsigned i = 0; i < 16; i += Size) {
+        lane_starts |= 1 << i;
+    }
+    for (unsigned shift = 1; shift < Size; shift <<= 1) {
+        byte_mask &= byte_mask >> shift;
+    }
+    return byte_mask & lane_starts;
+}
+#endif
+
+/** @copydoc findMaskedScalar */
+template <class T>
+inline int
+findMasked(const uint8_t *entries, std::size_t num_entries, T value, T mask)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // The entries are stored least significant byte first, which matches
+    // the lanes of a little endian vector load
+    constexpr std::size_t per_vector = 16 / sizeof(T);
+    const __m128i needle = Lanes<sizeof(T)>::set1(value);
+    const __m128i lane_mask = Lanes<sizeof(T)>::set1(mask);
+    for (; i + per_vector <= num_entries; i += per_vector) {
+        const __m128i diff = _mm_and_si128(lane_mask, _mm_xor_si128(needle,
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                entries + i * sizeof(T)))));
+        const unsigned hits = laneMask<sizeof(T)>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(diff, _mm_setzero_si128())));
+        if (hits) {
+            return i + findLsbSet(hits) / sizeof(T);
+        }
+    }
+#endif
+    return findMaskedScalar<T>(entries, num_entries, value, mask, i);
+}
+
+/** @copydoc findDeltaScalar */
+template <class T>
+inline int
+findDelta(const uint8_t *entries, std::size_t num_entries, T value,
+          typename std::make_signed<T>::type limit)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    using L = Lanes<sizeof(T)>;
+    if (L::hasCompare) {
+        constexpr std::size_t per_vector = 16 / sizeof(T);
+        const __m128i needle = L::set1(value);
+        const __m128i upper = L::set1(limit);
+        const __m128i lower = L::set1(-limit);
+        for (; i + per_vector <= num_entries; i += per_vector) {
+            const __m128i delta = L::sub(needle,
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                    entries + i * sizeof(T))));
+            const __m128i out_of_range = _mm_or_si128(L::gt(delta, upper),
+                L::gt(lower, delta));
+            const unsigned hits = laneMask<sizeof(T)>(
+                ~_mm_movemask_epi8(out_of_range) & 0xFFFF);
+            if (hits) {
+                return i + findLsbSet(hits) / sizeof(T);
+            }
+        }
+    }
+#endif
+    return findDeltaScalar<T>(entries, num_entries, value, limit, i);
+}
+
+} // namespace Kernel
+} // namespace Compressor
+
+#endif //__MEM_CACHE_COMPRESSORS_PATTERN_KERNELS_HH__
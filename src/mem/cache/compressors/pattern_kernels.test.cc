@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "mem/cache/compressors/pattern_kernels.hh"
+
+using namespace Compressor;
+
+namespace
+{
+
+/** A dictionary stored in the same layout as the compressors use. */
+template <class T>
+struct Dictionary
+{
+    std::vector<uint8_t> bytes;
+
+    void
+    add(T value)
+    {
+        for (std::size_t i = 0; i < sizeof(T); i++) {
+            bytes.push_back(value & 0xFF);
+            value >>= 8;
+        }
+    }
+
+    std::size_t size() const { return bytes.size() / sizeof(T); }
+};
+
+template <class T>
+class PatternKernelsTest : public testing::Test
+{
+  protected:
+    std::mt19937_64 rng;
+
+    /**
+     * Generate values that are close to each other, so that masked and
+     * delta matches happen often.
+     */
+    T
+    randomValue()
+    {
+        const T base = rng() & 0x3;
+        const T noise = rng() >> (rng() % (8 * sizeof(T)));
+        return (base << (8 * sizeof(T) - 2)) + noise;
+    }
+};
+
+using EntryTypes = testing::Types<uint16_t, uint32_t, uint64_t>;
+TYPED_TEST_SUITE(PatternKernelsTest, EntryTypes);
+
+} // anonymous namespace
+
+TYPED_TEST(PatternKernelsTest, LoadEntry)
+{
+    Dictionary<TypeParam> dict;
+    dict.add(0);
+    dict.add(TypeParam(0x0102030405060708));
+    EXPECT_EQ(TypeParam(0),
+              Kernel::loadEntry<TypeParam>(dict.bytes.data(), 0));
+    EXPECT_EQ(TypeParam(0x0102030405060708),
+              Kernel::loadEntry<TypeParam>(dict.bytes.data(), 1));
+}
+
+TYPED_TEST(PatternKernelsTest, EmptyDictionary)
+{
+    const uint8_t *none = nullptr;
+    EXPECT_EQ(-1, Kernel::findMasked<TypeParam>(none, 0, 0, ~TypeParam(0)));
+    EXPECT_EQ(-1, Kernel::findDelta<TypeParam>(none, 0, 0, 1));
+}
+
+/** The first of several matching entries is found, in every position. */
+TYPED_TEST(PatternKernelsTest, FirstMatch)
+{
+    for (std::size_t pos = 0; pos < 64; pos++) {
+        Dictionary<TypeParam> dict;
+        for (std::size_t i = 0; i < 64; i++) {
+            dict.add(i < pos ? TypeParam(0x5000 + i) : TypeParam(0x1234));
+        }
+        EXPECT_EQ(int(pos), Kernel::findMasked<TypeParam>(dict.bytes.data(),
+            dict.size(), 0x1234, ~TypeParam(0)));
+        EXPECT_EQ(int(pos), Kernel::findDelta<TypeParam>(dict.bytes.data(),
+            dict.size(), 0x1235, 1));
+        EXPECT_EQ(-1, Kernel::findDelta<TypeParam>(dict.bytes.data(),
+            pos, 0x1234, 0));
+    }
+}
+
+/** Only the masked bits take part in a match. */
+TYPED_TEST(PatternKernelsTest, Masked)
+{
+    const TypeParam mask = ~TypeParam(0xFF);
+    Dictionary<TypeParam> dict;
+    for (int i = 0; i < 16; i++) {
+        dict.add(TypeParam(0x100 * (i + 1) + 0x12));
+    }
+    EXPECT_EQ(4, Kernel::findMasked<TypeParam>(dict.bytes.data(),
+        dict.size(), 0x5FF, mask));
+    EXPECT_EQ(-1, Kernel::findMasked<TypeParam>(dict.bytes.data(),
+        dict.size(), 0x5FF, ~TypeParam(0)));
+}
+
+/** The delta limits are inclusive, and the difference wraps around. */
+TYPED_TEST(PatternKernelsTest, DeltaLimits)
+{
+    using SignedT = typename std::make_signed<TypeParam>::type;
+    const SignedT limit = 127;
+    Dictionary<TypeParam> dict;
+    for (int i = 0; i < 16; i++) {
+        dict.add(TypeParam(-1000 * (i + 1)));
+    }
+    const TypeParam base = TypeParam(-3000);
+    const uint8_t *entries = dict.bytes.data();
+    EXPECT_EQ(2, Kernel::findDelta<TypeParam>(entries, dict.size(),
+        base + limit, limit));
+    EXPECT_EQ(2, Kernel::findDelta<TypeParam>(entries, dict.size(),
+        base - limit, limit));
+    EXPECT_EQ(-1, Kernel::findDelta<TypeParam>(entries, dict.size(),
+        base + limit + 1, limit));
+    EXPECT_EQ(-1, Kernel::findDelta<TypeParam>(entries, dict.size(),
+        base - limit - 1, limit));
+    EXPECT_EQ(-1, Kernel::findDelta<TypeParam>(entries, dict.size(),
+        TypeParam(base + std::numeric_limits<SignedT>::max()), limit));
+}
+
+/** The vectorized kernels agree with the scalar ones. */
+TYPED_TEST(PatternKernelsTest, MatchesScalar)
+{
+    using SignedT = typename std::make_signed<TypeParam>::type;
+    const TypeParam masks[] = {TypeParam(~0ULL), TypeParam(~0xFFULL),
+        TypeParam(~0xFF00ULL), TypeParam(1ULL << (8 * sizeof(TypeParam) - 1))};
+    const SignedT limits[] = {0, 7, 127, 32767};
+
+    for (int iter = 0; iter < 2000; iter++) {
+        Dictionary<TypeParam> dict;
+        const std::size_t num_entries = this->rng() % 65;
+        for (std::size_t i = 0; i < num_entries; i++) {
+            dict.add(this->randomValue());
+        }
+        const uint8_t *entries = dict.bytes.data();
+        const TypeParam value = this->randomValue();
+
+        for (const TypeParam mask : masks) {
+            EXPECT_EQ(Kernel::findMaskedScalar<TypeParam>(entries,
+                num_entries, value, mask),
+                Kernel::findMasked<TypeParam>(entries, num_entries, value,
+                    mask));
+        }
+        for (const SignedT limit : limits) {
+            EXPECT_EQ(Kernel::findDeltaScalar<TypeParam>(entries,
+                num_entries, value, limit),
+                Kernel::findDelta<TypeParam>(entries, num_entries, value,
+                    limit));
+        }
+    }
+}
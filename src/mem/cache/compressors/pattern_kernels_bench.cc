@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * Measures the throughput of the dictionary searches of the compressors,
+ * using the vectorized kernels and their scalar counterparts. The lines
+ * are a mix of the data typically seen by a cache: zeros, small
+ * integers, pointers, repeated values and random data.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "mem/cache/compressors/pattern_kernels.hh"
+
+using namespace Compressor;
+
+namespace
+{
+
+const std::size_t blkSize = 64;
+const std::size_t numLines = 4096;
+const unsigned numRounds = 50;
+
+std::vector<uint64_t>
+generateLines()
+{
+    std::mt19937_64 rng(0);
+    std::vector<uint64_t> lines(numLines * blkSize / sizeof(uint64_t));
+    for (std::size_t line = 0; line < numLines; line++) {
+        uint64_t *words = &lines[line * blkSize / sizeof(uint64_t)];
+        const uint64_t base = rng();
+        for (std::size_t i = 0; i < blkSize / sizeof(uint64_t); i++) {
+            switch (line % 5) {
+              case 0: words[i] = 0; break;
+              case 1: words[i] = rng() % 1000; break;
+              case 2: words[i] = 0x7fff00000000 + (base & 0xffff) + i * 8;
+                break;
+              case 3: words[i] = base; break;
+              default: words[i] = rng(); break;
+            }
+        }
+    }
+    return lines;
+}
+
+/** Get the i-th value of type T of a line. */
+template <class T>
+T
+getValue(const uint64_t *line, std::size_t i)
+{
+    const std::size_t per_64 = sizeof(uint64_t) / sizeof(T);
+    return line[i / per_64] >> (8 * sizeof(T) * (i % per_64));
+}
+
+/** Append a value to a dictionary, least significant byte first. */
+template <class T>
+void
+addEntry(uint8_t *entries, std::size_t &num_entries, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        entries[num_entries * sizeof(T) + i] = value >> (8 * i);
+    }
+    num_entries++;
+}
+
+/**
+ * Search the bases of a base-delta compressor, which start with an
+ * implicit zero base. Every value that fits no base becomes a new one.
+ */
+template <class T, unsigned DeltaSizeBits, bool Vector>
+std::size_t
+baseDelta(const uint64_t *line)
+{
+    const typename std::make_signed<T>::type limit =
+        mask(DeltaSizeBits - 1);
+    uint8_t entries[blkSize + sizeof(T)];
+    std::size_t num_entries = 0;
+    addEntry<T>(entries, num_entries, 0);
+    for (std::size_t i = 0; i < blkSize / sizeof(T); i++) {
+        const T value = getValue<T>(line, i);
+        const int match = Vector ?
+            Kernel::findDelta<T>(entries, num_entries, value, limit) :
+            Kernel::findDeltaScalar<T>(entries, num_entries, value, limit);
+        if (match < 0) {
+            addEntry<T>(entries, num_entries, value);
+        }
+    }
+    return num_entries;
+}
+
+/**
+ * Search the dictionary of C-Pack, from the full match to the two byte
+ * match. Every value but the (partially) zero ones is added to it.
+ */
+template <bool Vector>
+std::size_t
+cpack(const uint64_t *line)
+{
+    const uint32_t masks[] = {0xFFFFFFFF, 0xFFFFFF00, 0xFFFF0000};
+    uint8_t entries[blkSize];
+    std::size_t num_entries = 0;
+    std::size_t matches = 0;
+    for (std::size_t i = 0; i < blkSize / sizeof(uint32_t); i++) {
+        const uint32_t value = getValue<uint32_t>(line, i);
+        if ((value & 0xFFFFFF00) == 0) {
+            continue;
+        }
+        for (const uint32_t mask : masks) {
+            const int match = Vector ?
+                Kernel::findMasked<uint32_t>(entries, num_entries, value,
+                    mask) :
+                Kernel::findMaskedScalar<uint32_t>(entries, num_entries,
+                    value, mask);
+            if (match >= 0) {
+                matches++;
+                break;
+            }
+        }
+        addEntry<uint32_t>(entries, num_entries, value);
+    }
+    return matches;
+}
+
+/** Run a search over all lines, and report the lines per second. */
+void
+run(const char *name, const std::vector<uint64_t> &lines,
+    std::size_t (*scalar)(const uint64_t *),
+    std::size_t (*vector)(const uint64_t *))
+{
+    double lines_per_sec[2];
+    std::size_t checksum[2] = {0, 0};
+    for (int v = 0; v < 2; v++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < numRounds; round++) {
+            for (std::size_t i = 0; i < lines.size();
+                 i += blkSize / sizeof(uint64_t)) {
+                checksum[v] += (v ? vector : scalar)(&lines[i]);
+            }
+        }
+        const std::chrono::duration<double> secs =
+            std::chrono::steady_clock::now() - start;
+        lines_per_sec[v] = numLines * numRounds / secs.count();
+    }
+
+    std::printf("%-16s scalar %8.3f Mlines/s  vector %8.3f Mlines/s  "
+                "speedup %5.2fx%s\n", name, lines_per_sec[0] / 1e6,
+                lines_per_sec[1] / 1e6, lines_per_sec[1] / lines_per_sec[0],
+                (checksum[0] == checksum[1]) ? "" : "  MISMATCH");
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    const std::vector<uint64_t> lines = generateLines();
+
+    run("Base64Delta8", lines, baseDelta<uint64_t, 8, false>,
+        baseDelta<uint64_t, 8, true>);
+    run("Base64Delta16", lines, baseDelta<uint64_t, 16, false>,
+        baseDelta<uint64_t, 16, true>);
+    run("Base64Delta32", lines, baseDelta<uint64_t, 32, false>,
+        baseDelta<uint64_t, 32, true>);
+    run("Base32Delta8", lines, baseDelta<uint32_t, 8, false>,
+        baseDelta<uint32_t, 8, true>);
+    run("Base32Delta16", lines, baseDelta<uint32_t, 16, false>,
+        baseDelta<uint32_t, 16, true>);
+    run("Base16Delta8", lines, baseDelta<uint16_t, 8, false>,
+        baseDelta<uint16_t, 8, true>);
+    run("CPack", lines, cpack<false>, cpack<true>);
+
+    return 0;
+}
@@ -52,6 +52,14 @@ Zero::addToDictionary(DictionaryEntry data)
     dictionary[numEntries++] = data;
 }
 
+std::unique_ptr<DictionaryCompressor<uint64_t>::Pattern>
+Zero::findPattern(const DictionaryEntry& bytes)
+{
+    // None of the patterns use the dictionary, which only keeps track of
+    // the non-zero values, so there are no entries to search
+    return getPattern(bytes, toDictionaryEntry(0), -1);
+}
+
 std::unique_ptr<Base::CompressionData>
 Zero::compress(const std::vector<Chunk>& chunks, Cycles& comp_lat,
     Cycles& decomp_lat)
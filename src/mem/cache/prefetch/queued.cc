@@ -55,8 +55,8 @@ Queued::DeferredPacket::createPkt(Addr paddr, unsigned blk_size,
                                             bool tag_prefetch,
                                             Tick t) {
     /* Create a prefetch memory request */
-    RequestPtr req = std::make_shared<Request>(paddr, blk_size,
-                                                0, requestor_id);
+    RequestPtr req = Request::create(paddr, blk_size,
+                                      0, requestor_id);
 
     if (pfInfo.isSecure()) {
         req->setFlags(Request::SECURE);
@@ -92,8 +92,167 @@ Queued::DeferredPacket::finish(const Fault &fault,
     owner->translationComplete(this, failed);
 }
 
+Queued::DeferredQueue::DeferredQueue(unsigned _capacity)
+    : capacity(_capacity), seqs(_capacity), ring(_capacity), head(0),
+      count(0), nextSeq(0)
+{
+    fatal_if(capacity == 0, "The prefetch queues need at least one entry");
+    // Slots are constructed on demand, but must never be reallocated
+    slots.reserve(capacity);
+    freeSlots.reserve(capacity);
+    addrMap.reserve(capacity);
+}
+
+bool
+Queued::DeferredQueue::before(unsigned a, unsigned b) const
+{
+    if (slots[a].priority != slots[b].priority) {
+        return slots[a].priority > slots[b].priority;
+    }
+    return seqs[a] < seqs[b];
+}
+
+template <typename Pred>
+size_t
+Queued::DeferredQueue::partition(Pred pred) const
+{
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (pred(at(mid))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+unsigned
+Queued::DeferredQueue::link(unsigned slot)
+{
+    assert(count < capacity);
+    seqs[slot] = nextSeq++;
+    // The slot has the newest sequence number, so it goes right after
+    // the last packet with the same or a higher priority
+    const int32_t priority = slots[slot].priority;
+    const size_t pos = partition([this, priority](unsigned s)
+        { return slots[s].priority >= priority; });
+
+    // Make room by shifting the closest end of the ring
+    unsigned shifted;
+    if (pos < count - pos) {
+        head = (head + capacity - 1) % capacity;
+        for (size_t i = 0; i < pos; i++) {
+            at(i) = at(i + 1);
+        }
+        shifted = pos;
+    } else {
+        for (size_t i = count; i > pos; i--) {
+            at(i) = at(i - 1);
+        }
+        shifted = count - pos;
+    }
+    at(pos) = slot;
+    count++;
+    return shifted;
+}
+
+unsigned
+Queued::DeferredQueue::unlink(size_t pos)
+{
+    assert(pos < count);
+    unsigned shifted;
+    if (pos < count - pos - 1) {
+        for (size_t i = pos; i > 0; i--) {
+            at(i) = at(i - 1);
+        }
+        head = (head + 1) % capacity;
+        shifted = pos;
+    } else {
+        for (size_t i = pos + 1; i < count; i++) {
+            at(i - 1) = at(i);
+        }
+        shifted = count - pos - 1;
+    }
+    count--;
+    return shifted;
+}
+
+size_t
+Queued::DeferredQueue::position(const DeferredPacket &dp) const
+{
+    const unsigned slot = &dp - slots.data();
+    assert(slot < slots.size());
+    const size_t pos = partition([this, slot](unsigned s)
+        { return before(s, slot); });
+    assert(pos < count && at(pos) == slot);
+    return pos;
+}
+
+size_t
+Queued::DeferredQueue::victim() const
+{
+    assert(count > 0);
+    const int32_t lowest = slots[at(count - 1)].priority;
+    return partition([this, lowest](unsigned s)
+        { return slots[s].priority > lowest; });
+}
+
+Queued::DeferredPacket *
+Queued::DeferredQueue::find(Addr addr, bool is_secure)
+{
+    auto it = addrMap.find(addrKey(addr, is_secure));
+    return it == addrMap.end() ? nullptr : &slots[it->second];
+}
+
+unsigned
+Queued::DeferredQueue::push(const DeferredPacket &dp)
+{
+    assert(!full());
+    unsigned slot;
+    if (freeSlots.empty()) {
+        slot = slots.size();
+        slots.push_back(dp);
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        slots[slot] = dp;
+    }
+    addrMap.emplace(addrKey(dp.pfInfo.getAddr(), dp.pfInfo.isSecure()),
+                    slot);
+    return link(slot);
+}
+
+unsigned
+Queued::DeferredQueue::erase(size_t pos)
+{
+    const unsigned slot = at(pos);
+    const PrefetchInfo &pfi = slots[slot].pfInfo;
+    auto range = addrMap.equal_range(addrKey(pfi.getAddr(), pfi.isSecure()));
+    for (auto it = range.first; it != range.second; it++) {
+        if (it->second == slot) {
+            addrMap.erase(it);
+            break;
+        }
+    }
+    freeSlots.push_back(slot);
+    return unlink(pos);
+}
+
+unsigned
+Queued::DeferredQueue::setPriority(size_t pos, int32_t priority)
+{
+    const unsigned slot = at(pos);
+    unsigned shifted = unlink(pos);
+    slots[slot].priority = priority;
+    return shifted + link(slot);
+}
+
 Queued::Queued(const QueuedPrefetcherParams &p)
-    : Base(p), queueSize(p.queue_size),
+    : Base(p), pfq(p.queue_size), pfqMissingTranslation(p.queue_size),
+      queueSize(p.queue_size),
       missingTranslationQueueSize(
         p.max_prefetch_requests_with_pending_translation),
       latency(p.latency), queueSquash(p.queue_squash),
@@ -106,8 +265,8 @@ Queued::Queued(const QueuedPrefetcherParams &p)
 Queued::~Queued()
 {
     // Delete the queued prefetch packets
-    for (DeferredPacket &p : pfq) {
-        delete p.pkt;
+    for (size_t pos = 0; pos < pfq.size(); pos++) {
+        delete pfq[pos].pkt;
     }
 }
 
@@ -149,15 +308,10 @@ Queued::notify(const PacketPtr &pkt, const PrefetchInfo &pfi)
 
     // Squash queued prefetches if demand miss to same line
     if (queueSquash) {
-        auto itr = pfq.begin();
-        while (itr != pfq.end()) {
-            if (itr->pfInfo.getAddr() == blk_addr &&
-                itr->pfInfo.isSecure() == is_secure) {
-                delete itr->pkt;
-                itr = pfq.erase(itr);
-            } else {
-                ++itr;
-            }
+        statsQueued.queueLookups++;
+        while (DeferredPacket *dp = pfq.find(blk_addr, is_secure)) {
+            delete dp->pkt;
+            removeFromQueue(pfq, pfq.position(*dp));
         }
     }
 
@@ -214,7 +368,7 @@ Queued::getPacket()
     }
 
     PacketPtr pkt = pfq.front().pkt;
-    pfq.pop_front();
+    removeFromQueue(pfq, 0);
 
     prefetchStats.pfIssued++;
     issuedPrefetches += 1;
@@ -235,103 +389,100 @@ Queued::QueuedStats::QueuedStats(Stats::Group *parent)
     ADD_STAT(pfRemovedFull, UNIT_COUNT,
              "number of prefetches dropped due to prefetch queue size"),
     ADD_STAT(pfSpanPage, UNIT_COUNT,
-             "number of prefetches that crossed the page")
+             "number of prefetches that crossed the page"),
+    ADD_STAT(queueLookups, UNIT_COUNT,
+             "number of address lookups in the prefetch queues"),
+    ADD_STAT(queueUpdates, UNIT_COUNT,
+             "number of insertions and removals in the prefetch queues"),
+    ADD_STAT(queueShifts, UNIT_COUNT,
+             "number of entries shifted to keep the prefetch queues "
+             "in priority order"),
+    ADD_STAT(avgQueueShifts, UNIT_RATE(Stats::Units::Count,
+                                      Stats::Units::Count),
+             "average number of entries shifted per queue update",
+             queueShifts / queueUpdates)
 {
+    avgQueueShifts.precision(2);
 }
 
 
 void
 Queued::processMissingTranslations(unsigned max)
 {
-    unsigned count = 0;
-    iterator it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end() && count < max) {
-        DeferredPacket &dp = *it;
-        // Increase the iterator first because dp.startTranslation can end up
-        // calling finishTranslation, which will erase "it"
-        it++;
-        dp.startTranslation(tlb);
-        count += 1;
+    // Gather the packets first, as dp.startTranslation can end up calling
+    // translationComplete, which removes the packet from the queue and
+    // shifts the position of the others
+    std::vector<DeferredPacket *> pending;
+    for (size_t pos = 0; pos < pfqMissingTranslation.size() &&
+            pending.size() < max; pos++) {
+        pending.push_back(&pfqMissingTranslation[pos]);
+    }
+    for (DeferredPacket *dp : pending) {
+        dp->startTranslation(tlb);
     }
 }
 
 void
 Queued::translationComplete(DeferredPacket *dp, bool failed)
 {
-    auto it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end()) {
-        if (&(*it) == dp) {
-            break;
-        }
-        it++;
-    }
-    assert(it != pfqMissingTranslation.end());
     if (!failed) {
         DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
                 "paddr %#x \n", tlb->name(),
-                it->translationRequest->getVaddr(),
-                it->translationRequest->getPaddr());
-        Addr target_paddr = it->translationRequest->getPaddr();
+                dp->translationRequest->getVaddr(),
+                dp->translationRequest->getPaddr());
+        Addr target_paddr = dp->translationRequest->getPaddr();
         // check if this prefetch is already redundant
-        if (cacheSnoop && (inCache(target_paddr, it->pfInfo.isSecure()) ||
-                    inMissQueue(target_paddr, it->pfInfo.isSecure()))) {
+        if (cacheSnoop && (inCache(target_paddr, dp->pfInfo.isSecure()) ||
+                    inMissQueue(target_paddr, dp->pfInfo.isSecure()))) {
             statsQueued.pfInCache++;
             DPRINTF(HWPrefetch, "Dropping redundant in "
                     "cache/MSHR prefetch addr:%#x\n", target_paddr);
         } else {
             Tick pf_time = curTick() + clockPeriod() * latency;
-            it->createPkt(it->translationRequest->getPaddr(), blkSize,
+            dp->createPkt(dp->translationRequest->getPaddr(), blkSize,
                     requestorId, tagPrefetch, pf_time);
-            addToQueue(pfq, *it);
+            addToQueue(pfq, *dp);
         }
     } else {
         DPRINTF(HWPrefetch, "%s Translation of vaddr %#x failed, dropping "
                 "prefetch request %#x \n", tlb->name(),
-                it->translationRequest->getVaddr());
+                dp->translationRequest->getVaddr());
     }
-    pfqMissingTranslation.erase(it);
+    removeFromQueue(pfqMissingTranslation,
+                    pfqMissingTranslation.position(*dp));
 }
 
 bool
-Queued::alreadyInQueue(std::list<DeferredPacket> &queue,
-                                 const PrefetchInfo &pfi, int32_t priority)
+Queued::alreadyInQueue(DeferredQueue &queue, const PrefetchInfo &pfi,
+                       int32_t priority)
 {
-    bool found = false;
-    iterator it;
-    for (it = queue.begin(); it != queue.end() && !found; it++) {
-        found = it->pfInfo.sameAddr(pfi);
+    statsQueued.queueLookups++;
+    DeferredPacket *dp = queue.find(pfi.getAddr(), pfi.isSecure());
+    if (dp == nullptr) {
+        return false;
     }
 
-    /* If the address is already in the queue, update priority and leave */
-    if (it != queue.end()) {
-        statsQueued.pfBufferHit++;
-        if (it->priority < priority) {
-            /* Update priority value and position in the queue */
-            it->priority = priority;
-            iterator prev = it;
-            while (prev != queue.begin()) {
-                prev--;
-                /* If the packet has higher priority, swap */
-                if (*it > *prev) {
-                    std::swap(*it, *prev);
-                    it = prev;
-                }
-            }
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue, priority updated\n");
-        } else {
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue\n");
-        }
+    /* The address is already in the queue, update priority and leave */
+    statsQueued.pfBufferHit++;
+    if (dp->priority < priority) {
+        /* Update priority value and position in the queue */
+        statsQueued.queueUpdates++;
+        statsQueued.queueShifts +=
+            queue.setPriority(queue.position(*dp), priority);
+        DPRINTF(HWPrefetch, "Prefetch addr already in "
+            "prefetch queue, priority updated\n");
+    } else {
+        DPRINTF(HWPrefetch, "Prefetch addr already in "
+            "prefetch queue\n");
     }
-    return found;
+    return true;
 }
 
 RequestPtr
 Queued::createPrefetchRequest(Addr addr, PrefetchInfo const &pfi,
                                         PacketPtr pkt)
 {
-    RequestPtr translation_req = std::make_shared<Request>(
+    RequestPtr translation_req = Request::create(
             addr, blkSize, pkt->req->getFlags(), requestorId, pfi.getPC(),
             pkt->req->contextId());
     translation_req->setFlags(Request::PREFETCH);
@@ -438,50 +589,29 @@ Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
 }
 
 void
-Queued::addToQueue(std::list<DeferredPacket> &queue,
-                             DeferredPacket &dpp)
+Queued::addToQueue(DeferredQueue &queue, DeferredPacket &dpp)
 {
     /* Verify prefetch buffer space for request */
-    if (queue.size() == queueSize) {
+    if (queue.full()) {
         statsQueued.pfRemovedFull++;
-        /* Lowest priority packet */
-        iterator it = queue.end();
-        panic_if (it == queue.begin(),
-            "Prefetch queue is both full and empty!");
-        --it;
-        /* Look for oldest in that level of priority */
-        panic_if (it == queue.begin(),
-            "Prefetch queue is full with 1 element!");
-        iterator prev = it;
-        bool cont = true;
-        /* While not at the head of the queue */
-        while (cont && prev != queue.begin()) {
-            prev--;
-            /* While at the same level of priority */
-            cont = prev->priority == it->priority;
-            if (cont)
-                /* update pointer */
-                it = prev;
-        }
+        /* Oldest packet among the ones with the lowest priority */
+        size_t pos = queue.victim();
         DPRINTF(HWPrefetch, "Prefetch queue full, removing lowest priority "
-                            "oldest packet, addr: %#x\n",it->pfInfo.getAddr());
-        delete it->pkt;
-        queue.erase(it);
+                            "oldest packet, addr: %#x\n",
+                            queue[pos].pfInfo.getAddr());
+        delete queue[pos].pkt;
+        removeFromQueue(queue, pos);
     }
 
-    if (queue.size() == 0) {
-        queue.emplace_back(dpp);
-    } else {
-        iterator it = queue.end();
-        do {
-            --it;
-        } while (it != queue.begin() && dpp > *it);
-        /* If we reach the head, we have to see if the new element is new head
-         * or not */
-        if (it == queue.begin() && dpp <= *it)
-            it++;
-        queue.insert(it, dpp);
-    }
+    statsQueued.queueUpdates++;
+    statsQueued.queueShifts += queue.push(dpp);
+}
+
+void
+Queued::removeFromQueue(DeferredQueue &queue, size_t pos)
+{
+    statsQueued.queueUpdates++;
+    statsQueued.queueShifts += queue.erase(pos);
 }
 
 } // namespace Prefetcher
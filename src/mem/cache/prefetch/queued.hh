@@ -39,8 +39,9 @@
 #define __MEM_CACHE_PREFETCH_QUEUED_HH__
 
 #include <cstdint>
-#include <list>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "base/types.hh"
@@ -133,11 +134,134 @@ class Queued : public Base
         void startTranslation(BaseTLB *tlb);
     };
 
-    std::list<DeferredPacket> pfq;
-    std::list<DeferredPacket> pfqMissingTranslation;
+    /**
+     * Fixed capacity queue of deferred packets, kept in descending order of
+     * priority and in insertion order within the same priority. Packets are
+     * stored in a pool of slots that do not move while the packet is
+     * queued, as the TLB keeps a pointer to them during a translation. The
+     * queue order is a ring of slot indices: insertions and removals only
+     * shift the indices between the affected position and the closest end
+     * of the ring, and positions are found with a binary search. A hash of
+     * the block addresses makes duplicate lookups independent of the
+     * number of queued packets.
+     */
+    class DeferredQueue
+    {
+      private:
+        /** Maximum number of packets */
+        const unsigned capacity;
+        /** Storage of the packets, never reallocated */
+        std::vector<DeferredPacket> slots;
+        /** Insertion order of the packet held by each slot */
+        std::vector<uint64_t> seqs;
+        /** Slots not holding a queued packet */
+        std::vector<unsigned> freeSlots;
+        /** Slot indices in queue order, starting at head */
+        std::vector<unsigned> ring;
+        unsigned head;
+        unsigned count;
+        uint64_t nextSeq;
+        /** Slots holding a packet, indexed by block address */
+        std::unordered_multimap<Addr, unsigned> addrMap;
+
+        static Addr
+        addrKey(Addr addr, bool is_secure)
+        {
+            return addr | (is_secure ? 1 : 0);
+        }
+
+        unsigned &at(size_t pos) { return ring[(head + pos) % capacity]; }
+        unsigned
+        at(size_t pos) const
+        {
+            return ring[(head + pos) % capacity];
+        }
+
+        /** Whether the packet in slot a goes before the one in slot b */
+        bool before(unsigned a, unsigned b) const;
+
+        /**
+         * Binary search of the first position whose slot does not satisfy
+         * the predicate, which must hold for a prefix of the queue.
+         */
+        template <typename Pred>
+        size_t partition(Pred pred) const;
 
-    using const_iterator = std::list<DeferredPacket>::const_iterator;
-    using iterator = std::list<DeferredPacket>::iterator;
+        /**
+         * Inserts a slot in the ring in priority order.
+         * @return number of ring entries shifted
+         */
+        unsigned link(unsigned slot);
+
+        /**
+         * Removes the slot at the given position from the ring.
+         * @return number of ring entries shifted
+         */
+        unsigned unlink(size_t pos);
+
+      public:
+        explicit DeferredQueue(unsigned capacity);
+
+        bool empty() const { return count == 0; }
+        size_t size() const { return count; }
+        bool full() const { return count == capacity; }
+
+        DeferredPacket &operator[](size_t pos) { return slots[at(pos)]; }
+        const DeferredPacket &
+        operator[](size_t pos) const
+        {
+            return slots[at(pos)];
+        }
+
+        DeferredPacket &front() { return (*this)[0]; }
+        const DeferredPacket &front() const { return (*this)[0]; }
+
+        /**
+         * Returns the position of a queued packet.
+         * @param dp packet held by this queue
+         */
+        size_t position(const DeferredPacket &dp) const;
+
+        /**
+         * Returns the position of the oldest packet among the ones with the
+         * lowest priority. The queue must not be empty.
+         */
+        size_t victim() const;
+
+        /**
+         * Looks up a queued packet by its block address.
+         * @param addr block address of the prefetch
+         * @param is_secure whether the prefetch targets the secure space
+         * @return a queued packet to that address, nullptr if none
+         */
+        DeferredPacket *find(Addr addr, bool is_secure);
+
+        /**
+         * Copies a packet into a free slot and queues it behind all
+         * packets with the same or a higher priority. The queue must not
+         * be full.
+         * @return number of ring entries shifted
+         */
+        unsigned push(const DeferredPacket &dp);
+
+        /**
+         * Removes the packet at the given position, without freeing its
+         * memory packet.
+         * @return number of ring entries shifted
+         */
+        unsigned erase(size_t pos);
+
+        /**
+         * Changes the priority of the packet at the given position and
+         * moves it behind all packets with the same or a higher priority.
+         * The packet keeps its slot.
+         * @return number of ring entries shifted
+         */
+        unsigned setPriority(size_t pos, int32_t priority);
+    };
+
+    DeferredQueue pfq;
+    DeferredQueue pfqMissingTranslation;
 
     // PARAMETERS
 
@@ -177,6 +301,10 @@ class Queued : public Base
         Stats::Scalar pfInCache;
         Stats::Scalar pfRemovedFull;
         Stats::Scalar pfSpanPage;
+        Stats::Scalar queueLookups;
+        Stats::Scalar queueUpdates;
+        Stats::Scalar queueShifts;
+        Stats::Formula avgQueueShifts;
     } statsQueued;
   public:
     using AddrPriority = std::pair<Addr, int32_t>;
@@ -204,7 +332,15 @@ class Queued : public Base
      * @param queue selected queue to use
      * @param dpp DeferredPacket to add
      */
-    void addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp);
+    void addToQueue(DeferredQueue &queue, DeferredPacket &dpp);
+
+    /**
+     * Removes the packet at the given position of the specified queue
+     * and accounts for the cost of the removal
+     * @param queue selected queue to use
+     * @param pos position of the packet in the queue
+     */
+    void removeFromQueue(DeferredQueue &queue, size_t pos);
 
     /**
      * Starts the translations of the queued prefetches with a
@@ -232,8 +368,8 @@ class Queued : public Base
      * @param priority priority of the prefetch request to be added
      * @return True if the prefetch request was found in the queue
      */
-    bool alreadyInQueue(std::list<DeferredPacket> &queue,
-                        const PrefetchInfo &pfi, int32_t priority);
+    bool alreadyInQueue(DeferredQueue &queue, const PrefetchInfo &pfi,
+                        int32_t priority);
 
     /**
      * Returns the maxmimum number of prefetch requests that are allowed
@@ -47,9 +47,11 @@
 
 #include <cassert>
 
+#include "base/bitfield.hh"
 #include "base/types.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/indexing_policies/set_associative.hh"
 #include "mem/request.hh"
 #include "sim/core.hh"
 #include "sim/sim_exit.hh"
@@ -62,11 +64,26 @@ BaseTags::BaseTags(const Params &p)
       warmupBound((p.warmup_percentage/100.0) * (p.size / p.block_size)),
       warmedUp(false), numBlocks(p.size / p.block_size),
       dataBlks(new uint8_t[p.size]), // Allocate data storage in one big chunk
+      setAssocIndexing(dynamic_cast<SetAssociative*>(indexingPolicy)),
       stats(*this)
 {
+    if (setAssocIndexing &&
+        setAssocIndexing->getAssoc() <= TagIndex::MaxAssoc) {
+        tagIndex.reset(new TagIndex(setAssocIndexing->getNumSets(),
+                                    setAssocIndexing->getAssoc()));
+    }
+
     registerExitCallback([this]() { cleanupRefs(); });
 }
 
+void
+BaseTags::indexEntry(TaggedEntry *entry)
+{
+    if (tagIndex) {
+        tagIndex->add(entry);
+    }
+}
+
 ReplaceableEntry*
 BaseTags::findBlockBySetAndWay(int set, int way) const
 {
@@ -79,6 +96,16 @@ BaseTags::findBlock(Addr addr, bool is_secure) const
     // Extract block tag
     Addr tag = extractTag(addr);
 
+    // Compare all ways of the set at once
+    if (tagIndex) {
+        const uint32_t set = setAssocIndexing->extractSet(addr);
+        const uint64_t ways = tagIndex->match(set, tag, is_secure);
+        if (ways == 0) {
+            return nullptr;
+        }
+        return static_cast<CacheBlk*>(tagIndex->getEntry(set, ctz64(ways)));
+    }
+
     // Find possible entries that may contain the given address
     const std::vector<ReplaceableEntry*> entries =
         indexingPolicy->getPossibleEntries(addr);
@@ -56,6 +56,7 @@
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/cache_blk.hh"
+#include "mem/cache/tags/tag_index.hh"
 #include "mem/packet.hh"
 #include "params/BaseTags.hh"
 #include "sim/clocked_object.hh"
@@ -63,6 +64,7 @@
 class System;
 class IndexingPolicy;
 class ReplaceableEntry;
+class SetAssociative;
 
 /**
  * A common base class of Cache tagstore objects.
@@ -99,6 +101,24 @@ class BaseTags : public ClockedObject
     /** The data blocks, 1 per cache block. */
     std::unique_ptr<uint8_t[]> dataBlks;
 
+    /** The indexing policy, if it is set associative. */
+    const SetAssociative *setAssocIndexing;
+
+    /**
+     * Index of the tags of all entries, which allows comparing all the
+     * ways of a set at once. Only available with set associative
+     * indexing, as the ways of a set must share the same location.
+     */
+    std::unique_ptr<TagIndex> tagIndex;
+
+    /**
+     * Add an entry to the tag index, if there is one. Must be called
+     * after the indexing policy has placed the entry.
+     *
+     * @param entry The entry to be indexed.
+     */
+    void indexEntry(TaggedEntry *entry);
+
     /**
      * TODO: It would be good if these stats were acquired after warmup.
      */
@@ -73,6 +73,7 @@ BaseSetAssoc::tagsInit()
 
         // Link block to indexing policy
         indexingPolicy->setEntry(blk, blk_index);
+        indexEntry(blk);
 
         // Associate a data chunk to the block
         blk->data = &dataBlks[blkSize*blk_index];
@@ -95,6 +95,7 @@ CompressedTags::tagsInit()
 
         // Link block to indexing policy
         indexingPolicy->setEntry(superblock, superblock_index);
+        indexEntry(superblock);
     }
 }
 
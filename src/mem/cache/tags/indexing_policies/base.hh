@@ -127,6 +127,20 @@ class BaseIndexingPolicy : public SimObject
      */
     ReplaceableEntry* getEntry(const uint32_t set, const uint32_t way) const;
 
+    /**
+     * Get the associativity of the table.
+     *
+     * @return The number of ways.
+     */
+    unsigned getAssoc() const { return assoc; }
+
+    /**
+     * Get the number of sets of the table.
+     *
+     * @return The number of sets.
+     */
+    uint32_t getNumSets() const { return numSets; }
+
     /**
      * Generate the tag from the given address.
      *
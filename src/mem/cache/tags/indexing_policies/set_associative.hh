@@ -78,15 +78,6 @@ class ReplaceableEntry;
  */
 class SetAssociative : public BaseIndexingPolicy
 {
-  protected:
-    /**
-     * Apply a hash function to calculate address set.
-     *
-     * @param addr The address to calculate the set for.
-     * @return The set index for given combination of address and way.
-     */
-    virtual uint32_t extractSet(const Addr addr) const;
-
   public:
     /**
      * Convenience typedef.
@@ -103,6 +94,14 @@ class SetAssociative : public BaseIndexingPolicy
      */
     ~SetAssociative() {};
 
+    /**
+     * Apply a hash function to calculate address set.
+     *
+     * @param addr The address to calculate the set for.
+     * @return The set index for given combination of address and way.
+     */
+    virtual uint32_t extractSet(const Addr addr) const;
+
     /**
      * Find all possible entries for insertion and replacement of an address.
      * Should be called immediately before ReplacementPolicy's findVictim()
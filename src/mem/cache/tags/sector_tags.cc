@@ -37,6 +37,7 @@
 #include <memory>
 #include <string>
 
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/types.hh"
@@ -44,6 +45,7 @@
 #include "mem/cache/replacement_policies/base.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/indexing_policies/set_associative.hh"
 
 SectorTags::SectorTags(const SectorTagsParams &p)
     : BaseTags(p), allocAssoc(p.assoc),
@@ -109,6 +111,7 @@ SectorTags::tagsInit()
 
         // Link block to indexing policy
         indexingPolicy->setEntry(sec_blk, sec_blk_index);
+        indexEntry(sec_blk);
     }
 }
 
@@ -253,6 +256,22 @@ SectorTags::findBlock(Addr addr, bool is_secure) const
     // due to sectors being composed of contiguous-address entries
     const Addr offset = extractSectorOffset(addr);
 
+    // Compare all ways of the set at once. More than one sector may hold
+    // the tag, e.g., when compressed superblocks cannot be co-allocated
+    if (tagIndex) {
+        const uint32_t set = setAssocIndexing->extractSet(addr);
+        for (uint64_t ways = tagIndex->match(set, tag, is_secure); ways;
+             ways &= ways - 1) {
+            auto sector = static_cast<SectorBlk*>(
+                tagIndex->getEntry(set, ctz64(ways)));
+            auto blk = sector->blks[offset];
+            if (blk->matchTag(tag, is_secure)) {
+                return blk;
+            }
+        }
+        return nullptr;
+    }
+
     // Find all possible sector entries that may contain the given address
     const std::vector<ReplaceableEntry*> entries =
         indexingPolicy->getPossibleEntries(addr);
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of a structure-of-arrays tag index for set associative tags.
+ */
+
+#include "mem/cache/tags/tag_index.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "mem/cache/tags/tagged_entry.hh"
+
+constexpr unsigned TagIndex::MaxAssoc;
+
+TagIndex::TagIndex(uint32_t num_sets, unsigned _assoc)
+    : numSets(num_sets), assoc(_assoc),
+      // Round to a multiple of 4 ways so that the AVX2 loop never needs
+      // a tail; padding keys stay zero and never match
+      stride(roundUp(assoc, 4)),
+      keys(numSets * stride, 0), entries(numSets * stride, nullptr)
+{
+    fatal_if(assoc > MaxAssoc, "Tag index supports up to %d ways.\n",
+             MaxAssoc);
+}
+
+void
+TagIndex::add(TaggedEntry *entry)
+{
+    const uint32_t set = entry->getSet();
+    const uint32_t way = entry->getWay();
+    assert(set < numSets && way < assoc);
+
+    const size_t slot = set * stride + way;
+    entries[slot] = entry;
+    entry->setIndexKey(&keys[slot]);
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of a structure-of-arrays tag index for set associative tags.
+ */
+
+#ifndef __MEM_CACHE_TAGS_TAG_INDEX_HH__
+#define __MEM_CACHE_TAGS_TAG_INDEX_HH__
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+
+#endif
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+class TaggedEntry;
+
+/**
+ * A copy of the tag, valid and secure bits of every entry of a set
+ * associative table, laid out so that all the ways of a set are
+ * contiguous. The three fields are packed into a single 64-bit key per
+ * way, which lets a lookup compare several ways per instruction instead
+ * of walking the entries one pointer at a time.
+ *
+ * The entries own their state and keep their key up to date through the
+ * pointer handed to them by add(). Invalid entries have a zero key,
+ * which never matches a lookup key since those have the valid bit set.
+ */
+class TagIndex
+{
+  public:
+    /** Maximum associativity, as matches are reported in a 64-bit mask. */
+    static constexpr unsigned MaxAssoc = 64;
+
+    /**
+     * @param num_sets Number of sets of the table.
+     * @param assoc Number of ways of each set.
+     */
+    TagIndex(uint32_t num_sets, unsigned assoc);
+
+    /** Generate the key of a valid entry. */
+    static uint64_t
+    makeKey(Addr tag, bool is_secure)
+    {
+        // Tags are shifted by at least the block offset, which leaves
+        // room for the valid and secure bits
+        assert((tag >> 62) == 0);
+        return (tag << 2) | (is_secure ? 0x2 : 0x0) | 0x1;
+    }
+
+    /**
+     * Add an entry to the index. The entry must already have been
+     * assigned its set and way by the indexing policy.
+     */
+    void add(TaggedEntry *entry);
+
+    /**
+     * Get the ways of a set that hold the given tag.
+     *
+     * @param set The set to look into.
+     * @param tag The tag to look for.
+     * @param is_secure Whether the tag belongs to the secure space.
+     * @return A mask with bit i set if way i matches.
+     */
+    uint64_t
+    match(uint32_t set, Addr tag, bool is_secure) const
+    {
+        assert(set < numSets);
+        return matchKeys(&keys[set * stride], stride,
+                         makeKey(tag, is_secure));
+    }
+
+    /** Get the entry of a given set and way. */
+    TaggedEntry *
+    getEntry(uint32_t set, unsigned way) const
+    {
+        return entries[set * stride + way];
+    }
+
+    /**
+     * Compare a row of keys against a key. This is exposed so that other
+     * set associative structures can share the same key layout.
+     *
+     * @param row The keys to compare.
+     * @param stride Number of keys in the row, a multiple of four no
+     *        larger than MaxAssoc.
+     * @param key The key to look for.
+     * @return A mask with bit i set if key i of the row matches.
+     */
+    static uint64_t
+    matchKeys(const uint64_t *row, unsigned stride, uint64_t key)
+    {
+        assert(stride % 4 == 0 && stride <= MaxAssoc);
+        uint64_t mask = 0;
+#if defined(__AVX2__)
+        const __m256i needle = _mm256_set1_epi64x(key);
+        for (unsigned way = 0; way < stride; way += 4) {
+            const __m256i cmp = _mm256_cmpeq_epi64(needle,
+                _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(row + way)));
+            mask |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)))
+                << way;
+        }
+#elif defined(__SSE2__)
+        // SSE2 lacks a 64-bit compare, so combine the two 32-bit
+        // halves of each lane
+        const __m128i needle = _mm_set1_epi64x(key);
+        for (unsigned way = 0; way < stride; way += 2) {
+            const __m128i cmp32 = _mm_cmpeq_epi32(needle,
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + way)));
+            const __m128i cmp = _mm_and_si128(cmp32,
+                _mm_shuffle_epi32(cmp32, _MM_SHUFFLE(2, 3, 0, 1)));
+            mask |= uint64_t(_mm_movemask_pd(_mm_castsi128_pd(cmp))) << way;
+        }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+        const uint64x2_t needle = vdupq_n_u64(key);
+        for (unsigned way = 0; way < stride; way += 2) {
+            const uint64x2_t cmp = vceqq_u64(needle, vld1q_u64(row + way));
+            mask |= (vgetq_lane_u64(cmp, 0) & 0x1) << way;
+            mask |= (vgetq_lane_u64(cmp, 1) & 0x2) << way;
+        }
+#else
+        for (unsigned way = 0; way < stride; ++way)
+            mask |= uint64_t(row[way] == key) << way;
+#endif
+        return mask;
+    }
+
+  protected:
+    const uint32_t numSets;
+    const unsigned assoc;
+
+    /** Number of keys per set, padded to the SIMD width. */
+    const unsigned stride;
+
+    /** The keys of all entries, indexed by set * stride + way. */
+    std::vector<uint64_t> keys;
+
+    /** The entries, in the same layout as the keys. */
+    std::vector<TaggedEntry *> entries;
+};
+
+#endif //__MEM_CACHE_TAGS_TAG_INDEX_HH__
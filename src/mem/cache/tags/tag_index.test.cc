@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/cache/tags/tag_index.hh"
+#include "mem/cache/tags/tagged_entry.hh"
+
+namespace
+{
+
+/** Exposes the protected modifiers of a tagged entry. */
+class TestEntry : public TaggedEntry
+{
+  public:
+    using TaggedEntry::setSecure;
+};
+
+/** A table of entries placed as a set associative indexing would. */
+struct Table
+{
+    TagIndex index;
+    std::vector<TestEntry> entries;
+
+    Table(uint32_t num_sets, unsigned assoc)
+      : index(num_sets, assoc), entries(num_sets * assoc)
+    {
+        for (unsigned i = 0; i < entries.size(); ++i) {
+            entries[i].setPosition(i / assoc, i % assoc);
+            index.add(&entries[i]);
+        }
+    }
+};
+
+} // anonymous namespace
+
+/** Entries are only found while they are valid. */
+TEST(TagIndexTest, InsertInvalidate)
+{
+    Table table(4, 8);
+    EXPECT_EQ(0, table.index.match(2, 0x10, false));
+
+    table.entries[2 * 8 + 5].insert(0x10, false);
+    EXPECT_EQ(1ULL << 5, table.index.match(2, 0x10, false));
+    EXPECT_EQ(&table.entries[2 * 8 + 5], table.index.getEntry(2, 5));
+    EXPECT_EQ(0, table.index.match(1, 0x10, false));
+    EXPECT_EQ(0, table.index.match(2, 0x11, false));
+
+    table.entries[2 * 8 + 5].invalidate();
+    EXPECT_EQ(0, table.index.match(2, 0x10, false));
+}
+
+/** The secure bit is part of the match. */
+TEST(TagIndexTest, Secure)
+{
+    Table table(1, 4);
+    table.entries[1].insert(0x20, true);
+    EXPECT_EQ(0, table.index.match(0, 0x20, false));
+    EXPECT_EQ(1ULL << 1, table.index.match(0, 0x20, true));
+
+    table.entries[3].insert(0x20, false);
+    EXPECT_EQ(1ULL << 3, table.index.match(0, 0x20, false));
+}
+
+/**
+ * Associativities that are not a multiple of the vector width match
+ * every way, and report all ways holding the tag.
+ */
+TEST(TagIndexTest, OddAssociativity)
+{
+    for (unsigned assoc : { 1, 3, 5, 20, 64 }) {
+        Table table(2, assoc);
+        for (unsigned way = 0; way < assoc; ++way)
+            table.entries[assoc + way].insert(way, false);
+        for (unsigned way = 0; way < assoc; ++way) {
+            EXPECT_EQ(1ULL << way, table.index.match(1, way, false));
+            EXPECT_EQ(0, table.index.match(0, way, false));
+        }
+
+        table.entries[assoc].invalidate();
+        table.entries[assoc].insert(assoc - 1, false);
+        EXPECT_EQ((1ULL << (assoc - 1)) | 1,
+                  table.index.match(1, assoc - 1, false));
+    }
+}
+
+/** Copies of an entry do not update the original's key. */
+TEST(TagIndexTest, Copy)
+{
+    Table table(1, 2);
+    table.entries[0].insert(0x30, false);
+
+    TestEntry copy(table.entries[0]);
+    copy.invalidate();
+    EXPECT_EQ(1, table.index.match(0, 0x30, false));
+
+    table.entries[1] = table.entries[0];
+    EXPECT_EQ(3, table.index.match(0, 0x30, false));
+}
@@ -30,10 +30,12 @@
 #define __CACHE_TAGGED_ENTRY_HH__
 
 #include <cassert>
+#include <cstdint>
 
 #include "base/cprintf.hh"
 #include "base/types.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
+#include "mem/cache/tags/tag_index.hh"
 
 /**
  * A tagged entry is an entry containing a tag. Each tag is accompanied by a
@@ -43,9 +45,42 @@
 class TaggedEntry : public ReplaceableEntry
 {
   public:
-    TaggedEntry() : _valid(false), _secure(false), _tag(MaxAddr) {}
+    TaggedEntry()
+      : _valid(false), _secure(false), _tag(MaxAddr), _indexKey(nullptr)
+    {}
     ~TaggedEntry() = default;
 
+    /** Copies do not inherit the original's slot in a tag index. */
+    TaggedEntry(const TaggedEntry &other)
+      : ReplaceableEntry(other), _valid(other._valid),
+        _secure(other._secure), _tag(other._tag), _indexKey(nullptr)
+    {}
+
+    TaggedEntry &
+    operator=(const TaggedEntry &other)
+    {
+        ReplaceableEntry::operator=(other);
+        _valid = other._valid;
+        _secure = other._secure;
+        _tag = other._tag;
+        updateIndexKey();
+        return *this;
+    }
+
+    /**
+     * Attach the entry to its slot in a tag index (see TagIndex). The
+     * slot is kept up to date with the entry's tag, valid and secure
+     * bits from then on.
+     *
+     * @param key The entry's key in the index.
+     */
+    void
+    setIndexKey(uint64_t *key)
+    {
+        _indexKey = key;
+        updateIndexKey();
+    }
+
     /**
      * Checks if the entry is valid.
      *
@@ -117,10 +152,20 @@ class TaggedEntry : public ReplaceableEntry
      *
      * @param tag The tag value.
      */
-    virtual void setTag(Addr tag) { _tag = tag; }
+    virtual void
+    setTag(Addr tag)
+    {
+        _tag = tag;
+        updateIndexKey();
+    }
 
     /** Set secure bit. */
-    virtual void setSecure() { _secure = true; }
+    virtual void
+    setSecure()
+    {
+        _secure = true;
+        updateIndexKey();
+    }
 
     /** Set valid bit. The block must be invalid beforehand. */
     virtual void
@@ -128,6 +173,7 @@ class TaggedEntry : public ReplaceableEntry
     {
         assert(!isValid());
         _valid = true;
+        updateIndexKey();
     }
 
   private:
@@ -147,8 +193,27 @@ class TaggedEntry : public ReplaceableEntry
     /** The entry's tag. */
     Addr _tag;
 
+    /** The entry's key in a tag index, if it belongs to one. */
+    uint64_t *_indexKey;
+
     /** Clear secure bit. Should be only used by the invalidation function. */
-    void clearSecure() { _secure = false; }
+    void
+    clearSecure()
+    {
+        _secure = false;
+        updateIndexKey();
+    }
+
+    /** Mirror the tag, valid and secure bits in the tag index. */
+    void
+    updateIndexKey()
+    {
+        // The tag is still MaxAddr while an entry is being inserted
+        if (_indexKey) {
+            *_indexKey = _valid && _tag != MaxAddr ?
+                TagIndex::makeKey(_tag, _secure) : 0;
+        }
+    }
 };
 
 #endif//__CACHE_TAGGED_ENTRY_HH__
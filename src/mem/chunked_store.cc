@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/chunked_store.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "base/cprintf.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace
+{
+
+const char imageMagic[8] = { 'g', 'e', 'm', '5', 'p', 'm', 'e', 'm' };
+const uint32_t imageVersion = 1;
+
+struct Footer
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numFiles;
+    uint64_t chunkSize;
+    uint64_t size;
+    uint64_t numChunks;
+    uint64_t indexOffset;
+};
+
+std::string
+absolutePath(const std::string &path)
+{
+    if (!path.empty() && path[0] == '/')
+        return path;
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return path;
+    return std::string(cwd) + "/" + path;
+}
+
+std::string
+pwriteAll(int fd, const void *buf, uint64_t len, uint64_t offset)
+{
+    const uint8_t *data = static_cast<const uint8_t *>(buf);
+    while (len) {
+        ssize_t ret = pwrite(fd, data, len, offset);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return std::strerror(errno);
+        }
+        data += ret;
+        len -= ret;
+        offset += ret;
+    }
+    return "";
+}
+
+std::string
+preadAll(int fd, void *buf, uint64_t len, uint64_t offset)
+{
+    uint8_t *data = static_cast<uint8_t *>(buf);
+    while (len) {
+        ssize_t ret = pread(fd, data, len, offset);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return std::strerror(errno);
+        }
+        if (ret == 0)
+            return "unexpected end of file";
+        data += ret;
+        len -= ret;
+        offset += ret;
+    }
+    return "";
+}
+
+/**
+ * Hash a chunk with two independent 64 bit hashes.
+ * @return True if the chunk only holds zeros.
+ */
+bool
+hashChunk(const uint8_t *data, uint64_t len, uint64_t hash[2])
+{
+    uint64_t h0 = 0xcbf29ce484222325ULL;
+    uint64_t h1 = 0x9e3779b97f4a7c15ULL ^ len;
+    uint64_t any = 0;
+
+    auto mix = [&](uint64_t word) {
+        any |= word;
+        h0 = (h0 ^ word) * 0x100000001b3ULL;
+        h1 = (h1 + word) * 0xff51afd7ed558ccdULL;
+        h1 ^= h1 >> 29;
+    };
+
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        mix(word);
+    }
+    for (; i < len; i++)
+        mix(data[i]);
+
+    hash[0] = h0;
+    hash[1] = h1;
+    return any == 0;
+}
+
+} // anonymous namespace
+
+const uint64_t ChunkedStore::ChunkSize;
+
+ChunkedStore::ChunkedStore(unsigned num_threads, int level,
+                           bool incremental)
+    : numThreads(num_threads), level(level), incremental(incremental)
+{
+    fatal_if(ChunkSize % sysconf(_SC_PAGESIZE),
+             "Memory image chunks must be a multiple of the page size.\n");
+}
+
+std::string
+ChunkedStore::forEachChunk(
+        size_t num_chunks,
+        const std::function<std::string(size_t)> &func) const
+{
+    size_t num_threads = numThreads ? numThreads :
+        std::max(std::thread::hardware_concurrency(), 1U);
+    num_threads = std::min(num_threads, num_chunks);
+
+    std::atomic<size_t> next(0);
+    std::mutex error_mutex;
+    std::string error;
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < num_chunks; i = next++) {
+            std::string chunk_error = func(i);
+            if (!chunk_error.empty()) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error.empty())
+                    error = chunk_error;
+                // Stop all the workers.
+                next = num_chunks;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < num_threads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread: threads)
+        thread.join();
+
+    return error;
+}
+
+void
+ChunkedStore::write(const std::string &path, const uint8_t *pmem,
+                    uint64_t size)
+{
+    const std::string abs_path = absolutePath(path);
+    const size_t num_chunks = divCeil(size, ChunkSize);
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+
+    // Deltas need a parent of the same size which isn't about to be
+    // replaced by this image.
+    const bool delta = incremental && parentChunks.size() == num_chunks &&
+        std::find(parentFiles.begin(), parentFiles.end(), abs_path) ==
+        parentFiles.end();
+
+    // Write to a temporary file and rename it, so that an image being
+    // replaced stays intact for anything which still maps it.
+    const std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        fatal("Can't open physical memory checkpoint file '%s': %s\n",
+              tmp_path, std::strerror(errno));
+    }
+
+    // Files 1 and up are the files of the parent.
+    std::vector<Chunk> chunks(num_chunks);
+    std::atomic<uint64_t> next_offset(0);
+
+    std::string error = forEachChunk(num_chunks, [&](size_t i) {
+        const uint64_t start = i * ChunkSize;
+        const uint64_t len = std::min(ChunkSize, size - start);
+        const uint8_t *data = pmem + start;
+        Chunk &chunk = chunks[i];
+
+        if (hashChunk(data, len, chunk.hash))
+            return std::string();
+
+        if (delta) {
+            const Chunk &parent = parentChunks[i];
+            if (parent.type != Zero && parent.hash[0] == chunk.hash[0] &&
+                    parent.hash[1] == chunk.hash[1]) {
+                chunk = parent;
+                chunk.file = parent.file + 1;
+                return std::string();
+            }
+        }
+
+        std::vector<uint8_t> deflated;
+        chunk.type = Raw;
+        chunk.length = len;
+        if (level > 0) {
+            uLongf deflated_len = compressBound(len);
+            deflated.resize(deflated_len);
+            // Only keep the deflated data if it saves an eighth.
+            if (compress2(deflated.data(), &deflated_len, data, len,
+                          level) == Z_OK &&
+                    deflated_len < len - len / 8) {
+                chunk.type = Deflated;
+                chunk.length = deflated_len;
+                data = deflated.data();
+            }
+        }
+
+        chunk.offset = next_offset.fetch_add(roundUp(chunk.length,
+                                                     page_size));
+        return pwriteAll(fd, data, chunk.length, chunk.offset);
+    });
+
+    // Only keep the files which are still referred to.
+    std::vector<std::string> files = { abs_path };
+    std::map<uint32_t, uint32_t> file_map = { { 0, 0 } };
+    for (auto &chunk: chunks) {
+        if (chunk.type == Zero)
+            continue;
+        auto it = file_map.find(chunk.file);
+        if (it == file_map.end()) {
+            it = file_map.emplace(chunk.file, files.size()).first;
+            files.push_back(parentFiles[chunk.file - 1]);
+        }
+        chunk.file = it->second;
+    }
+
+    // Write the index and the footer after the data.
+    std::vector<uint8_t> index;
+    auto append = [&index](const void *data, size_t len) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        index.insert(index.end(), bytes, bytes + len);
+    };
+    for (size_t f = 1; f < files.size(); f++) {
+        uint32_t len = files[f].size();
+        append(&len, sizeof(len));
+        append(files[f].data(), len);
+    }
+    for (const auto &chunk: chunks) {
+        append(&chunk.type, sizeof(chunk.type));
+        append(&chunk.file, sizeof(chunk.file));
+        append(&chunk.offset, sizeof(chunk.offset));
+        append(&chunk.length, sizeof(chunk.length));
+        append(chunk.hash, sizeof(chunk.hash));
+    }
+
+    Footer footer;
+    std::memcpy(footer.magic, imageMagic, sizeof(footer.magic));
+    footer.version = imageVersion;
+    footer.numFiles = files.size();
+    footer.chunkSize = ChunkSize;
+    footer.size = size;
+    footer.numChunks = num_chunks;
+    footer.indexOffset = next_offset;
+    append(&footer, sizeof(footer));
+
+    if (error.empty())
+        error = pwriteAll(fd, index.data(), index.size(), next_offset);
+
+    if (close(fd) != 0 && error.empty())
+        error = std::strerror(errno);
+    if (error.empty() && std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        error = std::strerror(errno);
+    if (!error.empty()) {
+        fatal("Write failed on physical memory checkpoint file '%s': %s\n",
+              path, error);
+    }
+
+    parentFiles = std::move(files);
+    parentChunks = std::move(chunks);
+}
+
+void
+ChunkedStore::read(const std::string &path, uint8_t *pmem, uint64_t size,
+                   bool lazy)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fatal("Can't open physical memory checkpoint file '%s': %s\n",
+              path, std::strerror(errno));
+    }
+
+    Footer footer;
+    fatal_if(st.st_size < (off_t)sizeof(footer) ||
+             !preadAll(fd, &footer, sizeof(footer),
+                       st.st_size - sizeof(footer)).empty() ||
+             std::memcmp(footer.magic, imageMagic, sizeof(imageMagic)) ||
+             footer.version != imageVersion,
+             "Physical memory checkpoint file '%s' is not a memory image.\n",
+             path);
+    fatal_if(footer.chunkSize != ChunkSize,
+             "Physical memory checkpoint file '%s' has unsupported %d byte "
+             "chunks.\n", path, footer.chunkSize);
+    fatal_if(footer.size != size,
+             "Memory range size has changed! Saw %lld, expected %lld\n",
+             footer.size, size);
+    fatal_if(footer.numChunks != divCeil(size, ChunkSize) ||
+             footer.indexOffset > st.st_size - sizeof(footer),
+             "Physical memory checkpoint file '%s' is corrupt.\n", path);
+
+    // Read the index.
+    std::vector<uint8_t> index(st.st_size - sizeof(footer) -
+                               footer.indexOffset);
+    std::string error = preadAll(fd, index.data(), index.size(),
+                                 footer.indexOffset);
+    size_t pos = 0;
+    auto extract = [&](void *data, size_t len) {
+        if (pos + len > index.size()) {
+            error = "truncated index";
+            return;
+        }
+        std::memcpy(data, index.data() + pos, len);
+        pos += len;
+    };
+
+    std::vector<std::string> files = { absolutePath(path) };
+    for (uint32_t f = 1; f < footer.numFiles && error.empty(); f++) {
+        uint32_t len = 0;
+        extract(&len, sizeof(len));
+        std::string file(len, '\0');
+        extract(&file[0], len);
+        files.push_back(file);
+    }
+
+    std::vector<Chunk> chunks(footer.numChunks);
+    for (auto &chunk: chunks) {
+        extract(&chunk.type, sizeof(chunk.type));
+        extract(&chunk.file, sizeof(chunk.file));
+        extract(&chunk.offset, sizeof(chunk.offset));
+        extract(&chunk.length, sizeof(chunk.length));
+        extract(chunk.hash, sizeof(chunk.hash));
+        if (chunk.type != Zero && chunk.file >= files.size())
+            error = "bad file index";
+    }
+    fatal_if(!error.empty(),
+             "Can't read physical memory checkpoint file '%s': %s\n",
+             path, error);
+
+    // Open the files of the parents.
+    std::vector<int> fds = { fd };
+    for (size_t f = 1; f < files.size(); f++) {
+        fds.push_back(open(files[f].c_str(), O_RDONLY));
+        if (fds.back() < 0) {
+            fatal("Can't open physical memory checkpoint file '%s', the "
+                  "parent of '%s': %s\n", files[f], path,
+                  std::strerror(errno));
+        }
+    }
+
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    error = forEachChunk(chunks.size(), [&](size_t i) {
+        const Chunk &chunk = chunks[i];
+        const uint64_t start = i * ChunkSize;
+        const uint64_t len = std::min(ChunkSize, size - start);
+        uint8_t *data = pmem + start;
+
+        switch (chunk.type) {
+          case Zero:
+            // The backing store is already zero.
+            return std::string();
+
+          case Raw:
+            if (chunk.length != len)
+                return std::string("bad raw chunk");
+            // Let the host page the chunk in on demand.
+            if (lazy && len % page_size == 0 &&
+                    mmap(data, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, fds[chunk.file],
+                         chunk.offset) != MAP_FAILED) {
+                return std::string();
+            }
+            return preadAll(fds[chunk.file], data, len, chunk.offset);
+
+          case Deflated:
+            {
+                std::vector<uint8_t> deflated(chunk.length);
+                std::string read_error = preadAll(fds[chunk.file],
+                        deflated.data(), chunk.length, chunk.offset);
+                if (!read_error.empty())
+                    return read_error;
+                uLongf inflated_len = len;
+                if (uncompress(data, &inflated_len, deflated.data(),
+                               chunk.length) != Z_OK ||
+                        inflated_len != len) {
+                    return std::string("corrupt chunk");
+                }
+                return std::string();
+            }
+
+          default:
+            return std::string("bad chunk type");
+        }
+    });
+
+    for (int file_fd: fds)
+        close(file_fd);
+
+    fatal_if(!error.empty(),
+             "Can't read physical memory checkpoint file '%s': %s\n",
+             path, error);
+
+    parentFiles = std::move(files);
+    parentChunks = std::move(chunks);
+}
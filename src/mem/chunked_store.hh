@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_CHUNKED_STORE_HH__
+#define __MEM_CHUNKED_STORE_HH__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * A checkpoint image of a backing store of the physical memory, split in
+ * fixed size chunks which are written and read in parallel.
+ *
+ * Chunks which only hold zeros take no space in the image, and the others
+ * are stored deflated, or raw when that doesn't save much. Raw chunks are
+ * page aligned in the file, so that a restore can map them into the
+ * backing store and let the host page them in on demand.
+ *
+ * An image can be incremental. Its chunks which are the same as in the
+ * previous image written or read by the same ChunkedStore then refer to
+ * the file holding that data rather than being stored again. Images refer
+ * to the files of their parents by absolute path.
+ *
+ * The file starts with the chunk data, followed by an index of the files
+ * and chunks of the image and a fixed size footer locating the index.
+ */
+class ChunkedStore
+{
+  public:
+    /** Size of the chunks, a multiple of the host page size. */
+    static const uint64_t ChunkSize = 1ULL << 20;
+
+    /**
+     * @param num_threads Threads compressing or decompressing chunks, or
+     *                    0 for one per host CPU.
+     * @param level The zlib compression level, or 0 to store raw chunks.
+     * @param incremental Whether to write images as deltas against the
+     *                    last image written or read.
+     */
+    ChunkedStore(unsigned num_threads, int level, bool incremental);
+
+    /**
+     * Write an image of a backing store.
+     * @param path The file to write.
+     * @param pmem The backing store.
+     * @param size The size of the backing store.
+     */
+    void write(const std::string &path, const uint8_t *pmem, uint64_t size);
+
+    /**
+     * Restore a backing store from an image.
+     * @param path The file to read.
+     * @param pmem The backing store, which only holds zeros.
+     * @param size The size of the backing store.
+     * @param lazy Whether raw chunks may be mapped rather than copied,
+     *             which requires a private mapping of the backing store.
+     */
+    void read(const std::string &path, uint8_t *pmem, uint64_t size,
+              bool lazy);
+
+  private:
+    enum ChunkType : uint8_t
+    {
+        Zero,
+        Raw,
+        Deflated,
+    };
+
+    struct Chunk
+    {
+        ChunkType type = Zero;
+        /** Index of the file holding the data in the file list. */
+        uint32_t file = 0;
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        uint64_t hash[2] = { 0, 0 };
+    };
+
+    const unsigned numThreads;
+    const int level;
+    const bool incremental;
+
+    /**
+     * The image last written or read, which is the parent of the next
+     * incremental image. The first file is the image itself.
+     */
+    std::vector<std::string> parentFiles;
+    std::vector<Chunk> parentChunks;
+
+    /**
+     * Call a function for each chunk from a number of threads.
+     * @return The first error reported by the function, if any.
+     */
+    std::string forEachChunk(
+            size_t num_chunks,
+            const std::function<std::string(size_t)> &func) const;
+};
+
+#endif // __MEM_CHUNKED_STORE_HH__
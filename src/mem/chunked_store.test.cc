@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "mem/chunked_store.hh"
+
+namespace
+{
+
+const uint64_t storeSize = 5 * ChunkedStore::ChunkSize + 16 * 4096;
+
+/** A fresh, zeroed and privately mapped backing store. */
+class Store
+{
+  public:
+    uint8_t *pmem;
+
+    Store()
+    {
+        pmem = (uint8_t *)mmap(NULL, storeSize, PROT_READ | PROT_WRITE,
+                               MAP_ANON | MAP_PRIVATE, -1, 0);
+        EXPECT_NE(pmem, MAP_FAILED);
+    }
+
+    ~Store() { munmap(pmem, storeSize); }
+};
+
+class ChunkedStoreTest : public testing::Test
+{
+  protected:
+    std::string dir;
+    Store original;
+
+    void
+    SetUp() override
+    {
+        char tmpl[] = "/tmp/chunked_store.XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+
+        // Chunk 0 is random, chunk 1 compresses well, chunk 2 and 4 only
+        // hold zeros and chunk 3 has a single byte set. The partial last
+        // chunk is random too.
+        uint64_t seed = 1;
+        auto random_fill = [&seed](uint8_t *data, uint64_t len) {
+            for (uint64_t i = 0; i < len; i++) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                data[i] = seed >> 56;
+            }
+        };
+        const uint64_t chunk = ChunkedStore::ChunkSize;
+        random_fill(original.pmem, chunk);
+        for (uint64_t i = 0; i < chunk; i++)
+            original.pmem[chunk + i] = i % 7;
+        original.pmem[3 * chunk + 12345] = 42;
+        random_fill(original.pmem + 5 * chunk, storeSize - 5 * chunk);
+    }
+
+    void
+    TearDown() override
+    {
+        std::string cmd = "rm -rf " + dir;
+        EXPECT_EQ(std::system(cmd.c_str()), 0);
+    }
+
+    off_t
+    fileSize(const std::string &path)
+    {
+        struct stat st;
+        EXPECT_EQ(stat(path.c_str(), &st), 0);
+        return st.st_size;
+    }
+};
+
+} // anonymous namespace
+
+/** Deflated images restore the original contents. */
+TEST_F(ChunkedStoreTest, DeflatedRoundTrip)
+{
+    ChunkedStore writer(4, 1, false);
+    writer.write(dir + "/image", original.pmem, storeSize);
+
+    // The zero chunks take no space and the repetitive one little.
+    EXPECT_LT(fileSize(dir + "/image"),
+              3 * ChunkedStore::ChunkSize + 16 * 4096);
+
+    Store restored;
+    ChunkedStore reader(3, 1, false);
+    reader.read(dir + "/image", restored.pmem, storeSize, false);
+    EXPECT_EQ(std::memcmp(original.pmem, restored.pmem, storeSize), 0);
+}
+
+/** Raw images can be mapped into the backing store. */
+TEST_F(ChunkedStoreTest, LazyRawRoundTrip)
+{
+    ChunkedStore writer(1, 0, false);
+    writer.write(dir + "/image", original.pmem, storeSize);
+
+    Store restored;
+    ChunkedStore reader(2, 0, false);
+    reader.read(dir + "/image", restored.pmem, storeSize, true);
+    EXPECT_EQ(std::memcmp(original.pmem, restored.pmem, storeSize), 0);
+
+    // The mapping is private, so writes don't reach the image.
+    restored.pmem[0] ^= 0xff;
+    Store again;
+    reader.read(dir + "/image", again.pmem, storeSize, false);
+    EXPECT_EQ(again.pmem[0], original.pmem[0]);
+}
+
+/** Incremental images only hold the chunks which changed. */
+TEST_F(ChunkedStoreTest, Incremental)
+{
+    ChunkedStore writer(0, 1, true);
+    writer.write(dir + "/parent", original.pmem, storeSize);
+
+    original.pmem[ChunkedStore::ChunkSize + 5] = 99;
+    writer.write(dir + "/child", original.pmem, storeSize);
+    EXPECT_LT(fileSize(dir + "/child"), fileSize(dir + "/parent") / 4);
+
+    Store restored;
+    ChunkedStore reader(0, 1, true);
+    reader.read(dir + "/child", restored.pmem, storeSize, true);
+    EXPECT_EQ(std::memcmp(original.pmem, restored.pmem, storeSize), 0);
+
+    // An image restored from a delta can be the parent of the next one.
+    restored.pmem[3 * ChunkedStore::ChunkSize] = 7;
+    reader.write(dir + "/grandchild", restored.pmem, storeSize);
+
+    Store restored_again;
+    ChunkedStore reader_again(0, 1, false);
+    reader_again.read(dir + "/grandchild", restored_again.pmem, storeSize,
+                      false);
+    EXPECT_EQ(std::memcmp(restored.pmem, restored_again.pmem, storeSize),
+              0);
+}
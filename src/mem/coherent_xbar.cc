@@ -196,6 +196,21 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
     if (snoop_caches) {
         assert(pkt->snoopDelay == 0);
 
+        if (!is_express_snoop && !backInvalidations.empty() &&
+            backInvalidations.count({pkt->getBlockAddr(
+                        system->cacheLineSize()), pkt->isSecure()})) {
+            // the line was evicted from the snoop filter and its
+            // dirty data is on the way to us, so the memory below is
+            // stale until the snoop response is written to it
+            DPRINTF(CoherentXBar, "%s: src %s packet %s BACK-INV BLOCKED\n",
+                    __func__, src_port->name(), pkt->print());
+
+            pkt->headerDelay = old_header_delay;
+            reqLayers[mem_side_port_id]->failedTiming(src_port,
+                                                    clockEdge(Cycles(1)));
+            return false;
+        }
+
         if (pkt->isClean() && !is_destination) {
             // before snooping we need to make sure that the memory
             // below is not busy and the cache clean request can be
@@ -217,6 +232,21 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
         if (snoopFilter) {
             // check with the snoop filter where to forward this packet
             auto sf_res = snoopFilter->lookupRequest(pkt, *src_port);
+
+            if (snoopFilter->lookupBlocked()) {
+                // the snoop filter has no room to track the line
+                // until some outstanding request completes
+                assert(!is_express_snoop);
+                DPRINTF(CoherentXBar, "%s: src %s packet %s SF BLOCKED\n",
+                        __func__, src_port->name(), pkt->print());
+
+                pkt->headerDelay = old_header_delay;
+                reqLayers[mem_side_port_id]->failedTiming(src_port,
+                                                        clockEdge(Cycles(1)));
+                return false;
+            }
+            backInvalidate(true);
+
             // the time required by a packet to be delivered through
             // the xbar has to be charged also with to lookup latency
             // of the snoop filter
@@ -567,6 +597,27 @@ CoherentXBar::recvTimingSnoopResp(PacketPtr pkt, PortID cpu_side_port_id)
     // determine the source port based on the id
     ResponsePort* src_port = cpuSidePorts[cpu_side_port_id];
 
+    const auto back_inv = backInvalidations.find(
+        {pkt->getAddr(), pkt->isSecure()});
+    if (back_inv != backInvalidations.end() &&
+        back_inv->second == pkt->req) {
+        // dirty data of a line evicted from the snoop filter, write
+        // it to the memory below, without modelling the timing of
+        // this rare case, and let requests to the line through again
+        assert(pkt->hasData());
+        DPRINTF(CoherentXBar, "%s: src %s packet %s BACK-INVALIDATED\n",
+                __func__, src_port->name(), pkt->print());
+
+        Packet wb_pkt(pkt->req, MemCmd::WriteReq);
+        wb_pkt.dataStatic(pkt->getConstPtr<uint8_t>());
+        memSidePorts[findPort(wb_pkt.getAddrRange())]->sendFunctional(
+            &wb_pkt);
+        backInvalidations.erase(back_inv);
+
+        pendingDelete.reset(pkt);
+        return true;
+    }
+
     // get the destination
     const auto route_lookup = routeTo.find(pkt->req);
     assert(route_lookup != routeTo.end());
@@ -757,6 +808,11 @@ CoherentXBar::recvAtomicBackdoor(PacketPtr pkt, PortID cpu_side_port_id,
             auto sf_res =
                 snoopFilter->lookupRequest(pkt,
                 *cpuSidePorts [cpu_side_port_id]);
+            // without requests in flight there is always a line to evict
+            panic_if(snoopFilter->lookupBlocked(),
+                     "%s: snoop filter blocked %s in atomic mode\n",
+                     name(), pkt->print());
+            backInvalidate(false);
             snoop_response_latency += sf_res.second * clockPeriod();
             DPRINTF(CoherentXBar, "%s: src %s packet %s SF size: %i lat: %i\n",
                     __func__, cpuSidePorts[cpu_side_port_id]->name(),
@@ -992,6 +1048,53 @@ CoherentXBar::forwardAtomic(PacketPtr pkt, PortID exclude_cpu_side_port_id,
     return std::make_pair(snoop_response_cmd, snoop_response_latency);
 }
 
+void
+CoherentXBar::backInvalidate(bool is_timing)
+{
+    Addr addr;
+    bool is_secure;
+    const SnoopFilter::SnoopList holders =
+        snoopFilter->takeEviction(addr, is_secure);
+    if (holders.empty())
+        return;
+
+    // to the caches above this looks like a read-exclusive request by
+    // someone else, so they all invalidate the line, and a cache with
+    // the line dirty responds with the data
+    RequestPtr req = Request::create(addr, system->cacheLineSize(), 0,
+                                     Request::wbRequestorId);
+    if (is_secure)
+        req->setFlags(Request::SECURE);
+    Packet snoop_pkt(req, MemCmd::ReadExReq);
+
+    DPRINTF(CoherentXBar, "%s: %s\n", __func__, snoop_pkt.print());
+
+    if (is_timing) {
+        snoop_pkt.setExpressSnoop();
+        forwardTiming(&snoop_pkt, InvalidPortID, holders);
+
+        // the response is sent later, and handled in recvTimingSnoopResp
+        if (snoop_pkt.cacheResponding())
+            backInvalidations[{addr, is_secure}] = req;
+        return;
+    }
+
+    snoop_pkt.allocate();
+    for (const auto& p : holders) {
+        p->sendAtomicSnoop(&snoop_pkt);
+        // restore the request for the remaining snoopers
+        if (snoop_pkt.isResponse())
+            snoop_pkt.cmd = MemCmd::ReadExReq;
+    }
+    snoopFanout.sample(holders.size());
+
+    if (snoop_pkt.cacheResponding()) {
+        Packet wb_pkt(req, MemCmd::WritebackDirty);
+        wb_pkt.dataStatic(snoop_pkt.getConstPtr<uint8_t>());
+        memSidePorts[findPort(wb_pkt.getAddrRange())]->sendAtomic(&wb_pkt);
+    }
+}
+
 void
 CoherentXBar::recvFunctional(PacketPtr pkt, PortID cpu_side_port_id)
 {
@@ -46,6 +46,7 @@
 #ifndef __MEM_COHERENT_XBAR_HH__
 #define __MEM_COHERENT_XBAR_HH__
 
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -264,6 +265,16 @@ class CoherentXBar : public BaseXBar
      */
     std::unordered_map<PacketId, PacketPtr> outstandingCMO;
 
+    /**
+     * Store the back-invalidations of lines evicted from the snoop
+     * filter that a cache with the line dirty will respond to, keyed
+     * by the line address and security state, so that we can write the
+     * data of the response to the memory below. Until then the line is
+     * neither tracked by the snoop filter nor up to date below, and
+     * requests to it are retried.
+     */
+    std::map<std::pair<Addr, bool>, RequestPtr> backInvalidations;
+
     /**
      * Keep a pointer to the system to be allow to querying memory system
      * properties.
@@ -385,6 +396,16 @@ class CoherentXBar : public BaseXBar
      */
     void forwardFunctional(PacketPtr pkt, PortID exclude_cpu_side_port_id);
 
+    /**
+     * Invalidate the line, if any, that the snoop filter evicted on
+     * the last request lookup in the caches above that hold it. Dirty
+     * data is passed on by the caches as for a read-exclusive snoop,
+     * and written to the memory below.
+     *
+     * @param is_timing Whether to use timing or atomic snoops
+     */
+    void backInvalidate(bool is_timing);
+
     /**
      * Determine if the crossbar should sink the packet, as opposed to
      * forwarding it, or responding.
@@ -40,6 +40,9 @@
 
 #include "mem/mem_ctrl.hh"
 
+#include <algorithm>
+
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/DRAM.hh"
 #include "debug/Drain.hh"
@@ -49,6 +52,49 @@
 #include "mem/mem_interface.hh"
 #include "sim/system.hh"
 
+void
+MemPacketQueue::push_back(MemPacket* pkt)
+{
+    pkt->queueSeq = nextSeq++;
+    Base::push_back(pkt);
+
+    BankIndex& index = banks[pkt->isDram()];
+    if (pkt->bankId >= index.packets.size()) {
+        index.packets.resize(pkt->bankId + 1);
+        index.waiting.resize(divCeil(pkt->bankId + 1, 64), 0);
+    }
+    index.packets[pkt->bankId].push_back(pkt);
+    index.waiting[pkt->bankId / 64] |= 1ULL << (pkt->bankId % 64);
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::erase(iterator pos)
+{
+    MemPacket* pkt = *pos;
+
+    BankIndex& index = banks[pkt->isDram()];
+    BankPackets& bank_pkts = index.packets[pkt->bankId];
+    auto it = std::find(bank_pkts.begin(), bank_pkts.end(), pkt);
+    assert(it != bank_pkts.end());
+    bank_pkts.erase(it);
+    if (bank_pkts.empty()) {
+        index.waiting[pkt->bankId / 64] &= ~(1ULL << (pkt->bankId % 64));
+    }
+
+    return Base::erase(pos);
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::find(const MemPacket* pkt)
+{
+    // Packets are only ever appended, so the queue is sorted by
+    // arrival order
+    auto it = std::lower_bound(begin(), end(), pkt->queueSeq,
+        [](const MemPacket* p, uint64_t seq) { return p->queueSeq < seq; });
+    assert(it != end() && *it == pkt);
+    return it;
+}
+
 MemCtrl::MemCtrl(const MemCtrlParams &p) :
     QoS::MemCtrl(p),
     port(name() + ".port", *this), isTimingMode(false),
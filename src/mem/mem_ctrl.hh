@@ -52,6 +52,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/bitfield.hh"
 #include "base/callback.hh"
 #include "base/statistics.hh"
 #include "enums/MemSched.hh"
@@ -146,6 +147,11 @@ class MemPacket
      */
     uint8_t _qosValue;
 
+    /**
+     * Arrival order of the packet in the MemPacketQueue holding it
+     */
+    uint64_t queueSeq = 0;
+
     /**
      * Set the packet QoS value
      * (interface compatibility with Packet)
@@ -205,9 +211,86 @@ class MemPacket
 
 };
 
-// The memory packets are store in a multiple dequeue structure,
-// based on their QoS priority
-typedef std::deque<MemPacket*> MemPacketQueue;
+/**
+ * The memory packets are stored in multiple queues, one per QoS
+ * priority. Besides keeping the packets in arrival order, each queue
+ * buckets them per bank and tracks which banks have packets waiting, so
+ * the schedulers can pick between the oldest packets of each bank
+ * instead of walking the whole queue.
+ */
+class MemPacketQueue : private std::deque<MemPacket*>
+{
+  private:
+    typedef std::deque<MemPacket*> Base;
+
+  public:
+    /** Packets of the queue targeting one bank, oldest first */
+    typedef std::vector<MemPacket*> BankPackets;
+
+    using Base::iterator;
+    using Base::const_iterator;
+    using Base::begin;
+    using Base::end;
+    using Base::empty;
+    using Base::size;
+    using Base::front;
+    using Base::back;
+
+    /** Append a packet to the queue */
+    void push_back(MemPacket* pkt);
+
+    /**
+     * Remove a packet from the queue
+     *
+     * @param pos Position of the packet
+     * @return The position following the removed packet
+     */
+    iterator erase(iterator pos);
+
+    /**
+     * Locate a queued packet, in logarithmic time
+     *
+     * @param pkt The packet to look for
+     * @return Its position in the queue
+     */
+    iterator find(const MemPacket* pkt);
+
+    /**
+     * Call a function for each bank with packets in the queue, in
+     * bank id order
+     *
+     * @param is_dram Whether to visit DRAM or NVM banks
+     * @param visitor Function called with the bank id and its packets
+     */
+    template <typename Visitor>
+    void
+    forEachBank(bool is_dram, Visitor visitor) const
+    {
+        const BankIndex& index = banks[is_dram];
+        for (size_t w = 0; w < index.waiting.size(); ++w) {
+            for (uint64_t bits = index.waiting[w]; bits; bits &= bits - 1) {
+                const uint16_t bank_id = w * 64 + ctz64(bits);
+                visitor(bank_id, index.packets[bank_id]);
+            }
+        }
+    }
+
+  private:
+    struct BankIndex
+    {
+        /** The queued packets of each bank, indexed by bank id */
+        std::vector<BankPackets> packets;
+
+        /** Bitmap of the banks with queued packets */
+        std::vector<uint64_t> waiting;
+    };
+
+    /** The NVM and DRAM banks, whose bank ids overlap */
+    BankIndex banks[2];
+
+    /** Arrival order of the next packet */
+    uint64_t nextSeq = 0;
+};
 
 
 /**
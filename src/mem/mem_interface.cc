@@ -168,116 +168,115 @@ MemInterface::decodePacket(const PacketPtr pkt, Addr pkt_addr,
 std::pair<MemPacketQueue::iterator, Tick>
 DRAMInterface::chooseNextFRFCFS(MemPacketQueue& queue, Tick min_col_at) const
 {
-    std::vector<uint32_t> earliest_banks(ranksPerChannel, 0);
-
-    // Has minBankPrep been called to populate earliest_banks?
-    bool filled_earliest_banks = false;
-    // can the PRE/ACT sequence be done without impacting utlization?
-    bool hidden_bank_prep = false;
-
-    // search for seamless row hits first, if no seamless row hit is
-    // found then determine if there are other packets that can be issued
-    // without incurring additional bus delay due to bank timing
-    // Will select closed rows first to enable more open row possibilies
-    // in future selections
-    bool found_hidden_bank = false;
-
-    // remember if we found a row hit, not seamless, but bank prepped
-    // and ready
-    bool found_prepped_pkt = false;
-
-    // if we have no row hit, prepped or not, and no seamless packet,
-    // just go for the earliest possible
-    bool found_earliest_pkt = false;
+    // The queue buckets its packets per bank, so only the oldest row hit
+    // and the oldest row miss of each bank are candidates. Across banks,
+    // the choice follows the same priorities as a walk through the whole
+    // queue in arrival order:
+    // 1. the oldest row hit that can issue seamlessly
+    // 2. the oldest row miss to one of the earliest banks, if that bank
+    //    can be prepared without impacting utilization
+    // 3. the oldest row hit
+    // 4. the oldest row miss to one of the earliest banks
+    // Read and write queues are kept apart, so all packets of a bank
+    // share the same column timing.
+    auto older = [](const MemPacket* a, const MemPacket* b) {
+        return !b || a->queueSeq < b->queueSeq;
+    };
+    auto col_allowed_at = [this](const MemPacket* pkt) {
+        const Bank& bank = ranks[pkt->rank]->banks[pkt->bank];
+        return pkt->isRead() ? bank.rdAllowedAt : bank.wrAllowedAt;
+    };
+
+    MemPacket* seamless_hit = nullptr;
+    MemPacket* prepped_hit = nullptr;
+    bool found_miss = false;
+
+    queue.forEachBank(true, [&](uint16_t bank_id,
+                                const MemPacketQueue::BankPackets& pkts) {
+        // all packets of a bank share the rank availability
+        MemPacket* first = pkts.front();
+        if (!burstReady(first)) {
+            DPRINTF(DRAM, "%s bank %d - Rank %d not available\n", __func__,
+                    first->bank, first->rank);
+            return;
+        }
 
-    Tick selected_col_at = MaxTick;
-    auto selected_pkt_it = queue.end();
+        const Bank& bank = ranks[first->rank]->banks[first->bank];
+        MemPacket* hit = nullptr;
+        for (MemPacket* pkt : pkts) {
+            if (pkt->row == bank.openRow) {
+                if (!hit)
+                    hit = pkt;
+            } else {
+                found_miss = true;
+            }
+            if (hit && found_miss)
+                break;
+        }
 
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        MemPacket* pkt = *i;
+        if (!hit)
+            return;
 
-        // select optimal DRAM packet in Q
-        if (pkt->isDram()) {
-            const Bank& bank = ranks[pkt->rank]->banks[pkt->bank];
-            const Tick col_allowed_at = pkt->isRead() ? bank.rdAllowedAt :
-                                                        bank.wrAllowedAt;
+        if (col_allowed_at(hit) <= min_col_at) {
+            if (older(hit, seamless_hit))
+                seamless_hit = hit;
+        } else if (older(hit, prepped_hit)) {
+            prepped_hit = hit;
+        }
+    });
 
-            DPRINTF(DRAM, "%s checking DRAM packet in bank %d, row %d\n",
-                    __func__, pkt->bank, pkt->row);
+    MemPacket* selected_pkt = nullptr;
+    if (seamless_hit) {
+        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
+        selected_pkt = seamless_hit;
+    } else {
+        MemPacket* earliest_miss = nullptr;
+        bool hidden_bank_prep = false;
+
+        if (found_miss) {
+            // determine entries with earliest bank delay, minBankPrep
+            // will give priority to packets that can issue seamlessly
+            std::vector<uint32_t> earliest_banks;
+            std::tie(earliest_banks, hidden_bank_prep) =
+                minBankPrep(queue, min_col_at);
+
+            queue.forEachBank(true, [&](uint16_t bank_id,
+                    const MemPacketQueue::BankPackets& pkts) {
+                MemPacket* first = pkts.front();
+                if (!burstReady(first) ||
+                    !bits(earliest_banks[first->rank], first->bank,
+                          first->bank)) {
+                    return;
+                }
 
-            // check if rank is not doing a refresh and thus is available,
-            // if not, jump to the next packet
-            if (burstReady(pkt)) {
-
-                DPRINTF(DRAM,
-                        "%s bank %d - Rank %d available\n", __func__,
-                        pkt->bank, pkt->rank);
-
-                // check if it is a row hit
-                if (bank.openRow == pkt->row) {
-                    // no additional rank-to-rank or same bank-group
-                    // delays, or we switched read/write and might as well
-                    // go for the row hit
-                    if (col_allowed_at <= min_col_at) {
-                        // FCFS within the hits, giving priority to
-                        // commands that can issue seamlessly, without
-                        // additional delay, such as same rank accesses
-                        // and/or different bank-group accesses
-                        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        // no need to look through the remaining queue entries
+                const Bank& bank = ranks[first->rank]->banks[first->bank];
+                for (MemPacket* pkt : pkts) {
+                    if (pkt->row != bank.openRow) {
+                        if (older(pkt, earliest_miss))
+                            earliest_miss = pkt;
                         break;
-                    } else if (!found_hidden_bank && !found_prepped_pkt) {
-                        // if we did not find a packet to a closed row that can
-                        // issue the bank commands without incurring delay, and
-                        // did not yet find a packet to a prepped row, remember
-                        // the current one
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        found_prepped_pkt = true;
-                        DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
-                    }
-                } else if (!found_earliest_pkt) {
-                    // if we have not initialised the bank status, do it
-                    // now, and only once per scheduling decisions
-                    if (!filled_earliest_banks) {
-                        // determine entries with earliest bank delay
-                        std::tie(earliest_banks, hidden_bank_prep) =
-                            minBankPrep(queue, min_col_at);
-                        filled_earliest_banks = true;
-                    }
-
-                    // bank is amongst first available banks
-                    // minBankPrep will give priority to packets that can
-                    // issue seamlessly
-                    if (bits(earliest_banks[pkt->rank],
-                             pkt->bank, pkt->bank)) {
-                        found_earliest_pkt = true;
-                        found_hidden_bank = hidden_bank_prep;
-
-                        // give priority to packets that can issue
-                        // bank commands 'behind the scenes'
-                        // any additional delay if any will be due to
-                        // col-to-col command requirements
-                        if (hidden_bank_prep || !found_prepped_pkt) {
-                            selected_pkt_it = i;
-                            selected_col_at = col_allowed_at;
-                        }
                     }
                 }
-            } else {
-                DPRINTF(DRAM, "%s bank %d - Rank %d not available\n", __func__,
-                        pkt->bank, pkt->rank);
-            }
+            });
+        }
+
+        // give priority to packets that can issue bank commands 'behind
+        // the scenes', then to prepped row hits
+        if (earliest_miss && (hidden_bank_prep || !prepped_hit)) {
+            selected_pkt = earliest_miss;
+        } else if (prepped_hit) {
+            DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
+            selected_pkt = prepped_hit;
         }
     }
 
-    if (selected_pkt_it == queue.end()) {
+    if (!selected_pkt) {
         DPRINTF(DRAM, "%s no available DRAM ranks found\n", __func__);
+        return std::make_pair(queue.end(), MaxTick);
     }
 
-    return std::make_pair(selected_pkt_it, selected_col_at);
+    return std::make_pair(queue.find(selected_pkt),
+                          col_allowed_at(selected_pkt));
 }
 
 void
@@ -1054,10 +1053,11 @@ DRAMInterface::minBankPrep(const MemPacketQueue& queue,
     // determine if we have queued transactions targetting the
     // bank in question
     std::vector<bool> got_waiting(ranksPerChannel * banksPerRank, false);
-    for (const auto& p : queue) {
-        if (p->isDram() && ranks[p->rank]->inRefIdleState())
-            got_waiting[p->bankId] = true;
-    }
+    queue.forEachBank(true, [&](uint16_t bank_id,
+                                const MemPacketQueue::BankPackets& pkts) {
+        if (ranks[pkts.front()->rank]->inRefIdleState())
+            got_waiting[bank_id] = true;
+    });
 
     // Find command with optimal bank timing
     // Will prioritize commands that can issue seamlessly.
@@ -2079,57 +2079,54 @@ void NVMInterface::setupRank(const uint8_t rank, const bool is_read)
 std::pair<MemPacketQueue::iterator, Tick>
 NVMInterface::chooseNextFRFCFS(MemPacketQueue& queue, Tick min_col_at) const
 {
-    // remember if we found a hit, but one that cannit issue seamlessly
-    bool found_prepped_pkt = false;
-
-    auto selected_pkt_it = queue.end();
-    Tick selected_col_at = MaxTick;
-
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        MemPacket* pkt = *i;
+    MemPacket* seamless_pkt = nullptr;
+    MemPacket* prepped_pkt = nullptr;
+    Tick seamless_col_at = MaxTick;
+    Tick prepped_col_at = MaxTick;
+
+    // Only the oldest packet of each bank that is ready can be picked,
+    // as later packets to the same bank share its timing. Pick the
+    // oldest one that can issue seamlessly, or else the oldest one.
+    queue.forEachBank(false, [&](uint16_t bank_id,
+                                 const MemPacketQueue::BankPackets& pkts) {
+        for (MemPacket* pkt : pkts) {
+            // check if rank is not doing a refresh and thus is available,
+            // if not, jump to the next packet
+            if (!burstReady(pkt)) {
+                DPRINTF(NVM, "%s bank %d - Rank %d not available\n",
+                        __func__, pkt->bank, pkt->rank);
+                continue;
+            }
 
-        // select optimal NVM packet in Q
-        if (!pkt->isDram()) {
             const Bank& bank = ranks[pkt->rank]->banks[pkt->bank];
             const Tick col_allowed_at = pkt->isRead() ? bank.rdAllowedAt :
                                                         bank.wrAllowedAt;
 
-            // check if rank is not doing a refresh and thus is available,
-            // if not, jump to the next packet
-            if (burstReady(pkt)) {
-                DPRINTF(NVM, "%s bank %d - Rank %d available\n", __func__,
-                        pkt->bank, pkt->rank);
-
-                // no additional rank-to-rank or media delays
-                if (col_allowed_at <= min_col_at) {
-                    // FCFS within entries that can issue without
-                    // additional delay, such as same rank accesses
-                    // or media delay requirements
-                    selected_pkt_it = i;
-                    selected_col_at = col_allowed_at;
-                    // no need to look through the remaining queue entries
-                    DPRINTF(NVM, "%s Seamless buffer hit\n", __func__);
-                    break;
-                } else if (!found_prepped_pkt) {
-                    // packet is to prepped region but cannnot issue
-                    // seamlessly; remember this one and continue
-                    selected_pkt_it = i;
-                    selected_col_at = col_allowed_at;
-                    DPRINTF(NVM, "%s Prepped packet found \n", __func__);
-                    found_prepped_pkt = true;
+            // no additional rank-to-rank or media delays
+            if (col_allowed_at <= min_col_at) {
+                if (!seamless_pkt || pkt->queueSeq < seamless_pkt->queueSeq) {
+                    seamless_pkt = pkt;
+                    seamless_col_at = col_allowed_at;
                 }
-            } else {
-                DPRINTF(NVM, "%s bank %d - Rank %d not available\n", __func__,
-                        pkt->bank, pkt->rank);
+            } else if (!prepped_pkt ||
+                       pkt->queueSeq < prepped_pkt->queueSeq) {
+                prepped_pkt = pkt;
+                prepped_col_at = col_allowed_at;
             }
+            break;
         }
-    }
+    });
 
-    if (selected_pkt_it == queue.end()) {
-        DPRINTF(NVM, "%s no available NVM ranks found\n", __func__);
+    if (seamless_pkt) {
+        DPRINTF(NVM, "%s Seamless buffer hit\n", __func__);
+        return std::make_pair(queue.find(seamless_pkt), seamless_col_at);
+    } else if (prepped_pkt) {
+        DPRINTF(NVM, "%s Prepped packet found \n", __func__);
+        return std::make_pair(queue.find(prepped_pkt), prepped_col_at);
     }
 
-    return std::make_pair(selected_pkt_it, selected_col_at);
+    DPRINTF(NVM, "%s no available NVM ranks found\n", __func__);
+    return std::make_pair(queue.end(), MaxTick);
 }
 
 void
@@ -237,6 +237,9 @@ MemCmd::commandInfo[] =
     { SET2(IsRead, IsRequest), InvalidCmd, "HTMAbort" },
 };
 
+FreeListPool Packet::pool("packets", sizeof(Packet));
+FreeListPool Packet::dataPool("packet_data", 64);
+
 AddrRange
 Packet::getAddrRange() const
 {
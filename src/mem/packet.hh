@@ -55,6 +55,7 @@
 #include "base/cast.hh"
 #include "base/compiler.hh"
 #include "base/flags.hh"
+#include "base/free_list_pool.hh"
 #include "base/logging.hh"
 #include "base/printable.hh"
 #include "base/types.hh"
@@ -317,6 +318,10 @@ class Packet : public Printable
         /// the packet is destroyed. The pointer is assumed to be pointing
         /// to an array, and delete [] is consequently called
         DYNAMIC_DATA           = 0x00002000,
+        /// The dynamic data was taken from the packet data pool rather
+        /// than allocated with new [], and is given back to it when the
+        /// packet is destroyed.
+        POOLED_DATA            = 0x00004000,
 
         /// suppress the error if this packet encounters a functional
         /// access failure.
@@ -350,6 +355,12 @@ class Packet : public Printable
     */
     PacketDataPtr data;
 
+    /// Pool that packets are allocated from.
+    static FreeListPool pool;
+
+    /// Pool for data payloads of up to a cache line.
+    static FreeListPool dataPool;
+
     /// The address of the request.  This address could be virtual or
     /// physical, depending on the system configuration.
     Addr addr;
@@ -997,6 +1008,24 @@ class Packet : public Printable
         deleteData();
     }
 
+    /**
+     * Packets are created and destroyed at a very high rate, so they are
+     * recycled through a per-thread free list rather than going to the
+     * heap every time.
+     */
+    static void *
+    operator new(size_t size)
+    {
+        assert(size == sizeof(Packet));
+        return pool.allocate();
+    }
+
+    static void
+    operator delete(void *p)
+    {
+        pool.release(p);
+    }
+
     /**
      * Take a request packet and modify it in place to be suitable for
      * returning as a response to that request.
@@ -1288,10 +1317,12 @@ class Packet : public Printable
     void
     deleteData()
     {
-        if (flags.isSet(DYNAMIC_DATA))
+        if (flags.isSet(POOLED_DATA))
+            dataPool.release(data);
+        else if (flags.isSet(DYNAMIC_DATA))
             delete [] data;
 
-        flags.clear(STATIC_DATA|DYNAMIC_DATA);
+        flags.clear(STATIC_DATA|DYNAMIC_DATA|POOLED_DATA);
         data = NULL;
     }
 
@@ -1304,7 +1335,14 @@ class Packet : public Printable
         if (hasData() || hasRespData()) {
             assert(flags.noneSet(STATIC_DATA|DYNAMIC_DATA));
             flags.set(DYNAMIC_DATA);
-            data = new uint8_t[getSize()];
+            // Payloads of up to a cache line are by far the most
+            // common, and are taken from a pool
+            if (getSize() <= dataPool.chunkSize()) {
+                flags.set(POOLED_DATA);
+                data = static_cast<uint8_t *>(dataPool.allocate());
+            } else {
+                data = new uint8_t[getSize()];
+            }
         }
     }
 
@@ -71,9 +71,17 @@
 PhysicalMemory::PhysicalMemory(const std::string& _name,
                                const std::vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve,
-                               const std::string& shared_backstore) :
+                               const std::string& shared_backstore,
+                               bool chunked_checkpoints,
+                               unsigned checkpoint_threads,
+                               int checkpoint_level,
+                               bool incremental_checkpoints) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
-    sharedBackstore(shared_backstore)
+    sharedBackstore(shared_backstore),
+    chunkedCheckpoints(chunked_checkpoints),
+    checkpointThreads(checkpoint_threads),
+    checkpointLevel(checkpoint_level),
+    incrementalCheckpoints(incremental_checkpoints)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -230,6 +238,8 @@ PhysicalMemory::createBackingStore(
     // it appropriately
     backingStore.emplace_back(range, pmem,
                               conf_table_reported, in_addr_map, kvm_map);
+    chunkedStores.emplace_back(checkpointThreads, checkpointLevel,
+                               incrementalCheckpoints);
 
     // point the memories to their backing store
     for (const auto& m : _memories) {
@@ -342,14 +352,26 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 {
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    std::string filename =
-        name() + ".store" + std::to_string(store_id) + ".pmem";
+    std::string filename = name() + ".store" + std::to_string(store_id) +
+        (chunkedCheckpoints ? ".chunks" : ".pmem");
     long range_size = range.size();
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
             filename, range_size);
 
     SERIALIZE_SCALAR(store_id);
+
+    if (chunkedCheckpoints) {
+        std::string format = "chunked";
+        SERIALIZE_SCALAR(format);
+        SERIALIZE_SCALAR(filename);
+        SERIALIZE_SCALAR(range_size);
+
+        chunkedStores[store_id].write(CheckpointIn::dir() + "/" + filename,
+                                      pmem, range.size());
+        return;
+    }
+
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
 
@@ -420,6 +442,25 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     std::string filepath = cp.getCptDir() + "/" + filename;
 
+    // checkpoints which don't name a format hold gzipped files
+    std::string format = "gzip";
+    UNSERIALIZE_OPT_SCALAR(format);
+    if (format == "chunked") {
+        long range_size;
+        UNSERIALIZE_SCALAR(range_size);
+
+        DPRINTF(Checkpoint, "Unserializing chunked physical memory %s "
+                "with size %d\n", filename, range_size);
+
+        // raw chunks can only be mapped over a private backing store
+        chunkedStores[store_id].read(filepath, backingStore[store_id].pmem,
+                                     backingStore[store_id].range.size(),
+                                     sharedBackstore.empty());
+        return;
+    }
+    fatal_if(format != "gzip", "Unknown physical memory checkpoint "
+             "format '%s'\n", format);
+
     // mmap memoryfile
     gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
     if (compressed_mem == NULL)
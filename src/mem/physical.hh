@@ -44,6 +44,7 @@
 
 #include "base/addr_range.hh"
 #include "base/addr_range_map.hh"
+#include "mem/chunked_store.hh"
 #include "mem/packet.hh"
 #include "sim/serialize.hh"
 
@@ -135,10 +136,21 @@ class PhysicalMemory : public Serializable
 
     const std::string sharedBackstore;
 
+    // Whether to checkpoint the backing stores as chunked images rather
+    // than gzipped files, and how
+    const bool chunkedCheckpoints;
+    const unsigned checkpointThreads;
+    const int checkpointLevel;
+    const bool incrementalCheckpoints;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
 
+    // The chunked images of the backing stores, which remember the last
+    // image of each store for incremental checkpoints
+    mutable std::vector<ChunkedStore> chunkedStores;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -167,7 +179,11 @@ class PhysicalMemory : public Serializable
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
-                   const std::string& shared_backstore);
+                   const std::string& shared_backstore,
+                   bool chunked_checkpoints=false,
+                   unsigned checkpoint_threads=0,
+                   int checkpoint_level=1,
+                   bool incremental_checkpoints=false);
 
     /**
      * Unmap all the backing store we have used.
@@ -55,13 +55,15 @@ MemTraceProbe::MemTraceProbe(const MemTraceProbeParams &p)
         // append the current simulation output directory
         filename = simout.resolve(p.trace_file);
 
-        const std::string suffix = ".gz";
         // If trace_compress has been set, check the suffix. Append
-        // accordingly.
-        if (p.trace_compress &&
-            filename.compare(filename.size() - suffix.size(), suffix.size(),
-                             suffix) != 0)
-            filename = filename + suffix;
+        // accordingly, unless a zstd compressed trace was asked for.
+        auto has_suffix = [&filename](const std::string &suffix) {
+            return filename.size() >= suffix.size() &&
+                filename.compare(filename.size() - suffix.size(),
+                                 suffix.size(), suffix) == 0;
+        };
+        if (p.trace_compress && !has_suffix(".gz") && !has_suffix(".zst"))
+            filename = filename + ".gz";
     } else {
         // Generate a filename from the name of the SimObject. Append .trc
         // and .gz if we want compression enabled.
@@ -116,5 +118,7 @@ MemTraceProbe::handleRequest(const ProbePoints::PacketInfo &pkt_info)
         pkt_msg.set_pc(pkt_info.pc);
     pkt_msg.set_pkt_id(pkt_info.id);
 
+    // Let a seekable trace be entered at the tick of any packet
+    traceStream->seekPoint(curTick());
     traceStream->write(pkt_msg);
 }
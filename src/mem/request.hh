@@ -54,10 +54,12 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/amo.hh"
 #include "base/flags.hh"
+#include "base/free_list_pool.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "mem/htm.hh"
@@ -423,6 +425,9 @@ class Request
     /** The cause for HTM transaction abort */
     HtmFailureFaultCause _htmAbortCause = HtmFailureFaultCause::INVALID;
 
+    /** Pool that requests are allocated from, see create(). */
+    static FreeListPool pool;
+
   public:
 
     /**
@@ -475,6 +480,20 @@ class Request
 
     ~Request() {}
 
+    /**
+     * Create a new request, passing the arguments on to the matching
+     * constructor. Use this rather than std::make_shared<Request> as
+     * requests (and their reference counts) are then recycled through a
+     * per-thread pool instead of going to the heap.
+     */
+    template <typename ...Args>
+    static RequestPtr
+    create(Args&&... args)
+    {
+        return std::allocate_shared<Request>(PoolAllocator<Request>(pool),
+                                             std::forward<Args>(args)...);
+    }
+
     /**
      * Set up Context numbers.
      */
@@ -548,8 +567,8 @@ class Request
         assert(hasVaddr());
         assert(!hasPaddr());
         assert(split_addr > _vaddr && split_addr < _vaddr + _size);
-        req1 = std::make_shared<Request>(*this);
-        req2 = std::make_shared<Request>(*this);
+        req1 = Request::create(*this);
+        req2 = Request::create(*this);
         req1->_size = split_addr - _vaddr;
         req2->_vaddr = split_addr;
         req2->_size = _size - req1->_size;
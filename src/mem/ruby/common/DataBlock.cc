@@ -40,52 +40,223 @@
 
 #include "mem/ruby/common/DataBlock.hh"
 
+#include <mutex>
+#include <vector>
+
 #include "mem/ruby/common/WriteMask.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
+FreeListPool DataBlock::payloadPool("ruby_data_blocks",
+                                    sizeof(DataBlock::Payload) + 64);
+
+namespace
+{
+
+/**
+ * The copy statistics of one thread. As for FreeListPool, only the
+ * owning thread writes the counters, and the live ones are tracked so
+ * that they can be summed up from any thread.
+ */
+struct CopyCounters
+{
+    std::atomic<uint64_t> bytesCopied{0};
+    std::atomic<uint64_t> sharedCopies{0};
+
+    CopyCounters();
+    ~CopyCounters();
+};
+
+std::mutex countersMutex;
+std::vector<CopyCounters *> liveCounters;
+/** Counts from threads which have exited, protected by countersMutex */
+uint64_t retiredBytesCopied = 0;
+uint64_t retiredSharedCopies = 0;
+
+CopyCounters::CopyCounters()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    liveCounters.push_back(this);
+}
+
+CopyCounters::~CopyCounters()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    for (auto it = liveCounters.begin(); it != liveCounters.end(); ++it) {
+        if (*it == this) {
+            liveCounters.erase(it);
+            break;
+        }
+    }
+    retiredBytesCopied += bytesCopied;
+    retiredSharedCopies += sharedCopies;
+}
+
+CopyCounters &
+threadCounters()
+{
+    static thread_local CopyCounters counters;
+    return counters;
+}
+
+void
+bump(std::atomic<uint64_t> &c, uint64_t n)
+{
+    c.store(c.load(std::memory_order_relaxed) + n,
+            std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
 DataBlock::DataBlock(const DataBlock &cp)
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
-    m_alloc = true;
+    if (cp.m_payload) {
+        acquire(cp.m_payload);
+        countSharedCopy();
+    } else {
+        // External storage can change under our feet, it cannot be shared
+        acquire(allocPayload());
+        memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+        countBytesCopied(RubySystem::getBlockSizeBytes());
+    }
+}
+
+DataBlock::Payload *
+DataBlock::allocPayload()
+{
+    const uint32_t size = RubySystem::getBlockSizeBytes();
+    void *raw = sizeof(Payload) + size <= payloadPool.chunkSize() ?
+        payloadPool.allocate() : ::operator new(sizeof(Payload) + size);
+    Payload *payload = new (raw) Payload;
+    payload->refCount.store(0, std::memory_order_relaxed);
+    payload->size = size;
+    return payload;
+}
+
+void
+DataBlock::freePayload(Payload *payload)
+{
+    const size_t bytes = sizeof(Payload) + payload->size;
+    payload->~Payload();
+    if (bytes <= payloadPool.chunkSize())
+        payloadPool.release(payload);
+    else
+        ::operator delete(payload);
+}
+
+DataBlock::Payload *
+DataBlock::zeroPayload()
+{
+    // Each thread has its own, so that the threads do not fight over
+    // its reference count. It holds a reference of its own, and is
+    // only replaced if the block size changes.
+    static thread_local Payload *zero = nullptr;
+    if (!zero || zero->size != RubySystem::getBlockSizeBytes()) {
+        if (zero)
+            releasePayload(zero);
+        zero = allocPayload();
+        zero->refCount.store(1, std::memory_order_relaxed);
+        memset(zero->data(), 0, zero->size);
+    }
+    return zero;
+}
+
+void
+DataBlock::unshare()
+{
+    Payload *old = m_payload;
+    acquire(allocPayload());
+    memcpy(m_data, old->data(), RubySystem::getBlockSizeBytes());
+    countBytesCopied(RubySystem::getBlockSizeBytes());
+    // The other blocks may have let go of the old payload meanwhile
+    releasePayload(old);
+}
+
+void
+DataBlock::countBytesCopied(uint64_t bytes)
+{
+    bump(threadCounters().bytesCopied, bytes);
 }
 
 void
-DataBlock::alloc()
+DataBlock::countSharedCopy()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    m_alloc = true;
-    clear();
+    bump(threadCounters().sharedCopies, 1);
+}
+
+uint64_t
+DataBlock::getBytesCopied()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    uint64_t total = retiredBytesCopied;
+    for (auto *counters: liveCounters)
+        total += counters->bytesCopied;
+    return total;
+}
+
+uint64_t
+DataBlock::getSharedCopies()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+    uint64_t total = retiredSharedCopies;
+    for (auto *counters: liveCounters)
+        total += counters->sharedCopies;
+    return total;
+}
+
+void
+DataBlock::resetStats()
+{
+    // Only called while the event queues are stopped, so no thread is
+    // updating its counters
+    std::lock_guard<std::mutex> lock(countersMutex);
+    retiredBytesCopied = 0;
+    retiredSharedCopies = 0;
+    for (auto *counters: liveCounters) {
+        counters->bytesCopied = 0;
+        counters->sharedCopies = 0;
+    }
 }
 
 void
 DataBlock::clear()
 {
-    memset(m_data, 0, RubySystem::getBlockSizeBytes());
+    if (m_payload) {
+        release();
+        acquire(zeroPayload());
+    } else {
+        memset(m_data, 0, RubySystem::getBlockSizeBytes());
+    }
 }
 
 bool
 DataBlock::equal(const DataBlock& obj) const
 {
-    return !memcmp(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    return m_data == obj.m_data ||
+        !memcmp(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
 }
 
 void
 DataBlock::copyPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
+    uint64_t copied = 0;
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         if (mask.getMask(i, 1)) {
             m_data[i] = dblk.m_data[i];
+            copied++;
         }
     }
+    countBytesCopied(copied);
 }
 
 void
 DataBlock::atomicPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         m_data[i] = dblk.m_data[i];
     }
+    countBytesCopied(RubySystem::getBlockSizeBytes());
     mask.performAtomic(m_data);
 }
 
@@ -111,12 +282,14 @@ DataBlock::getData(int offset, int len) const
 uint8_t*
 DataBlock::getDataMod(int offset)
 {
+    makeWritable();
     return &m_data[offset];
 }
 
 void
 DataBlock::setData(const uint8_t *data, int offset, int len)
 {
+    makeWritable();
     memcpy(&m_data[offset], data, len);
 }
 
@@ -125,12 +298,28 @@ DataBlock::setData(PacketPtr pkt)
 {
     int offset = getOffset(pkt->getAddr());
     assert(offset + pkt->getSize() <= RubySystem::getBlockSizeBytes());
+    makeWritable();
     pkt->writeData(&m_data[offset]);
 }
 
 DataBlock &
 DataBlock::operator=(const DataBlock & obj)
 {
-    memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    if (m_payload && obj.m_payload) {
+        if (m_payload != obj.m_payload) {
+            release();
+            acquire(obj.m_payload);
+            countSharedCopy();
+        }
+    } else if (m_data != obj.m_data) {
+        // Either side uses external storage, so the data must be copied
+        if (m_payload &&
+            m_payload->refCount.load(std::memory_order_acquire) > 1) {
+            release();
+            acquire(allocPayload());
+        }
+        memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+        countBytesCopied(RubySystem::getBlockSizeBytes());
+    }
     return *this;
 }
@@ -43,28 +43,42 @@
 
 #include <inttypes.h>
 
+#include <atomic>
 #include <cassert>
 #include <iomanip>
 #include <iostream>
 
+#include "base/free_list_pool.hh"
 #include "mem/packet.hh"
 
 class WriteMask;
 
+/**
+ * The data of a cache block. The bytes are kept in a reference counted
+ * payload that copies of the block share until one of them is written,
+ * so blocks forwarded unchanged between messages, TBEs and cache entries
+ * do not allocate nor copy any data. All the blocks holding zeros share
+ * a payload of their thread. A block can also be made to operate on
+ * external storage with assign(), in which case copies into the block
+ * write through to that storage.
+ *
+ * Blocks are passed between controllers and networks which may run on
+ * different event queue threads, so the reference counts are atomic,
+ * and the free payloads and the statistics are kept per thread.
+ */
 class DataBlock
 {
   public:
     DataBlock()
     {
-        alloc();
+        acquire(zeroPayload());
     }
 
     DataBlock(const DataBlock &cp);
 
     ~DataBlock()
     {
-        if (m_alloc)
-            delete [] m_data;
+        release();
     }
 
     DataBlock& operator=(const DataBlock& obj);
@@ -84,21 +98,83 @@ class DataBlock
     bool equal(const DataBlock& obj) const;
     void print(std::ostream& out) const;
 
+    /** Number of bytes copied between blocks since the last reset */
+    static uint64_t getBytesCopied();
+    /** Number of block copies that shared the payload instead */
+    static uint64_t getSharedCopies();
+    static void resetStats();
+
   private:
-    void alloc();
+    /**
+     * Header of the storage of a block, followed in memory by the block
+     * data. Unused payloads go back to a pool for reuse.
+     */
+    struct Payload
+    {
+        /** Number of blocks using the payload */
+        std::atomic<uint32_t> refCount;
+        /** Number of data bytes, which can change between Ruby systems */
+        uint32_t size;
+
+        uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+    };
+
+    static Payload *allocPayload();
+    static void freePayload(Payload *payload);
+    static Payload *zeroPayload();
+
+    static void
+    releasePayload(Payload *payload)
+    {
+        if (payload->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            freePayload(payload);
+    }
+
+    void
+    acquire(Payload *payload)
+    {
+        payload->refCount.fetch_add(1, std::memory_order_relaxed);
+        m_payload = payload;
+        m_data = payload->data();
+    }
+
+    void
+    release()
+    {
+        if (m_payload)
+            releasePayload(m_payload);
+    }
+
+    /** Gives this block a payload of its own before a write */
+    void
+    makeWritable()
+    {
+        if (m_payload &&
+            m_payload->refCount.load(std::memory_order_acquire) > 1) {
+            unshare();
+        }
+    }
+    void unshare();
+
+    /** Count bytes copied, and copies avoided, by the calling thread */
+    static void countBytesCopied(uint64_t bytes);
+    static void countSharedCopy();
+
     uint8_t *m_data;
-    bool m_alloc;
+    /** Storage of the block, nullptr if using external storage */
+    Payload *m_payload;
+
+    /** Payloads of blocks of up to 64 bytes, larger ones use the heap */
+    static FreeListPool payloadPool;
 };
 
 inline void
 DataBlock::assign(uint8_t *data)
 {
     assert(data != NULL);
-    if (m_alloc) {
-        delete [] m_data;
-    }
+    release();
     m_data = data;
-    m_alloc = false;
+    m_payload = nullptr;
 }
 
 inline uint8_t
@@ -110,6 +186,7 @@ DataBlock::getByte(int whichByte) const
 inline void
 DataBlock::setByte(int whichByte, uint8_t data)
 {
+    makeWritable();
     m_data[whichByte] = data;
 }
 
@@ -117,6 +194,7 @@ inline void
 DataBlock::copyPartial(const DataBlock & dblk, int offset, int len)
 {
     setData(&dblk.m_data[offset], offset, len);
+    countBytesCopied(len);
 }
 
 inline std::ostream&
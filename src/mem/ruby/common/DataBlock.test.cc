@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "mem/ruby/common/DataBlock.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+// The test does not create a Ruby system, it only needs its block size
+uint32_t RubySystem::m_block_size_bytes = 64;
+uint32_t RubySystem::m_block_size_bits = 6;
+
+namespace
+{
+
+const int blockSize = 64;
+
+/** Check that every byte of a block has the given value. */
+::testing::AssertionResult
+allBytes(const DataBlock &blk, uint8_t value)
+{
+    for (int i = 0; i < blockSize; i++) {
+        if (blk.getByte(i) != value) {
+            return ::testing::AssertionFailure() << "byte " << i
+                << " is " << (int)blk.getByte(i);
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+DataBlock
+filledBlock(uint8_t value)
+{
+    DataBlock blk;
+    for (int i = 0; i < blockSize; i++)
+        blk.setByte(i, value);
+    return blk;
+}
+
+} // anonymous namespace
+
+TEST(DataBlockTest, DefaultIsZero)
+{
+    DataBlock a, b;
+    EXPECT_TRUE(allBytes(a, 0));
+    // zero blocks share their storage
+    EXPECT_EQ(a.getData(0, blockSize), b.getData(0, blockSize));
+}
+
+TEST(DataBlockTest, CopySharesUntilWritten)
+{
+    DataBlock::resetStats();
+    DataBlock a = filledBlock(0x11);
+    DataBlock b(a);
+    EXPECT_EQ(a.getData(0, blockSize), b.getData(0, blockSize));
+    EXPECT_GT(DataBlock::getSharedCopies(), 0);
+
+    const uint64_t copied = DataBlock::getBytesCopied();
+    b.setByte(3, 0x22);
+    EXPECT_NE(a.getData(0, blockSize), b.getData(0, blockSize));
+    EXPECT_EQ(DataBlock::getBytesCopied(), copied + blockSize);
+
+    EXPECT_TRUE(allBytes(a, 0x11));
+    EXPECT_EQ(b.getByte(3), 0x22);
+    EXPECT_EQ(b.getByte(2), 0x11);
+
+    // the block now owns its storage, so writes no longer copy it
+    b.setByte(4, 0x33);
+    EXPECT_EQ(DataBlock::getBytesCopied(), copied + blockSize);
+    EXPECT_TRUE(allBytes(a, 0x11));
+}
+
+TEST(DataBlockTest, AssignShares)
+{
+    DataBlock a = filledBlock(0x44);
+    DataBlock b = filledBlock(0x55);
+    b = a;
+    EXPECT_EQ(a.getData(0, blockSize), b.getData(0, blockSize));
+    EXPECT_TRUE(a == b);
+
+    uint8_t bytes[4] = {1, 2, 3, 4};
+    a.setData(bytes, 8, sizeof(bytes));
+    EXPECT_TRUE(allBytes(b, 0x44));
+    EXPECT_EQ(a.getByte(9), 2);
+    EXPECT_FALSE(a == b);
+
+    // assigning a block to itself, or to one sharing its storage
+    const DataBlock &self = b;
+    b = self;
+    DataBlock c(b);
+    c = b;
+    EXPECT_TRUE(allBytes(c, 0x44));
+}
+
+TEST(DataBlockTest, WriteAfterShareLeavesOthers)
+{
+    DataBlock a = filledBlock(0x66);
+    std::vector<DataBlock> copies(4, a);
+    copies[1].getDataMod(0)[0] = 0x77;
+    copies[2].clear();
+
+    EXPECT_TRUE(allBytes(a, 0x66));
+    EXPECT_TRUE(allBytes(copies[0], 0x66));
+    EXPECT_EQ(copies[1].getByte(0), 0x77);
+    EXPECT_EQ(copies[1].getByte(1), 0x66);
+    EXPECT_TRUE(allBytes(copies[2], 0));
+    EXPECT_TRUE(allBytes(copies[3], 0x66));
+
+    // the last owner of a payload can write it in place
+    copies.clear();
+    const uint8_t *data = a.getData(0, blockSize);
+    a.setByte(0, 0x88);
+    EXPECT_EQ(a.getData(0, blockSize), data);
+}
+
+TEST(DataBlockTest, ExternalStorage)
+{
+    uint8_t storage[blockSize];
+    memset(storage, 0x99, sizeof(storage));
+
+    DataBlock ext;
+    ext.assign(storage);
+    EXPECT_TRUE(allBytes(ext, 0x99));
+
+    // writes and copies into the block go to the storage
+    ext.setByte(0, 0x10);
+    EXPECT_EQ(storage[0], 0x10);
+    ext = filledBlock(0x20);
+    EXPECT_EQ(storage[5], 0x20);
+
+    // copies of the block do not follow later changes of the storage
+    DataBlock copy(ext);
+    DataBlock assigned;
+    assigned = ext;
+    storage[7] = 0x30;
+    EXPECT_TRUE(allBytes(copy, 0x20));
+    EXPECT_TRUE(allBytes(assigned, 0x20));
+    EXPECT_EQ(ext.getByte(7), 0x30);
+
+    ext.clear();
+    EXPECT_TRUE(allBytes(ext, 0));
+    EXPECT_EQ(storage[7], 0);
+    EXPECT_TRUE(allBytes(copy, 0x20));
+}
+
+TEST(DataBlockTest, Clear)
+{
+    DataBlock a = filledBlock(0xaa);
+    DataBlock b(a);
+    b.clear();
+    EXPECT_TRUE(allBytes(b, 0));
+    EXPECT_TRUE(allBytes(a, 0xaa));
+
+    // cleared blocks share the zero storage, which writes do not change
+    DataBlock zero;
+    EXPECT_EQ(b.getData(0, blockSize), zero.getData(0, blockSize));
+    b.setByte(1, 0xbb);
+    EXPECT_TRUE(allBytes(zero, 0));
+    EXPECT_TRUE(allBytes(DataBlock(), 0));
+}
+
+/**
+ * Blocks are handed between threads, which copy, write and drop their
+ * copies concurrently.
+ */
+TEST(DataBlockTest, ShareAcrossThreads)
+{
+    const DataBlock shared = filledBlock(0xcc);
+    const int num_threads = 4;
+
+    std::vector<std::thread> threads;
+    std::vector<bool> ok(num_threads, false);
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&shared, &ok, t]() {
+            bool good = true;
+            std::vector<DataBlock> blocks;
+            for (int i = 0; i < 10000; i++) {
+                blocks.push_back(shared);
+                if (i % 3 == 0)
+                    blocks.back().setByte(i % blockSize, t);
+                if (i % 5 == 0)
+                    blocks.back().clear();
+                if (blocks.size() > 16)
+                    blocks.erase(blocks.begin());
+            }
+            for (int i = 0; i < blockSize; i++)
+                good = good && shared.getByte(i) == 0xcc;
+            ok[t] = good;
+        });
+    }
+    for (auto &thread: threads)
+        thread.join();
+
+    for (int t = 0; t < num_threads; t++)
+        EXPECT_TRUE(ok[t]);
+    EXPECT_TRUE(allBytes(shared, 0xcc));
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/ArrivalQueue.hh"
+
+#include <algorithm>
+#include <functional>
+
+void
+ArrivalQueue::push(MsgPtr message)
+{
+    if (!m_sorted) {
+        m_heap.push_back(std::move(message));
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<MsgPtr>());
+        return;
+    }
+
+    if (m_ring.empty() || !(m_ring.back() > message)) {
+        m_ring.push_back(std::move(message));
+    } else if (message > m_ring.front()) {
+        auto it = std::upper_bound(m_ring.begin(), m_ring.end(), message,
+            [](const MsgPtr &a, const MsgPtr &b) { return b > a; });
+        m_ring.insert(it, std::move(message));
+    } else {
+        m_ring.push_front(std::move(message));
+    }
+}
+
+MsgPtr
+ArrivalQueue::pop()
+{
+    MsgPtr message;
+    if (m_sorted) {
+        message = std::move(m_ring.front());
+        m_ring.pop_front();
+    } else {
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<MsgPtr>());
+        message = std::move(m_heap.back());
+        m_heap.pop_back();
+    }
+    return message;
+}
+
+void
+ArrivalQueue::clear()
+{
+    m_heap.clear();
+    m_ring.clear();
+}
+
+std::vector<MsgPtr>
+ArrivalQueue::sorted() const
+{
+    if (m_sorted) {
+        return std::vector<MsgPtr>(m_ring.rbegin(), m_ring.rend());
+    }
+    std::vector<MsgPtr> copy(m_heap);
+    std::sort_heap(copy.begin(), copy.end(), std::greater<MsgPtr>());
+    return copy;
+}
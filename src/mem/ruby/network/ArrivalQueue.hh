@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_ARRIVALQUEUE_HH__
+#define __MEM_RUBY_NETWORK_ARRIVALQUEUE_HH__
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/*
+ * The messages of a MessageBuffer ordered by arrival time, and by
+ * enqueue order among messages with the same arrival time.
+ *
+ * The messages are either kept in a binary heap, or in a ring sorted by
+ * arrival. Messages mostly arrive in order, as each buffer is fed by a
+ * few senders with similar latencies, so the ring inserts most messages
+ * at its back and pops them from its front without moving any others.
+ * Out of order arrivals, and stalled messages put back in the queue,
+ * are placed with a binary search.
+ */
+class ArrivalQueue
+{
+  public:
+    explicit ArrivalQueue(bool sorted) : m_sorted(sorted) {}
+
+    bool empty() const { return m_sorted ? m_ring.empty() : m_heap.empty(); }
+
+    size_t
+    size() const
+    {
+        return m_sorted ? m_ring.size() : m_heap.size();
+    }
+
+    //! The message with the earliest arrival. The queue must not be empty.
+    const MsgPtr &
+    front() const
+    {
+        return m_sorted ? m_ring.front() : m_heap.front();
+    }
+
+    void push(MsgPtr message);
+
+    //! Removes and returns the message with the earliest arrival
+    MsgPtr pop();
+
+    void clear();
+
+    //! Calls f on every message, in no particular order
+    template <typename F>
+    void
+    forEach(F f) const
+    {
+        if (m_sorted) {
+            for (const MsgPtr &m : m_ring)
+                f(m);
+        } else {
+            for (const MsgPtr &m : m_heap)
+                f(m);
+        }
+    }
+
+    //! Returns a copy of the messages, latest arrival first
+    std::vector<MsgPtr> sorted() const;
+
+  private:
+    const bool m_sorted;
+    std::vector<MsgPtr> m_heap;
+    std::deque<MsgPtr> m_ring;
+};
+
+#endif // __MEM_RUBY_NETWORK_ARRIVALQUEUE_HH__
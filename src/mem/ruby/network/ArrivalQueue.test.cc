@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/ruby/network/ArrivalQueue.hh"
+
+namespace
+{
+
+/** A message which only carries an arrival time and an id. */
+class TestMsg : public Message
+{
+  public:
+    TestMsg(Tick arrival, uint64_t id) : Message(0)
+    {
+        setLastEnqueueTime(arrival);
+        setMsgCounter(id);
+    }
+
+    MsgPtr clone() const override { return MsgPtr(new TestMsg(*this)); }
+    void print(std::ostream &out) const override {}
+};
+
+struct Arrival
+{
+    Tick time;
+    uint64_t id;
+};
+
+/**
+ * Messages arriving mostly in order, with some arriving late, some early
+ * and some at the same time as others.
+ */
+const std::vector<Arrival> arrivals = {
+    {100, 0}, {200, 1}, {200, 2}, {150, 3}, {300, 4}, {50, 5},
+    {300, 6}, {250, 7}, {400, 8}, {50, 9}, {400, 10}, {350, 11},
+};
+
+/** The ids of the arrivals, in order of arrival and then of id. */
+const std::vector<uint64_t> order = {5, 9, 0, 3, 1, 2, 7, 4, 6, 11, 8, 10};
+
+void
+pushAll(ArrivalQueue &queue)
+{
+    for (const Arrival &a : arrivals)
+        queue.push(MsgPtr(new TestMsg(a.time, a.id)));
+}
+
+} // anonymous namespace
+
+/** Both engines pop the messages by arrival time, then by enqueue order. */
+TEST(ArrivalQueueTest, PopOrder)
+{
+    for (bool sorted : {false, true}) {
+        ArrivalQueue queue(sorted);
+        pushAll(queue);
+        EXPECT_EQ(queue.size(), arrivals.size());
+
+        std::vector<uint64_t> popped;
+        while (!queue.empty()) {
+            const uint64_t front = queue.front()->getMsgCounter();
+            MsgPtr m = queue.pop();
+            EXPECT_EQ(m->getMsgCounter(), front);
+            popped.push_back(front);
+        }
+        EXPECT_EQ(popped, order) << (sorted ? "sorted" : "heap");
+    }
+}
+
+/** Messages pushed while others are popped keep their place. */
+TEST(ArrivalQueueTest, InterleavedPushPop)
+{
+    for (bool sorted : {false, true}) {
+        ArrivalQueue queue(sorted);
+        queue.push(MsgPtr(new TestMsg(100, 0)));
+        queue.push(MsgPtr(new TestMsg(300, 1)));
+        EXPECT_EQ(queue.pop()->getMsgCounter(), 0U);
+
+        // Stalled messages come back with earlier arrival times.
+        queue.push(MsgPtr(new TestMsg(200, 2)));
+        queue.push(MsgPtr(new TestMsg(50, 3)));
+        queue.push(MsgPtr(new TestMsg(300, 4)));
+        EXPECT_EQ(queue.pop()->getMsgCounter(), 3U);
+        EXPECT_EQ(queue.pop()->getMsgCounter(), 2U);
+        EXPECT_EQ(queue.pop()->getMsgCounter(), 1U);
+        EXPECT_EQ(queue.pop()->getMsgCounter(), 4U);
+        EXPECT_TRUE(queue.empty());
+    }
+}
+
+/** sorted() returns the messages latest arrival first in both engines. */
+TEST(ArrivalQueueTest, SortedIsLatestFirst)
+{
+    for (bool sorted : {false, true}) {
+        ArrivalQueue queue(sorted);
+        pushAll(queue);
+
+        std::vector<uint64_t> ids;
+        for (const MsgPtr &m : queue.sorted())
+            ids.push_back(m->getMsgCounter());
+        EXPECT_EQ(ids, std::vector<uint64_t>(order.rbegin(), order.rend()));
+        // sorted() leaves the queue alone.
+        EXPECT_EQ(queue.size(), arrivals.size());
+    }
+}
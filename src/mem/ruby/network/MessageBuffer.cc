@@ -52,7 +52,10 @@
 using m5::stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params &p)
-    : SimObject(p), m_stall_map_size(0),
+    : SimObject(p),
+    m_prio_heap(p.engine == MessageBufferEngine::flat),
+    m_stall_msg_map(p.engine == MessageBufferEngine::flat),
+    m_stall_map_size(0),
     m_max_size(p.buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p.ordered),
@@ -74,7 +77,6 @@ MessageBuffer::MessageBuffer(const Params &p)
     m_msgs_this_cycle = 0;
     m_priority_rank = 0;
 
-    m_stall_msg_map.clear();
     m_input_link_id = 0;
     m_vnet_id = 0;
 
@@ -251,18 +253,17 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     msg_ptr->setLastEnqueueTime(arrival_time);
     msg_ptr->setMsgCounter(m_msg_counter);
 
+    DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
+            arrival_time, *msg_ptr);
+
     // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    m_prio_heap.push(std::move(message));
     // Increment the number of messages statistic
     m_buf_msgs++;
 
     assert((m_max_size == 0) ||
            ((m_prio_heap.size() + m_stall_map_size) <= m_max_size));
 
-    DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
-            arrival_time, *(message.get()));
-
     // Schedule the wakeup
     assert(m_consumer != NULL);
     m_consumer->scheduleEventAbsolute(arrival_time);
@@ -275,8 +276,8 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     DPRINTF(RubyQueue, "Popping\n");
     assert(isReady(current_time));
 
-    // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    // get the message about to be dequeued
+    Message *message = m_prio_heap.front().get();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -292,8 +293,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    m_prio_heap.pop();
     if (decrement_messages) {
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
@@ -338,42 +338,36 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    MsgPtr node = m_prio_heap.pop();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    m_prio_heap.push(std::move(node));
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
 void
-MessageBuffer::reanalyzeList(std::list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::reanalyzeList(std::vector<MsgPtr> &lt, Tick schdTick)
 {
-    while (!lt.empty()) {
-        MsgPtr m = lt.front();
+    for (MsgPtr &m : lt) {
         assert(m->getLastEnqueueTime() <= schdTick);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  std::greater<MsgPtr>());
-
-        m_consumer->scheduleEventAbsolute(schdTick);
-
         DPRINTF(RubyQueue, "Requeue arrival_time: %lld, Message: %s\n",
             schdTick, *(m.get()));
 
-        lt.pop_front();
+        m_prio_heap.push(std::move(m));
+
+        m_consumer->scheduleEventAbsolute(schdTick);
     }
+    lt.clear();
 }
 
 void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    assert(m_stall_msg_map.contains(addr));
 
     //
     // Put all stalled messages associated with this address back on the
@@ -381,10 +375,10 @@ MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    m_stall_map_size -= m_stall_msg_map[addr].size();
+    m_stall_msg_map.take(addr, m_reanalyze_msgs);
+    m_stall_map_size -= m_reanalyze_msgs.size();
     assert(m_stall_map_size >= 0);
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    reanalyzeList(m_reanalyze_msgs, current_time);
 }
 
 void
@@ -398,13 +392,10 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle.
     //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end(); ++map_iter) {
-        m_stall_map_size -= map_iter->second.size();
-        assert(m_stall_map_size >= 0);
-        reanalyzeList(map_iter->second, current_time);
-    }
-    m_stall_msg_map.clear();
+    m_stall_msg_map.takeAll(m_reanalyze_msgs);
+    m_stall_map_size -= m_reanalyze_msgs.size();
+    assert(m_stall_map_size >= 0);
+    reanalyzeList(m_reanalyze_msgs, current_time);
 }
 
 void
@@ -424,7 +415,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    m_stall_msg_map.push(addr, std::move(message));
     m_stall_map_size++;
     m_stall_count++;
 }
@@ -432,7 +423,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
 bool
 MessageBuffer::hasStalledMsg(Addr addr) const
 {
-    return (m_stall_msg_map.count(addr) != 0);
+    return m_stall_msg_map.contains(addr);
 }
 
 void
@@ -473,9 +464,7 @@ MessageBuffer::print(std::ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    std::vector<MsgPtr> copy(m_prio_heap);
-    std::sort_heap(copy.begin(), copy.end(), std::greater<MsgPtr>());
-    ccprintf(out, "%s] %s", copy, name());
+    ccprintf(out, "%s] %s", m_prio_heap.sorted(), name());
 }
 
 bool
@@ -494,35 +483,25 @@ MessageBuffer::functionalAccess(Packet *pkt, bool is_read, WriteMask *mask)
     uint32_t num_functional_accesses = 0;
 
     // Check the priority heap and write any messages that may
-    // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
-        if (is_read && !mask && msg->functionalRead(pkt))
-            return 1;
-        else if (is_read && mask && msg->functionalRead(pkt, *mask))
+    // correspond to the address in the packet. Then do the same for the
+    // stall queue.
+    bool done = false;
+    auto access = [&](const MsgPtr &m) {
+        Message *msg = m.get();
+        if (done)
+            return true;
+        if (is_read && !mask && msg->functionalRead(pkt)) {
+            num_functional_accesses = 1;
+            done = true;
+        } else if (is_read && mask && msg->functionalRead(pkt, *mask)) {
             num_functional_accesses++;
-        else if (!is_read && msg->functionalWrite(pkt))
+        } else if (!is_read && msg->functionalWrite(pkt)) {
             num_functional_accesses++;
-    }
-
-    // Check the stall queue and write any messages that may
-    // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (is_read && !mask && msg->functionalRead(pkt))
-                return 1;
-            else if (is_read && mask && msg->functionalRead(pkt, *mask))
-                num_functional_accesses++;
-            else if (!is_read && msg->functionalWrite(pkt))
-                num_functional_accesses++;
         }
-    }
+        return done;
+    };
+    m_prio_heap.forEach(access);
+    m_stall_msg_map.forEach(access);
 
     return num_functional_accesses;
 }
@@ -60,6 +60,8 @@
 #include "mem/port.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/ArrivalQueue.hh"
+#include "mem/ruby/network/StallMap.hh"
 #include "mem/ruby/network/dummy_port.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/MessageBuffer.hh"
@@ -83,11 +85,7 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
-        enqueue(m, current_time, delta);
+        enqueue(m_prio_heap.pop(), current_time, delta);
     }
 
     bool areNSlotsAvailable(unsigned int n, Tick curTime);
@@ -136,8 +134,8 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
-    bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
+    bool isEmpty() const { return m_prio_heap.empty(); }
+    bool isStallMapEmpty() { return m_stall_msg_map.empty(); }
     unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
 
     unsigned int getSize(Tick curTime);
@@ -179,7 +177,7 @@ class MessageBuffer : public SimObject
     }
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    void reanalyzeList(std::vector<MsgPtr> &, Tick);
 
     uint32_t functionalAccess(Packet *pkt, bool is_read, WriteMask *mask);
 
@@ -187,13 +185,14 @@ class MessageBuffer : public SimObject
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    std::vector<MsgPtr> m_prio_heap;
 
-    std::function<void()> m_dequeue_callback;
+    /**
+     * The messages waiting to be dequeued, by arrival time. The engine
+     * parameter selects between a binary heap and a sorted ring.
+     */
+    ArrivalQueue m_prio_heap;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    std::function<void()> m_dequeue_callback;
 
     /**
      * A map from line addresses to lists of stalled messages for that line.
@@ -207,8 +206,14 @@ class MessageBuffer : public SimObject
      * initially received, and when a line is unblocked, the messages are
      * moved back to the m_prio_heap in the same order. This prevents starving
      * older requests with younger ones.
+     *
+     * The engine parameter selects between an ordered map and a flat hash
+     * table of lines.
      */
-    StallMsgMapType m_stall_msg_map;
+    StallMap m_stall_msg_map;
+
+    //! Scratch vector for the messages released from the stall map
+    std::vector<MsgPtr> m_reanalyze_msgs;
 
     /**
      * A map from line addresses to corresponding vectors of messages that
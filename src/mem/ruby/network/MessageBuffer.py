@@ -47,6 +47,14 @@ from m5.SimObject import SimObject
 class MessageRandomization(ScopedEnum):
     vals = ['disabled', 'enabled', 'ruby_system']
 
+# The data structures holding the messages of a MessageBuffer. 'heap' keeps
+# the messages in a binary heap and the stalled ones in an ordered map.
+# 'flat' keeps the messages in a ring sorted by arrival time and the stalled
+# ones in a flat hash table, which is faster for buffers whose messages
+# mostly arrive in order.
+class MessageBufferEngine(ScopedEnum):
+    vals = ['heap', 'flat']
+
 class MessageBuffer(SimObject):
     type = 'MessageBuffer'
     cxx_class = 'MessageBuffer'
@@ -61,6 +69,8 @@ class MessageBuffer(SimObject):
                                             for internall trigger queues and \
                                             should not be used if this msg. \
                                             buffer connects different objects")
+    engine = Param.MessageBufferEngine('heap',
+                    "Data structures holding the messages of the buffer")
 
     out_port = RequestPort("Request port to MessageBuffer receiver")
     master = DeprecatedParam(out_port, '`master` is now called `out_port`')
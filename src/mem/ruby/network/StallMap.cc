@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/StallMap.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "base/intmath.hh"
+
+constexpr uint32_t StallMap::NoLine;
+
+StallMap::StallMap(bool flat)
+    : m_flat(flat), m_num_lines(0), m_shift(0)
+{
+    if (m_flat)
+        rehash(16);
+}
+
+size_t
+StallMap::findSlot(Addr addr) const
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = home(addr);
+    while (m_slots[slot] != NoLine && m_lines[m_slots[slot]].addr != addr)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void
+StallMap::rehash(size_t num_slots)
+{
+    assert(isPowerOf2(num_slots));
+    m_slots.assign(num_slots, NoLine);
+    m_shift = 64 - floorLog2(num_slots);
+    for (size_t i = 0; i < m_num_lines; i++)
+        m_slots[findSlot(m_lines[i].addr)] = i;
+}
+
+void
+StallMap::eraseSlot(size_t slot)
+{
+    const size_t mask = m_slots.size() - 1;
+    const uint32_t index = m_slots[slot];
+    assert(index < m_num_lines);
+    m_lines[index].messages.clear();
+
+    // Move the last line in place of the erased one
+    const uint32_t last = m_num_lines - 1;
+    if (index != last) {
+        m_slots[findSlot(m_lines[last].addr)] = index;
+        std::swap(m_lines[index], m_lines[last]);
+    }
+    m_num_lines--;
+
+    // Shift back the lines that probed past the erased slot
+    size_t hole = slot;
+    size_t next = (slot + 1) & mask;
+    while (m_slots[next] != NoLine) {
+        const size_t want = home(m_lines[m_slots[next]].addr);
+        // Move the line if its home is not between the hole and it
+        if (((next - want) & mask) >= ((next - hole) & mask)) {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    m_slots[hole] = NoLine;
+}
+
+bool
+StallMap::contains(Addr addr) const
+{
+    if (!m_flat)
+        return m_map.count(addr) != 0;
+    return m_slots[findSlot(addr)] != NoLine;
+}
+
+void
+StallMap::push(Addr addr, MsgPtr message)
+{
+    if (!m_flat) {
+        m_map[addr].push_back(std::move(message));
+        return;
+    }
+
+    size_t slot = findSlot(addr);
+    if (m_slots[slot] == NoLine) {
+        // Keep the table at most half full
+        if (2 * (m_num_lines + 1) > m_slots.size()) {
+            rehash(2 * m_slots.size());
+            slot = findSlot(addr);
+        }
+        if (m_num_lines == m_lines.size())
+            m_lines.emplace_back();
+        m_lines[m_num_lines].addr = addr;
+        m_slots[slot] = m_num_lines++;
+    }
+    m_lines[m_slots[slot]].messages.push_back(std::move(message));
+}
+
+void
+StallMap::take(Addr addr, std::vector<MsgPtr> &messages)
+{
+    if (!m_flat) {
+        auto it = m_map.find(addr);
+        assert(it != m_map.end());
+        for (MsgPtr &m : it->second)
+            messages.push_back(std::move(m));
+        m_map.erase(it);
+        return;
+    }
+
+    const size_t slot = findSlot(addr);
+    assert(m_slots[slot] != NoLine);
+    for (MsgPtr &m : m_lines[m_slots[slot]].messages)
+        messages.push_back(std::move(m));
+    eraseSlot(slot);
+}
+
+void
+StallMap::takeAll(std::vector<MsgPtr> &messages)
+{
+    if (!m_flat) {
+        for (auto &line : m_map)
+            for (MsgPtr &m : line.second)
+                messages.push_back(std::move(m));
+        m_map.clear();
+        return;
+    }
+
+    for (size_t i = 0; i < m_num_lines; i++) {
+        for (MsgPtr &m : m_lines[i].messages)
+            messages.push_back(std::move(m));
+        m_lines[i].messages.clear();
+    }
+    m_num_lines = 0;
+    std::fill(m_slots.begin(), m_slots.end(), NoLine);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_STALLMAP_HH__
+#define __MEM_RUBY_NETWORK_STALLMAP_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/*
+ * The messages a MessageBuffer holds back until the line they address is
+ * unblocked, kept in the order in which they were stalled.
+ *
+ * The lines are either kept in a std::map, or in a dense array of lines
+ * indexed by an open addressing hash table with linear probing. The
+ * latter only allocates when the number of stalled lines grows beyond
+ * anything seen before, and finds a line without walking a tree.
+ */
+class StallMap
+{
+  public:
+    explicit StallMap(bool flat);
+
+    bool empty() const { return size() == 0; }
+
+    //! Number of lines with stalled messages
+    size_t size() const { return m_flat ? m_num_lines : m_map.size(); }
+
+    bool contains(Addr addr) const;
+
+    void push(Addr addr, MsgPtr message);
+
+    //! Moves the messages of a line to the end of a vector, in stall
+    //! order, and removes the line
+    void take(Addr addr, std::vector<MsgPtr> &messages);
+
+    //! Moves the messages of all lines to the end of a vector, each line
+    //! in stall order, and removes all lines
+    void takeAll(std::vector<MsgPtr> &messages);
+
+    //! Calls f on every message until it returns true
+    template <typename F>
+    void
+    forEach(F f) const
+    {
+        if (m_flat) {
+            for (size_t i = 0; i < m_num_lines; i++)
+                for (const MsgPtr &m : m_lines[i].messages)
+                    if (f(m))
+                        return;
+        } else {
+            for (const auto &line : m_map)
+                for (const MsgPtr &m : line.second)
+                    if (f(m))
+                        return;
+        }
+    }
+
+  private:
+    struct Line
+    {
+        Addr addr;
+        std::vector<MsgPtr> messages;
+    };
+
+    //! Empty slot of the hash table
+    static constexpr uint32_t NoLine = ~uint32_t(0);
+
+    size_t
+    home(Addr addr) const
+    {
+        // Fibonacci hashing spreads the line-aligned addresses
+        return (addr * 0x9e3779b97f4a7c15ULL) >> m_shift;
+    }
+
+    //! Slot of the hash table holding the line, or the empty slot where
+    //! the line would go
+    size_t findSlot(Addr addr) const;
+    void rehash(size_t num_slots);
+    //! Removes the line in a slot, keeping its vector for reuse
+    void eraseSlot(size_t slot);
+
+    const bool m_flat;
+
+    // use a std::map for the stalled messages as this container is
+    // sorted and ensures a well-defined iteration order
+    std::map<Addr, std::vector<MsgPtr>> m_map;
+
+    //! The first m_num_lines lines hold messages, the rest are spare
+    std::vector<Line> m_lines;
+    size_t m_num_lines;
+    //! Index in m_lines of the line in each slot, a power of two of slots
+    std::vector<uint32_t> m_slots;
+    unsigned m_shift;
+};
+
+#endif // __MEM_RUBY_NETWORK_STALLMAP_HH__
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/network/StallMap.hh"
+
+namespace
+{
+
+/** A message which only carries an id, in its message counter. */
+class TestMsg : public Message
+{
+  public:
+    explicit TestMsg(uint64_t id) : Message(0) { setMsgCounter(id); }
+
+    MsgPtr clone() const override { return MsgPtr(new TestMsg(*this)); }
+    void print(std::ostream &out) const override {}
+};
+
+MsgPtr
+msg(uint64_t id)
+{
+    return MsgPtr(new TestMsg(id));
+}
+
+std::vector<uint64_t>
+take(StallMap &map, Addr addr)
+{
+    std::vector<MsgPtr> messages;
+    map.take(addr, messages);
+    std::vector<uint64_t> ids;
+    for (const MsgPtr &m : messages)
+        ids.push_back(m->getMsgCounter());
+    return ids;
+}
+
+/**
+ * Lines whose home is the given slot of a table with 16 slots, which is
+ * the size of the table of a new flat map. This mirrors the hash of the
+ * map.
+ */
+std::vector<Addr>
+linesHomedAt(size_t slot, size_t count)
+{
+    std::vector<Addr> lines;
+    for (Addr addr = 0; lines.size() < count; addr += 64) {
+        if (((addr * 0x9e3779b97f4a7c15ULL) >> 60) == slot)
+            lines.push_back(addr);
+    }
+    return lines;
+}
+
+} // anonymous namespace
+
+/** Messages of a line are taken in the order they were stalled. */
+TEST(StallMapTest, TakeInStallOrder)
+{
+    for (bool flat : {false, true}) {
+        StallMap map(flat);
+        map.push(0x40, msg(1));
+        map.push(0x80, msg(2));
+        map.push(0x40, msg(3));
+        EXPECT_EQ(map.size(), 2U);
+        EXPECT_TRUE(map.contains(0x40));
+
+        EXPECT_EQ(take(map, 0x40), std::vector<uint64_t>({1, 3}));
+        EXPECT_FALSE(map.contains(0x40));
+        EXPECT_TRUE(map.contains(0x80));
+        EXPECT_EQ(take(map, 0x80), std::vector<uint64_t>({2}));
+        EXPECT_TRUE(map.empty());
+    }
+}
+
+/**
+ * Erasing a line from the last slot of the table shifts back the lines
+ * which collided with it and wrapped around to the first slots.
+ */
+TEST(StallMapTest, EraseShiftsBackAcrossWrap)
+{
+    const std::vector<Addr> lines = linesHomedAt(15, 4);
+    StallMap map(true);
+    for (size_t i = 0; i < lines.size(); i++)
+        map.push(lines[i], msg(i));
+
+    // The first line sits in slot 15 and the others wrapped around.
+    EXPECT_EQ(take(map, lines[0]), std::vector<uint64_t>({0}));
+    for (size_t i = 1; i < lines.size(); i++)
+        EXPECT_TRUE(map.contains(lines[i]));
+
+    // Erase from the middle of the wrapped run as well.
+    EXPECT_EQ(take(map, lines[2]), std::vector<uint64_t>({2}));
+    EXPECT_TRUE(map.contains(lines[1]));
+    EXPECT_TRUE(map.contains(lines[3]));
+    EXPECT_FALSE(map.contains(lines[0]));
+    EXPECT_FALSE(map.contains(lines[2]));
+
+    map.push(lines[0], msg(4));
+    EXPECT_EQ(take(map, lines[3]), std::vector<uint64_t>({3}));
+    EXPECT_EQ(take(map, lines[1]), std::vector<uint64_t>({1}));
+    EXPECT_EQ(take(map, lines[0]), std::vector<uint64_t>({4}));
+    EXPECT_TRUE(map.empty());
+}
+
+/** The flat map behaves as the ordered one through random operations. */
+TEST(StallMapTest, FlatMatchesOrdered)
+{
+    std::mt19937 rng(1);
+    StallMap flat(true);
+    std::map<Addr, std::vector<uint64_t>> expected;
+
+    for (uint64_t id = 0; id < 20000; id++) {
+        // Few lines, so that the table both grows and collides.
+        const Addr addr = (rng() % 48) * 64;
+        if (rng() % 3 == 0 && expected.count(addr)) {
+            EXPECT_EQ(take(flat, addr), expected[addr]);
+            expected.erase(addr);
+        } else {
+            flat.push(addr, msg(id));
+            expected[addr].push_back(id);
+        }
+        ASSERT_EQ(flat.size(), expected.size());
+    }
+
+    for (Addr addr = 0; addr < 48 * 64; addr += 64)
+        EXPECT_EQ(flat.contains(addr), expected.count(addr) != 0);
+
+    std::vector<MsgPtr> all;
+    flat.takeAll(all);
+    size_t count = 0;
+    for (const auto &line : expected)
+        count += line.second.size();
+    EXPECT_EQ(all.size(), count);
+    EXPECT_TRUE(flat.empty());
+}
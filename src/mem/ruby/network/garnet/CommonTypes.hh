@@ -31,6 +31,9 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_COMMONTYPES_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_COMMONTYPES_HH__
 
+#include <cstdint>
+
+#include "base/types.hh"
 #include "mem/ruby/common/NetDest.hh"
 
 // All common enums and typedefs go here
@@ -63,6 +66,53 @@ struct RouteInfo
     int hops_traversed;
 };
 
+/**
+ * Counts the cycles a router, link or NI did not wake up for, because it
+ * went to sleep rather than polling for flits or credits every cycle.
+ * A sleep lasts until the next wakeup, whatever its cause, and skips
+ * every cycle in between.
+ */
+class SkippedWakeups
+{
+  public:
+    /** The component will not wake up next cycle to poll. */
+    void
+    sleep(Cycles now)
+    {
+        if (!m_sleeping) {
+            m_sleeping = true;
+            m_since = now;
+        }
+    }
+
+    /** The component woke up, ending any sleep. */
+    void
+    wakeup(Cycles now)
+    {
+        if (m_sleeping) {
+            m_sleeping = false;
+            if (now > m_since + 1)
+                m_count += now - m_since - 1;
+        }
+    }
+
+    /** Only count the cycles of an ongoing sleep from now on. */
+    void
+    reset(Cycles now)
+    {
+        m_count = 0;
+        if (m_sleeping)
+            m_since = now;
+    }
+
+    uint64_t count() const { return m_count; }
+
+  private:
+    bool m_sleeping = false;
+    Cycles m_since;
+    uint64_t m_count = 0;
+};
+
 #define INFINITE_ 10000
 
 #endif //__MEM_RUBY_NETWORK_GARNET_0_COMMONTYPES_HH__
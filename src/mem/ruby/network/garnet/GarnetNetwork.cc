@@ -52,7 +52,8 @@
  */
 
 GarnetNetwork::GarnetNetwork(const Params &p)
-    : Network(p)
+    : Network(p), m_partitioned(false),
+      m_analytical(p.network_model == GarnetNetworkModel::analytical)
 {
     m_num_rows = p.num_rows;
     m_ni_flit_size = p.ni_flit_size;
@@ -83,6 +84,7 @@ GarnetNetwork::GarnetNetwork(const Params &p)
         // initialize the router's network pointers
         router->init_net_ptr(this);
     }
+    m_router_hops.resize(m_routers.size());
 
     // record the network interfaces
     for (std::vector<ClockedObject*>::const_iterator i = p.netifs.begin();
@@ -110,6 +112,34 @@ GarnetNetwork::init()
     assert(m_topology_ptr != NULL);
     m_topology_ptr->createLinks(this);
 
+    // Routers and interfaces may be spread over several event queues to
+    // simulate the network in parallel. Partitions only interact
+    // through remote links, so the latency of those links is the
+    // lookahead that bounds the simulation quantum.
+    std::vector<NetworkLink *> links(m_networklinks);
+    links.insert(links.end(), m_creditlinks.begin(), m_creditlinks.end());
+    for (auto *link : links) {
+        if (!link->isRemote())
+            continue;
+
+        m_partitioned = true;
+        fatal_if(link->lookahead() < simQuantum,
+                 "%s crosses event queues but its latency (%d ticks) is "
+                 "smaller than the simulation quantum (%d ticks).\n",
+                 link->name(), link->lookahead(), simQuantum);
+    }
+
+    if (m_partitioned)
+        inform("%s is partitioned across event queues\n", name());
+
+    // The analytical model reserves every link of a route when the
+    // message is injected, which is only safe on a single event queue.
+    fatal_if(m_analytical && m_partitioned,
+             "%s: the analytical network model cannot be partitioned.\n",
+             name());
+    if (m_analytical)
+        inform("%s uses the analytical network model\n", name());
+
     // Initialize topology specific parameters
     if (getNumRows() > 0) {
         // Only for Mesh topology
@@ -206,6 +236,10 @@ GarnetNetwork::makeExtInLink(NodeID global_src, SwitchID dest, BasicLink* link,
         m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     }
 
+    NetworkLink *ni_link = garnet_link->extBridgeEn ?
+        garnet_link->extNetBridge[LinkDirection_In] : net_link;
+    m_injection_hops[ni_link] =
+        { net_link, (int)dest, m_routers[dest]->get_num_inports() - 1 };
 }
 
 /*
@@ -278,6 +312,10 @@ GarnetNetwork::makeExtOutLink(SwitchID src, NodeID global_dest,
                        link->m_weight, credit_link,
                        m_routers[src]->get_vc_per_vnet());
     }
+
+    m_router_hops[src].push_back({ net_link, -1, -1 });
+    assert(m_router_hops[src].size() ==
+           (size_t)m_routers[src]->get_num_outports());
 }
 
 /*
@@ -341,6 +379,11 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
                         link->m_weight, credit_link,
                         m_routers[dest]->get_vc_per_vnet());
     }
+
+    m_router_hops[src].push_back(
+        { net_link, (int)dest, m_routers[dest]->get_num_inports() - 1 });
+    assert(m_router_hops[src].size() ==
+           (size_t)m_routers[src]->get_num_outports());
 }
 
 // Total routers in the network
@@ -359,6 +402,46 @@ GarnetNetwork::get_router_id(int global_ni, int vnet)
     return m_nis[local_ni]->get_router_id(vnet);
 }
 
+NetworkInterface *
+GarnetNetwork::getNetworkInterface(NodeID global_ni)
+{
+    return m_nis[getLocalNodeID(global_ni)];
+}
+
+/*
+ * The analytical model walks the route the routing units would choose
+ * and reserves each link for the whole packet. Packets are pipelined
+ * (wormhole): the head flit pays the router and link latencies at every
+ * hop, and the rest of the packet follows one flit per cycle. Contention
+ * shows up as the head waiting for a link still busy with earlier
+ * packets. Bridges are not modelled, only the links they sit on.
+ */
+Tick
+GarnetNetwork::reserveRoute(NetworkLink *in_link, RouteInfo &route,
+                            int num_flits, Tick ready)
+{
+    auto it = m_injection_hops.find(in_link);
+    assert(it != m_injection_hops.end());
+    AnalyticalHop hop = it->second;
+    Tick head = hop.link->reserve(ready, num_flits, route.vnet);
+
+    while (hop.router != -1) {
+        Router *router = m_routers[hop.router];
+        route.hops_traversed++;
+        panic_if(route.hops_traversed > (int)m_routers.size(),
+                 "%s: route from NI %d to NI %d does not converge.\n",
+                 name(), route.src_ni, route.dest_ni);
+
+        head += router->cyclesToTicks(router->get_pipe_stages());
+        int outport = router->route_compute(route, hop.inport,
+            router->getInportDirection(hop.inport));
+        hop = m_router_hops[hop.router][outport];
+        head = hop.link->reserve(head, num_flits, route.vnet);
+    }
+
+    return head + hop.link->cyclesToTicks(Cycles(num_flits - 1));
+}
+
 void
 GarnetNetwork::regStats()
 {
@@ -500,6 +583,11 @@ GarnetNetwork::regStats()
         .name(name() + ".avg_vc_load")
         .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
         ;
+
+    // Cycles routers, links and NIs slept instead of polling for
+    // credits or flits
+    m_skipped_wakeups
+        .name(name() + ".skipped_wakeups");
 }
 
 void
@@ -528,9 +616,17 @@ GarnetNetwork::collateStats()
         }
     }
 
+    for (auto *link : m_creditlinks)
+        m_skipped_wakeups += link->getSkippedWakeups();
+    for (auto *link : m_networklinks)
+        m_skipped_wakeups += link->getSkippedWakeups();
+    for (auto *ni : m_nis)
+        m_skipped_wakeups += ni->getSkippedWakeups();
+
     // Ask the routers to collate their statistics
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
+        m_skipped_wakeups += m_routers[i]->getSkippedWakeups();
     }
 }
 
@@ -546,6 +642,9 @@ GarnetNetwork::resetStats()
     for (int i = 0; i < m_creditlinks.size(); i++) {
         m_creditlinks[i]->resetStats();
     }
+    for (int i = 0; i < m_nis.size(); i++) {
+        m_nis[i]->resetStats();
+    }
 }
 
 void
@@ -33,8 +33,10 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_GARNETNETWORK_HH__
 
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
+#include "base/uncontended_mutex.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
@@ -73,6 +75,25 @@ class GarnetNetwork : public Network
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
     FaultModel* fault_model;
 
+    // Whether messages are routed whole by the analytical model rather
+    // than flitisized and simulated cycle by cycle
+    bool isAnalytical() const { return m_analytical; }
+
+    /**
+     * Route a packet of num_flits flits through the analytical model.
+     * The packet enters the network through in_link, the link the NI
+     * injects into, with its head flit ready at tick ready. Every router
+     * on the way adds its pipeline latency, and every link adds its
+     * latency and the time the packet waits for the link to be free.
+     *
+     * @param route Route of the packet, its hops are updated.
+     * @return The tick at which the tail flit reaches the destination NI.
+     */
+    Tick reserveRoute(NetworkLink *in_link, RouteInfo &route, int num_flits,
+                      Tick ready);
+
+    NetworkInterface *getNetworkInterface(NodeID global_ni);
+
 
     // Internal configuration
     bool isVNetOrdered(int vnet) const { return m_ordered[vnet]; }
@@ -106,42 +127,115 @@ class GarnetNetwork : public Network
     void print(std::ostream& out) const;
 
     // increment counters
-    void increment_injected_packets(int vnet) { m_packets_injected[vnet]++; }
-    void increment_received_packets(int vnet) { m_packets_received[vnet]++; }
+    void
+    increment_injected_packets(int vnet)
+    {
+        StatsGuard guard(this);
+        m_packets_injected[vnet]++;
+    }
+
+    void
+    increment_received_packets(int vnet)
+    {
+        StatsGuard guard(this);
+        m_packets_received[vnet]++;
+    }
 
     void
     increment_packet_network_latency(Tick latency, int vnet)
     {
+        StatsGuard guard(this);
         m_packet_network_latency[vnet] += latency;
     }
 
     void
     increment_packet_queueing_latency(Tick latency, int vnet)
     {
+        StatsGuard guard(this);
         m_packet_queueing_latency[vnet] += latency;
     }
 
-    void increment_injected_flits(int vnet) { m_flits_injected[vnet]++; }
-    void increment_received_flits(int vnet) { m_flits_received[vnet]++; }
+    void
+    increment_injected_flits(int vnet)
+    {
+        StatsGuard guard(this);
+        m_flits_injected[vnet]++;
+    }
+
+    void
+    increment_received_flits(int vnet)
+    {
+        StatsGuard guard(this);
+        m_flits_received[vnet]++;
+    }
 
     void
     increment_flit_network_latency(Tick latency, int vnet)
     {
+        StatsGuard guard(this);
         m_flit_network_latency[vnet] += latency;
     }
 
     void
     increment_flit_queueing_latency(Tick latency, int vnet)
     {
+        StatsGuard guard(this);
         m_flit_queueing_latency[vnet] += latency;
     }
 
     void
     increment_total_hops(int hops)
     {
+        StatsGuard guard(this);
         m_total_hops += hops;
     }
 
+  private:
+    /**
+     * The routers and interfaces of a partitioned network are spread
+     * over several event queues (see NetworkLink::isRemote()), so the
+     * network-wide stats are updated from several threads.
+     */
+    class StatsGuard
+    {
+      public:
+        StatsGuard(GarnetNetwork *net)
+            : mutex(net->m_partitioned ? &net->m_stats_mutex : nullptr)
+        {
+            if (mutex)
+                mutex->lock();
+        }
+
+        ~StatsGuard()
+        {
+            if (mutex)
+                mutex->unlock();
+        }
+
+      private:
+        UncontendedMutex *mutex;
+    };
+
+    bool m_partitioned;
+    UncontendedMutex m_stats_mutex;
+
+    /**
+     * The link leaving a router output port, or an NI, and where it
+     * leads: the input port of a router, or an NI if router is -1.
+     */
+    struct AnalyticalHop
+    {
+        NetworkLink *link;
+        int router;
+        int inport;
+    };
+
+    const bool m_analytical;
+    // Hops of the analytical model, by router and output port
+    std::vector<std::vector<AnalyticalHop>> m_router_hops;
+    // Hops of the analytical model, by the link an NI injects into
+    std::unordered_map<const NetworkLink *, AnalyticalHop> m_injection_hops;
+
   protected:
     // Configuration
     int m_num_rows;
@@ -185,6 +279,8 @@ class GarnetNetwork : public Network
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
+    Stats::Scalar m_skipped_wakeups;
+
   private:
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
@@ -34,6 +34,14 @@ from m5.objects.Network import RubyNetwork
 from m5.objects.BasicRouter import BasicRouter
 from m5.objects.ClockedObject import ClockedObject
 
+# How the network is simulated. 'cycle_accurate' moves every flit through
+# the router pipelines cycle by cycle. 'analytical' routes whole messages
+# through the same routing tables and computes their latency from the
+# occupancy of the links along the route, which is much faster but does
+# not model virtual channels, credits or buffer backpressure.
+class GarnetNetworkModel(ScopedEnum):
+    vals = ['cycle_accurate', 'analytical']
+
 class GarnetNetwork(RubyNetwork):
     type = 'GarnetNetwork'
     cxx_header = "mem/ruby/network/garnet/GarnetNetwork.hh"
@@ -48,6 +56,8 @@ class GarnetNetwork(RubyNetwork):
     fault_model = Param.FaultModel(NULL, "network fault model");
     garnet_deadlock_threshold = Param.UInt32(50000,
                               "network-level deadlock threshold")
+    network_model = Param.GarnetNetworkModel('cycle_accurate',
+                              "how the network is simulated")
 
 class GarnetNetworkInterface(ClockedObject):
     type = 'GarnetNetworkInterface'
@@ -47,7 +47,8 @@ NetworkInterface::NetworkInterface(const Params &p)
     m_virtual_networks(p.virt_nets), m_vc_per_vnet(0),
     m_vc_allocator(m_virtual_networks, 0),
     m_deadlock_threshold(p.garnet_deadlock_threshold),
-    vc_busy_counter(m_virtual_networks, 0)
+    vc_busy_counter(m_virtual_networks, 0),
+    m_last_delivery(m_virtual_networks, 0)
 {
     m_stall_count.resize(m_virtual_networks);
     niOutVcs.resize(0);
@@ -189,6 +190,7 @@ NetworkInterface::wakeup()
             "woke up. Period: %ld\n", m_id, oss.str(), clockPeriod());
 
     assert(curTick() == clockEdge());
+    m_skipped_wakeups.wakeup(curCycle());
     MsgPtr msg_ptr;
     Tick curTime = clockEdge();
 
@@ -202,7 +204,10 @@ NetworkInterface::wakeup()
 
         if (b->isReady(curTime)) { // Is there a message waiting
             msg_ptr = b->peekMsgPtr();
-            if (flitisizeMessage(msg_ptr, vnet)) {
+            bool sent = m_net_ptr->isAnalytical() ?
+                routeMessage(msg_ptr, vnet) :
+                flitisizeMessage(msg_ptr, vnet);
+            if (sent) {
                 b->dequeue(curTime);
             }
         }
@@ -355,6 +360,22 @@ NetworkInterface::checkStallQueue()
     }
 }
 
+// The destination of the copy of a multicast message sent to destID
+static NetDest
+unicastDestination(NodeID destID)
+{
+    NetDest personal_dest;
+    for (int m = 0; m < (int) MachineType_NUM; m++) {
+        if ((destID >= MachineType_base_number((MachineType) m)) &&
+            destID < MachineType_base_number((MachineType) (m+1))) {
+            personal_dest.add((MachineID) {(MachineType) m, (destID -
+                MachineType_base_number((MachineType) m))});
+            break;
+        }
+    }
+    return personal_dest;
+}
+
 // Embed the protocol message into flits
 bool
 NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
@@ -390,18 +411,9 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
 
         Message *new_net_msg_ptr = new_msg_ptr.get();
         if (dest_nodes.size() > 1) {
-            NetDest personal_dest;
-            for (int m = 0; m < (int) MachineType_NUM; m++) {
-                if ((destID >= MachineType_base_number((MachineType) m)) &&
-                    destID < MachineType_base_number((MachineType) (m+1))) {
-                    // calculating the NetDest associated with this destID
-                    personal_dest.clear();
-                    personal_dest.add((MachineID) {(MachineType) m, (destID -
-                        MachineType_base_number((MachineType) m))});
-                    new_net_msg_ptr->getDestination() = personal_dest;
-                    break;
-                }
-            }
+            // calculating the NetDest associated with this destID
+            NetDest personal_dest = unicastDestination(destID);
+            new_net_msg_ptr->getDestination() = personal_dest;
             net_msg_dest.removeNetDest(personal_dest);
             // removing the destination from the original message to reflect
             // that a message with this particular destination has been
@@ -443,6 +455,96 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     return true ;
 }
 
+/*
+ * Send a whole message through the analytical network model. Each copy
+ * of a multicast message reserves the links of its route and is handed
+ * to the destination NI directly. There are no virtual channels nor
+ * credits, so the only backpressure is a full protocol buffer at one of
+ * the destinations, which keeps the message in the source buffer.
+ */
+bool
+NetworkInterface::routeMessage(MsgPtr msg_ptr, int vnet)
+{
+    Message *net_msg_ptr = msg_ptr.get();
+    std::vector<NodeID> dest_nodes =
+        net_msg_ptr->getDestination().getAllDest();
+
+    for (NodeID destID : dest_nodes) {
+        if (!m_net_ptr->getNetworkInterface(destID)->
+                outNode_ptr[vnet]->areNSlotsAvailable(1, curTick())) {
+            vc_busy_counter[vnet] += 1;
+            panic_if(vc_busy_counter[vnet] > m_deadlock_threshold,
+                "%s: Possible network deadlock in vnet: %d at time: %llu \n",
+                name(), vnet, curTick());
+            return false;
+        }
+    }
+    vc_busy_counter[vnet] = 0;
+
+    OutputPort *oPort = getOutportForVnet(vnet);
+    assert(oPort);
+    int num_flits = (int)divCeil((float) m_net_ptr->MessageSizeType_to_int(
+        net_msg_ptr->getMessageSize()), (float)oPort->bitWidth());
+
+    // Like a flitisized message, the head flit leaves the next cycle
+    Tick ready = clockEdge(Cycles(1));
+    Tick src_queueing_delay = curTick() - msg_ptr->getTime();
+
+    for (NodeID destID : dest_nodes) {
+        MsgPtr new_msg_ptr = msg_ptr->clone();
+        if (dest_nodes.size() > 1)
+            new_msg_ptr->getDestination() = unicastDestination(destID);
+
+        RouteInfo route;
+        route.vnet = vnet;
+        route.net_dest = new_msg_ptr->getDestination();
+        route.src_ni = m_id;
+        route.src_router = oPort->routerID();
+        route.dest_ni = destID;
+        route.dest_router = m_net_ptr->get_router_id(destID, vnet);
+        route.hops_traversed = -1;
+
+        Tick arrival = m_net_ptr->reserveRoute(oPort->outNetLink(), route,
+                                               num_flits, ready);
+        DPRINTF(RubyNetwork, "Routed message to NI %d in %d hops, tail "
+                "arrives at %ld\n", destID, route.hops_traversed, arrival);
+        m_net_ptr->getNetworkInterface(destID)->
+            deliverMessage(new_msg_ptr, vnet, arrival);
+
+        // The stats are those the flits would have reported on arrival
+        Tick network_delay = arrival - ready;
+        m_net_ptr->increment_injected_packets(vnet);
+        m_net_ptr->increment_received_packets(vnet);
+        m_net_ptr->increment_packet_network_latency(network_delay, vnet);
+        m_net_ptr->increment_packet_queueing_latency(src_queueing_delay,
+                                                     vnet);
+        for (int i = 0; i < num_flits; i++) {
+            // Flit i arrives num_flits - 1 - i cycles before the tail
+            Tick lag = std::min(network_delay,
+                                cyclesToTicks(Cycles(num_flits - 1 - i)));
+            m_net_ptr->increment_injected_flits(vnet);
+            m_net_ptr->increment_received_flits(vnet);
+            m_net_ptr->increment_flit_network_latency(network_delay - lag,
+                                                      vnet);
+            m_net_ptr->increment_flit_queueing_latency(src_queueing_delay,
+                                                       vnet);
+        }
+        m_net_ptr->increment_total_hops(route.hops_traversed * num_flits);
+    }
+    return true;
+}
+
+void
+NetworkInterface::deliverMessage(MsgPtr msg_ptr, int vnet, Tick arrival)
+{
+    // Messages may overtake each other on different routes, but the
+    // protocol buffer has to receive them in order.
+    Tick when = std::max(arrival + cyclesToTicks(Cycles(1)),
+                         m_last_delivery[vnet]);
+    m_last_delivery[vnet] = when;
+    outNode_ptr[vnet]->enqueue(msg_ptr, curTick(), when - curTick());
+}
+
 // Looking for a free output vc
 int
 NetworkInterface::calculateVC(int vnet)
@@ -623,8 +725,15 @@ NetworkInterface::checkReschedule()
         }
     }
 
-    for (auto& ni_out_vc : niOutVcs) {
-        if (ni_out_vc.isReady(clockEdge(Cycles(1)))) {
+    // Flits of a vc without credits can only leave once a credit
+    // arrives, and the credit link wakes the NI up when it does.
+    bool waiting_for_credit = false;
+    for (int vc = 0; vc < niOutVcs.size(); vc++) {
+        if (niOutVcs[vc].isReady(clockEdge(Cycles(1)))) {
+            if (!outVcState[vc].has_credit()) {
+                waiting_for_credit = true;
+                continue;
+            }
             scheduleEvent(Cycles(1));
             return;
         }
@@ -648,6 +757,9 @@ NetworkInterface::checkReschedule()
             return;
         }
     }
+
+    if (waiting_for_credit && !alreadyScheduled(clockEdge(Cycles(1))))
+        m_skipped_wakeups.sleep(curCycle());
 }
 
 void
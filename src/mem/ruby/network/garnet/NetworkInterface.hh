@@ -71,8 +71,18 @@ class NetworkInterface : public ClockedObject, public Consumer
 
     uint32_t functionalWrite(Packet *);
 
+    uint64_t getSkippedWakeups() const { return m_skipped_wakeups.count(); }
+    void resetStats() { m_skipped_wakeups.reset(curCycle()); }
+
     void scheduleFlit(flit *t_flit);
 
+    /**
+     * Hand a message routed by the analytical model over to the
+     * protocol. The message is ejected a cycle after its tail flit
+     * arrives at tick arrival.
+     */
+    void deliverMessage(MsgPtr msg_ptr, int vnet, Tick arrival);
+
     int get_router_id(int vnet)
     {
         OutputPort *oPort = getOutportForVnet(vnet);
@@ -281,9 +291,14 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<MessageBuffer *> outNode_ptr;
     // When a vc stays busy for a long time, it indicates a deadlock
     std::vector<int> vc_busy_counter;
+    // Last ejection tick of each vnet in the analytical model
+    std::vector<Tick> m_last_delivery;
+    // Cycles the NI did not wake up for flits waiting for credits
+    SkippedWakeups m_skipped_wakeups;
 
     void checkStallQueue();
     bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    bool routeMessage(MsgPtr msg_ptr, int vnet);
     int calculateVC(int vnet);
 
 
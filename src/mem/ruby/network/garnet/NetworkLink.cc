@@ -32,6 +32,7 @@
 
 #include "mem/ruby/network/garnet/NetworkLink.hh"
 
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/CreditLink.hh"
@@ -39,7 +40,9 @@
 NetworkLink::NetworkLink(const Params &p)
     : ClockedObject(p), Consumer(this), m_id(p.link_id),
       m_type(NUM_LINK_TYPES_),
-      m_latency(p.link_latency), m_link_utilized(0),
+      m_latency(p.link_latency), m_remote_consumer(false),
+      m_reserved_until(0),
+      m_link_utilized(0),
       m_virt_nets(p.virt_nets), linkBuffer(),
       link_consumer(nullptr), link_srcQueue(nullptr)
 {
@@ -55,6 +58,8 @@ void
 NetworkLink::setLinkConsumer(Consumer *consumer)
 {
     link_consumer = consumer;
+    m_remote_consumer =
+        consumer->getObject()->eventQueue() != eventQueue();
 }
 
 void
@@ -77,6 +82,8 @@ NetworkLink::wakeup()
         src_object->name());
     assert(link_srcQueue != nullptr);
     assert(curTick() == clockEdge());
+    m_skipped_wakeups.wakeup(curCycle());
+
     if (link_srcQueue->isReady(curTick())) {
         flit *t_flit = link_srcQueue->getTopFlit();
         DPRINTF(RubyNetwork, "Transmission will finish at %ld :%s\n",
@@ -89,17 +96,60 @@ NetworkLink::wakeup()
                 (mVnets.size() == 0));
         }
         t_flit->set_time(clockEdge(m_latency));
-        linkBuffer.insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        if (m_remote_consumer) {
+            // The consumer runs in another thread, only touch it from
+            // its own event queue once the flit has arrived.
+            {
+                std::lock_guard<UncontendedMutex> lock(m_buffer_mutex);
+                linkBuffer.insert(t_flit);
+            }
+            Consumer *consumer = link_consumer;
+            const Tick arrival = clockEdge(m_latency);
+            consumer->getObject()->schedule(new EventFunctionWrapper(
+                [consumer, arrival]{
+                    consumer->scheduleEventAbsolute(arrival);
+                }, name() + ".remoteDelivery", true), arrival);
+        } else {
+            linkBuffer.insert(t_flit);
+            link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        }
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
     }
 
     if (!link_srcQueue->isEmpty()) {
-        scheduleEvent(Cycles(1));
+        // Sleep until the next flit can cross rather than polling the
+        // source queue every cycle. Sources schedule the link themselves
+        // when they insert a flit that is ready earlier.
+        Cycles wait(1);
+        Tick ready = link_srcQueue->peekTopFlit()->get_time();
+        if (ready > clockEdge(wait)) {
+            wait = ticksToCycles(ready - curTick());
+            m_skipped_wakeups.sleep(curCycle());
+        }
+        scheduleEvent(wait);
     }
 }
 
+Tick
+NetworkLink::reserve(Tick ready, int num_flits, int vnet)
+{
+    const Tick period = clockPeriod();
+    const Tick start =
+        std::max(divCeil(ready, period) * period, m_reserved_until);
+    m_reserved_until = start + num_flits * period;
+
+    // There are no virtual channels in the analytical model, the load of
+    // a vnet is accounted to its first vc.
+    m_link_utilized += num_flits;
+    if (!m_vc_load.empty())
+        m_vc_load[vnet * (m_vc_load.size() / m_virt_nets)] += num_flits;
+
+    DPRINTF(RubyNetwork, "Reserved %d flits from %ld, head arrives at "
+            "%ld\n", num_flits, start, start + cyclesToTicks(m_latency));
+    return start + cyclesToTicks(m_latency);
+}
+
 void
 NetworkLink::resetStats()
 {
@@ -108,6 +158,7 @@ NetworkLink::resetStats()
     }
 
     m_link_utilized = 0;
+    m_skipped_wakeups.reset(curCycle());
 }
 
 uint32_t
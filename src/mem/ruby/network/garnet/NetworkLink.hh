@@ -34,8 +34,10 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_NETWORKLINK_HH__
 
 #include <iostream>
+#include <mutex>
 #include <vector>
 
+#include "base/uncontended_mutex.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
 #include "mem/ruby/network/garnet/flitBuffer.hh"
@@ -62,15 +64,60 @@ class NetworkLink : public ClockedObject, public Consumer
     virtual void wakeup();
 
     unsigned int getLinkUtilization() const { return m_link_utilized; }
+    uint64_t getSkippedWakeups() const { return m_skipped_wakeups.count(); }
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
 
+    /**
+     * A link is remote if its consumer is serviced by a different event
+     * queue, i.e., it connects two partitions of a parallel network.
+     * Flits (or credits) crossing a remote link are handed over through
+     * the link buffer under a lock, and the consumer is woken up by an
+     * event scheduled on its own queue. The link latency is the
+     * lookahead of the partitions, so it must cover the simulation
+     * quantum.
+     */
+    bool isRemote() const { return m_remote_consumer; }
+    Tick lookahead() const { return cyclesToTicks(m_latency); }
+
     inline bool isReady(Tick curTime)
     {
+        if (m_remote_consumer) {
+            std::lock_guard<UncontendedMutex> lock(m_buffer_mutex);
+            return linkBuffer.isReady(curTime);
+        }
         return linkBuffer.isReady(curTime);
     }
 
-    inline flit* peekLink() { return linkBuffer.peekTopFlit(); }
-    inline flit* consumeLink() { return linkBuffer.getTopFlit(); }
+    inline flit*
+    peekLink()
+    {
+        if (m_remote_consumer) {
+            std::lock_guard<UncontendedMutex> lock(m_buffer_mutex);
+            return linkBuffer.peekTopFlit();
+        }
+        return linkBuffer.peekTopFlit();
+    }
+
+    inline flit*
+    consumeLink()
+    {
+        if (m_remote_consumer) {
+            std::lock_guard<UncontendedMutex> lock(m_buffer_mutex);
+            return linkBuffer.getTopFlit();
+        }
+        return linkBuffer.getTopFlit();
+    }
+
+    /**
+     * Reserve the link for a packet of num_flits flits of vnet whose
+     * head flit is ready to cross at tick ready. This is the per-link
+     * occupancy model of the analytical network: the packet waits until
+     * the flits of the packets that reserved the link before it have
+     * been sent, and then occupies the link for one cycle per flit.
+     *
+     * @return The tick at which the head flit reaches the consumer.
+     */
+    Tick reserve(Tick ready, int num_flits, int vnet);
 
     uint32_t functionalWrite(Packet *);
     void resetStats();
@@ -85,9 +132,16 @@ class NetworkLink : public ClockedObject, public Consumer
 
     ClockedObject *src_object;
 
+    bool m_remote_consumer;
+    UncontendedMutex m_buffer_mutex;
+
+    // First tick at which the analytical model can send a flit
+    Tick m_reserved_until;
+
     // Statistical variables
     unsigned int m_link_utilized;
     std::vector<unsigned int> m_vc_load;
+    SkippedWakeups m_skipped_wakeups;
 
   protected:
     uint32_t m_virt_nets;
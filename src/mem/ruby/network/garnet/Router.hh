@@ -118,6 +118,12 @@ class Router : public BasicRouter, public Consumer
     void collateStats();
     void resetStats();
 
+    uint64_t
+    getSkippedWakeups()
+    {
+        return switchAllocator.get_skipped_wakeups();
+    }
+
     // For Fault Model:
     bool get_fault_vector(int temperature, float fault_vector[]) {
         return m_network_ptr->fault_model->fault_vector(m_id, temperature,
@@ -46,6 +46,8 @@ SwitchAllocator::SwitchAllocator(Router *router)
 
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+
+    m_switch_requested = false;
 }
 
 void
@@ -86,6 +88,8 @@ SwitchAllocator::init()
 void
 SwitchAllocator::wakeup()
 {
+    m_skipped_wakeups.wakeup(m_router->curCycle());
+
     arbitrate_inports(); // First stage of allocation
     arbitrate_outports(); // Second stage of allocation
 
@@ -106,6 +110,8 @@ SwitchAllocator::wakeup()
 void
 SwitchAllocator::arbitrate_inports()
 {
+    m_switch_requested = false;
+
     // Select a VC from each input in a round robin manner
     // Independent arbiter at each input port
     for (int inport = 0; inport < m_num_inports; inport++) {
@@ -126,6 +132,7 @@ SwitchAllocator::arbitrate_inports()
                     send_allowed(inport, invc, outport, outvc);
 
                 if (make_request) {
+                    m_switch_requested = true;
                     m_input_arbiter_activity++;
                     m_port_requests[outport][inport] = true;
                     m_vc_winners[outport][inport]= invc;
@@ -349,6 +356,11 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
 
 // Wakeup the router next cycle to perform SA again
 // if there are flits ready.
+// If none of the flits ready for SA could even request its output port,
+// they all wait for a free output vc or a credit. Both come with a
+// credit, whose arrival wakes the router up, so polling until then would
+// only repeat the same failed requests. Flits that become ready for SA
+// later have a wakeup scheduled by their InputUnit.
 void
 SwitchAllocator::check_for_wakeup()
 {
@@ -361,7 +373,10 @@ SwitchAllocator::check_for_wakeup()
     for (int i = 0; i < m_num_inports; i++) {
         for (int j = 0; j < m_num_vcs; j++) {
             if (m_router->getInputUnit(i)->need_stage(j, SA_, nextCycle)) {
-                m_router->schedule_wakeup(Cycles(1));
+                if (m_switch_requested)
+                    m_router->schedule_wakeup(Cycles(1));
+                else
+                    m_skipped_wakeups.sleep(m_router->curCycle());
                 return;
             }
         }
@@ -394,4 +409,5 @@ SwitchAllocator::resetStats()
 {
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+    m_skipped_wakeups.reset(m_router->curCycle());
 }
@@ -67,6 +67,11 @@ class SwitchAllocator : public Consumer
     {
         return m_output_arbiter_activity;
     }
+    inline uint64_t
+    get_skipped_wakeups()
+    {
+        return m_skipped_wakeups.count();
+    }
 
     void resetStats();
 
@@ -76,6 +81,11 @@ class SwitchAllocator : public Consumer
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
 
+    // Whether any input vc requested an output port this cycle
+    bool m_switch_requested;
+    // Cycles the router did not wake up for flits waiting for credits
+    SkippedWakeups m_skipped_wakeups;
+
     Router *m_router;
     std::vector<int> m_round_robin_invc;
     std::vector<int> m_round_robin_inport;
@@ -52,6 +52,7 @@
 
 #include "base/stl_helpers.hh"
 #include "base/str.hh"
+#include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/profiler/AddressProfiler.hh"
 #include "mem/ruby/protocol/MachineType.hh"
@@ -113,7 +114,11 @@ ProfilerStats::ProfilerStats(Stats::Group *parent, Profiler *profiler)
       ADD_STAT(m_latencyHistCoalsr, ""),
       ADD_STAT(m_hitLatencyHistSeqr, ""),
       ADD_STAT(m_missLatencyHistSeqr, ""),
-      ADD_STAT(m_missLatencyHistCoalsr, "")
+      ADD_STAT(m_missLatencyHistCoalsr, ""),
+      ADD_STAT(m_dataBlockBytesCopied, UNIT_BYTE,
+               "bytes copied between data blocks"),
+      ADD_STAT(m_dataBlockSharedCopies, UNIT_COUNT,
+               "data block copies that shared the data instead")
 {
     delayHistogram
         .init(10)
@@ -553,6 +558,9 @@ Profiler::collateStats()
 #endif
         }
     }
+
+    rubyProfilerStats.m_dataBlockBytesCopied = DataBlock::getBytesCopied();
+    rubyProfilerStats.m_dataBlockSharedCopies = DataBlock::getSharedCopies();
 }
 
 void
@@ -178,6 +178,10 @@ class Profiler
         //! miss in the controller connected to this sequencer.
         Stats::Histogram m_missLatencyHistSeqr;
         Stats::Histogram m_missLatencyHistCoalsr;
+
+        //! Copies of the data of cache blocks, see DataBlock
+        Stats::Scalar m_dataBlockBytesCopied;
+        Stats::Scalar m_dataBlockSharedCopies;
     };
 
     //added by SS
@@ -41,6 +41,9 @@
 
 #include "mem/ruby/structures/CacheMemory.hh"
 
+#include <algorithm>
+
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "debug/HtmMem.hh"
@@ -49,6 +52,7 @@
 #include "debug/RubyResourceStalls.hh"
 #include "debug/RubyStats.hh"
 #include "mem/cache/replacement_policies/weighted_lru_rp.hh"
+#include "mem/cache/tags/tag_index.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
@@ -92,6 +96,8 @@ CacheMemory::init()
 
     m_cache.resize(m_cache_num_sets,
                     std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
+    m_tag_keys_stride = roundUp(m_cache_assoc, 4);
+    m_tag_keys.resize(m_cache_num_sets * m_tag_keys_stride, 0);
     replacement_data.resize(m_cache_num_sets,
                                std::vector<ReplData>(m_cache_assoc, nullptr));
     // instantiate all the replacement_data here
@@ -128,13 +134,10 @@ CacheMemory::addressToCacheSet(Addr address) const
 int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
-    assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
+    int way = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (way != -1 &&
+        m_cache[cacheSet][way]->m_Permission != AccessPermission_NotPresent)
+        return way;
     return -1; // Not found
 }
 
@@ -145,10 +148,16 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
                                            Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
+    // search the set for the tags, up to 64 ways at a time
+    const uint64_t key = TagIndex::makeKey(tag, false);
+    const uint64_t *row = &m_tag_keys[cacheSet * m_tag_keys_stride];
+    for (int way = 0; way < m_tag_keys_stride; way += TagIndex::MaxAssoc) {
+        const unsigned stride = std::min<unsigned>(m_tag_keys_stride - way,
+                                                   TagIndex::MaxAssoc);
+        const uint64_t mask = TagIndex::matchKeys(row + way, stride, key);
+        if (mask)
+            return way + ctz64(mask);
+    }
     return -1; // Not found
 }
 
@@ -284,7 +293,7 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            *tagKey(cacheSet, i) = TagIndex::makeKey(address, false);
             set[i]->setPosition(cacheSet, i);
             set[i]->replacementData = replacement_data[cacheSet][i];
             set[i]->setLastAccess(curTick());
@@ -310,7 +319,7 @@ CacheMemory::deallocate(Addr address)
     uint32_t way = entry->getWay();
     delete entry;
     m_cache[cache_set][way] = NULL;
-    m_tag_index.erase(address);
+    *tagKey(cache_set, way) = 0;
 }
 
 // Returns with the physical address of the conflicting cache line
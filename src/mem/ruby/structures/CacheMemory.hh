@@ -43,7 +43,6 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -162,6 +161,12 @@ class CacheMemory : public SimObject
     int findTagInSet(int64_t line, Addr tag) const;
     int findTagInSetIgnorePermissions(int64_t cacheSet, Addr tag) const;
 
+    // Key of an address in m_tag_keys, zero if the way is empty
+    uint64_t *tagKey(int64_t cacheSet, int way)
+    {
+        return &m_tag_keys[cacheSet * m_tag_keys_stride + way];
+    }
+
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
     CacheMemory& operator=(const CacheMemory& obj);
@@ -172,9 +177,14 @@ class CacheMemory : public SimObject
 
     // The first index is the # of cache lines.
     // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
     std::vector<std::vector<AbstractCacheEntry*> > m_cache;
 
+    // Flat copy of the addresses held by m_cache, with the ways of a set
+    // padded to m_tag_keys_stride keys so that a lookup compares several
+    // ways at once. The keys are laid out as in the classic TagIndex.
+    std::vector<uint64_t> m_tag_keys;
+    int m_tag_keys_stride;
+
     /** We use the replacement policies from the Classic memory system. */
     ReplacementPolicy::Base *m_replacementPolicy_ptr;
 
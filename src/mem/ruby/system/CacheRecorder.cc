@@ -29,10 +29,21 @@
 
 #include "mem/ruby/system/CacheRecorder.hh"
 
+#include <algorithm>
+
 #include "debug/RubyCacheTrace.hh"
 #include "mem/ruby/system/RubySystem.hh"
 #include "mem/ruby/system/Sequencer.hh"
 
+// Number of records read ahead of the ones being replayed. Together
+// with the records in flight, this bounds the memory used by warmup.
+static const uint64_t readAheadRecords = 4 * CacheRecorder::recordsPerChunk;
+
+// Request types a line has been replayed with, see isRedundant().
+static const uint8_t replayedLoad = 0x1;
+static const uint8_t replayedIfetch = 0x2;
+static const uint8_t replayedStore = 0x4;
+
 void
 TraceRecord::print(std::ostream& out) const
 {
@@ -42,22 +53,34 @@ TraceRecord::print(std::ostream& out) const
 }
 
 CacheRecorder::CacheRecorder()
-    : m_uncompressed_trace(NULL),
-      m_uncompressed_trace_size(0),
-      m_block_size_bytes(RubySystem::getBlockSizeBytes())
+    : m_records_read(0), m_records_skipped(0), m_records_flushed(0),
+      m_block_size_bytes(RubySystem::getBlockSizeBytes()),
+      m_trace(NULL), m_trace_format(TraceFormatChunked), m_trace_size(0),
+      m_bytes_read(0), m_chunk_records_left(0), m_parallel(false),
+      m_records_buffered(0)
 {
 }
 
-CacheRecorder::CacheRecorder(uint8_t* uncompressed_trace,
-                             uint64_t uncompressed_trace_size,
+CacheRecorder::CacheRecorder(const std::string &trace_file,
+                             TraceFormat format, uint64_t trace_size,
                              std::vector<Sequencer*>& seq_map,
-                             uint64_t block_size_bytes)
-    : m_uncompressed_trace(uncompressed_trace),
-      m_uncompressed_trace_size(uncompressed_trace_size),
-      m_seq_map(seq_map),  m_bytes_read(0), m_records_read(0),
-      m_records_flushed(0), m_block_size_bytes(block_size_bytes)
+                             uint64_t block_size_bytes, bool parallel)
+    : m_seq_map(seq_map), m_records_read(0), m_records_skipped(0),
+      m_records_flushed(0), m_block_size_bytes(block_size_bytes),
+      m_trace(NULL), m_trace_name(trace_file), m_trace_format(format),
+      m_trace_size(trace_size), m_bytes_read(0), m_chunk_records_left(0),
+      m_parallel(parallel), m_records_buffered(0)
 {
-    if (m_uncompressed_trace != NULL) {
+    for (auto seq : m_seq_map) {
+        if (m_seq_index.count(seq) == 0) {
+            m_seq_index[seq] = m_seqs.size();
+            m_seqs.push_back(seq);
+        }
+    }
+    m_lanes.resize(parallel ? m_seqs.size() : 1);
+    m_replayed.resize(m_seqs.size());
+
+    if (!m_trace_name.empty()) {
         if (m_block_size_bytes < RubySystem::getBlockSizeBytes()) {
             // Block sizes larger than when the trace was recorded are not
             // supported, as we cannot reliably turn accesses to smaller blocks
@@ -65,15 +88,26 @@ CacheRecorder::CacheRecorder(uint8_t* uncompressed_trace,
             panic("Recorded cache block size (%d) < current block size (%d) !!",
                     m_block_size_bytes, RubySystem::getBlockSizeBytes());
         }
+
+        m_trace = gzopen(m_trace_name.c_str(), "rb");
+        if (m_trace == NULL)
+            fatal("Unable to open trace file %s", m_trace_name);
     }
 }
 
 CacheRecorder::~CacheRecorder()
 {
-    if (m_uncompressed_trace != NULL) {
-        delete [] m_uncompressed_trace;
-        m_uncompressed_trace = NULL;
+    if (m_trace != NULL) {
+        gzclose(m_trace);
+        m_trace = NULL;
+    }
+    for (auto &lane : m_lanes) {
+        for (auto rec : lane.pending)
+            free(rec);
+        free(lane.current);
     }
+    for (auto rec : m_records)
+        free(rec);
     m_seq_map.clear();
 }
 
@@ -83,9 +117,9 @@ CacheRecorder::enqueueNextFlushRequest()
     if (m_records_flushed < m_records.size()) {
         TraceRecord* rec = m_records[m_records_flushed];
         m_records_flushed++;
-        auto req = std::make_shared<Request>(rec->m_data_address,
-                                             m_block_size_bytes, 0,
-                                             Request::funcRequestorId);
+        auto req = Request::create(rec->m_data_address,
+                                   m_block_size_bytes, 0,
+                                   Request::funcRequestorId);
         MemCmd::Command requestType = MemCmd::FlushReq;
         Packet *pkt = new Packet(req, requestType);
 
@@ -99,55 +133,170 @@ CacheRecorder::enqueueNextFlushRequest()
     }
 }
 
+TraceRecord *
+CacheRecorder::readRecord()
+{
+    if (m_trace == NULL)
+        return NULL;
+
+    if (m_trace_format == TraceFormatChunked) {
+        while (m_chunk_records_left == 0) {
+            TraceChunkHeader header;
+            int bytes = gzread(m_trace, &header, sizeof(header));
+            if (bytes == 0) {
+                fatal_if(m_bytes_read != m_trace_size,
+                         "Cache trace %s is truncated\n", m_trace_name);
+                return NULL;
+            }
+            if (bytes != sizeof(header) || header.m_magic != chunkMagic)
+                fatal("Corrupt chunk in cache trace %s\n", m_trace_name);
+            m_bytes_read += sizeof(header);
+            m_chunk_records_left = header.m_num_records;
+        }
+        m_chunk_records_left--;
+    } else if (m_bytes_read >= m_trace_size) {
+        return NULL;
+    }
+
+    TraceRecord *rec = (TraceRecord*)malloc(recordSize());
+    if (gzread(m_trace, rec, recordSize()) != (int)recordSize())
+        fatal("Unable to read complete trace from file %s\n", m_trace_name);
+    m_bytes_read += recordSize();
+    m_records_read++;
+    return rec;
+}
+
+bool
+CacheRecorder::isRedundant(unsigned seq_idx, const TraceRecord *rec)
+{
+    // Replaying a line through a sequencer that has already fetched it
+    // with the same request, or has already written it, only updates
+    // the replacement state, as the same line is often held by several
+    // caches behind the same sequencer (e.g. an L1 and a shared L2).
+    // A store elsewhere may take the line away, so it is forgotten for
+    // all the other sequencers.
+    uint8_t type;
+    if (rec->m_type == RubyRequestType_LD) {
+        type = replayedLoad;
+    } else if (rec->m_type == RubyRequestType_IFETCH) {
+        type = replayedIfetch;
+    } else {
+        type = replayedStore;
+        for (unsigned i = 0; i < m_replayed.size(); i++) {
+            if (i != seq_idx)
+                m_replayed[i].erase(rec->m_data_address);
+        }
+    }
+
+    uint8_t &replayed = m_replayed[seq_idx][rec->m_data_address];
+    bool redundant = (replayed & type) ||
+        (type == replayedLoad && (replayed & replayedStore));
+    replayed |= type;
+    return redundant;
+}
+
 void
-CacheRecorder::enqueueNextFetchRequest()
+CacheRecorder::fillLanes()
+{
+    while (m_records_buffered < readAheadRecords) {
+        TraceRecord *rec = readRecord();
+        if (rec == NULL)
+            break;
+
+        assert(rec->m_cntrl_id < m_seq_map.size());
+        unsigned seq_idx = m_seq_index[m_seq_map[rec->m_cntrl_id]];
+        // Skipping records changes the order in which the others are
+        // replayed, so it is only done when that order is relaxed anyway.
+        if (m_parallel && isRedundant(seq_idx, rec)) {
+            DPRINTF(RubyCacheTrace, "Skipping %s\n", *rec);
+            m_records_skipped++;
+            free(rec);
+            continue;
+        }
+
+        m_lanes[m_parallel ? seq_idx : 0].pending.push_back(rec);
+        m_records_buffered++;
+    }
+}
+
+void
+CacheRecorder::issueRecord(Sequencer *seq, const TraceRecord *rec)
 {
-    if (m_bytes_read < m_uncompressed_trace_size) {
-        TraceRecord* traceRecord = (TraceRecord*) (m_uncompressed_trace +
-                                                                m_bytes_read);
-
-        DPRINTF(RubyCacheTrace, "Issuing %s\n", *traceRecord);
-
-        for (int rec_bytes_read = 0; rec_bytes_read < m_block_size_bytes;
-                rec_bytes_read += RubySystem::getBlockSizeBytes()) {
-            RequestPtr req;
-            MemCmd::Command requestType;
-
-            if (traceRecord->m_type == RubyRequestType_LD) {
-                requestType = MemCmd::ReadReq;
-                req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
-                                    Request::funcRequestorId);
-            }   else if (traceRecord->m_type == RubyRequestType_IFETCH) {
-                requestType = MemCmd::ReadReq;
-                req = std::make_shared<Request>(
-                        traceRecord->m_data_address + rec_bytes_read,
-                        RubySystem::getBlockSizeBytes(),
-                        Request::INST_FETCH, Request::funcRequestorId);
-            }   else {
-                requestType = MemCmd::WriteReq;
-                req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
+    DPRINTF(RubyCacheTrace, "Issuing %s\n", *rec);
+
+    for (int rec_bytes_read = 0; rec_bytes_read < m_block_size_bytes;
+            rec_bytes_read += RubySystem::getBlockSizeBytes()) {
+        RequestPtr req;
+        MemCmd::Command requestType;
+
+        if (rec->m_type == RubyRequestType_LD) {
+            requestType = MemCmd::ReadReq;
+            req = Request::create(
+                rec->m_data_address + rec_bytes_read,
+                RubySystem::getBlockSizeBytes(), 0,
                                 Request::funcRequestorId);
-            }
+        }   else if (rec->m_type == RubyRequestType_IFETCH) {
+            requestType = MemCmd::ReadReq;
+            req = Request::create(
+                    rec->m_data_address + rec_bytes_read,
+                    RubySystem::getBlockSizeBytes(),
+                    Request::INST_FETCH, Request::funcRequestorId);
+        }   else {
+            requestType = MemCmd::WriteReq;
+            req = Request::create(
+                rec->m_data_address + rec_bytes_read,
+                RubySystem::getBlockSizeBytes(), 0,
+                            Request::funcRequestorId);
+        }
 
-            Packet *pkt = new Packet(req, requestType);
-            pkt->dataStatic(traceRecord->m_data + rec_bytes_read);
+        Packet *pkt = new Packet(req, requestType);
+        pkt->dataStatic(rec->m_data + rec_bytes_read);
+
+        assert(seq != NULL);
+        seq->makeRequest(pkt);
+    }
+}
+
+void
+CacheRecorder::enqueueNextFetchRequest()
+{
+    fillLanes();
 
-            Sequencer* m_sequencer_ptr = m_seq_map[traceRecord->m_cntrl_id];
-            assert(m_sequencer_ptr != NULL);
-            m_sequencer_ptr->makeRequest(pkt);
+    bool busy = false;
+    for (auto &lane : m_lanes) {
+        if (lane.current == nullptr && !lane.pending.empty()) {
+            lane.current = lane.pending.front();
+            lane.pending.pop_front();
+            m_records_buffered--;
+
+            // A record from a trace with larger blocks is replayed as
+            // several requests, which must all complete.
+            lane.outstanding =
+                m_block_size_bytes / RubySystem::getBlockSizeBytes();
+            issueRecord(m_seq_map[lane.current->m_cntrl_id], lane.current);
         }
+        busy |= lane.current != nullptr;
+    }
 
-        m_bytes_read += (sizeof(TraceRecord) + m_block_size_bytes);
-        m_records_read++;
-    } else {
-        DPRINTF(RubyCacheTrace, "Fetched all %d records\n", m_records_read);
+    if (!busy) {
+        DPRINTF(RubyCacheTrace, "Fetched all %d records, skipped %d\n",
+                m_records_read, m_records_skipped);
     }
 }
 
+void
+CacheRecorder::fetchRequestComplete(Sequencer *seq)
+{
+    ReplayLane &lane = m_lanes[m_parallel ? m_seq_index.at(seq) : 0];
+    assert(lane.current != nullptr && lane.outstanding > 0);
+    if (--lane.outstanding > 0)
+        return;
+
+    free(lane.current);
+    lane.current = nullptr;
+    enqueueNextFetchRequest();
+}
+
 void
 CacheRecorder::addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                          RubyRequestType type, Tick time, DataBlock& data)
@@ -166,37 +315,41 @@ CacheRecorder::addRecord(int cntrl, Addr data_addr, Addr pc_addr,
 }
 
 uint64_t
-CacheRecorder::aggregateRecords(uint8_t **buf, uint64_t total_size)
+CacheRecorder::writeRecords(const std::string &filename)
 {
     std::sort(m_records.begin(), m_records.end(), compareTraceRecords);
 
-    int size = m_records.size();
-    uint64_t current_size = 0;
-    int record_size = sizeof(TraceRecord) + m_block_size_bytes;
-
-    for (int i = 0; i < size; ++i) {
-        // Determine if we need to expand the buffer size
-        if (current_size + record_size > total_size) {
-            uint8_t* new_buf = new (std::nothrow) uint8_t[total_size * 2];
-            if (new_buf == NULL) {
-                fatal("Unable to allocate buffer of size %s\n",
-                      total_size * 2);
-            }
-            total_size = total_size * 2;
-            uint8_t* old_buf = *buf;
-            memcpy(new_buf, old_buf, current_size);
-            *buf = new_buf;
-            delete [] old_buf;
-        }
+    gzFile trace = gzopen(filename.c_str(), "wb");
+    if (trace == NULL)
+        fatal("Can't open memory trace file '%s'\n", filename);
+
+    uint64_t trace_size = 0;
+    auto write = [&](const void *data, size_t size) {
+        if (gzwrite(trace, data, size) != (int)size)
+            fatal("Write failed on memory trace file '%s'\n", filename);
+        trace_size += size;
+    };
 
-        // Copy the current record into the buffer
-        memcpy(&((*buf)[current_size]), m_records[i], record_size);
-        current_size += record_size;
+    for (size_t first = 0; first < m_records.size();
+         first += recordsPerChunk) {
+        size_t last = std::min<size_t>(first + recordsPerChunk,
+                                       m_records.size());
 
-        free(m_records[i]);
-        m_records[i] = NULL;
+        TraceChunkHeader header;
+        header.m_magic = chunkMagic;
+        header.m_num_records = last - first;
+        write(&header, sizeof(header));
+
+        for (size_t i = first; i < last; ++i) {
+            write(m_records[i], recordSize());
+            free(m_records[i]);
+            m_records[i] = NULL;
+        }
     }
 
+    if (gzclose(trace))
+        fatal("Close failed on memory trace file '%s'\n", filename);
+
     m_records.clear();
-    return current_size;
+    return trace_size;
 }
@@ -35,6 +35,11 @@
 #ifndef __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 #define __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 
+#include <zlib.h>
+
+#include <deque>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "base/types.hh"
@@ -63,20 +68,55 @@ class TraceRecord {
     void print(std::ostream& out) const;
 };
 
+/*!
+ * Header written in front of every chunk of records in a chunked cache
+ * trace. Chunking lets the trace be written and replayed as a stream,
+ * without ever holding all of it in memory.
+ */
+struct TraceChunkHeader
+{
+    uint32_t m_magic;
+    uint32_t m_num_records;
+};
+
 class CacheRecorder
 {
   public:
+    /** On-disk layouts of the cache trace. */
+    enum TraceFormat
+    {
+        /** A single flat array of records (older checkpoints). */
+        TraceFormatFlat = 0,
+        /** Records grouped in chunks, each with a TraceChunkHeader. */
+        TraceFormatChunked = 1,
+    };
+
+    static const uint32_t chunkMagic = 0x43524352;
+    static const uint32_t recordsPerChunk = 4096;
+
     CacheRecorder();
-    ~CacheRecorder();
+    virtual ~CacheRecorder();
 
-    CacheRecorder(uint8_t* uncompressed_trace,
-                  uint64_t uncompressed_trace_size,
+    /*!
+     * Create a recorder that replays the trace in trace_file. The
+     * trace is read a chunk at a time while the warmup progresses.
+     * If parallel is set, every sequencer replays its own records
+     * independently of the others, and redundant records are skipped.
+     * Otherwise every record is replayed, one at a time in trace order.
+     */
+    CacheRecorder(const std::string &trace_file, TraceFormat format,
+                  uint64_t trace_size,
                   std::vector<Sequencer*>& SequencerMap,
-                  uint64_t block_size_bytes);
+                  uint64_t block_size_bytes, bool parallel);
     void addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                    RubyRequestType type, Tick time, DataBlock& data);
 
-    uint64_t aggregateRecords(uint8_t **data, uint64_t size);
+    /*!
+     * Sort the recorded records and stream them to a chunked, gzip
+     * compressed trace file. The records are released as they are
+     * written. Returns the uncompressed size of the trace.
+     */
+    uint64_t writeRecords(const std::string &filename);
 
     /*!
      * Function for flushing the memory contents of the caches to the
@@ -91,25 +131,90 @@ class CacheRecorder
     /*!
      * Function for fetching warming up the memory and the caches. It goes
      * through the recorded contents of the caches, as available in the
-     * checkpoint and issues fetch requests. Except for the first one, a
-     * fetch request is issued only after the previous one has completed.
-     * It should be possible to use this with any protocol.
+     * checkpoint and issues fetch requests. Each sequencer has at most
+     * one record in flight, and issues its next one only after the
+     * previous one has completed. When replaying in parallel, the
+     * sequencers progress independently, and a record is skipped if its
+     * sequencer has already replayed the same line with the same or a
+     * stronger request. It should be possible to use this with any
+     * protocol.
      */
     void enqueueNextFetchRequest();
 
+    /*!
+     * Called by a sequencer when one of the fetch requests issued
+     * through it during warmup has completed.
+     */
+    void fetchRequestComplete(Sequencer *seq);
+
+    uint64_t recordsRead() const { return m_records_read; }
+    uint64_t recordsSkipped() const { return m_records_skipped; }
+
+  protected:
+    /** Issue the requests that replay rec through seq. */
+    virtual void issueRecord(Sequencer *seq, const TraceRecord *rec);
+
   private:
     // Private copy constructor and assignment operator
     CacheRecorder(const CacheRecorder& obj);
     CacheRecorder& operator=(const CacheRecorder& obj);
 
+    /*!
+     * Records waiting to be replayed through one or more sequencers,
+     * and the record currently being replayed.
+     */
+    struct ReplayLane
+    {
+        std::deque<TraceRecord*> pending;
+        TraceRecord *current = nullptr;
+        unsigned outstanding = 0;
+    };
+
+    /** Read the next record from the trace, NULL at its end. */
+    TraceRecord *readRecord();
+
+    /*!
+     * Read records into the replay lanes until the read-ahead window
+     * is full or the trace ends, dropping redundant records.
+     */
+    void fillLanes();
+
+    /** Check (and note) if a record repeats an earlier one. */
+    bool isRedundant(unsigned seq_idx, const TraceRecord *rec);
+
+    size_t recordSize() const
+    {
+        return sizeof(TraceRecord) + m_block_size_bytes;
+    }
+
     std::vector<TraceRecord*> m_records;
-    uint8_t* m_uncompressed_trace;
-    uint64_t m_uncompressed_trace_size;
     std::vector<Sequencer*> m_seq_map;
-    uint64_t m_bytes_read;
     uint64_t m_records_read;
+    uint64_t m_records_skipped;
     uint64_t m_records_flushed;
     uint64_t m_block_size_bytes;
+
+    /** The trace being replayed. */
+    gzFile m_trace;
+    std::string m_trace_name;
+    TraceFormat m_trace_format;
+    uint64_t m_trace_size;
+    uint64_t m_bytes_read;
+    uint32_t m_chunk_records_left;
+
+    /** The distinct sequencers in m_seq_map and their indices. */
+    std::vector<Sequencer*> m_seqs;
+    std::unordered_map<Sequencer*, unsigned> m_seq_index;
+
+    /** Replay the sequencers independently, skipping redundant records. */
+    bool m_parallel;
+
+    /** One lane per sequencer when replaying in parallel, else one. */
+    std::vector<ReplayLane> m_lanes;
+    uint64_t m_records_buffered;
+
+    /** Per sequencer, the request types replayed for each line. */
+    std::vector<std::unordered_map<Addr, uint8_t>> m_replayed;
 };
 
 inline bool
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "mem/ruby/system/CacheRecorder.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+// The test does not create a Ruby system, it only needs its block size
+uint32_t RubySystem::m_block_size_bytes = 64;
+uint32_t RubySystem::m_block_size_bits = 6;
+
+namespace
+{
+
+const int blockSize = 64;
+
+/** Sequencers are only used as keys, they are never dereferenced. */
+int seqStorage[2];
+Sequencer *const seqA = reinterpret_cast<Sequencer *>(&seqStorage[0]);
+Sequencer *const seqB = reinterpret_cast<Sequencer *>(&seqStorage[1]);
+
+struct Access
+{
+    int cntrl;
+    Addr addr;
+    RubyRequestType type;
+};
+
+/** A recorder which notes the records it replays instead of issuing them. */
+class TestRecorder : public CacheRecorder
+{
+  public:
+    using CacheRecorder::CacheRecorder;
+
+    struct Issued
+    {
+        Sequencer *seq;
+        Addr addr;
+        uint8_t data;
+    };
+    std::vector<Issued> issued;
+
+    /** Replay the whole trace, completing the requests in issue order. */
+    void
+    replay()
+    {
+        enqueueNextFetchRequest();
+        for (size_t i = 0; i < issued.size(); i++)
+            fetchRequestComplete(issued[i].seq);
+    }
+
+  protected:
+    void
+    issueRecord(Sequencer *seq, const TraceRecord *rec) override
+    {
+        issued.push_back({ seq, rec->m_data_address, rec->m_data[0] });
+    }
+};
+
+class CacheRecorderTest : public ::testing::Test
+{
+  protected:
+    std::string traceName;
+    std::vector<Sequencer *> seqMap;
+
+    void
+    SetUp() override
+    {
+        char name[] = "/tmp/cache_trace.XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        traceName = name;
+        // Controllers 0 and 1 share a sequencer, e.g. an L1 and an L2
+        seqMap = { seqA, seqA, seqB };
+    }
+
+    void TearDown() override { std::remove(traceName.c_str()); }
+
+    /**
+     * Write a chunked trace of the accesses, which are replayed in the
+     * order given, with the index of each in the first byte of its data.
+     */
+    uint64_t
+    writeChunked(const std::vector<Access> &accesses)
+    {
+        CacheRecorder recorder;
+        for (size_t i = 0; i < accesses.size(); i++) {
+            DataBlock data;
+            data.setByte(0, i);
+            // Traces are replayed from the most recent access
+            recorder.addRecord(accesses[i].cntrl, accesses[i].addr, 0,
+                               accesses[i].type, accesses.size() - i, data);
+        }
+        return recorder.writeRecords(traceName);
+    }
+
+    /** Write a flat trace, as found in older checkpoints. */
+    uint64_t
+    writeFlat(const std::vector<Access> &accesses)
+    {
+        gzFile trace = gzopen(traceName.c_str(), "wb");
+        const size_t size = sizeof(TraceRecord) + blockSize;
+        TraceRecord *rec = (TraceRecord *)calloc(1, size);
+        for (size_t i = 0; i < accesses.size(); i++) {
+            rec->m_cntrl_id = accesses[i].cntrl;
+            rec->m_time = accesses.size() - i;
+            rec->m_data_address = accesses[i].addr;
+            rec->m_pc_address = 0;
+            rec->m_type = accesses[i].type;
+            rec->m_data[0] = i;
+            EXPECT_EQ((int)size, gzwrite(trace, rec, size));
+        }
+        free(rec);
+        gzclose(trace);
+        return accesses.size() * size;
+    }
+};
+
+} // anonymous namespace
+
+TEST_F(CacheRecorderTest, ChunkedRoundTrip)
+{
+    // Span several chunks, the last of them partial
+    std::vector<Access> accesses;
+    const size_t num = 2 * CacheRecorder::recordsPerChunk + 3;
+    for (size_t i = 0; i < num; i++)
+        accesses.push_back({ 2, i * blockSize, RubyRequestType_LD });
+
+    const uint64_t size = writeChunked(accesses);
+    EXPECT_EQ(3 * sizeof(TraceChunkHeader) +
+              num * (sizeof(TraceRecord) + blockSize), size);
+
+    TestRecorder recorder(traceName, CacheRecorder::TraceFormatChunked,
+                          size, seqMap, blockSize, false);
+    recorder.replay();
+    ASSERT_EQ(num, recorder.issued.size());
+    for (size_t i = 0; i < num; i++) {
+        EXPECT_EQ(seqB, recorder.issued[i].seq);
+        EXPECT_EQ(i * blockSize, recorder.issued[i].addr);
+        EXPECT_EQ(uint8_t(i), recorder.issued[i].data);
+    }
+    EXPECT_EQ(num, recorder.recordsRead());
+    EXPECT_EQ(0, recorder.recordsSkipped());
+}
+
+TEST_F(CacheRecorderTest, FlatFallback)
+{
+    const std::vector<Access> accesses = {
+        { 0, 0x1000, RubyRequestType_LD },
+        { 2, 0x2000, RubyRequestType_ST },
+        { 1, 0x1000, RubyRequestType_IFETCH },
+    };
+    const uint64_t size = writeFlat(accesses);
+
+    TestRecorder recorder(traceName, CacheRecorder::TraceFormatFlat, size,
+                          seqMap, blockSize, false);
+    recorder.replay();
+    ASSERT_EQ(3, recorder.issued.size());
+    EXPECT_EQ(seqA, recorder.issued[0].seq);
+    EXPECT_EQ(0x1000, recorder.issued[0].addr);
+    EXPECT_EQ(seqB, recorder.issued[1].seq);
+    EXPECT_EQ(0x2000, recorder.issued[1].addr);
+    EXPECT_EQ(1, recorder.issued[1].data);
+    EXPECT_EQ(seqA, recorder.issued[2].seq);
+    EXPECT_EQ(0x1000, recorder.issued[2].addr);
+    EXPECT_EQ(3, recorder.recordsRead());
+}
+
+/** The same line loaded through both controllers of a sequencer. */
+const std::vector<Access> repeatedLoads = {
+    { 0, 0x1000, RubyRequestType_LD },
+    { 1, 0x1000, RubyRequestType_LD },
+    { 2, 0x1000, RubyRequestType_ST },
+    { 0, 0x1000, RubyRequestType_LD },
+};
+
+TEST_F(CacheRecorderTest, SerialReplaysEveryRecord)
+{
+    const uint64_t size = writeChunked(repeatedLoads);
+    TestRecorder recorder(traceName, CacheRecorder::TraceFormatChunked,
+                          size, seqMap, blockSize, false);
+    recorder.replay();
+    ASSERT_EQ(4, recorder.issued.size());
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_EQ(i, recorder.issued[i].data);
+    EXPECT_EQ(0, recorder.recordsSkipped());
+}
+
+TEST_F(CacheRecorderTest, ParallelSkipsRedundantRecords)
+{
+    const uint64_t size = writeChunked(repeatedLoads);
+    TestRecorder recorder(traceName, CacheRecorder::TraceFormatChunked,
+                          size, seqMap, blockSize, true);
+    recorder.replay();
+
+    // The second load is skipped, but the store through the other
+    // sequencer makes the line eligible again.
+    std::vector<uint8_t> replayed_a, replayed_b;
+    for (const auto &issued : recorder.issued)
+        (issued.seq == seqA ? replayed_a : replayed_b).push_back(issued.data);
+    EXPECT_EQ(std::vector<uint8_t>({ 0, 3 }), replayed_a);
+    EXPECT_EQ(std::vector<uint8_t>({ 2 }), replayed_b);
+    EXPECT_EQ(4, recorder.recordsRead());
+    EXPECT_EQ(1, recorder.recordsSkipped());
+}
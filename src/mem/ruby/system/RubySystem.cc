@@ -40,10 +40,7 @@
 
 #include "mem/ruby/system/RubySystem.hh"
 
-#include <fcntl.h>
-#include <zlib.h>
-
-#include <cstdio>
+#include <chrono>
 #include <list>
 
 #include "base/intmath.hh"
@@ -51,6 +48,7 @@
 #include "debug/RubyCacheTrace.hh"
 #include "debug/RubySystem.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/system/DMASequencer.hh"
 #include "mem/ruby/system/Sequencer.hh"
@@ -71,7 +69,7 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params &p)
     : ClockedObject(p), m_access_backing_store(p.access_backing_store),
-      m_cache_recorder(NULL)
+      m_parallel_warmup(p.parallel_warmup), m_cache_recorder(NULL)
 {
     m_randomization = p.randomization;
 
@@ -166,7 +164,8 @@ RubySystem::~RubySystem()
 }
 
 void
-RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
+RubySystem::makeCacheRecorder(const std::string &cache_trace_file,
+                              CacheRecorder::TraceFormat cache_trace_format,
                               uint64_t cache_trace_size,
                               uint64_t block_size_bytes)
 {
@@ -194,8 +193,11 @@ RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
     }
 
     // Create the CacheRecorder and record the cache trace
-    m_cache_recorder = new CacheRecorder(uncompressed_trace, cache_trace_size,
-                                         sequencer_map, block_size_bytes);
+    m_cache_recorder = new CacheRecorder(cache_trace_file,
+                                         cache_trace_format,
+                                         cache_trace_size, sequencer_map,
+                                         block_size_bytes,
+                                         m_parallel_warmup);
 }
 
 void
@@ -205,7 +207,8 @@ RubySystem::memWriteback()
 
     // Make the trace so we know what to write back.
     DPRINTF(RubyCacheTrace, "Recording Cache Trace\n");
-    makeCacheRecorder(NULL, 0, getBlockSizeBytes());
+    makeCacheRecorder("", CacheRecorder::TraceFormatChunked, 0,
+                      getBlockSizeBytes());
     for (int cntrl = 0; cntrl < m_abs_cntrl_vec.size(); cntrl++) {
         m_abs_cntrl_vec[cntrl]->recordCacheTrace(cntrl, m_cache_recorder);
     }
@@ -271,35 +274,6 @@ RubySystem::memWriteback()
     // checkpoint is immediately taken.
 }
 
-void
-RubySystem::writeCompressedTrace(uint8_t *raw_data, std::string filename,
-                                 uint64_t uncompressed_trace_size)
-{
-    // Create the checkpoint file for the memory
-    std::string thefile = CheckpointIn::dir() + "/" + filename.c_str();
-
-    int fd = creat(thefile.c_str(), 0664);
-    if (fd < 0) {
-        perror("creat");
-        fatal("Can't open memory trace file '%s'\n", filename);
-    }
-
-    gzFile compressedMemory = gzdopen(fd, "wb");
-    if (compressedMemory == NULL)
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
-
-    if (gzwrite(compressedMemory, raw_data, uncompressed_trace_size) !=
-        uncompressed_trace_size) {
-        fatal("Write failed on memory trace file '%s'\n", filename);
-    }
-
-    if (gzclose(compressedMemory)) {
-        fatal("Close failed on memory trace file '%s'\n", filename);
-    }
-    delete[] raw_data;
-}
-
 void
 RubySystem::serialize(CheckpointOut &cp) const
 {
@@ -316,15 +290,15 @@ RubySystem::serialize(CheckpointOut &cp) const
         fatal("Call memWriteback() before serialize() to create ruby trace");
     }
 
-    // Aggregate the trace entries together into a single array
-    uint8_t *raw_data = new uint8_t[4096];
-    uint64_t cache_trace_size = m_cache_recorder->aggregateRecords(&raw_data,
-                                                                 4096);
+    // Stream the trace entries to the checkpoint a chunk at a time
     std::string cache_trace_file = name() + ".cache.gz";
-    writeCompressedTrace(raw_data, cache_trace_file, cache_trace_size);
+    uint64_t cache_trace_size = m_cache_recorder->writeRecords(
+        CheckpointIn::dir() + "/" + cache_trace_file);
+    int cache_trace_format = CacheRecorder::TraceFormatChunked;
 
     SERIALIZE_SCALAR(cache_trace_file);
     SERIALIZE_SCALAR(cache_trace_size);
+    SERIALIZE_SCALAR(cache_trace_format);
 }
 
 void
@@ -338,42 +312,9 @@ RubySystem::drainResume()
     }
 }
 
-void
-RubySystem::readCompressedTrace(std::string filename, uint8_t *&raw_data,
-                                uint64_t &uncompressed_trace_size)
-{
-    // Read the trace file
-    gzFile compressedTrace;
-
-    // trace file
-    int fd = open(filename.c_str(), O_RDONLY);
-    if (fd < 0) {
-        perror("open");
-        fatal("Unable to open trace file %s", filename);
-    }
-
-    compressedTrace = gzdopen(fd, "rb");
-    if (compressedTrace == NULL) {
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
-    }
-
-    raw_data = new uint8_t[uncompressed_trace_size];
-    if (gzread(compressedTrace, raw_data, uncompressed_trace_size) <
-            uncompressed_trace_size) {
-        fatal("Unable to read complete trace from file %s\n", filename);
-    }
-
-    if (gzclose(compressedTrace)) {
-        fatal("Failed to close cache trace file '%s'\n", filename);
-    }
-}
-
 void
 RubySystem::unserialize(CheckpointIn &cp)
 {
-    uint8_t *uncompressed_trace = NULL;
-
     // This value should be set to the checkpoint-system's block-size.
     // Optional, as checkpoints without it can be run if the
     // checkpoint-system's block-size == current block-size.
@@ -383,17 +324,28 @@ RubySystem::unserialize(CheckpointIn &cp)
     std::string cache_trace_file;
     uint64_t cache_trace_size = 0;
 
+    // Checkpoints without a format hold a single flat array of records.
+    int cache_trace_format = CacheRecorder::TraceFormatFlat;
+
     UNSERIALIZE_SCALAR(cache_trace_file);
     UNSERIALIZE_SCALAR(cache_trace_size);
+    UNSERIALIZE_OPT_SCALAR(cache_trace_format);
     cache_trace_file = cp.getCptDir() + "/" + cache_trace_file;
 
-    readCompressedTrace(cache_trace_file, uncompressed_trace,
-                        cache_trace_size);
+    if (cache_trace_format != CacheRecorder::TraceFormatFlat &&
+        cache_trace_format != CacheRecorder::TraceFormatChunked) {
+        fatal("Unknown cache trace format %d in %s\n", cache_trace_format,
+              cache_trace_file);
+    }
+
     m_warmup_enabled = true;
     m_systems_to_warmup++;
 
-    // Create the cache recorder that will hang around until startup.
-    makeCacheRecorder(uncompressed_trace, cache_trace_size, block_size_bytes);
+    // Create the cache recorder that will hang around until startup. The
+    // trace is read from the file as the warmup progresses.
+    makeCacheRecorder(cache_trace_file,
+                      (CacheRecorder::TraceFormat)cache_trace_format,
+                      cache_trace_size, block_size_bytes);
 }
 
 void
@@ -433,8 +385,17 @@ RubySystem::startup()
         resetClock();
 
         // Schedule an event to start cache warmup
+        auto host_start = std::chrono::steady_clock::now();
         enqueueRubyEvent(curTick());
         simulate();
+        std::chrono::duration<double> host_time =
+            std::chrono::steady_clock::now() - host_start;
+
+        uint64_t records = m_cache_recorder->recordsRead();
+        uint64_t skipped = m_cache_recorder->recordsSkipped();
+        inform("%s: cache warmup replayed %d of %d records (%d redundant) "
+               "in %d ticks, %.3fs host time\n", name(), records - skipped,
+               records, skipped, curTick(), host_time.count());
 
         delete m_cache_recorder;
         m_cache_recorder = NULL;
@@ -467,6 +428,7 @@ void
 RubySystem::resetStats()
 {
     m_start_cycle = curCycle();
+    DataBlock::resetStats();
     for (auto& network : m_networks) {
         network->resetStats();
     }
@@ -46,6 +46,9 @@ class RubySystem(ClockedObject):
 
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
+    parallel_warmup = Param.Bool(True, "Replay the checkpointed cache \
+        trace through all sequencers in parallel, skipping redundant \
+        records, rather than every record one at a time")
 
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
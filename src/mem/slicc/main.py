@@ -71,6 +71,8 @@ def main(args=None):
                       help="print traceback on error")
     parser.add_option("-q", "--quiet",
                       help="don't print messages")
+    parser.add_option("--dispatch-tables", action='store_true',
+                      help="dispatch transitions through dense tables")
     opts,files = parser.parse_args(args=args)
 
     if len(files) != 1:
@@ -91,7 +93,7 @@ def main(args=None):
     protocol_base = os.path.join(os.path.dirname(__file__),
                                  '..', 'ruby', 'protocol')
     slicc = SLICC(slicc_file, protocol_base, verbose=True, debug=opts.debug,
-                  traceback=opts.tb)
+                  traceback=opts.tb, dispatch_tables=opts.dispatch_tables)
 
 
     if opts.print_files:
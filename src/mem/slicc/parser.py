@@ -49,13 +49,21 @@ import slicc.util as util
 from slicc.symbols import SymbolTable
 
 class SLICC(Grammar):
-    def __init__(self, filename, base_dir, verbose=False, traceback=False, **kwargs):
+    def __init__(self, filename, base_dir, verbose=False, traceback=False,
+                 dispatch_tables=False, **kwargs):
         self.protocol = None
         self.traceback = traceback
         self.verbose = verbose
+        # Dispatch transitions through dense state x event tables of fused
+        # transition functions rather than a switch statement
+        self.dispatch_tables = dispatch_tables
         self.symtab = SymbolTable(self)
         self.base_dir = base_dir
 
+        # PLY writes its parser tables to the current directory, which is
+        # usually the source tree. Building the parser is cheap, so don't.
+        self.setupParserFactory(write_tables=0)
+
         try:
             self.decl_list = self.parse_file(filename, **kwargs)
         except ParseError as e:
@@ -285,6 +285,7 @@ class $py_ident(RubyController):
 #include <sstream>
 #include <string>
 
+#include "base/compiler.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/protocol/TransitionResult.hh"
 #include "mem/ruby/protocol/Types.hh"
@@ -380,6 +381,29 @@ TransitionResult doTransitionWorker(${ident}_Event event,
 
         code('''
                                     Addr addr);
+''')
+
+        if self.symtab.slicc.dispatch_tables:
+            funcs, resource_bits = self.fusedTransitions()
+            params = self.transitionParams()
+            code('''
+
+typedef TransitionResult (${c_ident}::*TransitionFunc)($params);
+
+/** Fused transition functions indexed by state and event */
+static const TransitionFunc
+    m_transition_table[${ident}_State_NUM][${ident}_Event_NUM];
+''')
+            if resource_bits:
+                code('''
+/** Check all the resources whose bits are set in one step */
+bool checkResources(uint64_t resources, Addr addr);
+''')
+            code('')
+            for name,case,transitions in funcs:
+                code('TransitionResult $name($params);')
+
+        code('''
 
 ${ident}_Event m_curTransitionEvent;
 ${ident}_State m_curTransitionNextState;
@@ -419,31 +443,38 @@ void set_tbe(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${ident}_TBE* m_new_tbe);
 void unset_tbe(${{self.TBEType.c_ident}}*& m_tbe_ptr);
 ''')
 
-        # Prototype the actions that the controller can take
+        # Prototype the actions that the controller can take. With dispatch
+        # tables they are defined inline in the controller's .cc file, and
+        # must be declared inline in every file that includes this one.
         code('''
 
 // Actions
 ''')
+        action_attr = ''
+        if self.symtab.slicc.dispatch_tables:
+            action_attr = 'M5_FORCE_INLINE '
         if self.TBEType != None and self.EntryType != None:
             for action in self.actions.values():
                 code('/** \\brief ${{action.desc}} */')
-                code('void ${{action.ident}}(${{self.TBEType.c_ident}}*& '
-                     'm_tbe_ptr, ${{self.EntryType.c_ident}}*& '
-                     'm_cache_entry_ptr, Addr addr);')
+                code('${action_attr}void ${{action.ident}}('
+                     '${{self.TBEType.c_ident}}*& m_tbe_ptr, '
+                     '${{self.EntryType.c_ident}}*& m_cache_entry_ptr, '
+                     'Addr addr);')
         elif self.TBEType != None:
             for action in self.actions.values():
                 code('/** \\brief ${{action.desc}} */')
-                code('void ${{action.ident}}(${{self.TBEType.c_ident}}*& '
-                     'm_tbe_ptr, Addr addr);')
+                code('${action_attr}void ${{action.ident}}('
+                     '${{self.TBEType.c_ident}}*& m_tbe_ptr, Addr addr);')
         elif self.EntryType != None:
             for action in self.actions.values():
                 code('/** \\brief ${{action.desc}} */')
-                code('void ${{action.ident}}(${{self.EntryType.c_ident}}*& '
-                     'm_cache_entry_ptr, Addr addr);')
+                code('${action_attr}void ${{action.ident}}('
+                     '${{self.EntryType.c_ident}}*& m_cache_entry_ptr, '
+                     'Addr addr);')
         else:
             for action in self.actions.values():
                 code('/** \\brief ${{action.desc}} */')
-                code('void ${{action.ident}}(Addr addr);')
+                code('${action_attr}void ${{action.ident}}(Addr addr);')
 
         # the controller internal variables
         code('''
@@ -1069,6 +1100,11 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
 
 // Actions
 ''')
+        # With dispatch tables, the actions are only called from the fused
+        # transition functions in this file, which they are inlined into
+        action_attr = ''
+        if self.symtab.slicc.dispatch_tables:
+            action_attr = 'M5_FORCE_INLINE '
         if self.TBEType != None and self.EntryType != None:
             for action in self.actions.values():
                 if "c_code" not in action:
@@ -1076,7 +1112,7 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${action_attr}void
 $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -1097,7 +1133,7 @@ $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${{self.Entry
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${action_attr}void
 $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -1112,7 +1148,7 @@ $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, Addr addr)
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${action_attr}void
 $c_ident::${{action.ident}}(${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -1127,7 +1163,7 @@ $c_ident::${{action.ident}}(${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Add
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${action_attr}void
 $c_ident::${{action.ident}}(Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -1206,6 +1242,9 @@ $c_ident::functionalReadBuffers(PacketPtr& pkt, WriteMask &mask)
 }
 ''')
 
+        if self.symtab.slicc.dispatch_tables:
+            self.printDispatchTable(code)
+
         code.write(path, "%s.cc" % c_ident)
 
     def printCWakeup(self, path, includes):
@@ -1480,16 +1519,119 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
 {
     m_curTransitionEvent = event;
     m_curTransitionNextState = next_state;
+''')
+
+        if self.symtab.slicc.dispatch_tables:
+            args = ['next_state']
+            if self.TBEType != None:
+                args.append('m_tbe_ptr')
+            if self.EntryType != None:
+                args.append('m_cache_entry_ptr')
+            args.append('addr')
+            args = ', '.join(args)
+
+            # The fused transition functions and the table live with the
+            # actions, such that the actions can be inlined into them
+            code('''
+
+    TransitionFunc transition = m_transition_table[state][event];
+    if (transition == nullptr) {
+        panic("Invalid transition\\n"
+              "%s time: %d addr: %#x event: %s state: %s\\n",
+              name(), curCycle(), addr, event, state);
+    }
+
+    return (this->*transition)($args);
+}
+''')
+            code.write(path, "%s_Transitions.cc" % self.ident)
+            return
+
+        code('''
     switch(HASH_FUN(state, event)) {
 ''')
 
+        cases = self.transitionCases()
+
+        # Walk through all of the unique code blocks and spit out the
+        # corresponding case statement elements
+        for case,transitions in cases.items():
+            # Iterative over all the multiple transitions that share
+            # the same code
+            for trans in transitions:
+                code('  case HASH_FUN(${ident}_State_${{trans.state.ident}}, '
+                     '${ident}_Event_${{trans.event.ident}}):')
+            code('    $case\n')
+
+        code('''
+      default:
+        panic("Invalid transition\\n"
+              "%s time: %d addr: %#x event: %s state: %s\\n",
+              name(), curCycle(), addr, event, state);
+    }
+
+    return TransitionResult_Valid;
+}
+''')
+        code.write(path, "%s_Transitions.cc" % self.ident)
+
+
+    def resourceChecks(self, trans):
+        '''Return the checks for the resources needed by a transition as
+        (code, condition) pairs, in the order in which they are made'''
+
+        checks = []
+        for key,val in trans.resources.items():
+            cond = '%s.areNSlotsAvailable(%s, clockEdge())' % (key.code, val)
+            val = '''
+if (!%s)
+    return TransitionResult_ResourceStall;
+''' % cond
+            checks.append((val, cond))
+
+        # Check all of the request_types for resource constraints
+        for request_type in trans.request_types:
+            cond = 'checkResourceAvailable(%s_RequestType_%s, addr)' % \
+                (self.ident, request_type.ident)
+            val = '''
+if (!%s) {
+    return TransitionResult_ResourceStall;
+}
+''' % cond
+            checks.append((val, cond))
+
+        # Emit the code sequences in a sorted order.  This makes the
+        # output deterministic (without this the output order can vary
+        # since Map's keys() on a vector of pointers is not deterministic
+        return sorted(checks)
+
+    def resourceBits(self):
+        '''Assign a bit of a 64 bit mask to each resource check made by the
+        transitions of the machine. The bits follow the order of the checks,
+        such that testing the bits in order makes the checks in the order
+        they would be made one by one. Return None if there are too many
+        distinct checks for a mask.'''
+
+        checks = set()
+        for trans in self.transitions:
+            checks.update(self.resourceChecks(trans))
+        if len(checks) > 64:
+            return None
+        return OrderedDict((check, bit)
+                           for bit, check in enumerate(sorted(checks)))
+
+    def transitionCases(self, resource_bits=None):
+        '''Return a map from the code of the transitions to the list of
+        transitions sharing that code. The resources needed by a transition
+        are checked one by one, or in one step through checkResources() if
+        a map of resource bits is given.'''
+
+        ident = self.ident
+
         # This map will allow suppress generating duplicate code
         cases = OrderedDict()
 
         for trans in self.transitions:
-            case_string = "%s_State_%s, %s_Event_%s" % \
-                (self.ident, trans.state.ident, self.ident, trans.event.ident)
-
             case = self.symtab.codeFormatter()
             # Only set next_state if it changes
             if trans.state != trans.nextState:
@@ -1511,29 +1653,18 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
             request_types = trans.request_types
 
             # Check for resources
-            case_sorter = []
-            res = trans.resources
-            for key,val in res.items():
-                val = '''
-if (!%s.areNSlotsAvailable(%s, clockEdge()))
+            checks = self.resourceChecks(trans)
+            if resource_bits is None:
+                for c,cond in checks:
+                    case("$c")
+            elif checks:
+                mask = 0
+                for check in checks:
+                    mask |= 1 << resource_bits[check]
+                case('''
+if (!checkResources(${{"%#x" % mask}}ULL, addr))
     return TransitionResult_ResourceStall;
-''' % (key.code, val)
-                case_sorter.append(val)
-
-            # Check all of the request_types for resource constraints
-            for request_type in request_types:
-                val = '''
-if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
-    return TransitionResult_ResourceStall;
-}
-''' % (self.ident, request_type.ident)
-                case_sorter.append(val)
-
-            # Emit the code sequences in a sorted order.  This makes the
-            # output deterministic (without this the output order can vary
-            # since Map's keys() on a vector of pointers is not deterministic
-            for c in sorted(case_sorter):
-                case("$c")
+''')
 
             # Record access types for this transition
             for request_type in request_types:
@@ -1569,29 +1700,107 @@ if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
             if case not in cases:
                 cases[case] = []
 
-            cases[case].append(case_string)
+            cases[case].append(trans)
 
-        # Walk through all of the unique code blocks and spit out the
-        # corresponding case statement elements
-        for case,transitions in cases.items():
-            # Iterative over all the multiple transitions that share
-            # the same code
-            for trans in transitions:
-                code('  case HASH_FUN($trans):')
-            code('    $case\n')
+        return cases
 
-        code('''
-      default:
-        panic("Invalid transition\\n"
-              "%s time: %d addr: %#x event: %s state: %s\\n",
-              name(), curCycle(), addr, event, state);
-    }
+    def transitionParams(self):
+        '''Parameters of the fused transition functions'''
 
-    return TransitionResult_Valid;
+        params = ['%s_State& next_state' % self.ident]
+        if self.TBEType != None:
+            params.append('%s*& m_tbe_ptr' % self.TBEType.c_ident)
+        if self.EntryType != None:
+            params.append('%s*& m_cache_entry_ptr' % self.EntryType.c_ident)
+        params.append('Addr addr')
+        return ', '.join(params)
+
+    def fusedTransitions(self):
+        '''Return one fused transition function for each distinct transition
+        code as a (name, code, transitions) tuple, and the resource bits
+        the functions check.'''
+
+        resource_bits = self.resourceBits()
+        funcs = []
+        for case,transitions in self.transitionCases(resource_bits).items():
+            name = 'transition_%s_%s' % (transitions[0].state.ident,
+                                         transitions[0].event.ident)
+            funcs.append((name, case, transitions))
+        return funcs, resource_bits
+
+    def printDispatchTable(self, code):
+        '''Output the resource check, the fused transition functions and the
+        dense state x event table dispatching the transitions'''
+
+        ident = self.ident
+        c_ident = "%s_Controller" % self.ident
+        funcs, resource_bits = self.fusedTransitions()
+
+        if resource_bits:
+            code('''
+bool
+$c_ident::checkResources(uint64_t resources, Addr addr)
+{
+    // Test the bits in order, which is the order in which a transition
+    // would check its resources one by one
+''')
+            code.indent()
+            for check,bit in resource_bits.items():
+                code('''
+if ((resources & ${{"%#x" % (1 << bit)}}ULL) &&
+    !${{check[1]}}) {
+    return false;
 }
 ''')
-        code.write(path, "%s_Transitions.cc" % self.ident)
+            code.dedent()
+            code('''
+    return true;
+}
+''')
+
+        params = self.transitionParams()
+        for name,case,transitions in funcs:
+            code('''
+
+TransitionResult
+$c_ident::$name($params)
+{
+''')
+            code.indent()
+            for trans in transitions:
+                code('// ${{trans.state.ident}} x ${{trans.event.ident}}')
+            code('$case')
+            code.dedent()
+            code('}')
+
+        func_of = {}
+        for name,case,transitions in funcs:
+            for trans in transitions:
+                func_of[(trans.state, trans.event)] = name
+
+        code('''
+
+static_assert(${ident}_State_NUM == ${{len(self.states)}} &&
+              ${ident}_Event_NUM == ${{len(self.events)}},
+              "The transition table must cover all states and events");
 
+const $c_ident::TransitionFunc
+$c_ident::m_transition_table[${ident}_State_NUM][${ident}_Event_NUM] = {
+''')
+        code.indent()
+        for state in self.states.values():
+            code('{ // ${{state.ident}}')
+            code.indent()
+            for event in self.events.values():
+                name = func_of.get((state, event))
+                if name is None:
+                    code('nullptr, // ${{event.ident}}')
+                else:
+                    code('&$c_ident::$name, // ${{event.ident}}')
+            code.dedent()
+            code('},')
+        code.dedent()
+        code('};')
 
     # **************************
     # ******* HTML Files *******
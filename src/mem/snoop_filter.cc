@@ -49,12 +49,21 @@
 
 const int SnoopFilter::SNOOP_MASK_SIZE;
 
+SnoopFilter::SnoopFilter(const SnoopFilterParams &p)
+    : SimObject(p),
+      cachedLocations(p.max_capacity / p.system->cacheLineSize(), p.assoc),
+      linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
+      maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
+      stats(this)
+{
+}
+
 void
-SnoopFilter::eraseIfNullEntry(SnoopFilterCache::iterator& sf_it)
+SnoopFilter::eraseIfNullEntry(size_t sf_idx)
 {
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = cachedLocations.item(sf_idx);
     if ((sf_item.requested | sf_item.holder).none()) {
-        cachedLocations.erase(sf_it);
+        cachedLocations.erase(sf_idx);
         DPRINTF(SnoopFilter, "%s:   Removed SF entry.\n",
                 __func__);
     }
@@ -75,21 +84,50 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
         line_addr |= LineSecure;
     }
     SnoopMask req_port = portToMask(cpu_side_port);
-    reqLookupResult.it = cachedLocations.find(line_addr);
-    bool is_hit = (reqLookupResult.it != cachedLocations.end());
+    reqLookupResult.idx = cachedLocations.find(line_addr);
+    reqLookupResult.generation = cachedLocations.generation();
+    reqLookupResult.blocked = false;
+    bool is_hit = (reqLookupResult.idx != SnoopFilterCache::invalidEntry);
 
     // If the snoop filter has no entry, and we should not allocate,
     // do not create a new snoop filter entry, simply return a NULL
-    // portlist.
-    if (!is_hit && !allocate)
+    // portlist. A bounded snoop filter may have dropped the line
+    // while the eviction was on its way, which then needs no
+    // tracking either.
+    if (!is_hit && (!allocate ||
+                    (cachedLocations.bounded() && cpkt->isEviction())))
         return snoopDown(lookupLatency);
 
-    // If no hit in snoop filter create a new element and update iterator
+    // If no hit in snoop filter create a new element, evicting an
+    // old one if needed
     if (!is_hit) {
-        reqLookupResult.it =
-            cachedLocations.emplace(line_addr, SnoopItem()).first;
+        size_t sf_idx = cachedLocations.findVictim(line_addr);
+        if (sf_idx == SnoopFilterCache::invalidEntry) {
+            DPRINTF(SnoopFilter, "%s:   SF set full, blocking request\n",
+                    __func__);
+            stats.blockedRequests++;
+            reqLookupResult.blocked = true;
+            return snoopDown(lookupLatency);
+        }
+        if (cachedLocations.isValid(sf_idx)) {
+            SnoopItem& victim = cachedLocations.item(sf_idx);
+            assert(victim.requested.none());
+            DPRINTF(SnoopFilter, "%s:   evicting %#llx SF value %x.%x\n",
+                    __func__, cachedLocations.addr(sf_idx),
+                    victim.requested, victim.holder);
+            stats.evictions++;
+            assert(!reqLookupResult.evicted);
+            reqLookupResult.evicted = true;
+            reqLookupResult.evictedAddr = cachedLocations.addr(sf_idx);
+            reqLookupResult.evictedHolders = victim.holder;
+        }
+        cachedLocations.insert(sf_idx, line_addr);
+        reqLookupResult.idx = sf_idx;
+        reqLookupResult.generation = cachedLocations.generation();
+    } else {
+        cachedLocations.touch(reqLookupResult.idx);
     }
-    SnoopItem& sf_item = reqLookupResult.it->second;
+    SnoopItem& sf_item = cachedLocations.item(reqLookupResult.idx);
     SnoopMask interested = sf_item.holder | sf_item.requested;
 
     // Store unmodified value of snoop filter item in temp storage in
@@ -156,29 +194,48 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
 void
 SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
 {
-    if (reqLookupResult.it != cachedLocations.end()) {
+    if (reqLookupResult.idx != SnoopFilterCache::invalidEntry) {
         // since we rely on the caller, do a basic check to ensure
         // that finishRequest is being called following lookupRequest
         Addr line_addr = (addr & ~(Addr(linesize - 1)));
         if (is_secure) {
             line_addr |= LineSecure;
         }
-        assert(reqLookupResult.it->first == line_addr);
+        // an unbounded table may have moved the entry since
+        if (reqLookupResult.generation != cachedLocations.generation()) {
+            reqLookupResult.idx = cachedLocations.find(line_addr);
+            reqLookupResult.generation = cachedLocations.generation();
+        }
+        assert(reqLookupResult.idx != SnoopFilterCache::invalidEntry &&
+               cachedLocations.addr(reqLookupResult.idx) == line_addr);
         if (will_retry) {
             SnoopItem retry_item = reqLookupResult.retryItem;
             // Undo any changes made in lookupRequest to the snoop filter
             // entry if the request will come again. retryItem holds
             // the previous value of the snoopfilter entry.
-            reqLookupResult.it->second = retry_item;
+            cachedLocations.item(reqLookupResult.idx) = retry_item;
 
             DPRINTF(SnoopFilter, "%s:   restored SF value %x.%x\n",
                     __func__,  retry_item.requested, retry_item.holder);
         }
 
-        eraseIfNullEntry(reqLookupResult.it);
+        eraseIfNullEntry(reqLookupResult.idx);
+        reqLookupResult.idx = SnoopFilterCache::invalidEntry;
     }
 }
 
+SnoopFilter::SnoopList
+SnoopFilter::takeEviction(Addr& addr, bool& is_secure)
+{
+    if (!reqLookupResult.evicted)
+        return SnoopList();
+
+    reqLookupResult.evicted = false;
+    addr = reqLookupResult.evictedAddr & ~Addr(LineSecure);
+    is_secure = reqLookupResult.evictedAddr & LineSecure;
+    return maskToPortList(reqLookupResult.evictedHolders);
+}
+
 std::pair<SnoopFilter::SnoopList, Cycles>
 SnoopFilter::lookupSnoop(const Packet* cpkt)
 {
@@ -190,10 +247,11 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = (sf_it != cachedLocations.end());
+    size_t sf_idx = cachedLocations.find(line_addr);
+    bool is_hit = (sf_idx != SnoopFilterCache::invalidEntry);
 
-    panic_if(!is_hit && (cachedLocations.size() >= maxEntryCount),
+    panic_if(!is_hit && (cachedLocations.size() >= maxEntryCount) &&
+             !cachedLocations.bounded(),
              "snoop filter exceeded capacity of %d cache blocks\n",
              maxEntryCount);
 
@@ -203,7 +261,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (!is_hit)
         return snoopDown(lookupLatency);
 
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = cachedLocations.item(sf_idx);
 
     SnoopMask interested = (sf_item.holder | sf_item.requested);
 
@@ -233,7 +291,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
         sf_item.holder = 0;
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_idx);
     }
 
     return snoopSelected(maskToPortList(interested), lookupLatency);
@@ -263,7 +321,11 @@ SnoopFilter::updateSnoopResponse(const Packet* cpkt,
     }
     SnoopMask rsp_mask = portToMask(rsp_port);
     SnoopMask req_mask = portToMask(req_port);
-    SnoopItem& sf_item = cachedLocations[line_addr];
+    // The destination has a request in flight, so the line is tracked
+    size_t sf_idx = cachedLocations.find(line_addr);
+    panic_if(sf_idx == SnoopFilterCache::invalidEntry,
+             "No SF entry for %#llx\n", line_addr);
+    SnoopItem& sf_item = cachedLocations.item(sf_idx);
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -310,8 +372,8 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = sf_it != cachedLocations.end();
+    size_t sf_idx = cachedLocations.find(line_addr);
+    bool is_hit = sf_idx != SnoopFilterCache::invalidEntry;
 
     // Nothing to do if it is not a hit
     if (!is_hit)
@@ -321,7 +383,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     // Modified state, and we know that there are no other copies, or
     // they will all be invalidated imminently
     if (!cpkt->hasSharers()) {
-        SnoopItem& sf_item = sf_it->second;
+        SnoopItem& sf_item = cachedLocations.item(sf_idx);
 
         DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
@@ -329,7 +391,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
 
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_idx);
     }
 }
 
@@ -352,12 +414,12 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    if (sf_it == cachedLocations.end())
+    size_t sf_idx = cachedLocations.find(line_addr);
+    if (sf_idx == SnoopFilterCache::invalidEntry)
         return;
 
     SnoopMask response_mask = portToMask(cpu_side_port);
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = cachedLocations.item(sf_idx);
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -376,7 +438,7 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
         if (cpkt->isInvalidate()) {
             sf_item.holder &= ~response_mask;
         }
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_idx);
     } else {
         // Any other response implies that a cache above will have the
         // block.
@@ -404,7 +466,13 @@ SnoopFilter::SnoopFilterStats::SnoopFilterStats(Stats::Group *parent)
                "holder of the requested data."),
       ADD_STAT(hitMultiSnoops, UNIT_COUNT,
                "Number of snoops hitting in the snoop filter with multiple "
-               "(>1) holders of the requested data.")
+               "(>1) holders of the requested data."),
+      ADD_STAT(evictions, UNIT_COUNT,
+               "Number of lines evicted, and back-invalidated, to make room "
+               "for new lines."),
+      ADD_STAT(blockedRequests, UNIT_COUNT,
+               "Number of requests retried as no line could be evicted to "
+               "make room for them.")
 {}
 
 void
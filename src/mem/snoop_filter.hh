@@ -44,8 +44,8 @@
 #define __MEM_SNOOP_FILTER_HH__
 
 #include <bitset>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "mem/packet.hh"
 #include "mem/port.hh"
@@ -82,6 +82,13 @@
  *     upper cache dropped a line, making the snoop filter pessimistic for now
  * (4) ordering: there is no single point of order in the system.  Instead,
  *     requesting MSHRs track order between local requests and remote snoops
+ *
+ * By default the snoop filter tracks any number of lines. If an
+ * associativity is set, it instead holds at most max_capacity worth of
+ * lines in a set-associative table, and has to evict a line to make room
+ * for a new one. The caller of lookupRequest is then responsible for
+ * back-invalidating the evicted line in the caches above (see
+ * takeEviction).
  */
 class SnoopFilter : public SimObject {
   public:
@@ -91,13 +98,7 @@ class SnoopFilter : public SimObject {
 
     typedef std::vector<QueuedResponsePort*> SnoopList;
 
-    SnoopFilter (const SnoopFilterParams &p) :
-        SimObject(p), reqLookupResult(cachedLocations.end()),
-        linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
-        maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
-        stats(this)
-    {
-    }
+    SnoopFilter (const SnoopFilterParams &p);
 
     /**
      * Init a new snoop filter and tell it about all the cpu_sideports
@@ -149,6 +150,25 @@ class SnoopFilter : public SimObject {
      */
     void finishRequest(bool will_retry, Addr addr, bool is_secure);
 
+    /**
+     * Check if the last lookupRequest could not allocate an entry for
+     * the line, as all the entries it could use are waiting for
+     * responses. In this case the request did not change the snoop
+     * filter and has to be retried later.
+     */
+    bool lookupBlocked() const { return reqLookupResult.blocked; }
+
+    /**
+     * Take the line, if any, that the last lookupRequest evicted to make
+     * room for the requested one. The line is no longer tracked, and the
+     * caller has to invalidate it in all the returned ports.
+     *
+     * @param addr      Set to the address of the evicted line
+     * @param is_secure Set if the evicted line is in the secure space
+     * @return List of the ports that held the evicted line
+     */
+    SnoopList takeEviction(Addr& addr, bool& is_secure);
+
     /**
      * Handle an incoming snoop from below (the memory-side port). These
      * can upgrade the tracking logic and may also benefit from
@@ -215,10 +235,86 @@ class SnoopFilter : public SimObject {
         SnoopMask requested;
         SnoopMask holder;
     };
+
     /**
-     * HashMap of SnoopItems indexed by line address
+     * Flat, open-addressed table of SnoopItems indexed by line
+     * address. The ways of a set are adjacent, and a line is looked up
+     * by probing the ways of the set picked by a hash of its address.
+     * The tags are kept apart from the (much larger) items so that the
+     * probe usually touches a single host cache line.
+     *
+     * A bounded table has a fixed number of sets, and inserting into a
+     * full set replaces its least recently used entry that has no
+     * requests in flight. An unbounded table instead doubles its
+     * number of sets whenever a set overflows, which moves the
+     * entries, so entry indices are only stable until the next
+     * insertion into an unbounded table.
      */
-    typedef std::unordered_map<Addr, SnoopItem> SnoopFilterCache;
+    class SnoopFilterCache
+    {
+      public:
+        /** Index returned for lines that are not in the table. */
+        static const size_t invalidEntry = (size_t)-1;
+
+        /**
+         * @param entries Number of entries in a bounded table
+         * @param assoc Associativity, 0 for an unbounded table
+         */
+        SnoopFilterCache(uint64_t entries, unsigned assoc);
+
+        /** Find the entry of a line, invalidEntry if not present. */
+        size_t find(Addr line_addr) const;
+
+        /**
+         * Find the entry to insert a line, that is not in the table,
+         * into. This is a free entry if there is one in the set of the
+         * line, otherwise the least recently used entry without
+         * requests in flight, which the caller has to evict.
+         *
+         * @return The entry, or invalidEntry if a bounded table has no
+         *         entry in the set that can be replaced.
+         */
+        size_t findVictim(Addr line_addr);
+
+        /** (Re)use an entry found by findVictim for a line. */
+        void insert(size_t idx, Addr line_addr);
+
+        void erase(size_t idx);
+
+        bool isValid(size_t idx) const { return tags[idx] != invalidTag; }
+
+        Addr addr(size_t idx) const { return tags[idx]; }
+        SnoopItem& item(size_t idx) { return items[idx]; }
+
+        /** Mark an entry as the most recently used in its set. */
+        void touch(size_t idx) { lastUse[idx] = ++useCount; }
+
+        /** Number of valid entries. */
+        uint64_t size() const { return numEntries; }
+
+        bool bounded() const { return isBounded; }
+
+        /** Incremented every time the entries are moved. */
+        uint64_t generation() const { return numResizes; }
+
+      private:
+        /** Tag of unused entries, never a (line aligned) address. */
+        static const Addr invalidTag = MaxAddr;
+
+        size_t setOf(Addr line_addr) const;
+        void resize(size_t num_sets);
+
+        const bool isBounded;
+        const unsigned assoc;
+        size_t numSets;
+        uint64_t numEntries;
+        uint64_t useCount;
+        uint64_t numResizes;
+
+        std::vector<Addr> tags;
+        std::vector<SnoopItem> items;
+        std::vector<uint64_t> lastUse;
+    };
 
     /**
      * Simple factory methods for standard return values.
@@ -256,9 +352,9 @@ class SnoopFilter : public SimObject {
     /**
      * Removes snoop filter items which have no requestors and no holders.
      */
-    void eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+    void eraseIfNullEntry(size_t sf_idx);
 
-    /** Simple hash set of cached addresses. */
+    /** Table of cached addresses. */
     SnoopFilterCache cachedLocations;
 
     /**
@@ -268,8 +364,11 @@ class SnoopFilter : public SimObject {
      * This structure keeps track of the state previous to such changes.
      */
     struct ReqLookupResult {
-        /** Iterator used to store the result from lookupRequest. */
-        SnoopFilterCache::iterator it;
+        /** Entry used to store the result from lookupRequest. */
+        size_t idx;
+
+        /** Table generation the entry index belongs to. */
+        uint64_t generation;
 
         /**
          * Variable to temporarily store value of snoopfilter entry
@@ -278,17 +377,20 @@ class SnoopFilter : public SimObject {
          */
         SnoopItem retryItem;
 
-        /**
-         * The constructor must be informed of the internal cache's end
-         * iterator, so do not allow the compiler to implictly define it.
-         *
-         * @param end_it Iterator to the end of the internal cache.
-         */
-        ReqLookupResult(SnoopFilterCache::iterator end_it)
-            : it(end_it), retryItem{0, 0}
+        /** The request could not allocate an entry. */
+        bool blocked;
+
+        /** Line evicted to make room for the request, if any. */
+        bool evicted;
+        Addr evictedAddr;
+        SnoopMask evictedHolders;
+
+        ReqLookupResult()
+            : idx(SnoopFilterCache::invalidEntry), generation(0),
+              retryItem{0, 0}, blocked(false), evicted(false),
+              evictedAddr(0), evictedHolders(0)
         {
         }
-        ReqLookupResult() = delete;
     } reqLookupResult;
 
     /** List of all attached snooping CPU-side ports. */
@@ -321,6 +423,9 @@ class SnoopFilter : public SimObject {
         Stats::Scalar totSnoops;
         Stats::Scalar hitSingleSnoops;
         Stats::Scalar hitMultiSnoops;
+
+        Stats::Scalar evictions;
+        Stats::Scalar blockedRequests;
     } stats;
 };
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "mem/snoop_filter.hh"
+
+namespace
+{
+
+/** Give the test access to the table of the snoop filter. */
+class SnoopFilterAccess : public SnoopFilter
+{
+  public:
+    using SnoopFilter::SnoopFilterCache;
+    using SnoopFilter::SnoopItem;
+};
+
+typedef SnoopFilterAccess::SnoopFilterCache Table;
+
+const Addr lineSize = 64;
+
+/** Insert a line that is not in the table, and return its entry. */
+size_t
+insertLine(Table &table, Addr line_addr)
+{
+    size_t idx = table.findVictim(line_addr);
+    EXPECT_NE(idx, Table::invalidEntry);
+    if (idx != Table::invalidEntry)
+        table.insert(idx, line_addr);
+    return idx;
+}
+
+} // anonymous namespace
+
+TEST(SnoopFilterCacheTest, FindInsertErase)
+{
+    Table table(16, 4);
+    EXPECT_TRUE(table.bounded());
+    EXPECT_EQ(table.find(0x1000), Table::invalidEntry);
+
+    const size_t idx = insertLine(table, 0x1000);
+    EXPECT_EQ(table.find(0x1000), idx);
+    EXPECT_TRUE(table.isValid(idx));
+    EXPECT_EQ(table.addr(idx), Addr(0x1000));
+    EXPECT_EQ(table.size(), 1U);
+
+    table.erase(idx);
+    EXPECT_FALSE(table.isValid(idx));
+    EXPECT_EQ(table.find(0x1000), Table::invalidEntry);
+    EXPECT_EQ(table.size(), 0U);
+}
+
+/**
+ * The security state of a line is kept in the lowest bit of its tag,
+ * so the secure and non-secure versions of a line are different
+ * entries.
+ */
+TEST(SnoopFilterCacheTest, SecureTag)
+{
+    Table table(16, 4);
+    const Addr line = 0x2000;
+    const Addr secure_line = line | 0x1;
+
+    const size_t idx = insertLine(table, line);
+    EXPECT_EQ(table.find(secure_line), Table::invalidEntry);
+
+    const size_t secure_idx = insertLine(table, secure_line);
+    EXPECT_NE(idx, secure_idx);
+    EXPECT_EQ(table.find(line), idx);
+    EXPECT_EQ(table.find(secure_line), secure_idx);
+    EXPECT_EQ(table.addr(secure_idx), secure_line);
+
+    table.item(secure_idx).holder.set(3);
+    EXPECT_TRUE(table.item(idx).holder.none());
+
+    table.erase(idx);
+    EXPECT_EQ(table.find(line), Table::invalidEntry);
+    EXPECT_EQ(table.find(secure_line), secure_idx);
+}
+
+/**
+ * A full set replaces its least recently used entry, skipping the
+ * entries with requests in flight.
+ */
+TEST(SnoopFilterCacheTest, LRUVictimSkipsRequested)
+{
+    // a single set, so all the lines compete for the same ways
+    const unsigned assoc = 4;
+    Table table(assoc, assoc);
+
+    std::vector<size_t> idx;
+    for (Addr i = 0; i < assoc; ++i)
+        idx.push_back(insertLine(table, i * lineSize));
+    EXPECT_EQ(table.size(), assoc);
+
+    // the first line inserted is the least recently used
+    EXPECT_EQ(table.findVictim(assoc * lineSize), idx[0]);
+
+    // using it makes the second line the least recently used
+    table.touch(idx[0]);
+    EXPECT_EQ(table.findVictim(assoc * lineSize), idx[1]);
+
+    // lines with requests in flight are never replaced
+    table.item(idx[1]).requested.set(0);
+    table.item(idx[2]).requested.set(1);
+    EXPECT_EQ(table.findVictim(assoc * lineSize), idx[3]);
+
+    // replacing an entry keeps the number of valid entries
+    table.insert(idx[3], assoc * lineSize);
+    EXPECT_EQ(table.size(), assoc);
+    EXPECT_EQ(table.find(3 * lineSize), Table::invalidEntry);
+    EXPECT_EQ(table.find(assoc * lineSize), idx[3]);
+    EXPECT_TRUE(table.item(idx[3]).requested.none());
+}
+
+/**
+ * A bounded table cannot make room for a line when every entry of its
+ * set has requests in flight, and it does not grow.
+ */
+TEST(SnoopFilterCacheTest, Blocked)
+{
+    const unsigned assoc = 2;
+    Table table(assoc, assoc);
+
+    for (Addr i = 0; i < assoc; ++i) {
+        const size_t idx = insertLine(table, i * lineSize);
+        table.item(idx).requested.set(i);
+    }
+
+    const uint64_t generation = table.generation();
+    EXPECT_EQ(table.findVictim(assoc * lineSize), Table::invalidEntry);
+    EXPECT_EQ(table.generation(), generation);
+    EXPECT_EQ(table.size(), assoc);
+
+    // the set is usable again once a response arrived
+    const size_t idx = table.find(0);
+    table.item(idx).requested.reset();
+    EXPECT_EQ(table.findVictim(assoc * lineSize), idx);
+}
+
+/**
+ * An unbounded table grows when a set overflows, and moves all the
+ * entries, with their state, to the larger table.
+ */
+TEST(SnoopFilterCacheTest, ResizeWhileRefilling)
+{
+    Table table(0, 0);
+    EXPECT_FALSE(table.bounded());
+
+    const uint64_t generation = table.generation();
+    const Addr num_lines = 4096;
+    for (Addr i = 0; i < num_lines; ++i) {
+        const Addr line = (i * lineSize) | (i & 0x1);
+        const size_t idx = insertLine(table, line);
+        table.item(idx).holder.set(i % 7);
+        if (i % 3 == 0)
+            table.item(idx).requested.set(i % 5);
+    }
+    EXPECT_GT(table.generation(), generation);
+    EXPECT_EQ(table.size(), num_lines);
+
+    // every line is found exactly once, in its own entry, with the
+    // state it had before the table grew
+    std::set<size_t> entries;
+    for (Addr i = 0; i < num_lines; ++i) {
+        const Addr line = (i * lineSize) | (i & 0x1);
+        const size_t idx = table.find(line);
+        ASSERT_NE(idx, Table::invalidEntry);
+        EXPECT_TRUE(entries.insert(idx).second);
+        EXPECT_EQ(table.addr(idx), line);
+
+        const SnoopFilterAccess::SnoopItem &item = table.item(idx);
+        EXPECT_EQ(item.holder.count(), 1U);
+        EXPECT_TRUE(item.holder.test(i % 7));
+        EXPECT_EQ(item.requested.any(), i % 3 == 0);
+        if (i % 3 == 0) {
+            EXPECT_TRUE(item.requested.test(i % 5));
+        }
+    }
+
+    // and the lines that were not inserted are still not found
+    EXPECT_EQ(table.find(num_lines * lineSize), Table::invalidEntry);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Implementation of the table of the snoop filter.
+ */
+
+#include "mem/snoop_filter.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+const size_t SnoopFilter::SnoopFilterCache::invalidEntry;
+const Addr SnoopFilter::SnoopFilterCache::invalidTag;
+
+SnoopFilter::SnoopFilterCache::SnoopFilterCache(uint64_t entries,
+                                                unsigned assoc)
+    : isBounded(assoc != 0), assoc(isBounded ? assoc : 8), numSets(0),
+      numEntries(0), useCount(0), numResizes(0)
+{
+    if (isBounded) {
+        fatal_if(entries % assoc != 0 || !isPowerOf2(entries / assoc),
+                 "Snoop filter needs a power of two number of sets, "
+                 "%d entries and associativity %d gives %d sets\n",
+                 entries, assoc, entries / assoc);
+        resize(entries / assoc);
+    } else {
+        resize(64);
+    }
+}
+
+size_t
+SnoopFilter::SnoopFilterCache::setOf(Addr line_addr) const
+{
+    // Mix the address, so that the lines of any regular stride
+    // spread across the sets, and then take the set from the middle
+    // bits of the product
+    return ((line_addr * 0x9e3779b97f4a7c15ULL) >> 32) & (numSets - 1);
+}
+
+void
+SnoopFilter::SnoopFilterCache::resize(size_t num_sets)
+{
+    std::vector<Addr> old_tags(num_sets * assoc, invalidTag);
+    std::vector<SnoopItem> old_items(num_sets * assoc);
+    std::vector<uint64_t> old_last_use(num_sets * assoc, 0);
+    old_tags.swap(tags);
+    old_items.swap(items);
+    old_last_use.swap(lastUse);
+    numSets = num_sets;
+    numEntries = 0;
+    numResizes++;
+
+    for (size_t i = 0; i < old_tags.size(); ++i) {
+        if (old_tags[i] == invalidTag)
+            continue;
+        // the entries of a set only ever spread over the sets it
+        // splits into, so refilling never overflows a set
+        size_t idx = findVictim(old_tags[i]);
+        assert(idx != invalidEntry && !isValid(idx));
+        insert(idx, old_tags[i]);
+        items[idx] = old_items[i];
+        lastUse[idx] = old_last_use[i];
+    }
+}
+
+size_t
+SnoopFilter::SnoopFilterCache::find(Addr line_addr) const
+{
+    const size_t first = setOf(line_addr) * assoc;
+    for (size_t idx = first; idx < first + assoc; ++idx) {
+        if (tags[idx] == line_addr)
+            return idx;
+    }
+    return invalidEntry;
+}
+
+size_t
+SnoopFilter::SnoopFilterCache::findVictim(Addr line_addr)
+{
+    assert(find(line_addr) == invalidEntry);
+
+    const size_t first = setOf(line_addr) * assoc;
+    size_t victim = invalidEntry;
+    for (size_t idx = first; idx < first + assoc; ++idx) {
+        if (tags[idx] == invalidTag)
+            return idx;
+        // lines with requests in flight have to stay tracked until
+        // the responses arrive
+        if (items[idx].requested.none() &&
+            (victim == invalidEntry || lastUse[idx] < lastUse[victim])) {
+            victim = idx;
+        }
+    }
+
+    if (!isBounded) {
+        resize(numSets * 2);
+        return findVictim(line_addr);
+    }
+    return victim;
+}
+
+void
+SnoopFilter::SnoopFilterCache::insert(size_t idx, Addr line_addr)
+{
+    if (!isValid(idx))
+        numEntries++;
+    tags[idx] = line_addr;
+    items[idx] = SnoopItem();
+    touch(idx);
+}
+
+void
+SnoopFilter::SnoopFilterCache::erase(size_t idx)
+{
+    assert(tags[idx] != invalidTag);
+    tags[idx] = invalidTag;
+    numEntries--;
+}
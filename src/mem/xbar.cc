@@ -58,6 +58,7 @@ BaseXBar::BaseXBar(const BaseXBarParams &p)
       responseLatency(p.response_latency),
       headerLatency(p.header_latency),
       width(p.width),
+      batchLayers(p.batch_layers),
       gotAddrRanges(p.port_default_connection_count +
                           p.port_mem_side_ports_connection_count, false),
       gotAllAddrRanges(false), defaultPortID(InvalidPortID),
@@ -140,13 +141,19 @@ BaseXBar::Layer<SrcType, DstType>::Layer(DstType& _port, BaseXBar& _xbar,
                                        const std::string& _name) :
     Stats::Group(&_xbar, _name.c_str()),
     port(_port), xbar(_xbar), _name(xbar.name() + "." + _name), state(IDLE),
-    waitingForPeer(NULL), releaseEvent([this]{ releaseLayer(); }, name()),
+    waitingForPeer(NULL), batchTick(MaxTick),
+    releaseEvent([this]{ releaseLayer(); }, name()),
     ADD_STAT(occupancy, UNIT_TICK, "Layer occupancy (ticks)"),
-    ADD_STAT(utilization, UNIT_RATIO, "Layer utilization")
+    ADD_STAT(utilization, UNIT_RATIO, "Layer utilization"),
+    ADD_STAT(releaseEventsSaved, UNIT_COUNT,
+             "Release events saved by batching packets in the same tick")
 {
     occupancy
         .flags(Stats::nozero);
 
+    releaseEventsSaved
+        .flags(Stats::nozero);
+
     utilization
         .precision(1)
         .flags(Stats::nozero);
@@ -165,11 +172,22 @@ void BaseXBar::Layer<SrcType, DstType>::occupyLayer(Tick until)
 
     // until should never be 0 as express snoops never occupy the layer
     assert(until != 0);
-    xbar.schedule(releaseEvent, until);
 
     // account for the occupied ticks
     occupancy += until - curTick();
 
+    if (releaseEvent.scheduled()) {
+        // the packet joined the batch of the current tick, so rather
+        // than releasing in between, keep the layer busy for the
+        // combined time of all the packets in the batch
+        assert(xbar.batchLayers && batchTick == curTick());
+        until = releaseEvent.when() + (until - curTick());
+        xbar.reschedule(releaseEvent, until);
+        ++releaseEventsSaved;
+    } else {
+        xbar.schedule(releaseEvent, until);
+    }
+
     DPRINTF(BaseXBar, "The crossbar layer is now busy from tick %d to %d\n",
             curTick(), until);
 }
@@ -187,6 +205,14 @@ BaseXBar::Layer<SrcType, DstType>::tryTiming(SrcType* src_port)
     // first we see if the layer is busy, next we check if the
     // destination port is already engaged in a transaction waiting
     // for a retry from the peer
+    // in a batched crossbar, a layer that became busy in this very
+    // tick lets the packet through, provided nobody is queued ahead
+    // of it, and simply stays busy for longer
+    if (state == BUSY && xbar.batchLayers && batchTick == curTick() &&
+        waitingForPeer == NULL && waitingForLayer.empty()) {
+        return true;
+    }
+
     if (state == BUSY || waitingForPeer != NULL) {
         // the port should not be waiting already
         assert(std::find(waitingForLayer.begin(), waitingForLayer.end(),
@@ -201,6 +227,7 @@ BaseXBar::Layer<SrcType, DstType>::tryTiming(SrcType* src_port)
     }
 
     state = BUSY;
+    batchTick = curTick();
 
     return true;
 }
@@ -292,6 +319,7 @@ BaseXBar::Layer<SrcType, DstType>::retryWaiting()
         // update the state to busy and reset the retrying port, we
         // have done our bit and sent the retry
         state = BUSY;
+        batchTick = MaxTick;
 
         // occupy the crossbar layer until the next clock edge
         occupyLayer(xbar.clockEdge());
@@ -118,7 +118,9 @@ class BaseXBar : public ClockedObject
          * Determine if the layer accepts a packet from a specific
          * port. If not, the port in question is also added to the
          * retry list. In either case the state of the layer is
-         * updated accordingly.
+         * updated accordingly. When the crossbar batches its layers,
+         * a busy layer still accepts packets in the tick it became
+         * busy, as long as no other port is waiting for it.
          *
          * @param port Source port presenting the packet
          *
@@ -213,6 +215,13 @@ class BaseXBar : public ClockedObject
          */
         SrcType* waitingForPeer;
 
+        /**
+         * The tick in which the current batch started, i.e. when the
+         * layer last went from idle or retry to busy on a packet, or
+         * MaxTick if the current occupancy cannot be joined.
+         */
+        Tick batchTick;
+
         /**
          * Release the layer after being occupied and return to an
          * idle state where we proceed to send a retry to any
@@ -229,6 +238,12 @@ class BaseXBar : public ClockedObject
         Stats::Scalar occupancy;
         Stats::Formula utilization;
 
+        /**
+         * Packets that joined an ongoing batch and therefore extended
+         * the pending release rather than scheduling their own.
+         */
+        Stats::Scalar releaseEventsSaved;
+
     };
 
     class ReqLayer : public Layer<ResponsePort, RequestPort>
@@ -313,6 +328,12 @@ class BaseXBar : public ClockedObject
     /** the width of the xbar in bytes */
     const uint32_t width;
 
+    /**
+     * If true, packets arriving at a layer in the same tick are
+     * forwarded as one batch sharing a single release event.
+     */
+    const bool batchLayers;
+
     AddrRangeMap<PortID, 3> portMap;
 
     /**
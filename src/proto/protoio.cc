@@ -38,27 +38,48 @@
 #include "proto/protoio.hh"
 
 #include "base/logging.hh"
+#include "config/use_zstd.hh"
+
+#if USE_ZSTD
+#include "proto/zstdio.hh"
+#endif
 
 using namespace google::protobuf;
 
 ProtoOutputStream::ProtoOutputStream(const std::string& filename) :
     fileStream(filename.c_str(),
             std::ios::out | std::ios::binary | std::ios::trunc),
-    wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
+    wrappedFileStream(NULL), gzipStream(NULL), zstdStream(NULL),
+    zeroCopyStream(NULL)
 {
     if (!fileStream.good())
         panic("Could not open %s for writing\n", filename);
 
+    std::string extension;
+    if (filename.find_last_of('.') != std::string::npos)
+        extension = filename.substr(filename.find_last_of('.') + 1);
+
     // Wrap the output file in a zero copy stream, that in turn is
     // wrapped in a gzip stream if the filename ends with .gz. The
-    // latter stream is in turn wrapped in a coded stream
-    wrappedFileStream = new io::OstreamOutputStream(&fileStream);
-    if (filename.find_last_of('.') != string::npos &&
-        filename.substr(filename.find_last_of('.') + 1) == "gz") {
-        gzipStream = new io::GzipOutputStream(wrappedFileStream);
-        zeroCopyStream = gzipStream;
+    // latter stream is in turn wrapped in a coded stream. A zstd
+    // stream does its own buffered writes to the file.
+    if (extension == "zst") {
+#if USE_ZSTD
+        zstdStream = new ZstdOutputStream(fileStream,
+                                          ZstdOutputStream::defaultThreads());
+        zeroCopyStream = zstdStream;
+#else
+        fatal("Can't write %s, gem5 was built without zstd support\n",
+              filename);
+#endif
     } else {
-        zeroCopyStream = wrappedFileStream;
+        wrappedFileStream = new io::OstreamOutputStream(&fileStream);
+        if (extension == "gz") {
+            gzipStream = new io::GzipOutputStream(wrappedFileStream);
+            zeroCopyStream = gzipStream;
+        } else {
+            zeroCopyStream = wrappedFileStream;
+        }
     }
 
     // Write the magic number to the file
@@ -74,6 +95,10 @@ ProtoOutputStream::~ProtoOutputStream()
     // As the compression is optional, see if the stream exists
     if (gzipStream != NULL)
         delete gzipStream;
+#if USE_ZSTD
+    if (zstdStream != NULL)
+        delete zstdStream;
+#endif
     delete wrappedFileStream;
     fileStream.close();
 }
@@ -98,18 +123,34 @@ ProtoOutputStream::write(const Message& msg)
     msg.SerializeWithCachedSizes(&codedStream);
 }
 
+void
+ProtoOutputStream::seekPoint(uint64_t key)
+{
+#if USE_ZSTD
+    if (zstdStream != NULL)
+        zstdStream->seekPoint(key);
+#endif
+}
+
 ProtoInputStream::ProtoInputStream(const std::string& filename) :
     fileStream(filename.c_str(), std::ios::in | std::ios::binary),
-    fileName(filename), useGzip(false),
-    wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
+    fileName(filename), useGzip(false), useZstd(false),
+    wrappedFileStream(NULL), gzipStream(NULL), zstdStream(NULL),
+    zeroCopyStream(NULL)
 {
     if (!fileStream.good())
         panic("Could not open %s for reading\n", filename);
 
-    // check the magic number to see if this is a gzip stream
-    unsigned char bytes[2];
-    fileStream.read((char*) bytes, 2);
+    // check the magic number to see if this is a gzip or zstd stream
+    unsigned char bytes[4];
+    fileStream.read((char*) bytes, 4);
     useGzip = fileStream.good() && bytes[0] == 0x1f && bytes[1] == 0x8b;
+    useZstd = fileStream.good() && bytes[0] == 0x28 && bytes[1] == 0xb5 &&
+        bytes[2] == 0x2f && bytes[3] == 0xfd;
+#if !USE_ZSTD
+    fatal_if(useZstd, "Can't read %s, gem5 was built without zstd "
+             "support\n", filename);
+#endif
 
     // seek to the start of the input file and clear any flags
     fileStream.clear();
@@ -123,17 +164,25 @@ ProtoInputStream::createStreams()
 {
     // All streams should be NULL at this point
     assert(wrappedFileStream == NULL && gzipStream == NULL &&
-           zeroCopyStream == NULL);
+           zstdStream == NULL && zeroCopyStream == NULL);
 
     // Wrap the input file in a zero copy stream, that in turn is
     // wrapped in a gzip stream if the filename ends with .gz. The
-    // latter stream is in turn wrapped in a coded stream
-    wrappedFileStream = new io::IstreamInputStream(&fileStream);
-    if (useGzip) {
-        gzipStream = new io::GzipInputStream(wrappedFileStream);
-        zeroCopyStream = gzipStream;
+    // latter stream is in turn wrapped in a coded stream. A zstd
+    // stream does its own reads from the file.
+    if (useZstd) {
+#if USE_ZSTD
+        zstdStream = new ZstdInputStream(fileStream);
+        zeroCopyStream = zstdStream;
+#endif
     } else {
-        zeroCopyStream = wrappedFileStream;
+        wrappedFileStream = new io::IstreamInputStream(&fileStream);
+        if (useGzip) {
+            gzipStream = new io::GzipInputStream(wrappedFileStream);
+            zeroCopyStream = gzipStream;
+        } else {
+            zeroCopyStream = wrappedFileStream;
+        }
     }
 
     uint32_t magic_check;
@@ -152,6 +201,12 @@ ProtoInputStream::destroyStreams()
         delete gzipStream;
         gzipStream = NULL;
     }
+#if USE_ZSTD
+    if (zstdStream != NULL) {
+        delete zstdStream;
+        zstdStream = NULL;
+    }
+#endif
     delete wrappedFileStream;
     wrappedFileStream = NULL;
 
@@ -176,6 +231,16 @@ ProtoInputStream::reset()
     createStreams();
 }
 
+bool
+ProtoInputStream::seek(uint64_t key)
+{
+#if USE_ZSTD
+    if (zstdStream != NULL)
+        return zstdStream->seek(key);
+#endif
+    return false;
+}
+
 bool
 ProtoInputStream::read(Message& msg)
 {
@@ -51,6 +51,9 @@
 
 #include <fstream>
 
+class ZstdInputStream;
+class ZstdOutputStream;
+
 /**
  * A ProtoStream provides the shared functionality of the input and
  * output streams. At the moment this is limited to magic number.
@@ -94,7 +97,9 @@ class ProtoOutputStream : public ProtoStream
 
     /**
      * Create an output stream for a given file name. If the filename
-     * ends with .gz then the file will be compressed accordinly.
+     * ends with .gz then the file will be compressed accordinly. If
+     * it ends with .zst, the file is compressed with zstd by several
+     * threads, and can be read from a seek point (see seekPoint()).
      *
      * @param filename Path to the file to create or truncate
      */
@@ -114,6 +119,16 @@ class ProtoOutputStream : public ProtoStream
      */
     void write(const google::protobuf::Message& msg);
 
+    /**
+     * Mark the message written next as a point the stream can be read
+     * from, tagged with a key such as its tick. Keys must not
+     * decrease. Only zstd streams use the seek points, which are
+     * cheap enough to mark every message.
+     *
+     * @param key Key of the message written next
+     */
+    void seekPoint(uint64_t key);
+
   private:
 
     /// Underlying file output stream
@@ -125,6 +140,9 @@ class ProtoOutputStream : public ProtoStream
     /// Optional Gzip stream to wrap the Zero Copy stream
     google::protobuf::io::GzipOutputStream* gzipStream;
 
+    /// Optional zstd stream writing straight to the file
+    ZstdOutputStream* zstdStream;
+
     /// Top-level zero-copy stream, either with compression or not
     google::protobuf::io::ZeroCopyOutputStream* zeroCopyStream;
 
@@ -143,8 +161,9 @@ class ProtoInputStream : public ProtoStream
   public:
 
     /**
-     * Create an input stream for a given file name. If the filename
-     * ends with .gz then the file will be decompressed accordingly.
+     * Create an input stream for a given file name. Gzip and zstd
+     * compressed files are recognised by their magic numbers and
+     * decompressed accordingly.
      *
      * @param filename Path to the file to read from
      */
@@ -169,6 +188,20 @@ class ProtoInputStream : public ProtoStream
      */
     void reset();
 
+    /**
+     * Skip ahead to the seek point with the largest key below key, as
+     * marked by ProtoOutputStream::seekPoint(), without decoding the
+     * messages in front of it. The messages read next include every
+     * message marked with a key of at least key, preceded by at most a
+     * compression frame of messages with smaller keys. The file header
+     * must have been read already.
+     *
+     * @param key Key of the first message of interest
+     * @return False if the file has no seek points, in which case the
+     *         stream is left untouched
+     */
+    bool seek(uint64_t key);
+
   private:
 
     /**
@@ -190,12 +223,18 @@ class ProtoInputStream : public ProtoStream
     /// Boolean flag to remember whether we use gzip or not
     bool useGzip;
 
+    /// Boolean flag to remember whether we use zstd or not
+    bool useZstd;
+
     /// Zero Copy stream wrapping the STL input stream
     google::protobuf::io::IstreamInputStream* wrappedFileStream;
 
     /// Optional Gzip stream to wrap the Zero Copy stream
     google::protobuf::io::GzipInputStream* gzipStream;
 
+    /// Optional zstd stream reading straight from the file
+    ZstdInputStream* zstdStream;
+
     /// Top-level zero-copy stream, either with compression or not
     google::protobuf::io::ZeroCopyInputStream* zeroCopyStream;
 
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "proto/zstdio.hh"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+
+namespace
+{
+
+/// Skippable frame holding the seek table
+const uint32_t seekTableMagic = 0x184D2A5E;
+/// Last field of the seek table
+const uint32_t seekableMagic = 0x8F92EAB1;
+/// Skippable frame holding the frame keys
+const uint32_t keysMagic = 0x184D2A5D;
+/// Last field of the frame keys, the ASCII characters g5ky
+const uint32_t keysEndMagic = 0x796b3567;
+
+/// Size of the seek table footer: frame count, descriptor and magic
+const size_t footerSize = 9;
+/// Size of a skippable frame header: magic and frame size
+const size_t skippableHeaderSize = 8;
+
+void
+put32(std::vector<char> &buf, uint32_t val)
+{
+    for (int i = 0; i < 4; ++i)
+        buf.push_back(char(val >> (8 * i)));
+}
+
+void
+put64(std::vector<char> &buf, uint64_t val)
+{
+    put32(buf, uint32_t(val));
+    put32(buf, uint32_t(val >> 32));
+}
+
+uint32_t
+get32(const char *buf)
+{
+    uint32_t val = 0;
+    for (int i = 0; i < 4; ++i)
+        val |= uint32_t(uint8_t(buf[i])) << (8 * i);
+    return val;
+}
+
+uint64_t
+get64(const char *buf)
+{
+    return get32(buf) | uint64_t(get32(buf + 4)) << 32;
+}
+
+} // anonymous namespace
+
+ZstdOutputStream::ZstdOutputStream(std::ofstream &_out, unsigned threads,
+                                   int _level, size_t frame_size)
+    : out(_out), level(_level), frameSize(frame_size),
+      current(new Frame{{}, {}, noKey, false}), nextToCompress(0),
+      byteCount(0), seekPointSeen(false), closed(false), stopping(false),
+      cctx(nullptr)
+{
+    current->data.reserve(frameSize);
+    if (threads == 0)
+        cctx = ZSTD_createCCtx();
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back([this]() { worker(); });
+}
+
+ZstdOutputStream::~ZstdOutputStream()
+{
+    close();
+    if (cctx)
+        ZSTD_freeCCtx((ZSTD_CCtx *)cctx);
+}
+
+unsigned
+ZstdOutputStream::defaultThreads()
+{
+    // Leave the simulation thread its core
+    unsigned cores = std::thread::hardware_concurrency();
+    return std::min(4u, cores > 1 ? cores - 1 : 1);
+}
+
+bool
+ZstdOutputStream::Next(void **data, int *size)
+{
+    assert(!closed);
+
+    // A single message outgrew the frame, split it there. The next frame
+    // starts in the middle of the message, so it has no key.
+    if (current->data.size() >= 2 * frameSize)
+        endFrame(noKey);
+
+    const size_t chunk = std::max<size_t>(frameSize / 16, 4096);
+    const size_t used = current->data.size();
+    current->data.resize(used + chunk);
+    *data = current->data.data() + used;
+    *size = chunk;
+    byteCount += chunk;
+    return true;
+}
+
+void
+ZstdOutputStream::BackUp(int count)
+{
+    assert((size_t)count <= current->data.size());
+    current->data.resize(current->data.size() - count);
+    byteCount -= count;
+}
+
+void
+ZstdOutputStream::seekPoint(uint64_t key)
+{
+    assert(!closed);
+    assert(current->key == noKey || key >= current->key);
+
+    // The first seek point closes the frame holding the file header,
+    // so that seeking never lands in front of it.
+    if (!seekPointSeen || current->data.size() >= frameSize) {
+        if (current->data.empty())
+            current->key = key;
+        else
+            endFrame(key);
+    }
+    seekPointSeen = true;
+}
+
+void
+ZstdOutputStream::endFrame(uint64_t next_key)
+{
+    std::unique_ptr<Frame> frame(new Frame{{}, {}, next_key, false});
+    frame->data.reserve(frameSize);
+    std::swap(frame, current);
+
+    if (workers.empty()) {
+        compress(*frame, cctx);
+        frame->done = true;
+        pending.push_back(std::move(frame));
+        nextToCompress++;
+    } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(frame));
+        work.notify_one();
+    }
+
+    drain(false);
+}
+
+void
+ZstdOutputStream::drain(bool wait_all)
+{
+    // Keep a couple of frames per thread in flight, which bounds the
+    // memory used and keeps the threads busy.
+    const size_t max_pending = wait_all ? 0 : 2 * workers.size();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pending.empty()) {
+        if (!pending.front()->done) {
+            if (pending.size() <= max_pending)
+                break;
+            done.wait(lock, [this]() { return pending.front()->done; });
+        }
+
+        std::unique_ptr<Frame> frame = std::move(pending.front());
+        pending.pop_front();
+        nextToCompress--;
+        lock.unlock();
+
+        out.write(frame->compressed.data(), frame->compressed.size());
+        compressedSizes.push_back(frame->compressed.size());
+        frameSizes.push_back(frame->data.size());
+        frameKeys.push_back(frame->key);
+
+        lock.lock();
+    }
+}
+
+void
+ZstdOutputStream::compress(Frame &frame, void *ctx)
+{
+    frame.compressed.resize(ZSTD_compressBound(frame.data.size()));
+    size_t size = ZSTD_compressCCtx((ZSTD_CCtx *)ctx,
+        frame.compressed.data(), frame.compressed.size(),
+        frame.data.data(), frame.data.size(), level);
+    panic_if(ZSTD_isError(size), "zstd compression failed: %s\n",
+             ZSTD_getErrorName(size));
+    frame.compressed.resize(size);
+}
+
+void
+ZstdOutputStream::worker()
+{
+    ZSTD_CCtx *ctx = ZSTD_createCCtx();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work.wait(lock, [this]() {
+            return stopping || nextToCompress < pending.size();
+        });
+        if (nextToCompress == pending.size())
+            break;
+
+        Frame *frame = pending[nextToCompress++].get();
+        lock.unlock();
+        compress(*frame, ctx);
+        lock.lock();
+
+        frame->done = true;
+        done.notify_all();
+    }
+
+    ZSTD_freeCCtx(ctx);
+}
+
+void
+ZstdOutputStream::close()
+{
+    if (closed)
+        return;
+
+    if (!current->data.empty())
+        endFrame(noKey);
+    drain(true);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+
+    const size_t num_frames = frameSizes.size();
+    std::vector<char> tail;
+
+    // The key of every frame, in a skippable frame of its own
+    put32(tail, keysMagic);
+    put32(tail, num_frames * 8 + 4);
+    for (auto key : frameKeys)
+        put64(tail, key);
+    put32(tail, keysEndMagic);
+
+    // The seek table, without checksums
+    put32(tail, seekTableMagic);
+    put32(tail, num_frames * 8 + footerSize);
+    for (size_t i = 0; i < num_frames; ++i) {
+        put32(tail, compressedSizes[i]);
+        put32(tail, frameSizes[i]);
+    }
+    put32(tail, num_frames);
+    tail.push_back(0);
+    put32(tail, seekableMagic);
+
+    out.write(tail.data(), tail.size());
+    closed = true;
+}
+
+ZstdInputStream::ZstdInputStream(std::ifstream &_in)
+    : in(_in), nextFrame(0), bufferPos(0), bufferSize(0),
+      inputPos(0), inputSize(0), dctx(ZSTD_createDCtx()), byteCount(0)
+{
+    readSeekTable();
+
+    in.clear();
+    in.seekg(0, std::ifstream::beg);
+
+    if (frameOffsets.empty()) {
+        input.resize(ZSTD_DStreamInSize());
+        buffer.resize(ZSTD_DStreamOutSize());
+    }
+}
+
+ZstdInputStream::~ZstdInputStream()
+{
+    ZSTD_freeDCtx((ZSTD_DCtx *)dctx);
+}
+
+void
+ZstdInputStream::readSeekTable()
+{
+    in.clear();
+    in.seekg(0, std::ifstream::end);
+    const uint64_t file_size = in.tellg();
+    if (file_size < skippableHeaderSize + footerSize)
+        return;
+
+    char footer[footerSize];
+    in.seekg(file_size - footerSize);
+    in.read(footer, footerSize);
+    if (!in || get32(footer + 5) != seekableMagic)
+        return;
+
+    const uint32_t num_frames = get32(footer);
+    const size_t entry_size = (footer[4] & 0x80) ? 12 : 8;
+    const uint64_t table_size =
+        skippableHeaderSize + num_frames * entry_size + footerSize;
+    if (file_size < table_size)
+        return;
+
+    const uint64_t table_start = file_size - table_size;
+    std::vector<char> table(table_size);
+    in.seekg(table_start);
+    in.read(table.data(), table_size);
+    if (!in || get32(table.data()) != seekTableMagic ||
+        get32(table.data() + 4) != table_size - skippableHeaderSize) {
+        warn("Ignoring the malformed zstd seek table\n");
+        return;
+    }
+
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < num_frames; ++i) {
+        const char *entry = table.data() + skippableHeaderSize +
+            i * entry_size;
+        frameOffsets.push_back(offset);
+        compressedSizes.push_back(get32(entry));
+        frameSizes.push_back(get32(entry + 4));
+        offset += compressedSizes.back();
+    }
+
+    // The frame keys are only found in files written by gem5
+    const uint64_t keys_size = skippableHeaderSize + num_frames * 8 + 4;
+    if (table_start < keys_size)
+        return;
+
+    std::vector<char> keys(keys_size);
+    in.seekg(table_start - keys_size);
+    in.read(keys.data(), keys_size);
+    if (!in || get32(keys.data()) != keysMagic ||
+        get32(keys.data() + 4) != keys_size - skippableHeaderSize ||
+        get32(keys.data() + keys_size - 4) != keysEndMagic) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < num_frames; ++i) {
+        uint64_t key = get64(keys.data() + skippableHeaderSize + i * 8);
+        if (key == ZstdOutputStream::noKey)
+            continue;
+        keyedFrames.push_back(i);
+        frameKeys.push_back(key);
+    }
+}
+
+bool
+ZstdInputStream::fill()
+{
+    if (!frameOffsets.empty()) {
+        if (nextFrame == frameOffsets.size())
+            return false;
+
+        const size_t compressed_size = compressedSizes[nextFrame];
+        const size_t size = frameSizes[nextFrame];
+        input.resize(compressed_size);
+        in.clear();
+        in.seekg(frameOffsets[nextFrame]);
+        in.read(input.data(), compressed_size);
+        panic_if(!in, "Truncated zstd frame %d\n", nextFrame);
+
+        if (buffer.size() < size)
+            buffer.resize(size);
+        size_t ret = ZSTD_decompressDCtx((ZSTD_DCtx *)dctx, buffer.data(),
+            size, input.data(), compressed_size);
+        panic_if(ZSTD_isError(ret) || ret != size,
+                 "Corrupt zstd frame %d\n", nextFrame);
+
+        nextFrame++;
+        bufferPos = 0;
+        bufferSize = size;
+        return true;
+    }
+
+    // Without a seek table, decompress the file as a stream
+    while (true) {
+        if (inputPos == inputSize) {
+            in.read(input.data(), input.size());
+            inputSize = in.gcount();
+            inputPos = 0;
+            if (inputSize == 0)
+                return false;
+        }
+
+        ZSTD_inBuffer src = { input.data(), inputSize, inputPos };
+        ZSTD_outBuffer dst = { buffer.data(), buffer.size(), 0 };
+        size_t ret = ZSTD_decompressStream((ZSTD_DStream *)dctx, &dst, &src);
+        panic_if(ZSTD_isError(ret), "zstd decompression failed: %s\n",
+                 ZSTD_getErrorName(ret));
+        inputPos = src.pos;
+
+        if (dst.pos != 0) {
+            bufferPos = 0;
+            bufferSize = dst.pos;
+            return true;
+        }
+    }
+}
+
+bool
+ZstdInputStream::Next(const void **data, int *size)
+{
+    while (bufferPos == bufferSize) {
+        if (!fill())
+            return false;
+    }
+
+    *data = buffer.data() + bufferPos;
+    *size = bufferSize - bufferPos;
+    byteCount += *size;
+    bufferPos = bufferSize;
+    return true;
+}
+
+void
+ZstdInputStream::BackUp(int count)
+{
+    assert((size_t)count <= bufferPos);
+    bufferPos -= count;
+    byteCount -= count;
+}
+
+bool
+ZstdInputStream::Skip(int count)
+{
+    while (count > 0) {
+        if (bufferPos == bufferSize && !fill())
+            return false;
+
+        const size_t skipped = std::min<size_t>(count, bufferSize - bufferPos);
+        bufferPos += skipped;
+        byteCount += skipped;
+        count -= skipped;
+    }
+    return true;
+}
+
+bool
+ZstdInputStream::seek(uint64_t key)
+{
+    if (keyedFrames.empty())
+        return false;
+
+    auto it = std::lower_bound(frameKeys.begin(), frameKeys.end(), key);
+    size_t idx = it == frameKeys.begin() ? 0 : it - frameKeys.begin() - 1;
+
+    nextFrame = keyedFrames[idx];
+    bufferPos = 0;
+    bufferSize = 0;
+    return true;
+}
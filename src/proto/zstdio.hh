@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Zero copy streams reading and writing zstd compressed files made of
+ * independent frames, with a seek table at the end of the file.
+ *
+ * The files follow the zstd seekable format: a sequence of regular zstd
+ * frames, followed by a skippable frame holding the compressed and
+ * decompressed size of every frame. Any zstd decoder can decompress
+ * them as a whole. On top of that, every frame is tagged with the key
+ * (typically a tick) of the first message it holds, in a second
+ * skippable frame in front of the seek table, so that a reader can jump
+ * straight to the frame holding a given key.
+ */
+
+#ifndef __PROTO_ZSTDIO_HH__
+#define __PROTO_ZSTDIO_HH__
+
+#include <google/protobuf/io/zero_copy_stream.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A zero copy output stream compressing its data into independent zstd
+ * frames. Frames are compressed by a pool of worker threads and
+ * written to the file in order. A new frame is only started at a seek
+ * point, i.e., a message boundary the stream was told about, once the
+ * current frame has reached the target frame size, or when a single
+ * message outgrows twice that size.
+ */
+class ZstdOutputStream : public google::protobuf::io::ZeroCopyOutputStream
+{
+  public:
+
+    /**
+     * Create a stream writing to an open file.
+     *
+     * @param out File to write to, it must outlive the stream
+     * @param threads Number of compression threads, 0 to compress
+     *                on the calling thread
+     * @param level zstd compression level
+     * @param frame_size Target size of the uncompressed frames
+     */
+    ZstdOutputStream(std::ofstream &out, unsigned threads,
+                     int level = 3, size_t frame_size = 1 << 20);
+
+    /**
+     * Close the stream if that was not done already.
+     */
+    ~ZstdOutputStream();
+
+    bool Next(void **data, int *size) override;
+    void BackUp(int count) override;
+    int64_t ByteCount() const override { return byteCount; }
+
+    /**
+     * Declare that the data written next starts a message tagged with
+     * key. Keys must not decrease.
+     */
+    void seekPoint(uint64_t key);
+
+    /**
+     * Compress and write the last frame, then the frame keys and the
+     * seek table. Nothing can be written after closing the stream.
+     */
+    void close();
+
+    /// Number of compression threads used when not told otherwise
+    static unsigned defaultThreads();
+
+    /// Key of the frames that do not start at a seek point
+    static const uint64_t noKey = UINT64_MAX;
+
+  private:
+
+    /// A frame on its way to the file
+    struct Frame
+    {
+        std::vector<char> data;
+        std::vector<char> compressed;
+        uint64_t key;
+        bool done;
+    };
+
+    /// Hand the current frame to the compression threads
+    void endFrame(uint64_t next_key);
+
+    /// Write the compressed frames at the head of the queue to the file
+    void drain(bool wait_all);
+
+    /// Compress a frame with a compression context of the caller
+    void compress(Frame &frame, void *cctx);
+
+    /// Body of the compression threads
+    void worker();
+
+    std::ofstream &out;
+    const int level;
+    const size_t frameSize;
+
+    /// Frame being filled, and the key of its first message
+    std::unique_ptr<Frame> current;
+
+    /// Frames handed over, in file order, and the next one to compress
+    std::deque<std::unique_ptr<Frame>> pending;
+    size_t nextToCompress;
+
+    /// Sizes and keys of the frames written so far
+    std::vector<uint32_t> compressedSizes;
+    std::vector<uint32_t> frameSizes;
+    std::vector<uint64_t> frameKeys;
+
+    int64_t byteCount;
+    bool seekPointSeen;
+    bool closed;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable done;
+    bool stopping;
+
+    /// Compression context of the calling thread, without workers
+    void *cctx;
+};
+
+/**
+ * A zero copy input stream decompressing a zstd file. Files with a seek
+ * table are decompressed one frame at a time and support jumping to the
+ * frame holding a key. Other zstd files are decompressed as a stream.
+ */
+class ZstdInputStream : public google::protobuf::io::ZeroCopyInputStream
+{
+  public:
+
+    /**
+     * Create a stream reading from an open file.
+     *
+     * @param in File to read from, it must outlive the stream
+     */
+    ZstdInputStream(std::ifstream &in);
+    ~ZstdInputStream();
+
+    bool Next(const void **data, int *size) override;
+    void BackUp(int count) override;
+    bool Skip(int count) override;
+    int64_t ByteCount() const override { return byteCount; }
+
+    /**
+     * Move to the last frame whose first message has a key smaller than
+     * key, or to the first frame with a key if there is none. Reading
+     * from there returns every message with a key of at least key, and
+     * as few messages before them as the frame size allows.
+     *
+     * @return False if the file has no frame keys, in which case the
+     *         stream is left untouched
+     */
+    bool seek(uint64_t key);
+
+  private:
+
+    /// Read the seek table and frame keys at the end of the file
+    void readSeekTable();
+
+    /// Load the next frame, or the next chunk of a plain stream
+    bool fill();
+
+    std::ifstream &in;
+
+    /// Frame locations from the seek table, empty for plain streams
+    std::vector<uint64_t> frameOffsets;
+    std::vector<uint32_t> compressedSizes;
+    std::vector<uint32_t> frameSizes;
+    size_t nextFrame;
+
+    /// Frames starting at a seek point, and their keys
+    std::vector<size_t> keyedFrames;
+    std::vector<uint64_t> frameKeys;
+
+    /// Decompressed data and the position of the reader in it
+    std::vector<char> buffer;
+    size_t bufferPos;
+    size_t bufferSize;
+
+    /// Compressed data, a frame or a chunk of a plain stream
+    std::vector<char> input;
+    size_t inputPos;
+    size_t inputSize;
+
+    void *dctx;
+    int64_t byteCount;
+};
+
+#endif //__PROTO_ZSTDIO_HH__
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <zstd.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "proto/zstdio.hh"
+
+namespace
+{
+
+/** The records the tests write, keyed by a quarter of their index. */
+struct Record
+{
+    uint64_t key;
+    uint64_t index;
+    char payload[16];
+};
+
+Record
+makeRecord(uint64_t index)
+{
+    Record rec;
+    rec.key = index / 4;
+    rec.index = index;
+    std::memset(rec.payload, char(index), sizeof(rec.payload));
+    return rec;
+}
+
+void
+writeBytes(google::protobuf::io::ZeroCopyOutputStream &os,
+           const void *data, size_t size)
+{
+    const char *src = static_cast<const char *>(data);
+    while (size > 0) {
+        void *buf;
+        int len;
+        ASSERT_TRUE(os.Next(&buf, &len));
+        const size_t n = std::min<size_t>(len, size);
+        std::memcpy(buf, src, n);
+        os.BackUp(len - n);
+        src += n;
+        size -= n;
+    }
+}
+
+bool
+readBytes(google::protobuf::io::ZeroCopyInputStream &is, void *data,
+          size_t size)
+{
+    char *dst = static_cast<char *>(data);
+    while (size > 0) {
+        const void *buf;
+        int len;
+        if (!is.Next(&buf, &len))
+            return false;
+        const size_t n = std::min<size_t>(len, size);
+        std::memcpy(dst, buf, n);
+        is.BackUp(len - n);
+        dst += n;
+        size -= n;
+    }
+    return true;
+}
+
+class ZstdIOTest : public ::testing::Test
+{
+  protected:
+    static const size_t numRecords = 20000;
+    std::string file;
+
+    void
+    SetUp() override
+    {
+        char name[] = "/tmp/zstdio.test.XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(fd, -1);
+        close(fd);
+        file = name;
+    }
+
+    void TearDown() override { std::remove(file.c_str()); }
+
+    /** Write the records with small frames so that there are many. */
+    void
+    writeRecords(unsigned threads)
+    {
+        std::ofstream out(file, std::ios::out | std::ios::binary);
+        ZstdOutputStream os(out, threads, 3, 4096);
+        for (uint64_t i = 0; i < numRecords; i++) {
+            const Record rec = makeRecord(i);
+            os.seekPoint(rec.key);
+            writeBytes(os, &rec, sizeof(rec));
+        }
+        os.close();
+    }
+
+    /** Check the records from the current position to the end. */
+    ::testing::AssertionResult
+    readRecords(ZstdInputStream &is, uint64_t first)
+    {
+        Record rec;
+        for (uint64_t i = first; i < numRecords; i++) {
+            if (!readBytes(is, &rec, sizeof(rec))) {
+                return ::testing::AssertionFailure()
+                    << "missing record " << i;
+            }
+            const Record expected = makeRecord(i);
+            if (std::memcmp(&rec, &expected, sizeof(rec)) != 0) {
+                return ::testing::AssertionFailure()
+                    << "record " << i << " differs";
+            }
+        }
+        if (readBytes(is, &rec, sizeof(rec)))
+            return ::testing::AssertionFailure() << "extra records";
+        return ::testing::AssertionSuccess();
+    }
+
+    std::vector<char>
+    fileContents()
+    {
+        std::ifstream in(file, std::ios::in | std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in),
+                                 std::istreambuf_iterator<char>());
+    }
+};
+
+} // anonymous namespace
+
+/** Records read back the same, compressed on threads or not. */
+TEST_F(ZstdIOTest, RoundTrip)
+{
+    for (unsigned threads : {0, 3}) {
+        writeRecords(threads);
+        std::ifstream in(file, std::ios::in | std::ios::binary);
+        ZstdInputStream is(in);
+        EXPECT_TRUE(readRecords(is, 0)) << threads << " threads";
+    }
+}
+
+/**
+ * Seeking to a key moves to a frame starting before the first record
+ * with that key, and reading on returns every record from there.
+ */
+TEST_F(ZstdIOTest, Seek)
+{
+    writeRecords(2);
+    std::ifstream in(file, std::ios::in | std::ios::binary);
+    ZstdInputStream is(in);
+
+    // Seek backwards and forwards in the same stream.
+    for (uint64_t key : {3000, 10, 4999, 0, 1234}) {
+        ASSERT_TRUE(is.seek(key));
+        Record rec;
+        ASSERT_TRUE(readBytes(is, &rec, sizeof(rec)));
+        EXPECT_LE(rec.key, key);
+        // A frame holds 128 records of 32 bytes, so there are at most
+        // that many before the first one with the key.
+        EXPECT_LE(key * 4 - rec.index, 128U) << "key " << key;
+        EXPECT_TRUE(readRecords(is, rec.index + 1)) << "key " << key;
+    }
+
+    // Keys past the end move to the last frame.
+    ASSERT_TRUE(is.seek(1 << 20));
+    Record rec;
+    ASSERT_TRUE(readBytes(is, &rec, sizeof(rec)));
+    EXPECT_TRUE(readRecords(is, rec.index + 1));
+}
+
+/**
+ * The seek table and the frame keys are skippable frames, so that any
+ * zstd decoder can decompress the file as a whole.
+ */
+TEST_F(ZstdIOTest, SeekTableIsSkippable)
+{
+    writeRecords(2);
+    const std::vector<char> compressed = fileContents();
+
+    std::vector<char> data(numRecords * sizeof(Record) + 1);
+    const size_t size = ZSTD_decompress(data.data(), data.size(),
+                                        compressed.data(), compressed.size());
+    ASSERT_FALSE(ZSTD_isError(size)) << ZSTD_getErrorName(size);
+    ASSERT_EQ(size, numRecords * sizeof(Record));
+    for (uint64_t i = 0; i < numRecords; i++) {
+        const Record expected = makeRecord(i);
+        EXPECT_EQ(std::memcmp(&data[i * sizeof(Record)], &expected,
+                              sizeof(Record)), 0) << "record " << i;
+    }
+}
+
+/** Files without a seek table are read as a plain stream. */
+TEST_F(ZstdIOTest, PlainStream)
+{
+    std::vector<char> data;
+    for (uint64_t i = 0; i < numRecords; i++) {
+        const Record rec = makeRecord(i);
+        const char *bytes = reinterpret_cast<const char *>(&rec);
+        data.insert(data.end(), bytes, bytes + sizeof(rec));
+    }
+    std::vector<char> compressed(ZSTD_compressBound(data.size()));
+    const size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                                      data.data(), data.size(), 3);
+    ASSERT_FALSE(ZSTD_isError(size));
+    {
+        std::ofstream out(file, std::ios::out | std::ios::binary);
+        out.write(compressed.data(), size);
+    }
+
+    std::ifstream in(file, std::ios::in | std::ios::binary);
+    ZstdInputStream is(in);
+    // There is nothing to seek with, and the stream stays at the start.
+    EXPECT_FALSE(is.seek(100));
+    EXPECT_TRUE(readRecords(is, 0));
+}
@@ -71,6 +71,7 @@ def parse_options():
     group = options.set_group
 
     listener_modes = ( "on", "off", "auto" )
+    event_queue_backends = ( "list", "calendar" )
 
     # Help options
     option('-B', "--build-info", action="store_true", default=False,
@@ -108,6 +109,10 @@ def parse_options():
         help="Reduce verbosity")
     option('-v', "--verbose", action="count", default=0,
         help="Increase verbosity")
+    option("--event-queue", metavar="{list,calendar}",
+        choices=event_queue_backends, default="list",
+        help="Data structure used to sort the events of the event queues " \
+        "[Default: %default]")
 
     # Statistics options
     group("Statistics Options")
@@ -234,6 +239,9 @@ def main(*args):
 
     m5.options = options
 
+    # The backend has to be selected before any event queue is created
+    event.setEventQueueBackend(options.event_queue)
+
     # Set the main event queue for the main thread.
     event.mainq = event.getEventQueue(0)
     event.setEventQueue(event.mainq)
@@ -183,6 +183,30 @@ def _hdf5Factory(fn, chunking=10, desc=True, formulas=True):
 
     return _m5.stats.initHDF5(fn, chunking, desc, formulas)
 
+@_url_factory([ "gcol", "columnar", ])
+def _columnarFactory(fn, compress=True, desc=True, formulas=True):
+    """Output stats in a binary columnar format.
+
+    The schema (stat names, descriptions and columns) is only written
+    when it changes and every dump appends one row of packed
+    doubles. This makes periodic stat dumps cheap and keeps the file
+    small. Use m5.stats.columnar.ColumnarStats to read the result.
+
+    Parameters:
+      * compress (bool): Deflate schema and rows (default: True)
+      * desc (bool): Output stat descriptions (default: True)
+      * formulas (bool): Output derived stats (default: True)
+
+    Uncompressed files have a fixed row stride and can be
+    memory-mapped by the reader without copying.
+
+    Example:
+      gcol://stats.gcol?compress=False
+
+    """
+
+    return _m5.stats.initColumnar(fn, compress, desc, formulas)
+
 @_url_factory(["json"])
 def _jsonFactory(fn):
     """Output stats in JSON format.
@@ -0,0 +1,244 @@
+# Copyright (c) 2021 The Regents of The University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Reader for the binary columnar stat format written by Stats::Columnar
+(see src/base/stats/columnar.hh).
+
+The module only depends on the Python standard library so that it can
+be used for analysis outside of gem5, e.g., by loading it directly
+from the source tree. If numpy is available, the values can also be
+retrieved as arrays; uncompressed files are then memory-mapped rather
+than copied.
+
+Example:
+    stats = ColumnarStats("m5out/stats.gcol")
+    cycles = stats.column("system.cpu.numCycles")
+    for tick, row in stats.rows():
+        ...
+"""
+
+import mmap
+import struct
+import zlib
+from collections import namedtuple
+
+MAGIC = b"gem5scol"
+VERSION = 1
+
+FLAG_COMPRESSED = 0x1
+
+RECORD_SCHEMA = 1
+RECORD_ROW = 2
+
+KINDS = ("scalar", "vector", "dist", "vectordist", "vector2d", "formula")
+
+_file_header = struct.Struct("=8sII")
+_record_header = struct.Struct("=IIQQ")
+
+Stat = namedtuple("Stat", "name kind desc subnames")
+
+class Schema(object):
+    """Layout of the rows that follow a schema record."""
+
+    def __init__(self, payload):
+        num_stats, num_columns = struct.unpack_from("=IQ", payload, 0)
+        pos = 12
+
+        def string():
+            nonlocal pos
+            length, = struct.unpack_from("=I", payload, pos)
+            pos += 4 + length
+            return bytes(payload[pos - length:pos]).decode("utf-8")
+
+        self.stats = []
+        self.columns = []
+        for _ in range(num_stats):
+            kind, columns = struct.unpack_from("=BI", payload, pos)
+            pos += 5
+            name = string()
+            desc = string()
+            subnames = [ string() for _ in range(columns) ]
+            self.stats.append(Stat(name, KINDS[kind], desc, subnames))
+            self.columns += [ name + sub for sub in subnames ]
+
+        assert len(self.columns) == num_columns
+        self.index = { name: i for i, name in enumerate(self.columns) }
+        self.row_size = 8 * (num_columns + 1)
+
+class ColumnarStats(object):
+    """A columnar stat file.
+
+    Rows are only decoded when they are accessed. Every row is
+    associated with the schema that was in effect when it was dumped.
+    """
+
+    def __init__(self, path):
+        self._file = open(path, "rb")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        magic, version, self.flags = _file_header.unpack_from(self._map, 0)
+        if magic != MAGIC:
+            raise ValueError("%s is not a columnar stat file" % path)
+        if version != VERSION:
+            raise ValueError("Unsupported columnar stat version %d" % version)
+
+        self.compressed = bool(self.flags & FLAG_COMPRESSED)
+        self.schemas = []
+        # (schema, offset, size, raw size) of every row in the file.
+        self._rows = []
+
+        pos = _file_header.size
+        end = len(self._map)
+        while pos + _record_header.size <= end:
+            rtype, rflags, size, raw_size = \
+                _record_header.unpack_from(self._map, pos)
+            pos += _record_header.size
+            if pos + size > end:
+                # Truncated record, e.g., the simulation is still running.
+                break
+            if rtype == RECORD_SCHEMA:
+                self.schemas.append(Schema(self._payload(pos, size, rflags)))
+            elif rtype == RECORD_ROW:
+                self._rows.append((len(self.schemas) - 1, pos, size, rflags))
+            pos += size
+
+    def close(self):
+        self._map.close()
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self):
+        return len(self._rows)
+
+    def _payload(self, pos, size, flags):
+        data = memoryview(self._map)[pos:pos + size]
+        if flags & FLAG_COMPRESSED:
+            return zlib.decompress(data)
+        return data
+
+    @property
+    def schema(self):
+        """The most recent schema in the file."""
+        return self.schemas[-1] if self.schemas else None
+
+    def rows(self):
+        """Iterate over (tick, schema, values) for every dump."""
+        last = None
+        last_schema = None
+        for schema_id, pos, size, flags in self._rows:
+            schema = self.schemas[schema_id]
+            payload = self._payload(pos, size, flags)
+            count = schema.row_size // 8
+            if not self.compressed:
+                tick, = struct.unpack_from("=Q", payload, 0)
+                values = struct.unpack_from("=%dd" % (count - 1), payload, 8)
+                yield tick, schema, values
+                continue
+
+            # Compressed rows are XORed with the previous row of the
+            # same schema.
+            words = struct.unpack("=%dQ" % count, payload)
+            if last_schema == schema_id:
+                words = tuple(a ^ b for a, b in zip(words, last))
+            last, last_schema = words, schema_id
+            values = struct.unpack("=%dd" % (count - 1),
+                                   struct.pack("=%dQ" % (count - 1),
+                                               *words[1:]))
+            yield words[0], schema, values
+
+    def ticks(self):
+        """Tick of every dump."""
+        return [ tick for tick, _, _ in self.rows() ]
+
+    def column(self, name):
+        """Values of a column for every dump.
+
+        Dumps that used a schema without the column report None.
+        """
+        return [ values[schema.index[name]] if name in schema.index
+                 else None
+                 for _, schema, values in self.rows() ]
+
+    def stat(self, name):
+        """Values of a stat as a dictionary of column name to values."""
+        for schema in reversed(self.schemas):
+            for stat in schema.stats:
+                if stat.name == name:
+                    return { name + sub: self.column(name + sub)
+                             for sub in stat.subnames }
+        raise KeyError(name)
+
+    def array(self, schema=None):
+        """Rows of a schema as a numpy array (dumps x columns).
+
+        The ticks are returned separately. For uncompressed files, the
+        array is a view into the memory-mapped file.
+        """
+        import numpy as np
+
+        if schema is None:
+            schema = len(self.schemas) - 1
+        rows = [ r for r in self._rows if r[0] == schema ]
+        num_columns = len(self.schemas[schema].columns)
+        if not rows:
+            return (np.zeros(0, dtype=np.uint64),
+                    np.zeros((0, num_columns)))
+
+        stride = rows[1][1] - rows[0][1] if len(rows) > 1 else 0
+        contiguous = all(r[1] - rows[0][1] == i * stride
+                         for i, r in enumerate(rows))
+        if not self.compressed and contiguous:
+            raw = np.ndarray(shape=(len(rows), num_columns + 1),
+                             dtype=np.uint64, buffer=self._map,
+                             offset=rows[0][1], strides=(stride, 8))
+        else:
+            raw = np.empty((len(rows), num_columns + 1), dtype=np.uint64)
+            for i, (_, pos, size, flags) in enumerate(rows):
+                raw[i] = np.frombuffer(self._payload(pos, size, flags),
+                                       dtype=np.uint64)
+            if self.compressed:
+                np.bitwise_xor.accumulate(raw, axis=0, out=raw)
+
+        return raw[:, 0], raw[:, 1:].view(np.float64)
+
+if __name__ == "__main__":
+    import sys
+
+    with ColumnarStats(sys.argv[1]) as stats:
+        print("%d dumps, %d schemas" % (len(stats), len(stats.schemas)))
+        for tick, schema, values in stats.rows():
+            last = (tick, schema, values)
+        if stats.schemas and len(stats):
+            tick, schema, values = last
+            print("Last dump at tick %d:" % tick)
+            for name, value in zip(schema.columns, values):
+                print("  %-60s %s" % (name, value))
@@ -111,6 +111,14 @@ pybind_init_event(py::module_ &m_native)
     m.def("setEventQueue", [](EventQueue *q) { return curEventQueue(q); });
     m.def("getEventQueue", &getEventQueue,
           py::return_value_policy::reference);
+    m.def("setEventQueueBackend", [](const std::string &backend) {
+            if (backend == "list")
+                eventQueueBackend = EventQueueBackend::BinList;
+            else if (backend == "calendar")
+                eventQueueBackend = EventQueueBackend::Calendar;
+            else
+                fatal("Unknown event queue backend '%s'\n", backend);
+        });
 
     py::class_<EventQueue>(m, "EventQueue")
         .def("name",  [](EventQueue *eq) { return eq->name(); })
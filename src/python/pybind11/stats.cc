@@ -44,6 +44,7 @@
 #include "pybind11/stl.h"
 
 #include "base/statistics.hh"
+#include "base/stats/columnar.hh"
 #include "base/stats/text.hh"
 #if USE_HDF5
 #include "base/stats/hdf5.hh"
@@ -106,6 +107,7 @@ pybind_init_stats(py::module_ &m_native)
     m
         .def("initSimStats", &Stats::initSimStats)
         .def("initText", &Stats::initText, py::return_value_policy::reference)
+        .def("initColumnar", &Stats::initColumnar)
 #if USE_HDF5
         .def("initHDF5", &Stats::initHDF5)
 #endif
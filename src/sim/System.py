@@ -48,6 +48,8 @@ from m5.objects.SimpleMemory import *
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
                                 'atomic_noncaching']
 
+class MemoryCheckpointFormat(Enum): vals = ['gzip', 'chunked']
+
 if buildEnv['TARGET_ISA'] in ('sparc', 'power'):
     default_byte_order = 'big'
 else:
@@ -87,6 +89,20 @@ class System(SimObject):
         "use to directly address the backstore from another host-OS process. "
         "Leave this empty to unset the MAP_SHARED flag.")
 
+    # Checkpoints can store the backing stores as one gzipped file each
+    # or as chunked images, which are written and read by several
+    # threads, skip all-zero chunks, can be incremental and can be paged
+    # in lazily on restore when stored uncompressed.
+    memory_checkpoint_format = Param.MemoryCheckpointFormat('gzip',
+        "Format of the memory in checkpoints")
+    memory_checkpoint_threads = Param.Unsigned(0, "Threads writing and "
+        "reading chunked memory images (0: one per host CPU)")
+    memory_checkpoint_level = Param.Int(1, "zlib level of chunked memory "
+        "images (0: uncompressed, mapped lazily on restore)")
+    memory_checkpoint_incremental = Param.Bool(False, "Only store the "
+        "memory chunks that changed since the last checkpoint taken or "
+        "restored, referring to that checkpoint for the others")
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     byte_order = Param.ByteOrder(default_byte_order,
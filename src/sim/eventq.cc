@@ -30,6 +30,7 @@
 
 #include "sim/eventq.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <mutex>
@@ -37,6 +38,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
@@ -55,6 +57,9 @@ uint32_t numMainEventQueues = 0;
 std::vector<EventQueue *> mainEventQueue;
 __thread EventQueue *_curEventQueue = NULL;
 bool inParallelMode = false;
+EventQueueBackend eventQueueBackend = EventQueueBackend::BinList;
+
+const size_t EventQueue::minBuckets;
 
 EventQueue *
 getEventQueue(uint32_t index)
@@ -109,6 +114,11 @@ Event::insertBefore(Event *event, Event *curr)
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        calendarInsert(event);
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
@@ -168,6 +178,11 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        calendarRemove(event);
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -192,15 +207,187 @@ EventQueue::remove(Event *event)
     prev->nextBin = Event::removeItem(event, curr);
 }
 
+void
+EventQueue::calendarInsert(Event *event)
+{
+    // Same as the BinList insertion, but restricted to the (short)
+    // list of bins hashed to the same bucket.
+    Event *&bucket = buckets[bucketIndex(event->when())];
+    if (!bucket || *event <= *bucket) {
+        bucket = Event::insertBefore(event, bucket);
+    } else {
+        Event *prev = bucket;
+        Event *curr = bucket->nextBin;
+        while (curr && *curr < *event) {
+            prev = curr;
+            curr = curr->nextBin;
+        }
+        prev->nextBin = Event::insertBefore(event, curr);
+    }
+
+    // insertBefore() only leaves nextInBin empty if it opened a new bin
+    if (!event->nextInBin)
+        ++numBins;
+
+    // The new event is always the top of its bin, so it becomes the
+    // head if it belongs to the earliest bin
+    if (!head || *event <= *head) {
+        head = event;
+        headSlot = event->when() >> bucketShift;
+    }
+
+    if (numBins > 2 * buckets.size())
+        calendarResize(2 * buckets.size());
+}
+
+void
+EventQueue::calendarRemove(Event *event)
+{
+    Event *&bucket = buckets[bucketIndex(event->when())];
+    if (!bucket)
+        panic("event not found!");
+
+    // Find the link pointing to the top of the event's bin
+    Event **link = &bucket;
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    if (!*link || **link != *event)
+        panic("event not found!");
+
+    const bool last_in_bin = *link == event && !event->nextInBin;
+    *link = Event::removeItem(event, *link);
+
+    if (last_in_bin)
+        --numBins;
+
+    if (event == head)
+        head = last_in_bin ? calendarFindHead() : *link;
+
+    if (buckets.size() > minBuckets && numBins < buckets.size() / 2)
+        calendarResize(buckets.size() / 2);
+}
+
+Event *
+EventQueue::calendarFindHead()
+{
+    if (!numBins)
+        return nullptr;
+
+    // All remaining bins are at or after the previous head, so walk
+    // the buckets one width at a time starting from there. The first
+    // bucket whose earliest bin falls within the width being looked at
+    // holds the new head.
+    const size_t mask = buckets.size() - 1;
+    Tick slot = headSlot;
+    for (size_t i = 0; i < buckets.size(); ++i, ++slot) {
+        Event *bin = buckets[slot & mask];
+        if (bin && (bin->when() >> bucketShift) <= slot) {
+            headSlot = slot;
+            return bin;
+        }
+    }
+
+    // Nothing within a full turn of the calendar, the next bin is far
+    // in the future. Fall back to a direct search.
+    Event *min = nullptr;
+    for (Event *bin : buckets) {
+        if (bin && (!min || *bin < *min))
+            min = bin;
+    }
+    headSlot = min->when() >> bucketShift;
+    return min;
+}
+
+void
+EventQueue::calendarResize(size_t num_buckets)
+{
+    calendarRebuild(sortedBins(), num_buckets);
+}
+
+void
+EventQueue::calendarRebuild(const std::vector<Event *> &bins,
+                            size_t num_buckets)
+{
+    assert(isPowerOf2(num_buckets));
+
+    // Estimate the bucket width from the average distance between the
+    // earliest bins, ignoring outliers, and make it a few times larger
+    // so that a bucket typically holds a handful of bins.
+    const size_t samples = std::min<size_t>(bins.size(), 25);
+    if (samples > 1) {
+        auto gap = [&bins](size_t i) {
+            return (double)(bins[i]->when() - bins[i - 1]->when());
+        };
+
+        double average = 0;
+        for (size_t i = 1; i < samples; ++i)
+            average += gap(i) / (samples - 1);
+
+        double kept = 0;
+        size_t num_kept = 0;
+        for (size_t i = 1; i < samples; ++i) {
+            if (gap(i) <= 2 * average) {
+                kept += gap(i);
+                ++num_kept;
+            }
+        }
+
+        if (kept > 0) {
+            // bins of the same tick but different priorities are 0
+            // apart, which can make the width less than a tick
+            const double width =
+                std::max(std::min(3 * kept / num_kept, 0x1p40), 1.0);
+            bucketShift = ceilLog2((Tick)width);
+        }
+    }
+
+    // Prepending the bins in reverse order leaves every bucket sorted
+    buckets.assign(num_buckets, nullptr);
+    for (auto it = bins.rbegin(); it != bins.rend(); ++it) {
+        Event *&bucket = buckets[bucketIndex((*it)->when())];
+        (*it)->nextBin = bucket;
+        bucket = *it;
+    }
+
+    numBins = bins.size();
+    head = bins.empty() ? nullptr : bins.front();
+    if (head)
+        headSlot = head->when() >> bucketShift;
+}
+
+std::vector<Event *>
+EventQueue::sortedBins() const
+{
+    std::vector<Event *> bins;
+
+    if (!calendar) {
+        for (Event *bin = head; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+        return bins;
+    }
+
+    bins.reserve(numBins);
+    for (Event *bucket : buckets) {
+        for (Event *bin = bucket; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+    std::sort(bins.begin(), bins.end(),
+              [](const Event *l, const Event *r) { return *l < *r; });
+
+    return bins;
+}
+
 Event *
 EventQueue::serviceOne()
 {
     std::lock_guard<EventQueue> lock(*this);
     Event *event = head;
-    Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
-    if (next) {
+    if (calendar) {
+        calendarRemove(event);
+    } else if (Event *next = head->nextInBin) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
 
@@ -293,15 +480,12 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
-            Event *nextInBin = nextBin;
+        for (Event *bin : sortedBins()) {
+            Event *nextInBin = bin;
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -316,8 +500,32 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
-    Event *nextBin = head;
-    while (nextBin) {
+    if (calendar) {
+        if (head != (numBins ? sortedBins().front() : nullptr)) {
+            cprintf("head is not the earliest bin!");
+            return false;
+        }
+
+        size_t bins = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            for (Event *bin = buckets[i]; bin; bin = bin->nextBin) {
+                if (bucketIndex(bin->when()) != i ||
+                    (bin->nextBin && *bin->nextBin <= *bin)) {
+                    cprintf("bin in the wrong bucket!");
+                    bin->dump();
+                    return false;
+                }
+                ++bins;
+            }
+        }
+
+        if (bins != numBins) {
+            cprintf("bin count mismatch!");
+            return false;
+        }
+    }
+
+    for (Event *nextBin : sortedBins()) {
         Event *nextInBin = nextBin;
         while (nextInBin) {
             if (nextInBin->when() < time) {
@@ -343,8 +551,6 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
@@ -353,8 +559,28 @@ EventQueue::debugVerify() const
 Event*
 EventQueue::replaceHead(Event* s)
 {
-    Event* t = head;
-    head = s;
+    if (!calendar) {
+        Event* t = head;
+        head = s;
+        return t;
+    }
+
+    // Hand out the current contents as a single sorted list of bins,
+    // and spread the new list over the buckets.
+    std::vector<Event *> old_bins = sortedBins();
+    std::vector<Event *> new_bins;
+    for (Event *bin = s; bin; bin = bin->nextBin)
+        new_bins.push_back(bin);
+
+    Event *t = nullptr;
+    for (auto it = old_bins.rbegin(); it != old_bins.rend(); ++it) {
+        (*it)->nextBin = t;
+        t = *it;
+    }
+
+    calendarRebuild(new_bins, std::max(minBuckets,
+        new_bins.empty() ? 0 : (size_t)1 << ceilLog2(new_bins.size())));
+
     return t;
 }
 
@@ -418,8 +644,12 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const std::string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0),
+      calendar(eventQueueBackend == EventQueueBackend::Calendar),
+      bucketShift(9), headSlot(0), numBins(0)
 {
+    if (calendar)
+        buckets.assign(minBuckets, nullptr);
 }
 
 void
@@ -43,6 +43,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/debug.hh"
 #include "base/flags.hh"
@@ -76,6 +77,23 @@ extern __thread EventQueue *_curEventQueue;
 //! Current mode of execution: parallel / serial
 extern bool inParallelMode;
 
+//! Data structures that can be used to keep the events of a queue
+//! sorted.
+enum class EventQueueBackend
+{
+    //! Sorted linked list of (tick, priority) bins. Insertion is linear
+    //! in the number of bins.
+    BinList,
+    //! Calendar queue hashing bins into buckets by their tick.
+    //! Insertion and removal of the head take expected constant time.
+    Calendar
+};
+
+//! Backend used by event queues created from now on. This is meant to
+//! be selected once at startup, before the main event queues are
+//! created.
+extern EventQueueBackend eventQueueBackend;
+
 //! Function for returning eventq queue for the provided
 //! index. The function allocates a new queue in case one
 //! does not exist for the index, provided that the index
@@ -653,6 +671,42 @@ class EventQueue
      */
     UncontendedMutex service_mutex;
 
+    /**
+     * Calendar queue state, only used if the queue was created with the
+     * Calendar backend. Bins are hashed into buckets by their tick,
+     * each bucket being a sorted list of bins linked through nextBin
+     * (just like the BinList backend, but much shorter), and head
+     * always points to the earliest bin across all buckets. The number
+     * of buckets grows and shrinks with the number of bins, and the
+     * bucket width is re-estimated from the spacing of the earliest
+     * bins on every resize.
+     */
+    const bool calendar;
+    std::vector<Event *> buckets;
+    //! log2 of the number of ticks covered by a bucket
+    unsigned bucketShift;
+    //! Bucket width multiple (when >> bucketShift) of head
+    Tick headSlot;
+    //! Number of distinct bins in the calendar
+    size_t numBins;
+
+    static const size_t minBuckets = 16;
+
+    size_t
+    bucketIndex(Tick when) const
+    {
+        return (when >> bucketShift) & (buckets.size() - 1);
+    }
+
+    void calendarInsert(Event *event);
+    void calendarRemove(Event *event);
+    Event *calendarFindHead();
+    void calendarResize(size_t num_buckets);
+    void calendarRebuild(const std::vector<Event *> &bins,
+                         size_t num_buckets);
+    //! All bins in the queue, sorted by (tick, priority)
+    std::vector<Event *> sortedBins() const;
+
     //! Insert / remove event from the queue. Should only be called
     //! by thread operating this queue.
     void insert(Event *event);
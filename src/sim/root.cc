@@ -39,6 +39,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "base/free_list_pool.hh"
 #include "base/hostinfo.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
@@ -66,6 +67,10 @@ Root::RootStats::RootStats()
              UNIT_RATE(Stats::Units::Tick, Stats::Units::Second),
              "The number of ticks simulated per host second (ticks/s)"),
     ADD_STAT(hostMemory, UNIT_BYTE, "Number of bytes of host memory used"),
+    ADD_STAT(hostPoolHits, UNIT_COUNT,
+             "Number of host allocations served from a free list pool"),
+    ADD_STAT(hostPoolMisses, UNIT_COUNT,
+             "Number of host allocations a free list pool passed to the heap"),
 
     statTime(true),
     startTick(0)
@@ -94,6 +99,34 @@ Root::RootStats::RootStats()
     hostTickRate = simTicks / hostSeconds;
 }
 
+void
+Root::RootStats::regStats()
+{
+    Stats::Group::regStats();
+
+    // The pools are all created during static initialization, so they
+    // are known by now.
+    const auto &pools = FreeListPool::pools();
+    hostPoolHits.init(pools.size()).flags(Stats::total | Stats::nozero);
+    hostPoolMisses.init(pools.size()).flags(Stats::total | Stats::nozero);
+    for (int i = 0; i < pools.size(); i++) {
+        hostPoolHits.subname(i, pools[i]->name());
+        hostPoolMisses.subname(i, pools[i]->name());
+    }
+}
+
+void
+Root::RootStats::preDumpStats()
+{
+    const auto &pools = FreeListPool::pools();
+    for (int i = 0; i < pools.size(); i++) {
+        hostPoolHits[i] = pools[i]->hits();
+        hostPoolMisses[i] = pools[i]->misses();
+    }
+
+    Stats::Group::preDumpStats();
+}
+
 void
 Root::RootStats::resetStats()
 {
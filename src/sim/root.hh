@@ -93,7 +93,9 @@ class Root : public SimObject
   public: // Global statistics
     struct RootStats : public Stats::Group
     {
+        void regStats() override;
         void resetStats() override;
+        void preDumpStats() override;
 
         Stats::Formula simSeconds;
         Stats::Value simTicks;
@@ -103,6 +105,8 @@ class Root : public SimObject
 
         Stats::Formula hostTickRate;
         Stats::Value hostMemory;
+        Stats::Vector hostPoolHits;
+        Stats::Vector hostPoolMisses;
 
         static RootStats instance;
 
@@ -215,7 +215,10 @@ System::System(const Params &p)
       kvmVM(nullptr),
 #endif
       physmem(name() + ".physmem", p.memories, p.mmap_using_noreserve,
-              p.shared_backstore),
+              p.shared_backstore,
+              p.memory_checkpoint_format == Enums::chunked,
+              p.memory_checkpoint_threads, p.memory_checkpoint_level,
+              p.memory_checkpoint_incremental),
       memoryMode(p.mem_mode),
       _cacheLineSize(p.cache_line_size),
       workItemsBegin(0),
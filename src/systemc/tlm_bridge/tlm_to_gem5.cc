@@ -109,7 +109,7 @@ payload2packet(RequestorID _id, tlm::tlm_generic_payload &trans)
     }
 
     Request::Flags flags;
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         trans.get_address(), trans.get_data_length(), flags, _id);
 
     /*
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Host-time microbenchmark for the cache compressors. Lines of several
+ * kinds of data are compressed with the real compress() of each
+ * compressor, built from the same parameters Compressors.py gives them,
+ * and the time per line is reported along with the average compressed
+ * size, which also serves as a checksum.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "mem/cache/compressors/base.hh"
+#include "mem/cache/compressors/base_delta.hh"
+#include "mem/cache/compressors/cpack.hh"
+#include "mem/cache/compressors/dictionary_compressor.hh"
+#include "mem/cache/compressors/fpc.hh"
+#include "mem/cache/compressors/multi.hh"
+#include "mem/cache/compressors/repeated_qwords.hh"
+#include "mem/cache/compressors/zero.hh"
+#include "params/Base16Delta8.hh"
+#include "params/Base32Delta16.hh"
+#include "params/Base32Delta8.hh"
+#include "params/Base64Delta16.hh"
+#include "params/Base64Delta32.hh"
+#include "params/Base64Delta8.hh"
+#include "params/CPack.hh"
+#include "params/FPC.hh"
+#include "params/MultiCompressor.hh"
+#include "params/RepeatedQwordsCompressor.hh"
+#include "params/ZeroCompressor.hh"
+
+namespace
+{
+
+const int blkSize = 64;
+const std::size_t lineWords = blkSize / sizeof(uint64_t);
+
+/** The parameters of every compressor, which must outlive them. */
+std::vector<std::unique_ptr<SimObjectParams>> allParams;
+
+/**
+ * Fill in the parameters shared by all compressors. The latencies only
+ * change the cycles reported to the cache, not the work done.
+ */
+void
+setBaseParams(BaseCacheCompressorParams &p, const std::string &name,
+              unsigned chunk_size_bits, int size_threshold)
+{
+    p.name = name;
+    p.eventq_index = 0;
+    p.block_size = blkSize;
+    p.chunk_size_bits = chunk_size_bits;
+    p.size_threshold_percentage = size_threshold;
+    p.comp_chunks_per_cycle = 1;
+    p.comp_extra_latency = Cycles(1);
+    p.decomp_chunks_per_cycle = 1;
+    p.decomp_extra_latency = Cycles(1);
+}
+
+/** Create a dictionary compressor with its default parameters. */
+template <class C>
+C *
+makeDictionary(const std::string &name, unsigned chunk_size_bits,
+               int dictionary_size, int size_threshold=50)
+{
+    auto *p = new typename C::Params();
+    allParams.emplace_back(p);
+    setBaseParams(*p, name, chunk_size_bits, size_threshold);
+    p->dictionary_size = dictionary_size;
+    return new C(*p);
+}
+
+Compressor::FPC *
+makeFPC()
+{
+    auto *p = new FPCParams();
+    allParams.emplace_back(p);
+    setBaseParams(*p, "fpc", 32, 50);
+    // FPC has no dictionary
+    p->dictionary_size = 1;
+    p->zero_run_bits = 3;
+    return new Compressor::FPC(*p);
+}
+
+/** The BDI configuration of Compressors.py. */
+Compressor::Multi *
+makeBDI()
+{
+    using namespace Compressor;
+
+    auto *p = new MultiCompressorParams();
+    allParams.emplace_back(p);
+    setBaseParams(*p, "bdi", 32, 50);
+    p->encoding_in_tags = true;
+    p->compressors = {
+        makeDictionary<Zero>("bdi.zero", 64, blkSize, 99),
+        makeDictionary<RepeatedQwords>("bdi.rep", 64, blkSize, 99),
+        makeDictionary<Base64Delta8>("bdi.b64d8", 64, blkSize, 99),
+        makeDictionary<Base64Delta16>("bdi.b64d16", 64, blkSize, 99),
+        makeDictionary<Base64Delta32>("bdi.b64d32", 64, blkSize, 99),
+        makeDictionary<Base32Delta8>("bdi.b32d8", 64, blkSize, 99),
+        makeDictionary<Base32Delta16>("bdi.b32d16", 64, blkSize, 99),
+        makeDictionary<Base16Delta8>("bdi.b16d8", 64, blkSize, 99),
+    };
+    for (auto *compressor : p->compressors)
+        compressor->regStats();
+    return new Multi(*p);
+}
+
+struct DataSet
+{
+    const char *name;
+    /** Fill a line with values of this kind. */
+    std::function<void(uint64_t *, std::mt19937_64 &)> fill;
+};
+
+/**
+ * Compress lines of a data set, returning the host time in nanoseconds
+ * per line and the average compressed size in bits.
+ */
+double
+run(Compressor::Base &compressor, const DataSet &data_set, unsigned lines,
+    double &avg_bits)
+{
+    // Cycle through more lines than fit in the L1 cache of the host, so
+    // that the data accesses are not unrealistically cheap
+    const unsigned num_lines = 1024;
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> data(num_lines * lineWords);
+    for (unsigned i = 0; i < num_lines; i++)
+        data_set.fill(&data[i * lineWords], rng);
+
+    uint64_t total_bits = 0;
+    Cycles comp_lat, decomp_lat;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < lines; i++) {
+        const uint64_t *line = &data[(i % num_lines) * lineWords];
+        total_bits +=
+            compressor.compress(line, comp_lat, decomp_lat)->getSizeBits();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    avg_bits = double(total_bits) / lines;
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+        lines;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 2)
+        panic("usage: %s [lines]\n", argv[0]);
+
+    const unsigned lines = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    using namespace Compressor;
+    const std::vector<std::pair<const char *, Base *>> compressors = {
+        { "zero", makeDictionary<Zero>("zero", 64, blkSize) },
+        { "rep_qwords",
+          makeDictionary<RepeatedQwords>("rep_qwords", 64, blkSize) },
+        { "cpack", makeDictionary<CPack>("cpack", 32, blkSize) },
+        { "fpc", makeFPC() },
+        { "b64d8", makeDictionary<Base64Delta8>("b64d8", 64, blkSize) },
+        { "bdi", makeBDI() },
+    };
+    for (const auto &compressor : compressors)
+        compressor.second->regStats();
+
+    const std::vector<DataSet> data_sets = {
+        { "zero", [](uint64_t *line, std::mt19937_64 &rng) {
+              std::fill(line, line + lineWords, 0);
+          } },
+        { "repeated", [](uint64_t *line, std::mt19937_64 &rng) {
+              std::fill(line, line + lineWords, rng());
+          } },
+        { "pointers", [](uint64_t *line, std::mt19937_64 &rng) {
+              // Pointers into the same heap region
+              const uint64_t base = 0x7f3a12000000 + (rng() % 16) * 4096;
+              for (std::size_t i = 0; i < lineWords; i++)
+                  line[i] = base + (rng() % 512) * 8;
+          } },
+        { "small_ints", [](uint64_t *line, std::mt19937_64 &rng) {
+              // Pairs of small signed 32 bit integers, with some zeros
+              for (std::size_t i = 0; i < lineWords; i++) {
+                  const uint32_t lo = rng() % 4 ? rng() % 200 - 100 : 0;
+                  const uint32_t hi = rng() % 4 ? rng() % 200 - 100 : 0;
+                  line[i] = (uint64_t(hi) << 32) | lo;
+              }
+          } },
+        { "random", [](uint64_t *line, std::mt19937_64 &rng) {
+              for (std::size_t i = 0; i < lineWords; i++)
+                  line[i] = rng();
+          } },
+    };
+
+    cprintf("%d lines of %d bytes per run, ns per line (average bits)\n\n",
+            lines, blkSize);
+    cprintf("%-11s", "compressor");
+    for (const auto &data_set : data_sets)
+        cprintf(" %18s", data_set.name);
+    cprintf("\n");
+    for (const auto &compressor : compressors) {
+        cprintf("%-11s", compressor.first);
+        for (const auto &data_set : data_sets) {
+            double avg_bits;
+            const double time = run(*compressor.second, data_set, lines,
+                                    avg_bits);
+            cprintf(" %9.1f (%6.1f)", time, avg_bits);
+        }
+        cprintf("\n");
+    }
+
+    cprintf("\n%-30s %12s %12s\n", "pool", "hits", "misses");
+    for (const FreeListPool *pool : { &BaseDictionaryCompressor::objectPool,
+            &BaseDictionaryCompressor::entriesPool }) {
+        cprintf("%-30s %12d %12d\n", pool->name(), pool->hits(),
+                pool->misses());
+    }
+
+    for (const auto &compressor : compressors)
+        delete compressor.second;
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2021 The Regents of The University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host-time microbenchmark for the event queue backends. Every
+ * workload is replayed on a BinList and a Calendar queue and the order
+ * in which events are serviced is checked to be identical. Workloads
+ * can also move and cancel pending events, as timeouts do.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "sim/eventq.hh"
+
+namespace
+{
+
+/**
+ * Event re-scheduling itself after a delay drawn from the workload's
+ * distribution, until the requested number of events has been
+ * serviced. Every churn-th event also moves another pending event,
+ * either with reschedule(), or by descheduling and scheduling it.
+ */
+class BenchEvent : public Event
+{
+  public:
+    typedef std::function<Tick()> Delay;
+
+  private:
+    EventQueue &eventq;
+    const Delay delay;
+    const unsigned id;
+    const unsigned churn;
+    const std::vector<BenchEvent *> &peers;
+    Counter &remaining;
+    uint64_t &checksum;
+
+    void
+    movePeer()
+    {
+        BenchEvent *peer = peers[(id * 7919 + remaining) % peers.size()];
+        if (peer == this || !peer->scheduled())
+            return;
+
+        const Tick when = eventq.getCurTick() + peer->delay();
+        if (remaining % 4 == 0) {
+            eventq.deschedule(peer);
+            eventq.schedule(peer, when);
+        } else {
+            eventq.reschedule(peer, when);
+        }
+    }
+
+  public:
+    BenchEvent(EventQueue &_eventq, Delay _delay, unsigned _id,
+               Priority prio, unsigned _churn,
+               const std::vector<BenchEvent *> &_peers,
+               Counter &_remaining, uint64_t &_checksum)
+        : Event(prio), eventq(_eventq), delay(_delay), id(_id),
+          churn(_churn), peers(_peers), remaining(_remaining),
+          checksum(_checksum)
+    {}
+
+    void
+    process() override
+    {
+        checksum = checksum * 31 + id;
+        if (--remaining <= 0)
+            return;
+        if (churn && remaining % churn == 0)
+            movePeer();
+        eventq.schedule(this, eventq.getCurTick() + delay());
+    }
+};
+
+struct Workload
+{
+    const char *name;
+    const char *desc;
+    /** Create the delay distribution of the n-th object. */
+    std::function<BenchEvent::Delay(unsigned, std::mt19937_64 &)> delay;
+    /** Move a pending event every churn events, never if 0. */
+    unsigned churn;
+};
+
+/**
+ * Run a workload with the given backend, returning the host time in
+ * seconds and the checksum of the servicing order.
+ */
+double
+run(const Workload &workload, EventQueueBackend backend, unsigned objects,
+    Counter events, uint64_t &checksum)
+{
+    eventQueueBackend = backend;
+    EventQueue eventq("bench");
+    curEventQueue(&eventq);
+
+    std::mt19937_64 rng(1);
+    Counter remaining = events;
+    checksum = 0;
+
+    std::vector<BenchEvent *> bench_events;
+    for (unsigned i = 0; i < objects; ++i) {
+        // Mix priorities like clocked objects and the memory system do
+        const Event::Priority prio = (i % 3 == 0) ?
+            Event::CPU_Tick_Pri : Event::Default_Pri;
+        bench_events.push_back(new BenchEvent(eventq,
+            workload.delay(i, rng), i, prio, workload.churn, bench_events,
+            remaining, checksum));
+        eventq.schedule(bench_events.back(), rng() % 1000);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (remaining > 0 && !eventq.empty())
+        eventq.serviceOne();
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto *event : bench_events) {
+        if (event->scheduled())
+            eventq.deschedule(event);
+        delete event;
+    }
+    curEventQueue(nullptr);
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 3)
+        panic("usage: %s [objects] [events]\n", argv[0]);
+
+    const unsigned objects = argc > 1 ? std::atoi(argv[1]) : 512;
+    const Counter events = argc > 2 ? std::atoll(argv[2]) : 10000000;
+
+    // Clock periods in ticks of typical CPU, cache, network and DRAM
+    // clock domains
+    const std::vector<Tick> periods = { 250, 333, 500, 625, 1000, 1250 };
+
+    const std::vector<Workload> workloads = {
+        { "clocked", "self-ticking objects in a few clock domains",
+          [&periods](unsigned i, std::mt19937_64 &rng) {
+              const Tick period = periods[i % periods.size()];
+              return [period]() { return period; };
+          }, 0 },
+        { "memory", "cache hits and exponentially distributed misses",
+          [](unsigned i, std::mt19937_64 &rng) {
+              std::exponential_distribution<> miss(1 / 50000.);
+              return [&rng, miss]() mutable -> Tick {
+                  if (rng() % 10 < 8)
+                      return 500 * (1 + rng() % 4);
+                  return 500 + (Tick)miss(rng);
+              };
+          }, 0 },
+        { "mixed", "clocked objects, memory latencies and rare timers",
+          [&periods](unsigned i, std::mt19937_64 &rng) {
+              const Tick period = periods[i % periods.size()];
+              return [period, i, &rng]() -> Tick {
+                  if (i % 64 == 0)
+                      return 1000000000 + rng() % 1000000;
+                  if (i % 2)
+                      return period;
+                  return period * (1 + rng() % 200);
+              };
+          }, 0 },
+        { "timeouts", "memory latencies, moving and cancelling timeouts",
+          [](unsigned i, std::mt19937_64 &rng) {
+              return [&rng]() -> Tick {
+                  if (rng() % 10 < 8)
+                      return 500 * (1 + rng() % 4);
+                  return 10000 + rng() % 100000;
+              };
+          }, 4 },
+    };
+
+    cprintf("%d objects, %d events per run\n\n", objects, events);
+    cprintf("%-10s %12s %12s %8s\n", "workload", "list (s)", "calendar (s)",
+            "speedup");
+    for (const auto &workload : workloads) {
+        uint64_t list_sum, calendar_sum;
+        const double list_time = run(workload, EventQueueBackend::BinList,
+                                     objects, events, list_sum);
+        const double calendar_time = run(workload,
+            EventQueueBackend::Calendar, objects, events, calendar_sum);
+
+        if (list_sum != calendar_sum)
+            panic("%s: backends serviced events in a different order\n",
+                  workload.name);
+
+        cprintf("%-10s %12.3f %12.3f %7.2fx  (%s)\n", workload.name,
+                list_time, calendar_time, list_time / calendar_time,
+                workload.desc);
+    }
+
+    return 0;
+}
@@ -176,15 +176,20 @@ class SConsFixture(UniqueFixture):
         log_call(log.test_log, command, time=None, stderr=sys.stderr)
 
 class Gem5Fixture(SConsFixture):
-    def __new__(cls, isa, variant, protocol=None):
-        target_dir = joinpath(config.build_dir, isa.upper())
-        if protocol:
-            target_dir += '_' + protocol
+    def __new__(cls, isa, variant, protocol=None, build_opts=None):
+        if build_opts:
+            # The build directory is named after the build_opts file, so
+            # scons picks its defaults up without any extra options.
+            target_dir = joinpath(config.build_dir, build_opts)
+        else:
+            target_dir = joinpath(config.build_dir, isa.upper())
+            if protocol:
+                target_dir += '_' + protocol
         target = joinpath(target_dir, 'gem5.%s' % variant)
         obj = super(Gem5Fixture, cls).__new__(cls, target)
         return obj
 
-    def _init(self, isa, variant, protocol=None):
+    def _init(self, isa, variant, protocol=None, build_opts=None):
         self.name = constants.gem5_binary_fixture_name
 
         self.targets = [self.target]
@@ -192,7 +197,7 @@ class Gem5Fixture(SConsFixture):
         self.directory = config.base_dir
 
         self.options = []
-        if protocol:
+        if protocol and not build_opts:
             self.options = [ '--default=' + isa.upper(),
                              'PROTOCOL=' + protocol ]
         self.set_global()
@@ -87,3 +87,19 @@ for basename_noext, args in null_tests:
         valid_isas=(constants.null_tag,),
         valid_hosts=constants.supported_hosts,
     )
+
+# Run the ruby testers on a protocol compiled with SLICC dispatch tables too.
+for basename_noext, args in null_tests:
+    if not basename_noext.startswith('ruby_'):
+        continue
+    gem5_verify_config(
+        name=basename_noext,
+        fixtures=(),
+        verifiers=(),
+        config=joinpath(config.base_dir, 'configs',
+            'example', basename_noext + '.py'),
+        config_args=args,
+        valid_isas=(constants.null_tag,),
+        valid_hosts=constants.supported_hosts,
+        build_opts='NULL_MESI_Two_Level_Tables',
+    )
@@ -59,7 +59,8 @@ def gem5_verify_config(name,
                        valid_variants=constants.supported_variants,
                        length=constants.supported_lengths[0],
                        valid_hosts=constants.supported_hosts,
-                       protocol=None):
+                       protocol=None,
+                       build_opts=None):
     '''
     Helper class to generate common gem5 tests using verifiers.
 
@@ -84,6 +85,10 @@ def gem5_verify_config(name,
 
     :param valid_variants: An iterable with the variant levels that
         this test can be ran for. (E.g. opt, debug)
+
+    :param build_opts: Name of a build_opts file to build gem5 with instead
+        of the default configuration of the isa. (E.g.
+        NULL_MESI_Two_Level_Tables)
     '''
     fixtures = list(fixtures)
     testsuites = []
@@ -105,6 +110,8 @@ def gem5_verify_config(name,
                         opt=opt)
                 if protocol:
                     _name += '-'+protocol
+                if build_opts:
+                    _name += '-'+build_opts
 
                 # Create the running of gem5 subtest.  NOTE: We specifically
                 # create this test before our verifiers so this is listed
@@ -126,7 +133,8 @@ def gem5_verify_config(name,
                 # Create the gem5 target for the specific architecture and
                 # variant.
                 _fixtures = copy.copy(fixtures)
-                _fixtures.append(Gem5Fixture(isa, opt, protocol))
+                _fixtures.append(Gem5Fixture(isa, opt, protocol,
+                                             build_opts))
                 _fixtures.append(tempdir)
                 _fixtures.append(gem5_returncode)
 
@@ -0,0 +1,117 @@
+#! /usr/bin/env python3
+
+# Copyright (c) 2021 The Regents of The University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Compare the host speed of two gem5 builds, e.g. from before and after a
+change to a CPU model, as the simulated instructions per host second
+(hostInstRate) over a set of workloads. Every workload is run several
+times with each build and the fastest run is kept, since host noise can
+only slow a run down. The number of simulated instructions must be the
+same for both builds.
+
+By default the workloads run on the DerivO3CPU with the configuration of
+the CPU regression tests. The workloads are paths to binaries, e.g. to the
+Bubblesort and FloatMM binaries that the regressions download:
+
+    util/host-inst-rate.py before/gem5.opt after/gem5.opt \\
+        tests/gem5/resources/cpu_tests/gcn3_x86/Bubblesort \\
+        tests/gem5/resources/cpu_tests/gcn3_x86/FloatMM
+
+They can also be fetched from
+http://dist.gem5.org/dist/develop/gem5/cpu_tests/benchmarks/bin/x86/.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+def read_stats(stats_file):
+    """Get the first dump of the global stats of a stats.txt file."""
+    stats = {}
+    with open(stats_file) as f:
+        for line in f:
+            if line.startswith('---------- End Simulation Statistics'):
+                break
+            m = re.match(r'^(simInsts|hostInstRate)\s+(\S+)',
+                         line)
+            if m:
+                stats[m.group(1)] = float(m.group(2))
+    return stats
+
+def run(gem5, config, cpu, binary):
+    with tempfile.TemporaryDirectory() as outdir:
+        subprocess.run([gem5, '-d', outdir, config, '--cpu', cpu, binary],
+                       check=True, stdout=subprocess.DEVNULL,
+                       stderr=subprocess.DEVNULL)
+        return read_stats(os.path.join(outdir, 'stats.txt'))
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('before', help='gem5 binary before the change')
+    parser.add_argument('after', help='gem5 binary after the change')
+    parser.add_argument('workloads', nargs='+',
+                        help='workload binaries to simulate')
+    parser.add_argument('--config', default=os.path.join(root, 'tests',
+                        'gem5', 'cpu_tests', 'run.py'),
+                        help='configuration script taking --cpu and the '
+                        'workload binary (default: %(default)s)')
+    parser.add_argument('--cpu', default='DerivO3CPU',
+                        help='CPU model (default: %(default)s)')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='runs of each workload per build '
+                        '(default: %(default)s)')
+    args = parser.parse_args()
+
+    print('{:<20} {:>12} {:>14} {:>14} {:>8}'.format('workload',
+          'sim insts', 'before (i/s)', 'after (i/s)', 'speedup'))
+    for workload in args.workloads:
+        rates = []
+        insts = set()
+        for gem5 in (args.before, args.after):
+            best = 0
+            for _ in range(args.runs):
+                stats = run(gem5, args.config, args.cpu, workload)
+                insts.add(stats['simInsts'])
+                best = max(best, stats['hostInstRate'])
+            rates.append(best)
+
+        if len(insts) != 1:
+            sys.exit('{}: the builds simulated a different number of '
+                     'instructions: {}'.format(workload, sorted(insts)))
+
+        print('{:<20} {:>12.0f} {:>14.0f} {:>14.0f} {:>7.2f}x'.format(
+              os.path.basename(workload), insts.pop(), rates[0], rates[1],
+              rates[1] / rates[0]))
+
+if __name__ == '__main__':
+    main()